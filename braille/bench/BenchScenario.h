@@ -0,0 +1,92 @@
+/*
+ * BenchScenario.h - The scenario format of commands.txt, shared by
+ * avr_bench (simavr, cycle counts) and sim_bench (braille_sim's board,
+ * replies only).
+ *
+ * One command per line, sent as "<line>\n"; blank lines and '#' comments
+ * are skipped. "text <words>" expands to one P:XX per character and is
+ * reported as one run. A command ends with its final reply line; the
+ * visualization printed before P:'s OK is not one.
+ */
+
+#ifndef BENCH_SCENARIO_H
+#define BENCH_SCENARIO_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * Reads a scenario file. Returns false if it cannot be opened.
+ */
+static inline bool loadScenario(const char* path, std::vector<std::string>* scenario) {
+  std::ifstream in(path);
+  if (!in) return false;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+    if (line.empty() || line[0] == '#') continue;
+    scenario->push_back(line);
+  }
+  return true;
+}
+
+/**
+ * True for a line that ends a command: "OK", "PONG", or one starting
+ * with a reply tag of braille/src/main.cpp (ERR..., SUM:, FSUM:, CAPS:,
+ * KEYS:, T:).
+ */
+static inline bool isFinalReply(const std::string& line) {
+  static const char* const TAGS[] = { "ERR", "SUM:", "FSUM:", "CAPS:", "KEYS:", "T:" };
+  if (line == "OK" || line == "PONG") return true;
+  for (size_t i = 0; i < sizeof(TAGS) / sizeof(TAGS[0]); i++) {
+    if (line.compare(0, strlen(TAGS[i]), TAGS[i]) == 0) return true;
+  }
+  return false;
+}
+
+/**
+ * Grade 1 letter in the firmware's bit order (bit0=d1, bit1=d2, bit2=d3,
+ * bit4=d4, bit5=d5, bit6=d6). Anything else is a blank cell.
+ */
+static inline uint8_t letterPattern(char c) {
+  // a-j as dots 1,2,4,5 in standard order
+  static const uint8_t AJ[10] = {
+    0x01, 0x03, 0x11, 0x31, 0x21, 0x13, 0x33, 0x23, 0x12, 0x32
+  };
+  if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+  if (c >= 'a' && c <= 'j') return AJ[c - 'a'];
+  if (c >= 'k' && c <= 't') return AJ[c - 'k'] | 0x04;          // + dot 3
+  if (c == 'w') return 0x72;                                     // dots 2456
+  if (c >= 'u' && c <= 'z') {
+    static const char UZ[] = "uvxyz";
+    const char* p = strchr(UZ, c);
+    return AJ[p - UZ] | 0x44;                                    // + dots 3,6
+  }
+  return 0x00;
+}
+
+/**
+ * The commands one scenario line sends, and the name it is reported as.
+ */
+static inline std::vector<std::string> expandCommand(const std::string& line, std::string* name) {
+  std::vector<std::string> out;
+  if (line.compare(0, 5, "text ") != 0) {
+    *name = line;
+    out.push_back(line);
+    return out;
+  }
+  std::string text = line.substr(5);
+  *name = "text:" + text;
+  for (size_t i = 0; i < text.size(); i++) {
+    char cmd[8];
+    snprintf(cmd, sizeof(cmd), "P:%02X", letterPattern(text[i]));
+    out.push_back(cmd);
+  }
+  return out;
+}
+
+#endif
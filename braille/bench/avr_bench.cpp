@@ -0,0 +1,309 @@
+/*
+ * avr_bench.cpp - Cycle-accurate benchmark of the firmware under simavr.
+ *
+ *   avr_bench --elf firmware.elf [--out results.json] [--mcu atmega328p]
+ *             [--freq 16000000] [commands.txt]
+ *
+ * Loads the [env:uno] firmware.elf into simavr, waits for the ready line,
+ * then sends each scenario command over UART0 (flow-controlled, at the
+ * baud the firmware configured) and counts AVR cycles from the first byte
+ * of the command to the '\n' of its final reply line (BenchScenario.h).
+ * The count includes the bytes' time on the wire in both directions, as
+ * the host sees it; "wire_in_cycles" is the part spent receiving.
+ *
+ * Also reports flash and static SRAM from the ELF and the peak stack depth
+ * (lowest SP seen, checked after every instruction) overall and per
+ * command. Results go to a JSON file for check_cycles.py.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <simavr/avr_uart.h>
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/sim_io.h>
+#include <simavr/sim_irq.h>
+
+#include "BenchScenario.h"
+
+#define DEFAULT_MCU "atmega328p"
+#define DEFAULT_FREQ 16000000UL
+#define READY_LINE "BRAILLE_LED_READY"
+#define COMMAND_TIMEOUT_S 5          // per command, in simulated seconds
+
+struct BenchResult {
+  std::string name;
+  int commands;                      // P:XX sent for a text run, else 1
+  uint64_t cycles;
+  uint64_t wireInCycles;
+  uint16_t peakStack;
+  std::string reply;                 // last reply line
+  bool timedOut;
+};
+
+// UART state shared with the simavr callbacks
+struct Uart {
+  avr_irq_t* input;
+  bool xon;
+  std::string line;
+  std::vector<std::string> lines;
+  uint64_t lastLineCycle;
+};
+
+static avr_t* avr = nullptr;
+static Uart uart;
+static uint16_t minSp = 0xFFFF;
+
+static void onUartOutput(struct avr_irq_t*, uint32_t value, void*) {
+  char c = (char)value;
+  if (c == '\r') return;
+  if (c != '\n') {
+    uart.line += c;
+    return;
+  }
+  uart.lines.push_back(uart.line);
+  uart.lastLineCycle = avr->cycle;
+  uart.line.clear();
+}
+
+static void onUartXon(struct avr_irq_t*, uint32_t, void*) {
+  uart.xon = true;
+}
+
+static void onUartXoff(struct avr_irq_t*, uint32_t, void*) {
+  uart.xon = false;
+}
+
+static uint16_t stackPointer() {
+  return avr->data[R_SPL] | (avr->data[R_SPH] << 8);
+}
+
+/**
+ * Steps the core one instruction, feeding the next pending byte whenever
+ * the UART accepts input. Returns false if the core stopped or crashed.
+ */
+static bool step(std::deque<uint8_t>& pending) {
+  if (uart.xon && !pending.empty()) {
+    avr_raise_irq(uart.input, pending.front());
+    pending.pop_front();
+  }
+  int state = avr_run(avr);
+  uint16_t sp = stackPointer();
+  if (sp != 0 && sp < minSp) minSp = sp;   // SP is 0 until crt0 sets it
+  return state != cpu_Done && state != cpu_Crashed;
+}
+
+/**
+ * AVR cycles one 8N1 byte takes at the baud in UBRR0 (ATmega328P layout:
+ * UCSR0A 0xC0 with U2X0 = bit 1, UBRR0L 0xC4, UBRR0H 0xC5).
+ */
+static uint32_t wireCyclesPerByte() {
+  uint16_t ubrr = avr->data[0xC4] | ((avr->data[0xC5] & 0x0F) << 8);
+  uint32_t cyclesPerBit = (avr->data[0xC0] & 0x02) ? 8 : 16;
+  return cyclesPerBit * (ubrr + 1) * 10;
+}
+
+/**
+ * Sends one command and runs until its final reply. Returns the cycles
+ * from the first byte until the reply's '\n' went out.
+ */
+static bool runCommand(const std::string& cmd, uint64_t timeoutCycles, uint64_t* cycles,
+                       std::string* reply) {
+  std::deque<uint8_t> pending(cmd.begin(), cmd.end());
+  pending.push_back('\n');
+
+  size_t seen = uart.lines.size();
+  uint64_t start = avr->cycle;
+  while (avr->cycle - start < timeoutCycles) {
+    if (!step(pending)) return false;
+    for (; seen < uart.lines.size(); seen++) {
+      if (isFinalReply(uart.lines[seen])) {
+        *cycles = uart.lastLineCycle - start;
+        *reply = uart.lines[seen];
+        return true;
+      }
+    }
+  }
+  *cycles = avr->cycle - start;
+  *reply = "";
+  return false;
+}
+
+static void writeJsonString(FILE* f, const std::string& s) {
+  fputc('"', f);
+  for (size_t i = 0; i < s.size(); i++) {
+    char c = s[i];
+    if (c == '"' || c == '\\') fprintf(f, "\\%c", c);
+    else if ((unsigned char)c < 0x20) fprintf(f, "\\u%04x", c);
+    else fputc(c, f);
+  }
+  fputc('"', f);
+}
+
+static void usage() {
+  fprintf(stderr,
+          "usage: avr_bench --elf FILE [--out FILE] [--mcu NAME] [--freq HZ] [COMMANDS]\n");
+}
+
+int main(int argc, char** argv) {
+  const char* elfPath = nullptr;
+  const char* outPath = "firmware_bench.json";
+  const char* scenarioPath = nullptr;
+  std::string mcu;
+  unsigned long freq = DEFAULT_FREQ;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--elf") && i + 1 < argc) elfPath = argv[++i];
+    else if (!strcmp(argv[i], "--out") && i + 1 < argc) outPath = argv[++i];
+    else if (!strcmp(argv[i], "--mcu") && i + 1 < argc) mcu = argv[++i];
+    else if (!strcmp(argv[i], "--freq") && i + 1 < argc) freq = strtoul(argv[++i], NULL, 10);
+    else if (argv[i][0] == '-') { usage(); return 2; }
+    else scenarioPath = argv[i];
+  }
+  if (!elfPath) {
+    usage();
+    return 2;
+  }
+
+  std::vector<std::string> scenario;
+  if (scenarioPath) {
+    if (!loadScenario(scenarioPath, &scenario)) {
+      fprintf(stderr, "cannot open %s\n", scenarioPath);
+      return 2;
+    }
+  } else {
+    scenario.push_back("PING");
+    scenario.push_back("P:FF");
+    scenario.push_back("CLEAR");
+  }
+
+  elf_firmware_t fw;
+  memset(&fw, 0, sizeof(fw));
+  if (elf_read_firmware(elfPath, &fw) != 0) {
+    fprintf(stderr, "cannot read %s\n", elfPath);
+    return 2;
+  }
+  if (mcu.empty()) mcu = fw.mmcu[0] ? fw.mmcu : DEFAULT_MCU;
+
+  avr = avr_make_mcu_by_name(mcu.c_str());
+  if (!avr) {
+    fprintf(stderr, "simavr does not know mcu '%s'\n", mcu.c_str());
+    return 2;
+  }
+  avr_init(avr);
+  avr->log = LOG_ERROR;
+  avr_load_firmware(avr, &fw);
+  avr->frequency = fw.frequency ? fw.frequency : freq;
+
+  // UART0: capture output ourselves instead of simavr's stdout echo
+  uint32_t flags = 0;
+  avr_ioctl(avr, AVR_IOCTL_UART_GET_FLAGS('0'), &flags);
+  flags &= ~AVR_UART_FLAG_STDIO;
+  avr_ioctl(avr, AVR_IOCTL_UART_SET_FLAGS('0'), &flags);
+  uart.input = avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_INPUT);
+  uart.xon = false;
+  avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUTPUT),
+                          onUartOutput, NULL);
+  avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUT_XON),
+                          onUartXon, NULL);
+  avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUT_XOFF),
+                          onUartXoff, NULL);
+
+  // Boot: run until the ready line
+  uint64_t timeoutCycles = (uint64_t)avr->frequency * COMMAND_TIMEOUT_S;
+  std::deque<uint8_t> none;
+  bool ready = false;
+  while (!ready && avr->cycle < timeoutCycles) {
+    if (!step(none)) break;
+    for (size_t i = 0; i < uart.lines.size(); i++) {
+      if (uart.lines[i] == READY_LINE) ready = true;
+    }
+  }
+  if (!ready) {
+    fprintf(stderr, "firmware never printed %s\n", READY_LINE);
+    return 1;
+  }
+  uint64_t bootCycles = uart.lastLineCycle;
+  uint16_t bootStack = avr->ramend - minSp;
+
+  // Serial.begin() has set UBRR0 by now; 10 bits per byte at that rate
+  uint32_t cyclesPerByte = wireCyclesPerByte();
+
+  std::vector<BenchResult> results;
+  int failures = 0;
+  for (size_t s = 0; s < scenario.size(); s++) {
+    BenchResult r;
+    std::vector<std::string> cmds = expandCommand(scenario[s], &r.name);
+    r.commands = cmds.size();
+    r.cycles = 0;
+    r.wireInCycles = 0;
+    r.timedOut = false;
+
+    minSp = stackPointer();
+    for (size_t c = 0; c < cmds.size(); c++) {
+      uint64_t cycles = 0;
+      if (!runCommand(cmds[c], timeoutCycles, &cycles, &r.reply)) {
+        r.timedOut = true;
+      }
+      r.cycles += cycles;
+      r.wireInCycles += (uint64_t)(cmds[c].size() + 1) * cyclesPerByte;
+      if (r.timedOut) break;
+    }
+    r.peakStack = avr->ramend - minSp;
+    if (r.timedOut) {
+      fprintf(stderr, "'%s' got no reply within %d s\n", r.name.c_str(), COMMAND_TIMEOUT_S);
+      failures++;
+    }
+    results.push_back(r);
+
+    printf("%-40.40s %10llu cycles %10.1f us  stack %4u  %s\n", r.name.c_str(),
+           (unsigned long long)r.cycles, r.cycles * 1e6 / avr->frequency, r.peakStack,
+           r.reply.c_str());
+  }
+
+  uint16_t peakStack = bootStack;
+  for (size_t i = 0; i < results.size(); i++) {
+    if (results[i].peakStack > peakStack) peakStack = results[i].peakStack;
+  }
+
+  FILE* f = fopen(outPath, "w");
+  if (!f) {
+    fprintf(stderr, "cannot write %s\n", outPath);
+    return 2;
+  }
+  fprintf(f, "{\n");
+  fprintf(f, "  \"firmware\": ");
+  writeJsonString(f, elfPath);
+  fprintf(f, ",\n  \"mcu\": ");
+  writeJsonString(f, mcu);
+  fprintf(f, ",\n  \"f_cpu\": %lu,\n", (unsigned long)avr->frequency);
+  fprintf(f, "  \"flash_bytes\": %u,\n", fw.flashsize);
+  fprintf(f, "  \"sram_static_bytes\": %u,\n", fw.datasize + fw.bsssize);
+  fprintf(f, "  \"peak_stack_bytes\": %u,\n", peakStack);
+  fprintf(f, "  \"boot_cycles\": %llu,\n", (unsigned long long)bootCycles);
+  fprintf(f, "  \"commands\": [\n");
+  for (size_t i = 0; i < results.size(); i++) {
+    const BenchResult& r = results[i];
+    fprintf(f, "    {\"name\": ");
+    writeJsonString(f, r.name);
+    fprintf(f, ", \"commands\": %d, \"cycles\": %llu, \"us\": %.1f, \"wire_in_cycles\": %llu,"
+               " \"peak_stack_bytes\": %u, \"reply\": ",
+            r.commands, (unsigned long long)r.cycles, r.cycles * 1e6 / avr->frequency,
+            (unsigned long long)r.wireInCycles, r.peakStack);
+    writeJsonString(f, r.reply);
+    fprintf(f, ", \"timed_out\": %s}%s\n", r.timedOut ? "true" : "false",
+            i + 1 < results.size() ? "," : "");
+  }
+  fprintf(f, "  ]\n}\n");
+  fclose(f);
+
+  printf("\nflash %u B, static SRAM %u B, peak stack %u B -> %s\n", fw.flashsize,
+         fw.datasize + fw.bsssize, peakStack, outPath);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""
+Compare an avr_bench result file against a committed baseline.
+
+Fails (exit 1) when any command takes more cycles than the baseline allows,
+when flash, static SRAM or peak stack grow, or when there is no baseline to
+compare with: a missing baseline.json must not let the check pass. Cycle counts under simavr
+are deterministic, so the default tolerance only absorbs toolchain noise.
+
+Usage:
+    python check_cycles.py baseline.json firmware_bench.json
+    python check_cycles.py baseline.json firmware_bench.json --tolerance 5
+    python check_cycles.py baseline.json firmware_bench.json --update
+"""
+
+import argparse
+import json
+import os
+import shutil
+import sys
+
+DEFAULT_TOLERANCE = 1.0   # percent
+
+# Sizes that must not grow, with the bytes of slack each is allowed
+SIZE_LIMITS = {
+    'flash_bytes': 0,
+    'sram_static_bytes': 0,
+    'peak_stack_bytes': 0,
+}
+
+
+def load(path):
+    with open(path, 'r', encoding='utf-8') as f:
+        return json.load(f)
+
+
+def compare(baseline, results, tolerance=DEFAULT_TOLERANCE):
+    """
+    Compare two result dicts.
+
+    Returns:
+        (rows, failures): rows are (name, old, new, change %, ok) tuples for
+        printing; failures is a list of messages.
+    """
+    rows = []
+    failures = []
+
+    for key, slack in SIZE_LIMITS.items():
+        if key not in baseline or key not in results:
+            continue
+        old, new = baseline[key], results[key]
+        ok = new <= old + slack
+        rows.append((key, old, new, _percent(old, new), ok))
+        if not ok:
+            failures.append(f"{key} grew from {old} to {new}")
+
+    old_cmds = {c['name']: c for c in baseline.get('commands', [])}
+    for cmd in results.get('commands', []):
+        name = cmd['name']
+        if cmd.get('timed_out'):
+            failures.append(f"'{name}' timed out")
+            rows.append((name, None, cmd['cycles'], None, False))
+            continue
+        if name not in old_cmds:
+            rows.append((name, None, cmd['cycles'], None, True))
+            continue
+        old, new = old_cmds[name]['cycles'], cmd['cycles']
+        ok = new <= old * (1 + tolerance / 100.0)
+        rows.append((name, old, new, _percent(old, new), ok))
+        if not ok:
+            failures.append(f"'{name}' went from {old} to {new} cycles "
+                            f"({_percent(old, new):+.2f}%, limit +{tolerance}%)")
+
+    return rows, failures
+
+
+def _percent(old, new):
+    return (new - old) * 100.0 / old if old else 0.0
+
+
+def print_rows(rows):
+    print(f"{'':40} {'baseline':>12} {'current':>12} {'change':>9}")
+    for name, old, new, change, ok in rows:
+        old_str = '-' if old is None else str(old)
+        change_str = '' if change is None else f"{change:+.2f}%"
+        flag = '' if ok else '  <-- regression'
+        print(f"{name[:40]:40} {old_str:>12} {new:>12} {change_str:>9}{flag}")
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description='Check avr_bench results for cycle and size regressions.'
+    )
+    parser.add_argument('baseline', help='Baseline JSON (committed)')
+    parser.add_argument('results', help='New avr_bench JSON')
+    parser.add_argument(
+        '--tolerance', type=float, default=DEFAULT_TOLERANCE,
+        help=f'Allowed cycle increase in percent (default: {DEFAULT_TOLERANCE})'
+    )
+    parser.add_argument(
+        '--update', action='store_true',
+        help='Copy the results over the baseline instead of checking'
+    )
+    args = parser.parse_args(argv)
+
+    if args.update:
+        shutil.copyfile(args.results, args.baseline)
+        print(f"Baseline updated: {args.baseline}")
+        return 0
+
+    if not os.path.exists(args.baseline):
+        print(f"ERROR: no baseline at {args.baseline}; nothing was checked. "
+              f"Create it from an [env:uno] build with --update and commit it.",
+              file=sys.stderr)
+        return 1
+
+    rows, failures = compare(load(args.baseline), load(args.results), args.tolerance)
+    print_rows(rows)
+
+    if failures:
+        print()
+        for message in failures:
+            print(f"REGRESSION: {message}")
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
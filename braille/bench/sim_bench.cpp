@@ -0,0 +1,116 @@
+/*
+ * sim_bench.cpp - Runs the avr_bench scenario on braille_sim's virtual Uno.
+ *
+ *   sim_bench [commands.txt]
+ *
+ * Sends each scenario command like avr_bench does (BenchScenario.h),
+ * waits for its final reply, and prints the reply and the simulated time
+ * from the first byte to the reply's '\n'. SimBoard's costs are estimates,
+ * so the times are only a rough guide; what this checks is that every
+ * command in the scenario ends with a reply avr_bench recognizes, on any
+ * machine, without simavr or an AVR toolchain. Exits with 1 if a command
+ * got no final reply within COMMAND_TIMEOUT_S.
+ */
+
+#include <stdio.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "BenchScenario.h"
+#include "SimBoard.h"
+
+#define READY_LINE "BRAILLE_LED_READY"
+#define COMMAND_TIMEOUT_S 5          // per command, in simulated seconds
+
+// The firmware under test
+void setup();
+void loop();
+
+/**
+ * Runs loop() until a final reply line is recorded after `seen` lines, or
+ * until `deadline`. Returns that line's index, or -1 on timeout.
+ */
+static long runUntilReply(SimBoard& board, size_t seen, uint64_t deadline) {
+  board.setDeadline(deadline);
+  try {
+    for (;;) {
+      const std::vector<SerialLine>& lines = board.txLines();
+      for (; seen < lines.size(); seen++) {
+        if (isFinalReply(lines[seen].text)) return (long)seen;
+      }
+      if (board.now() >= deadline) return -1;
+      board.beginIteration();
+      board.advance(board.timing().loopNs);
+      loop();
+      if (board.iterationWasIdle()) {
+        board.advanceTo(std::min(board.nextRxTime(), deadline));
+      }
+    }
+  } catch (const SimDeadline&) {
+    return -1;
+  }
+}
+
+int main(int argc, char** argv) {
+  std::vector<std::string> scenario;
+  if (argc > 1) {
+    if (argv[1][0] == '-' || !loadScenario(argv[1], &scenario)) {
+      fprintf(stderr, "usage: sim_bench [COMMANDS]\n");
+      return 2;
+    }
+  } else {
+    scenario.push_back("PING");
+    scenario.push_back("P:FF");
+    scenario.push_back("CLEAR");
+  }
+
+  SimBoard& board = SimBoard::instance();
+  board.reset();
+  const uint64_t timeout = (uint64_t)COMMAND_TIMEOUT_S * 1000000000ULL;
+
+  // Boot: setup() and the ready line
+  uint64_t ready = SIM_NEVER;
+  board.setDeadline(timeout);
+  try {
+    setup();
+  } catch (const SimDeadline&) {
+  }
+  for (size_t i = 0; i < board.txLines().size(); i++) {
+    if (board.txLines()[i].text == READY_LINE) ready = board.txLines()[i].time;
+  }
+  if (ready == SIM_NEVER) {
+    fprintf(stderr, "firmware never printed %s\n", READY_LINE);
+    return 1;
+  }
+  board.advanceTo(ready);
+
+  int failures = 0;
+  for (size_t s = 0; s < scenario.size(); s++) {
+    std::string name, reply;
+    std::vector<std::string> cmds = expandCommand(scenario[s], &name);
+    uint64_t total = 0;
+    bool timedOut = false;
+    for (size_t c = 0; c < cmds.size() && !timedOut; c++) {
+      uint64_t start = board.now();
+      size_t seen = board.txLines().size();
+      board.scheduleRx(start, cmds[c] + "\n");
+      long line = runUntilReply(board, seen, start + timeout);
+      if (line < 0) {
+        timedOut = true;
+        break;
+      }
+      const SerialLine& l = board.txLines()[(size_t)line];
+      reply = l.text;
+      // The host sends the next command once this reply has arrived
+      if (l.time > board.now()) board.advanceTo(l.time);
+      total += l.time - start;
+    }
+    if (timedOut) {
+      fprintf(stderr, "'%s' got no final reply within %d s\n", name.c_str(), COMMAND_TIMEOUT_S);
+      failures++;
+    }
+    printf("%-40.40s %10.1f us  %s\n", name.c_str(), total / 1000.0, reply.c_str());
+  }
+  return failures ? 1 : 0;
+}
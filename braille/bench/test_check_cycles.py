@@ -0,0 +1,94 @@
+"""
+Unit tests for check_cycles.py.
+
+    python braille/bench/test_check_cycles.py
+"""
+
+import json
+import sys
+import tempfile
+import unittest
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+from check_cycles import compare, main  # noqa: E402
+
+
+def result(cycles, flash=4000, stack=120, timed_out=False):
+    return {
+        'flash_bytes': flash,
+        'sram_static_bytes': 300,
+        'peak_stack_bytes': stack,
+        'commands': [
+            {'name': 'PING', 'cycles': cycles, 'timed_out': timed_out},
+            {'name': 'P:FF', 'cycles': 90000, 'timed_out': False},
+        ],
+    }
+
+
+class TestCompare(unittest.TestCase):
+    """Test regression detection."""
+
+    def test_identical_passes(self):
+        rows, failures = compare(result(1000), result(1000))
+        self.assertEqual(failures, [])
+        self.assertEqual(len(rows), 5)
+
+    def test_within_tolerance_passes(self):
+        _, failures = compare(result(1000), result(1009), tolerance=1.0)
+        self.assertEqual(failures, [])
+
+    def test_cycle_regression_fails(self):
+        _, failures = compare(result(1000), result(1020), tolerance=1.0)
+        self.assertEqual(len(failures), 1)
+        self.assertIn('PING', failures[0])
+
+    def test_faster_passes(self):
+        _, failures = compare(result(1000), result(800))
+        self.assertEqual(failures, [])
+
+    def test_flash_growth_fails(self):
+        _, failures = compare(result(1000), result(1000, flash=4002))
+        self.assertEqual(failures, ['flash_bytes grew from 4000 to 4002'])
+
+    def test_stack_growth_fails(self):
+        _, failures = compare(result(1000), result(1000, stack=130))
+        self.assertTrue(any('peak_stack_bytes' in f for f in failures))
+
+    def test_timeout_fails(self):
+        _, failures = compare(result(1000), result(1000, timed_out=True))
+        self.assertEqual(failures, ["'PING' timed out"])
+
+    def test_new_command_is_reported_not_failed(self):
+        new = result(1000)
+        new['commands'].append({'name': 'CLEAR', 'cycles': 5000, 'timed_out': False})
+        rows, failures = compare(result(1000), new)
+        self.assertEqual(failures, [])
+        self.assertIn(('CLEAR', None, 5000, None, True), rows)
+
+
+class TestMain(unittest.TestCase):
+    """Test the command line."""
+
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.tmp_path = Path(self.tmp.name)
+
+    def tearDown(self):
+        self.tmp.cleanup()
+
+    def test_missing_baseline_fails(self):
+        results = self.tmp_path / 'firmware_bench.json'
+        results.write_text(json.dumps(result(1000)))
+        self.assertEqual(main([str(self.tmp_path / 'baseline.json'), str(results)]), 1)
+
+    def test_update_then_check_passes(self):
+        baseline = self.tmp_path / 'baseline.json'
+        results = self.tmp_path / 'firmware_bench.json'
+        results.write_text(json.dumps(result(1000)))
+        self.assertEqual(main([str(baseline), str(results), '--update']), 0)
+        self.assertEqual(main([str(baseline), str(results)]), 0)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,147 @@
+#include "BrailleExpander.h"
+#include <Wire.h>
+
+// MCP23017 registers, IOCON.BANK = 0 (power-on default)
+#define MCP_IODIRA 0x00
+#define MCP_IOCON  0x0A
+#define MCP_OLATA  0x14
+#define MCP_OLATB  0x15
+
+// SCL periods per transaction: START + 9 bits per byte + STOP
+#define EXPANDER_BURST_BITS 38   // address, register, OLATA, OLATB
+#define MUX_SELECT_BITS 20       // address, channel mask
+
+BrailleExpander::BrailleExpander()
+  : _cellCount(0), _muxAddress(EXPANDER_NO_MUX), _muxChannel(-1),
+    _lastUpdateMicros(0) {
+  memset(_frame, 0, sizeof(_frame));
+  memset(_shown, 0, sizeof(_shown));
+}
+
+bool BrailleExpander::begin(uint8_t cellCount, uint32_t clockHz, int muxAddress) {
+  if (cellCount > EXPANDER_MAX_CELLS) cellCount = EXPANDER_MAX_CELLS;
+  _cellCount = cellCount;
+  _muxAddress = muxAddress;
+  _muxChannel = -1;
+
+  Wire.begin();
+  Wire.setClock(clockHz);
+
+  if (_expanderCount() > EXPANDER_PER_BUS && _muxAddress == EXPANDER_NO_MUX) {
+    return false;
+  }
+
+  bool ok = true;
+  for (uint8_t e = 0; e < _expanderCount(); e++) {
+    // Sequential addressing on (SEQOP = 0) so bursts auto-increment,
+    // then both ports to output
+    const uint8_t iocon = 0x00;
+    const uint8_t outputs[2] = {0x00, 0x00};
+    ok &= _writeRegisters(e, MCP_IOCON, &iocon, 1);
+    ok &= _writeRegisters(e, MCP_IODIRA, outputs, 2);
+  }
+
+  clear();
+  return refreshAll() == _expanderCount() && ok;
+}
+
+void BrailleExpander::setPattern(uint8_t cell, uint8_t pattern) {
+  if (cell < _cellCount) {
+    _frame[cell] = pattern;
+  }
+}
+
+void BrailleExpander::setFrame(const uint8_t* patterns, uint8_t count) {
+  if (count > _cellCount) count = _cellCount;
+  memcpy(_frame, patterns, count);
+}
+
+void BrailleExpander::clear() {
+  memset(_frame, 0, sizeof(_frame));
+}
+
+uint8_t BrailleExpander::update() {
+  return _flush(false);
+}
+
+uint8_t BrailleExpander::refreshAll() {
+  return _flush(true);
+}
+
+uint32_t BrailleExpander::worstCaseMicros(uint8_t cellCount, uint32_t clockHz) {
+  if (clockHz < 1000) return 0;
+
+  uint32_t expanders = (cellCount + 1) / 2;
+  uint32_t bits = expanders * EXPANDER_BURST_BITS;
+  if (expanders > EXPANDER_PER_BUS) {
+    // Switching to each channel in turn
+    bits += ((expanders + EXPANDER_PER_BUS - 1) / EXPANDER_PER_BUS) * MUX_SELECT_BITS;
+  }
+  return (bits * 1000UL + clockHz / 1000 - 1) / (clockHz / 1000);
+}
+
+uint8_t BrailleExpander::_flush(bool force) {
+  uint32_t start = micros();
+  uint8_t written = 0;
+
+  // Start on the mux channel that is already selected to save a switch
+  uint8_t count = _expanderCount();
+  uint8_t first = _muxChannel > 0 ? _muxChannel * EXPANDER_PER_BUS : 0;
+
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t e = (first + i) % count;
+    uint8_t a = e * 2;
+    uint8_t b = a + 1;
+    bool hasB = b < _cellCount;
+    bool changedA = force || _frame[a] != _shown[a];
+    bool changedB = hasB && (force || _frame[b] != _shown[b]);
+    if (!changedA && !changedB) continue;
+
+    bool ok;
+    if (changedA && (changedB || !hasB)) {
+      // OLATA then OLATB in one burst (a missing B cell stays blank)
+      uint8_t data[2] = {_frame[a], hasB ? _frame[b] : (uint8_t)0};
+      ok = _writeRegisters(e, MCP_OLATA, data, 2);
+    } else if (changedA) {
+      ok = _writeRegisters(e, MCP_OLATA, &_frame[a], 1);
+    } else {
+      ok = _writeRegisters(e, MCP_OLATB, &_frame[b], 1);
+    }
+
+    // On a NACK keep the old bytes so the next update() tries again
+    if (ok) {
+      _shown[a] = _frame[a];
+      if (hasB) _shown[b] = _frame[b];
+      written++;
+    }
+  }
+
+  _lastUpdateMicros = micros() - start;
+  return written;
+}
+
+bool BrailleExpander::_select(uint8_t expander) {
+  if (_muxAddress == EXPANDER_NO_MUX) return true;
+
+  int8_t channel = expander / EXPANDER_PER_BUS;
+  if (channel == _muxChannel) return true;
+
+  Wire.beginTransmission((uint8_t)_muxAddress);
+  Wire.write((uint8_t)(1 << channel));
+  if (Wire.endTransmission() != 0) {
+    _muxChannel = -1;
+    return false;
+  }
+  _muxChannel = channel;
+  return true;
+}
+
+bool BrailleExpander::_writeRegisters(uint8_t expander, uint8_t reg,
+                                      const uint8_t* data, uint8_t n) {
+  if (!_select(expander)) return false;
+
+  Wire.beginTransmission((uint8_t)(EXPANDER_BASE_ADDRESS + expander % EXPANDER_PER_BUS));
+  Wire.write(reg);
+  Wire.write(data, n);
+  return Wire.endTransmission() == 0;
+}
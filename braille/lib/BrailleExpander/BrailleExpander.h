@@ -0,0 +1,113 @@
+/*
+ * BrailleExpander.h - Drives many 8-dot Braille cells through MCP23017
+ * I2C port expanders instead of one GPIO per dot.
+ *
+ * Each MCP23017 drives two cells: even cells on port A, odd cells on
+ * port B. Pin GPx0..GPx7 follows the BrailleCell bit order:
+ *   GPx0=dot1, GPx1=dot2, GPx2=dot3, GPx3=dot7,
+ *   GPx4=dot4, GPx5=dot5, GPx6=dot6, GPx7=dot8
+ *
+ * One I2C bus holds 8 expanders (addresses 0x20-0x27) = 16 cells. For up
+ * to 32 cells, put a TCA9548A multiplexer in front: expanders 0-7 on mux
+ * channel 0, expanders 8-15 on channel 1.
+ *
+ * Patterns are staged in RAM with setPattern()/setFrame() and sent by
+ * update(), which compares against what each expander already holds and
+ * only addresses the ones that changed. Both ports of an expander go out
+ * in one auto-increment burst (OLATA, OLATB).
+ *
+ * Worst-case update() bus time (every cell changed, 38 SCL periods per
+ * expander, 20 per mux channel switch):
+ *
+ *   cells   expanders   400 kHz    1 MHz
+ *     16        8        760 us    304 us
+ *     32     16 + mux   1620 us    648 us
+ *
+ * See worstCaseMicros(). The AVR Wire library adds some CPU time per
+ * transaction on top; getLastUpdateMicros() reports the measured value.
+ */
+
+#ifndef BRAILLE_EXPANDER_H
+#define BRAILLE_EXPANDER_H
+
+#include <Arduino.h>
+
+#define EXPANDER_MAX_CELLS 32
+#define EXPANDER_BASE_ADDRESS 0x20
+#define EXPANDER_PER_BUS 8
+#define EXPANDER_NO_MUX -1
+
+class BrailleExpander {
+
+public:
+
+  // Constructor
+  BrailleExpander();
+
+  /**
+   * @brief Starts Wire, configures every expander's ports as outputs and
+   * lowers all dots.
+   * @param cellCount Number of cells (1-32).
+   * @param clockHz I2C clock, typically 400000 or 1000000.
+   * @param muxAddress TCA9548A address (0x70-0x77), or EXPANDER_NO_MUX.
+   * Required above 16 cells.
+   * @return false if an expander or the multiplexer did not acknowledge.
+   */
+  bool begin(uint8_t cellCount, uint32_t clockHz = 400000,
+             int muxAddress = EXPANDER_NO_MUX);
+
+  uint8_t getCellCount() { return _cellCount; }
+
+  /**
+   * @brief Stages a pattern for one cell. Nothing is sent until update().
+   */
+  void setPattern(uint8_t cell, uint8_t pattern);
+
+  /**
+   * @brief Stages patterns for cells 0..count-1 (one byte per cell).
+   */
+  void setFrame(const uint8_t* patterns, uint8_t count);
+
+  /**
+   * @brief Stages an all-blank frame.
+   */
+  void clear();
+
+  /**
+   * @brief Writes the staged frame, skipping expanders whose bytes did
+   * not change.
+   * @return Number of expanders written.
+   */
+  uint8_t update();
+
+  /**
+   * @brief Rewrites every expander, e.g. after a brown-out reset one of them.
+   */
+  uint8_t refreshAll();
+
+  /**
+   * @brief Duration of the last update() in microseconds.
+   */
+  uint32_t getLastUpdateMicros() { return _lastUpdateMicros; }
+
+  /**
+   * @brief Bus time for updating every cell, in microseconds.
+   */
+  static uint32_t worstCaseMicros(uint8_t cellCount, uint32_t clockHz);
+
+private:
+
+  uint8_t _frame[EXPANDER_MAX_CELLS];   // staged patterns
+  uint8_t _shown[EXPANDER_MAX_CELLS];   // what the expanders hold
+  uint8_t _cellCount;
+  int _muxAddress;
+  int8_t _muxChannel;                   // currently selected, -1 = unknown
+  uint32_t _lastUpdateMicros;
+
+  uint8_t _expanderCount() { return (_cellCount + 1) / 2; }
+  bool _select(uint8_t expander);
+  bool _writeRegisters(uint8_t expander, uint8_t reg, const uint8_t* data, uint8_t n);
+  uint8_t _flush(bool force);
+};
+
+#endif
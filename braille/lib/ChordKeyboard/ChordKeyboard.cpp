@@ -0,0 +1,167 @@
+#include "ChordKeyboard.h"
+
+#define DOT7 0x40
+#define DOT8 0x80
+#define NUMBER_SIGN 0x3C        // dots 3-4-5-6
+
+// Dots 1-6 (bit n-1 = dot n) to the character BrailleCell shows with them;
+// letters win over the digits that share a-j, and the number sign is '#'
+static const char CHORD_TO_CHAR[64] PROGMEM = {
+  0, 'a', ',', 'b', '\'', 'k', ';', 'l',
+  0, 'c', 'i', 'f', 0, 'm', 's', 'p',
+  0, 'e', ':', 'h', 0, 'o', '!', 'r',
+  0, 'd', 'j', 'g', ')', 'n', 't', 'q',
+  0, 0, 0, '(', '-', 'u', '?', 'v',
+  0, 0, 0, 0, 0, 'x', 0, 0,
+  0, 0, '.', 0, 0, 'z', '"', 0,
+  0, 0, 'w', 0, '#', 'y', 0, 0,
+};
+
+ChordKeyboard::ChordKeyboard() {
+  _debounce = 5000;
+  _down = 0;
+  _settling = 0;
+  _held = 0;
+  _head = 0;
+  _count = 0;
+  _chords = 0;
+  _lost = 0;
+  _numbers = false;
+  _active = false;
+}
+
+void ChordKeyboard::begin(const uint8_t keyPins[CHORD_KEYS], unsigned long debounceMicros) {
+  end();
+  _debounce = debounceMicros;
+  for (uint8_t k = 0; k < CHORD_KEYS; k++) {
+    _pins[k] = keyPins[k];
+    pinMode(_pins[k], INPUT_PULLUP);
+#ifdef __AVR__
+    _inputs[k] = portInputRegister(digitalPinToPort(_pins[k]));
+    _masks[k] = digitalPinToBitMask(_pins[k]);
+#endif
+  }
+
+  noInterrupts();
+  _down = _readKeys();   // keys held at start only count once released
+  _settling = 0;
+  _held = 0;
+  _head = 0;
+  _count = 0;
+  _numbers = false;
+  _active = true;
+  for (uint8_t k = 0; k < CHORD_KEYS; k++) {
+    _setInterrupt(k, true);
+    *digitalPinToPCICR(_pins[k]) |= _BV(digitalPinToPCICRbit(_pins[k]));
+  }
+  interrupts();
+}
+
+void ChordKeyboard::end() {
+  if (!_active) return;
+  noInterrupts();
+  for (uint8_t k = 0; k < CHORD_KEYS; k++) {
+    _setInterrupt(k, false);
+  }
+  _active = false;
+  _count = 0;
+  interrupts();
+}
+
+void ChordKeyboard::_setInterrupt(uint8_t key, bool on) {
+  volatile uint8_t* mask = digitalPinToPCMSK(_pins[key]);
+  uint8_t bit = _BV(digitalPinToPCMSKbit(_pins[key]));
+  if (on) *mask |= bit;
+  else *mask &= (uint8_t)~bit;
+}
+
+uint16_t ChordKeyboard::_readKeys() const {
+  uint16_t down = 0;
+  for (uint8_t k = 0; k < CHORD_KEYS; k++) {
+#ifdef __AVR__
+    bool pressed = !(*_inputs[k] & _masks[k]);
+#else
+    bool pressed = digitalRead(_pins[k]) == LOW;
+#endif
+    if (pressed) down |= (uint16_t)1 << k;
+  }
+  return down;
+}
+
+void ChordKeyboard::onPinChange() {
+  if (_active) _scan(micros());
+}
+
+// Runs with interrupts off: from the handler, or from poll()
+void ChordKeyboard::_scan(unsigned long now) {
+  for (uint8_t k = 0; k < CHORD_KEYS; k++) {
+    uint16_t bit = (uint16_t)1 << k;
+    if ((_settling & bit) && now - _since[k] >= _debounce) _settling &= ~bit;
+  }
+  // Edges of settling keys are bounce. A key that has just settled and
+  // reads the other way changed while it was settling: taken now.
+  uint16_t changed = (_readKeys() ^ _down) & ~_settling;
+  if (!changed) return;
+
+  _down ^= changed;
+  _settling |= changed;
+  for (uint8_t k = 0; k < CHORD_KEYS; k++) {
+    if (changed & ((uint16_t)1 << k)) _since[k] = now;
+  }
+  _held |= _down;
+  if (_down || !_held) return;
+
+  // The last key is up: the chord is finished
+  _chords++;
+  if (_count == CHORD_QUEUE) {
+    _lost++;
+  } else {
+    Chord& c = _queue[(uint8_t)(_head + _count) % CHORD_QUEUE];
+    c.keys = _held;
+    c.released = now;
+    _count++;
+  }
+  _held = 0;
+}
+
+void ChordKeyboard::poll() {
+  if (!_settling) return;
+  noInterrupts();
+  _scan(micros());
+  interrupts();
+}
+
+bool ChordKeyboard::read(Chord& chord) {
+  noInterrupts();
+  if (_count == 0) {
+    interrupts();
+    return false;
+  }
+  chord = _queue[_head];
+  _head = (uint8_t)(_head + 1) % CHORD_QUEUE;
+  _count--;
+  interrupts();
+
+  // Number mode: the number sign turns a-j into 1-0 until another chord
+  chord.ch = toChar(chord.keys);
+  if (_numbers && chord.ch >= 'a' && chord.ch <= 'j') {
+    chord.ch = chord.ch == 'j' ? '0' : (char)('1' + chord.ch - 'a');
+  } else {
+    _numbers = chord.keys == NUMBER_SIGN;
+  }
+  return true;
+}
+
+char ChordKeyboard::toChar(uint16_t keys) {
+  if (keys == CHORD_SPACE) return ' ';
+  if (keys == DOT7) return '\b';
+  if (keys == DOT8) return '\n';
+  if (keys & (CHORD_SPACE | DOT8)) return 0;
+
+  char c = (char)pgm_read_byte(&CHORD_TO_CHAR[keys & 0x3F]);
+  if (keys & DOT7) {
+    // Computer braille: dot 7 makes a letter a capital
+    return c >= 'a' && c <= 'z' ? (char)(c - 'a' + 'A') : 0;
+  }
+  return c;
+}
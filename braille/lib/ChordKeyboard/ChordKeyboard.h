@@ -0,0 +1,118 @@
+/*
+ * ChordKeyboard.h - Perkins-style chord entry on eight dot keys and a
+ * space bar, read through pin-change interrupts.
+ *
+ * Each key is a push button to ground on a pin with INPUT_PULLUP. A key
+ * pin that changes raises a pin-change interrupt, and onPinChange() reads
+ * every key and stamps the change with micros(). A key is therefore timed
+ * when it moves, not when loop() next gets round to it, and a long
+ * command or a full serial buffer cannot hide a keystroke.
+ *
+ * Each key has its own debounce state machine. The first edge counts at
+ * once, so bounce never delays a report, and the key then settles for the
+ * debounce time, during which its edges are ignored. The next scan after
+ * that (another key's interrupt, or poll() from loop()) reads the key
+ * again in case the bounce ended the other way. A chord is every key
+ * pressed since all keys were last up, and it ends when the last key is
+ * released. Finished chords wait in a queue of CHORD_QUEUE until loop()
+ * reads them; read() decodes them to characters through the inverse of
+ * BrailleCell's letter table.
+ */
+
+#ifndef CHORD_KEYBOARD_H
+#define CHORD_KEYBOARD_H
+
+#include <Arduino.h>
+
+#define CHORD_KEYS 9            // dots 1-8, then space
+#define CHORD_SPACE 0x100       // key bit of the space bar; bit n-1 is dot n
+
+#ifndef CHORD_QUEUE
+#define CHORD_QUEUE 8
+#endif
+
+struct Chord {
+  uint16_t keys;                // bit n-1 = dot n (as in U+2800), CHORD_SPACE
+  char ch;                      // decoded character, 0 for a command chord
+  unsigned long released;       // micros() of the release that ended it
+};
+
+class ChordKeyboard {
+
+public:
+
+  // Constructor
+  ChordKeyboard();
+
+  /**
+   * @brief Sets up the key pins and enables their pin-change interrupts.
+   * The sketch forwards those (ISR(PCINTn_vect) for each port the pins
+   * are on) to onPinChange().
+   * @param keyPins Pins of dots 1-8, then the space bar.
+   * @param debounceMicros How long a key ignores its edges after one counted.
+   */
+  void begin(const uint8_t keyPins[CHORD_KEYS], unsigned long debounceMicros = 5000);
+
+  /**
+   * @brief Disables the interrupts and drops queued chords.
+   */
+  void end();
+
+  bool active() const { return _active; }
+
+  /**
+   * @brief Reads the keys. Call from the pin-change interrupt handlers.
+   */
+  void onPinChange();
+
+  /**
+   * @brief Reads keys whose debounce time is over, for a bounce that ended
+   * the other way with no edge after it. Call from loop(); returns at
+   * once while no key is settling.
+   */
+  void poll();
+
+  /**
+   * @brief Takes the oldest finished chord and decodes it.
+   * @return false if none is queued.
+   */
+  bool read(Chord& chord);
+
+  uint8_t queued() const { return _count; }
+  uint16_t chords() const { return _chords; }   // finished, including lost ones
+  uint16_t lost() const { return _lost; }       // dropped on a full queue
+
+  /**
+   * @brief The character of a chord, without number mode: a letter or
+   * punctuation for dots 1-6, capitals with dot 7, ' ' for the space bar,
+   * '\b' for dot 7 alone and '\n' for dot 8 alone. 0 for anything else,
+   * such as space with dots (a command chord for the host).
+   */
+  static char toChar(uint16_t keys);
+
+private:
+  uint8_t _pins[CHORD_KEYS];
+#ifdef __AVR__
+  volatile uint8_t* _inputs[CHORD_KEYS];   // PINx register of each key
+  uint8_t _masks[CHORD_KEYS];
+#endif
+  unsigned long _debounce;
+  volatile uint16_t _down;       // debounced state, 1 = pressed
+  volatile uint16_t _settling;   // keys inside their debounce time
+  volatile uint16_t _held;       // keys pressed in the chord so far
+  unsigned long _since[CHORD_KEYS];
+
+  Chord _queue[CHORD_QUEUE];
+  volatile uint8_t _head;
+  volatile uint8_t _count;
+  volatile uint16_t _chords;
+  volatile uint16_t _lost;
+  bool _numbers;                 // after the number sign, a-j read as digits
+  bool _active;
+
+  uint16_t _readKeys() const;
+  void _scan(unsigned long now);
+  void _setInterrupt(uint8_t key, bool on);
+};
+
+#endif
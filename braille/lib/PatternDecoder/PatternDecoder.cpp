@@ -0,0 +1,40 @@
+#include "PatternDecoder.h"
+#include "PatternCodeTable.h"
+
+void PatternDecoder::begin(const char* p) {
+  _p = p;
+  _bits = 0;
+  _left = 0;
+}
+
+bool PatternDecoder::next(uint8_t& pattern) {
+  // Canonical decode: codes of one length are consecutive numbers, so
+  // compare against the first code of each length while reading bits
+  uint16_t code = 0;
+  uint16_t first = 0;
+  uint16_t index = 0;
+  for (uint8_t len = 1; len <= PATTERN_CODE_MAX_BITS; len++) {
+    if (_left == 0) {
+      char c = *_p;
+      if (c < '0' || c > 'o') return false;
+      _p++;
+      _bits = c - '0';
+      _left = 6;
+    }
+    _left--;
+    code |= (_bits >> _left) & 1;
+    uint8_t count = pgm_read_byte(&PATTERN_CODE_COUNTS[len]);
+    if (code - first < count) {
+      pattern = pgm_read_byte(&PATTERN_CODE_SYMBOLS[index + code - first]);
+      return true;
+    }
+    index += count;
+    first = (first + count) << 1;
+    code <<= 1;
+  }
+  return false;
+}
+
+uint8_t PatternDecoder::version() {
+  return PATTERN_CODE_VERSION;
+}
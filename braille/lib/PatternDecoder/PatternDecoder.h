@@ -0,0 +1,53 @@
+/*
+ * PatternDecoder.h - Reads cell patterns packed with a static Huffman code,
+ * for displays behind slow links (9600 baud Bluetooth bridges).
+ *
+ * The host codes each pattern with a canonical Huffman code trained on
+ * English text (PatternCodeTable.h, from braille/tools/gen_pattern_code.py)
+ * and sends the bits six at a time as the characters '0'..'o', so packed
+ * runs still travel in ordinary command lines. Text averages under five
+ * bits per cell, against two hex characters (16 bits on the wire).
+ *
+ * Decoding walks the code one bit at a time against two flash tables
+ * (code counts per length and the patterns in code order); the only RAM
+ * is the reader's position and current character.
+ */
+
+#ifndef PATTERN_DECODER_H
+#define PATTERN_DECODER_H
+
+#include <Arduino.h>
+
+class PatternDecoder {
+
+public:
+
+  /**
+   * @brief Starts reading packed characters at p.
+   */
+  void begin(const char* p);
+
+  /**
+   * @brief Decodes the next pattern.
+   * @return false on a character outside '0'..'o' or an invalid code.
+   */
+  bool next(uint8_t& pattern);
+
+  /**
+   * @brief The first character not (even partly) read. The unused low
+   * bits of the last character are padding.
+   */
+  const char* position() const { return _p; }
+
+  /**
+   * @brief Version of the code, reported to the host by CAPS.
+   */
+  static uint8_t version();
+
+private:
+  const char* _p;
+  uint8_t _bits;    // current character's six bits
+  uint8_t _left;    // of which not yet read
+};
+
+#endif
@@ -0,0 +1,35 @@
+#include "TextBuffer.h"
+
+TextBuffer::TextBuffer() {
+  _length = 0;
+}
+
+void TextBuffer::clear() {
+  _length = 0;
+}
+
+bool TextBuffer::replace(uint16_t pos, uint16_t remove, const char* text, uint16_t n) {
+  if (pos > _length) return false;
+  if (remove > _length - pos) remove = _length - pos;
+
+  uint16_t tail = _length - pos - remove;
+  uint32_t newLength = (uint32_t)_length - remove + n;
+  if (newLength > TEXT_BUFFER_SIZE) return false;
+
+  // Shift the tail once, then drop the new bytes into the gap
+  memmove(_data + pos + n, _data + pos + remove, tail);
+  memcpy(_data + pos, text, n);
+  _length = (uint16_t)newLength;
+  return true;
+}
+
+uint16_t TextBuffer::checksum() const {
+  uint16_t crc = 0xFFFF;
+  for (uint16_t i = 0; i < _length; i++) {
+    crc ^= (uint16_t)(uint8_t)_data[i] << 8;
+    for (uint8_t b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
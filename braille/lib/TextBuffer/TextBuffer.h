@@ -0,0 +1,57 @@
+/*
+ * TextBuffer.h - The document text held on the device, edited in place by
+ * the host's delta commands instead of being resent whole.
+ *
+ * The host keeps a copy of what it last sent and transmits only
+ * replace(pos, remove, text) edits (see "E:" in src/main.cpp). checksum()
+ * lets the host confirm both sides agree before it relies on that copy.
+ *
+ * Storage is a fixed array of TEXT_BUFFER_SIZE bytes; edits that would
+ * not fit are rejected and leave the text unchanged.
+ */
+
+#ifndef TEXT_BUFFER_H
+#define TEXT_BUFFER_H
+
+#include <Arduino.h>
+
+#ifndef TEXT_BUFFER_SIZE
+#define TEXT_BUFFER_SIZE 512
+#endif
+
+class TextBuffer {
+
+public:
+
+  // Constructor
+  TextBuffer();
+
+  /**
+   * @brief Empties the buffer.
+   */
+  void clear();
+
+  /**
+   * @brief Replaces `remove` bytes at `pos` with `n` bytes of `text`.
+   * Covers insert (remove = 0), delete (n = 0) and replace. `remove` is
+   * clamped to the end of the text, so 0xFFFF means "to the end".
+   * @return false if pos is past the end or the result would not fit;
+   * the text is left unchanged.
+   */
+  bool replace(uint16_t pos, uint16_t remove, const char* text, uint16_t n);
+
+  /**
+   * @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) of the text.
+   */
+  uint16_t checksum() const;
+
+  uint16_t length() const { return _length; }
+  uint16_t capacity() const { return TEXT_BUFFER_SIZE; }
+  const char* data() const { return _data; }
+
+private:
+  char _data[TEXT_BUFFER_SIZE];
+  uint16_t _length;
+};
+
+#endif
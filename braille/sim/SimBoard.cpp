@@ -0,0 +1,270 @@
+#include "SimBoard.h"
+#include <string.h>
+
+// Same values as the Arduino core
+#define SIM_INPUT 0
+#define SIM_OUTPUT 1
+#define SIM_INPUT_PULLUP 2
+
+SimBoard& SimBoard::instance() {
+  static SimBoard board;
+  return board;
+}
+
+SimBoard::SimBoard() {
+  reset();
+}
+
+void SimBoard::reset() {
+  _now = 0;
+  _deadline = SIM_NEVER;
+  memset(_pinLevel, 0, sizeof(_pinLevel));
+  memset(_pinMode, SIM_INPUT, sizeof(_pinMode));
+  memset(_inputLevel, 0, sizeof(_inputLevel));
+  memset(_inputDriven, 0, sizeof(_inputDriven));
+  _inputPending.clear();
+  memset(_pinUsed, 0, sizeof(_pinUsed));
+
+  _baud = 0;
+  _rxLineFree = 0;
+  _rxPending.clear();
+  _rxBuffer.clear();
+  _txDone.clear();
+  _rxOverflows = 0;
+  _txPartial.clear();
+
+  _i2cClock = 100000;   // Wire's default
+  _i2cBusNs = 0;
+
+  _pinEvents.clear();
+  _serialEvents.clear();
+  _txLines.clear();
+  _i2cTransfers.clear();
+  _recording = true;
+  _pinEdges = 0;
+  _busy = false;
+}
+
+void SimBoard::advance(uint64_t ns) {
+  advanceTo(_now + ns);
+}
+
+void SimBoard::advanceTo(uint64_t time) {
+  _applyInputs(time);
+  if (time > _now) _now = time;
+  if (_now > _deadline) throw SimDeadline();
+}
+
+void SimBoard::_applyInputs(uint64_t time) {
+  // An interrupt handler run from driveInput() advances the clock too and
+  // applies later changes itself
+  while (!_inputPending.empty() && _inputPending.front().time <= time) {
+    PinEvent e = _inputPending.front();
+    _inputPending.pop_front();
+    if (e.time > _now) _now = e.time;
+    driveInput(e.pin, e.value);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Pins
+// ---------------------------------------------------------------------------
+
+void SimBoard::setPinMode(uint8_t pin, uint8_t mode) {
+  if (pin >= SIM_NUM_PINS) return;
+  _pinMode[pin] = mode;
+  _pinUsed[pin] = true;
+  _busy = true;
+}
+
+uint8_t SimBoard::getPinMode(uint8_t pin) const {
+  return pin < SIM_NUM_PINS ? _pinMode[pin] : SIM_INPUT;
+}
+
+void SimBoard::writePin(uint8_t pin, uint8_t value) {
+  if (pin >= SIM_NUM_PINS) return;
+  value = value ? 1 : 0;
+  _pinUsed[pin] = true;
+  _busy = true;
+  if (_pinLevel[pin] == value) return;
+
+  _pinLevel[pin] = value;
+  _pinEdges++;
+  if (!_recording) return;
+  PinEvent e = {_now, pin, value};
+  _pinEvents.push_back(e);
+}
+
+uint8_t SimBoard::readPin(uint8_t pin) {
+  if (pin >= SIM_NUM_PINS) return 0;
+  if (_pinMode[pin] == SIM_OUTPUT) return _pinLevel[pin];
+  return _inputValue(pin);
+}
+
+uint8_t SimBoard::_inputValue(uint8_t pin) const {
+  if (!_inputDriven[pin] && _pinMode[pin] == SIM_INPUT_PULLUP) return 1;
+  return _inputLevel[pin];
+}
+
+void SimBoard::driveInput(uint8_t pin, uint8_t value) {
+  if (pin >= SIM_NUM_PINS) return;
+  uint8_t before = _inputValue(pin);
+  _inputLevel[pin] = value ? 1 : 0;
+  _inputDriven[pin] = true;
+  if (_pinMode[pin] != SIM_OUTPUT && _inputValue(pin) != before && onInputChange) {
+    _busy = true;
+    onInputChange(pin);
+  }
+}
+
+void SimBoard::scheduleInput(uint64_t time, uint8_t pin, uint8_t value) {
+  PinEvent e = {time, pin, value};
+  std::deque<PinEvent>::iterator it = _inputPending.end();
+  while (it != _inputPending.begin() && (it - 1)->time > time) --it;
+  _inputPending.insert(it, e);
+}
+
+uint64_t SimBoard::nextInputTime() const {
+  return _inputPending.empty() ? SIM_NEVER : _inputPending.front().time;
+}
+
+// ---------------------------------------------------------------------------
+// Serial
+// ---------------------------------------------------------------------------
+
+void SimBoard::serialBegin(unsigned long baud) {
+  _baud = baud;
+  _busy = true;
+}
+
+uint64_t SimBoard::byteTimeNs() const {
+  // 8N1: start + 8 data + stop bits
+  unsigned long baud = _baud ? _baud : 115200;
+  return 10ULL * 1000000000ULL / baud;
+}
+
+void SimBoard::scheduleRx(uint64_t time, const std::string& bytes) {
+  uint64_t t = time > _rxLineFree ? time : _rxLineFree;
+  for (size_t i = 0; i < bytes.size(); i++) {
+    SerialEvent e = {t, false, (uint8_t)bytes[i]};
+    if (_recording) _serialEvents.push_back(e);
+    t += byteTimeNs();
+    _rxPending.push_back(std::make_pair(t, (uint8_t)bytes[i]));
+  }
+  _rxLineFree = t;
+}
+
+uint64_t SimBoard::nextRxTime() const {
+  return _rxPending.empty() ? SIM_NEVER : _rxPending.front().first;
+}
+
+void SimBoard::_pumpRx() {
+  while (!_rxPending.empty() && _rxPending.front().first <= _now) {
+    if (_rxBuffer.size() < SIM_SERIAL_BUFFER) {
+      _rxBuffer.push_back(_rxPending.front().second);
+    } else {
+      _rxOverflows++;   // the real UART drops it too
+    }
+    _rxPending.pop_front();
+  }
+}
+
+int SimBoard::rxAvailable() {
+  advance(_timing.serialAvailableNs);
+  _pumpRx();
+  if (!_rxBuffer.empty()) _busy = true;
+  return (int)_rxBuffer.size();
+}
+
+int SimBoard::rxPeek() {
+  advance(_timing.serialReadNs);
+  _pumpRx();
+  return _rxBuffer.empty() ? -1 : _rxBuffer.front();
+}
+
+int SimBoard::rxRead() {
+  advance(_timing.serialReadNs);
+  _pumpRx();
+  _busy = true;
+  if (_rxBuffer.empty()) return -1;
+  int b = _rxBuffer.front();
+  _rxBuffer.pop_front();
+  return b;
+}
+
+void SimBoard::_drainTx() {
+  while (!_txDone.empty() && _txDone.front() <= _now) {
+    _txDone.pop_front();
+  }
+}
+
+void SimBoard::txWrite(uint8_t b) {
+  _busy = true;
+  advance(_timing.serialWriteNs);
+  _drainTx();
+
+  // Buffer full: block until the oldest byte has left, like HardwareSerial
+  if (_txDone.size() >= SIM_SERIAL_BUFFER) {
+    advanceTo(_txDone.front());
+    _drainTx();
+  }
+
+  uint64_t start = _txDone.empty() ? _now : _txDone.back();
+  if (start < _now) start = _now;
+  uint64_t done = start + byteTimeNs();
+  _txDone.push_back(done);
+
+  SerialEvent e = {start, true, b};
+  if (_recording) _serialEvents.push_back(e);
+  if (onTx) onTx(done, b);
+
+  if (!_recording) return;
+  if (b == '\n') {
+    if (!_txPartial.empty() && _txPartial.back() == '\r') _txPartial.pop_back();
+    SerialLine line = {done, _txPartial};
+    _txLines.push_back(line);
+    _txPartial.clear();
+  } else {
+    _txPartial += (char)b;
+  }
+}
+
+int SimBoard::txAvailable() {
+  _busy = true;   // waiting for room: no fast-forward past the drain
+  _drainTx();
+  return SIM_SERIAL_BUFFER - 1 - (int)_txDone.size();
+}
+
+void SimBoard::txFlush() {
+  if (!_txDone.empty()) advanceTo(_txDone.back());
+  _drainTx();
+}
+
+// ---------------------------------------------------------------------------
+// Loop driver support
+// ---------------------------------------------------------------------------
+
+void SimBoard::beginIteration() {
+  _busy = false;
+}
+
+// ---------------------------------------------------------------------------
+// I2C
+// ---------------------------------------------------------------------------
+
+uint8_t SimBoard::i2cWrite(uint8_t address, const uint8_t* data, size_t n) {
+  _busy = true;
+  I2cTransfer t;
+  t.time = _now;
+  t.address = address;
+  t.acked = onI2cWrite && onI2cWrite(address, data, n);
+  // A NACKed address ends the transfer after its byte
+  if (t.acked) t.bytes.assign(data, data + n);
+  t.sclPeriods = 2 + 9 * (uint32_t)(1 + t.bytes.size());
+
+  uint64_t busNs = (uint64_t)t.sclPeriods * 1000000000ULL / (_i2cClock ? _i2cClock : 100000);
+  _i2cBusNs += busNs;
+  if (_recording) _i2cTransfers.push_back(t);
+  advance(busNs + _timing.wireTransferNs);
+  return t.acked ? 0 : 2;
+}
@@ -0,0 +1,205 @@
+/*
+ * SimBoard.h - Virtual Arduino Uno for running the firmware on a PC.
+ *
+ * Holds everything the simulated core (core/Arduino.h) acts on: a virtual
+ * clock in nanoseconds, the level and mode of digital pins D0-D19, a
+ * UART with 64-byte RX/TX buffers that moves bytes at the configured baud,
+ * and an I2C bus (core/Wire.h) whose devices are callbacks.
+ * Every core call advances the clock by an estimated Uno cost (SimTiming),
+ * so latencies and skews come out in the right order of magnitude; for
+ * exact cycle counts use the simavr bench instead.
+ *
+ * Pin changes and serial bytes are recorded with their timestamps for
+ * VcdWriter and for the command summary printed by braille_sim.
+ *
+ * Scheduled input changes take effect as soon as the clock passes them,
+ * also in the middle of a core call, and are handed to onInputChange so
+ * the core can raise pin-change interrupts at that instant.
+ */
+
+#ifndef SIM_BOARD_H
+#define SIM_BOARD_H
+
+#include <stdint.h>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+#define SIM_NUM_PINS 20          // D0-D13, A0-A5 (D14-D19)
+#define SIM_SERIAL_BUFFER 64     // HardwareSerial RX and TX ring size
+#define SIM_NEVER UINT64_MAX
+
+/**
+ * @brief Estimated cost of each core call on a 16 MHz Uno, in ns.
+ */
+struct SimTiming {
+  uint32_t digitalWriteNs = 3400;
+  uint32_t digitalReadNs = 3000;
+  uint32_t pinModeNs = 3500;
+  uint32_t portAccessNs = 125;     // PORTx/DDRx/PINx: 2 cycles
+  uint32_t serialAvailableNs = 600;
+  uint32_t serialReadNs = 900;
+  uint32_t serialWriteNs = 4000;   // per byte into the TX buffer
+  uint32_t interruptNs = 2500;     // ISR entry and exit, registers saved
+  uint32_t loopNs = 500;           // loop() call overhead
+  uint32_t wireTransferNs = 12000; // Wire library per transmission, besides the bus
+};
+
+/**
+ * @brief Thrown out of the firmware when virtual time passes the deadline,
+ * so a sketch stuck in delay() or a busy-wait still ends the run.
+ */
+struct SimDeadline {};
+
+struct PinEvent {
+  uint64_t time;
+  uint8_t pin;
+  uint8_t value;
+};
+
+struct SerialEvent {
+  uint64_t time;   // start of the byte on the wire
+  bool tx;         // true = board to host
+  uint8_t value;
+};
+
+struct SerialLine {
+  uint64_t time;   // when the '\n' finished transmitting
+  std::string text;
+};
+
+struct I2cTransfer {
+  uint64_t time;               // START
+  uint8_t address;             // 7-bit
+  std::vector<uint8_t> bytes;  // after the address byte
+  bool acked;
+  uint32_t sclPeriods;         // START, 9 per byte with the address, STOP
+};
+
+class SimBoard {
+
+public:
+
+  static SimBoard& instance();
+
+  /**
+   * @brief Returns the board to power-on state and clears all records.
+   */
+  void reset();
+
+  SimTiming& timing() { return _timing; }
+
+  uint64_t now() const { return _now; }
+  void advance(uint64_t ns);
+  void advanceTo(uint64_t time);
+  void setDeadline(uint64_t time) { _deadline = time; }
+
+  // Pins
+  void setPinMode(uint8_t pin, uint8_t mode);
+  uint8_t getPinMode(uint8_t pin) const;
+  void writePin(uint8_t pin, uint8_t value);
+  uint8_t readPin(uint8_t pin);
+  void driveInput(uint8_t pin, uint8_t value);   // external signal on a pin
+  void scheduleInput(uint64_t time, uint8_t pin, uint8_t value);
+  uint64_t nextInputTime() const;                 // SIM_NEVER if nothing is pending
+
+  // Called when an input pin's level changes (INPUT_PULLUP reads high
+  // until something drives it)
+  std::function<void(uint8_t pin)> onInputChange;
+  bool pinUsed(uint8_t pin) const { return pin < SIM_NUM_PINS && _pinUsed[pin]; }
+
+  // Serial
+  void serialBegin(unsigned long baud);
+  unsigned long getBaud() const { return _baud; }
+  uint64_t byteTimeNs() const;
+
+  /**
+   * @brief Queues bytes from the host. The first starts at `time` (or when
+   * the line is free), the rest follow back to back at the baud rate.
+   */
+  void scheduleRx(uint64_t time, const std::string& bytes);
+  uint64_t nextRxTime() const;       // SIM_NEVER if nothing is pending
+  int rxAvailable();
+  int rxPeek();
+  int rxRead();
+  void txWrite(uint8_t b);
+  void txFlush();
+  int txAvailable();                 // free TX buffer bytes, like availableForWrite()
+  uint32_t getRxOverflows() const { return _rxOverflows; }
+
+  // Called for every byte the board sends (time = end of the byte)
+  std::function<void(uint64_t time, uint8_t b)> onTx;
+
+  // I2C
+  void i2cSetClock(uint32_t hz) { _i2cClock = hz; }
+  uint32_t getI2cClock() const { return _i2cClock; }
+
+  /**
+   * @brief One write transmission, as Wire.endTransmission() sends it: the
+   * clock advances by the bus time plus wireTransferNs. Returns 0, or 2
+   * when no device acknowledged the address (like the AVR Wire library).
+   */
+  uint8_t i2cWrite(uint8_t address, const uint8_t* data, size_t n);
+
+  // The devices on the bus: return true to acknowledge. Without one,
+  // every address is NACKed.
+  std::function<bool(uint8_t address, const uint8_t* data, size_t n)> onI2cWrite;
+  uint64_t i2cBusNs() const { return _i2cBusNs; }   // SCL time, all transfers
+
+  // Records. Long-running harnesses turn them off; counters keep going.
+  void setRecording(bool on) { _recording = on; }
+  uint64_t pinEdgeCount() const { return _pinEdges; }
+  const std::vector<PinEvent>& pinEvents() const { return _pinEvents; }
+  const std::vector<SerialEvent>& serialEvents() const { return _serialEvents; }
+  const std::vector<SerialLine>& txLines() const { return _txLines; }
+  const std::vector<I2cTransfer>& i2cTransfers() const { return _i2cTransfers; }
+
+  // Idle detection for the loop driver: an iteration that only polled
+  // Serial.available() can be fast-forwarded to the next RX byte.
+  void beginIteration();
+  bool iterationWasIdle() const { return !_busy; }
+  void markBusy() { _busy = true; }
+
+private:
+
+  SimBoard();
+
+  SimTiming _timing;
+  uint64_t _now;
+  uint64_t _deadline;
+
+  uint8_t _pinLevel[SIM_NUM_PINS];
+  uint8_t _pinMode[SIM_NUM_PINS];
+  uint8_t _inputLevel[SIM_NUM_PINS];
+  bool _inputDriven[SIM_NUM_PINS];
+  std::deque<PinEvent> _inputPending;       // scheduled, in time order
+  bool _pinUsed[SIM_NUM_PINS];
+
+  unsigned long _baud;
+  uint64_t _rxLineFree;                     // when the host's line is idle again
+  std::deque<std::pair<uint64_t, uint8_t>> _rxPending;  // (arrival, byte)
+  std::deque<uint8_t> _rxBuffer;
+  std::deque<uint64_t> _txDone;             // completion times of queued bytes
+  uint32_t _rxOverflows;
+  std::string _txPartial;
+
+  uint32_t _i2cClock;
+  uint64_t _i2cBusNs;
+
+  std::vector<PinEvent> _pinEvents;
+  std::vector<SerialEvent> _serialEvents;
+  std::vector<SerialLine> _txLines;
+  std::vector<I2cTransfer> _i2cTransfers;
+  bool _recording;
+  uint64_t _pinEdges;
+
+  bool _busy;
+
+  void _applyInputs(uint64_t time);
+  uint8_t _inputValue(uint8_t pin) const;
+  void _pumpRx();
+  void _drainTx();
+};
+
+#endif
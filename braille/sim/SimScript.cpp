@@ -0,0 +1,121 @@
+#include "SimScript.h"
+#include <stdlib.h>
+#include <fstream>
+
+#define DEFAULT_TAIL_NS 100000000ULL   // 100 ms after the last action
+
+SimScript::SimScript()
+  : _cursor(0), _end(0), _lastAction(0), _lineNumber(0) {}
+
+static std::string trim(const std::string& s) {
+  size_t a = s.find_first_not_of(" \t\r\n");
+  if (a == std::string::npos) return "";
+  size_t b = s.find_last_not_of(" \t\r\n");
+  return s.substr(a, b - a + 1);
+}
+
+bool SimScript::parseTime(const std::string& s, uint64_t* ns) {
+  char* end = nullptr;
+  double value = strtod(s.c_str(), &end);
+  if (end == s.c_str() || value < 0) return false;
+
+  std::string unit(end);
+  double scale;
+  if (unit == "" || unit == "us") scale = 1e3;
+  else if (unit == "ns") scale = 1;
+  else if (unit == "ms") scale = 1e6;
+  else if (unit == "s") scale = 1e9;
+  else return false;
+
+  *ns = (uint64_t)(value * scale + 0.5);
+  return true;
+}
+
+bool SimScript::parseLine(const std::string& raw) {
+  _lineNumber++;
+  std::string line = trim(raw);
+  if (line.empty() || line[0] == '#') return true;
+
+  size_t space = line.find(' ');
+  std::string cmd = line.substr(0, space);
+  std::string arg = space == std::string::npos ? "" : trim(line.substr(space + 1));
+
+  uint64_t t;
+  if (cmd == "at" || cmd == "wait" || cmd == "end") {
+    if (!parseTime(arg, &t)) {
+      _error = "line " + std::to_string(_lineNumber) + ": bad time '" + arg + "'";
+      return false;
+    }
+    if (cmd == "at") _cursor = t;
+    else if (cmd == "wait") _cursor += t;
+    else _end = t;
+    if (cmd != "end" && _cursor > _lastAction) _lastAction = _cursor;
+    return true;
+  }
+
+  if (cmd == "send") {
+    ScriptSend s = {_cursor, arg};
+    _sends.push_back(s);
+    if (_cursor > _lastAction) _lastAction = _cursor;
+    return true;
+  }
+
+  if (cmd == "expect") {
+    if (_sends.empty()) {
+      _error = "line " + std::to_string(_lineNumber) + ": expect before any send";
+      return false;
+    }
+    ScriptExpect e;
+    e.send = _sends.size() - 1;
+    e.from = _cursor;
+    e.within = 0;
+    size_t w = arg.rfind(" within ");
+    if (w != std::string::npos && parseTime(trim(arg.substr(w + 8)), &e.within)) {
+      arg = trim(arg.substr(0, w));
+    }
+    e.prefix = !arg.empty() && arg[arg.size() - 1] == '*';
+    e.text = e.prefix ? arg.substr(0, arg.size() - 1) : arg;
+    e.line = _lineNumber;
+    _expects.push_back(e);
+    return true;
+  }
+
+  if (cmd == "input" || cmd == "label") {
+    size_t sep = arg.find(' ');
+    int pin = atoi(arg.substr(0, sep).c_str());
+    std::string rest = sep == std::string::npos ? "" : trim(arg.substr(sep + 1));
+    if (pin < 0 || pin > 19 || rest.empty()) {
+      _error = "line " + std::to_string(_lineNumber) + ": expected '" + cmd + " <pin> <value>'";
+      return false;
+    }
+    if (cmd == "input") {
+      ScriptInput in = {_cursor, (uint8_t)pin, (uint8_t)(atoi(rest.c_str()) ? 1 : 0)};
+      _inputs.push_back(in);
+      if (_cursor > _lastAction) _lastAction = _cursor;
+    } else {
+      ScriptLabel l = {(uint8_t)pin, rest};
+      _labels.push_back(l);
+    }
+    return true;
+  }
+
+  _error = "line " + std::to_string(_lineNumber) + ": unknown command '" + cmd + "'";
+  return false;
+}
+
+bool SimScript::load(const std::string& path) {
+  std::ifstream in(path.c_str());
+  if (!in) {
+    _error = "cannot open " + path;
+    return false;
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    if (!parseLine(line)) return false;
+  }
+  return true;
+}
+
+uint64_t SimScript::getEndTime() const {
+  return _end ? _end : _lastAction + DEFAULT_TAIL_NS;
+}
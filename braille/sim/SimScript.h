@@ -0,0 +1,97 @@
+/*
+ * SimScript.h - Host-side stimulus for braille_sim.
+ *
+ * A script is a list of timed actions, one per line:
+ *
+ *   # comment
+ *   label 2 dot1      name pin D2 "dot1" in the VCD
+ *   at 10ms           move the cursor to an absolute time
+ *   wait 500us        move the cursor forward
+ *   send P:FF         host sends "P:FF\n", starting at the cursor
+ *   expect OK         a board line equal to "OK" must follow the last send
+ *                     (before the next one); "expect BRAILLE*" matches a prefix
+ *   expect K:* within 2ms
+ *                     ... and end within 2 ms of the cursor (e.g. an input)
+ *   input 10 1        drive input pin D10 high at the cursor
+ *   end 2s            stop the simulation (default: 100 ms after the last action)
+ *
+ * Times take ns/us/ms/s suffixes; a bare number is microseconds.
+ */
+
+#ifndef SIM_SCRIPT_H
+#define SIM_SCRIPT_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+struct ScriptSend {
+  uint64_t time;
+  std::string text;        // without the trailing '\n'
+};
+
+struct ScriptExpect {
+  size_t send;             // index of the send it follows
+  std::string text;
+  bool prefix;
+  uint64_t from;           // cursor at the expect line
+  uint64_t within;         // 0 = any time; else the line ends by from + within
+  int line;                // script line, for messages
+};
+
+struct ScriptInput {
+  uint64_t time;
+  uint8_t pin;
+  uint8_t value;
+};
+
+struct ScriptLabel {
+  uint8_t pin;
+  std::string name;
+};
+
+class SimScript {
+
+public:
+
+  SimScript();
+
+  /**
+   * @brief Parses one line. Returns false and sets getError() on bad input.
+   */
+  bool parseLine(const std::string& line);
+
+  /**
+   * @brief Parses a whole script file.
+   */
+  bool load(const std::string& path);
+
+  const std::string& getError() const { return _error; }
+
+  const std::vector<ScriptSend>& sends() const { return _sends; }
+  const std::vector<ScriptExpect>& expects() const { return _expects; }
+  const std::vector<ScriptInput>& inputs() const { return _inputs; }
+  const std::vector<ScriptLabel>& labels() const { return _labels; }
+
+  uint64_t getEndTime() const;
+
+  /**
+   * @brief Parses "10ms", "250us", "2s", "40ns" or a bare microsecond count.
+   */
+  static bool parseTime(const std::string& s, uint64_t* ns);
+
+private:
+
+  uint64_t _cursor;
+  uint64_t _end;            // 0 = not set
+  uint64_t _lastAction;
+  int _lineNumber;
+  std::string _error;
+
+  std::vector<ScriptSend> _sends;
+  std::vector<ScriptExpect> _expects;
+  std::vector<ScriptInput> _inputs;
+  std::vector<ScriptLabel> _labels;
+};
+
+#endif
@@ -0,0 +1,93 @@
+#include "VcdWriter.h"
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+void VcdWriter::setLabel(uint8_t pin, const std::string& label) {
+  _labels[pin] = label;
+}
+
+std::string VcdWriter::_name(uint8_t pin) const {
+  std::map<uint8_t, std::string>::const_iterator it = _labels.find(pin);
+  if (it != _labels.end()) return it->second;
+  return "D" + std::to_string(pin);
+}
+
+std::string VcdWriter::_id(int index) {
+  // Printable identifier codes '!'..'~', as short as possible
+  std::string id;
+  do {
+    id += (char)('!' + index % 94);
+    index /= 94;
+  } while (index > 0);
+  return id;
+}
+
+static std::string binary8(uint8_t v) {
+  std::string s = "b";
+  for (int i = 7; i >= 0; i--) s += ((v >> i) & 1) ? '1' : '0';
+  return s;
+}
+
+bool VcdWriter::write(const std::string& path, const SimBoard& board, uint64_t endTime) {
+  FILE* f = fopen(path.c_str(), "w");
+  if (!f) return false;
+
+  fprintf(f, "$date braille_sim $end\n");
+  fprintf(f, "$version braille_sim (virtual Arduino Uno) $end\n");
+  fprintf(f, "$timescale 1ns $end\n");
+  fprintf(f, "$scope module uno $end\n");
+
+  std::vector<uint8_t> pins;
+  std::string pinId[SIM_NUM_PINS];
+  int next = 0;
+  for (uint8_t p = 0; p < SIM_NUM_PINS; p++) {
+    if (!board.pinUsed(p)) continue;
+    pins.push_back(p);
+    pinId[p] = _id(next++);
+    fprintf(f, "$var wire 1 %s %s $end\n", pinId[p].c_str(), _name(p).c_str());
+  }
+  std::string rxId = _id(next++);
+  std::string txId = _id(next++);
+  fprintf(f, "$var wire 8 %s serial_rx $end\n", rxId.c_str());
+  fprintf(f, "$var wire 8 %s serial_tx $end\n", txId.c_str());
+  fprintf(f, "$upscope $end\n$enddefinitions $end\n");
+
+  fprintf(f, "$dumpvars\n");
+  for (size_t i = 0; i < pins.size(); i++) {
+    fprintf(f, "0%s\n", pinId[pins[i]].c_str());
+  }
+  fprintf(f, "bxxxxxxxx %s\nbxxxxxxxx %s\n$end\n", rxId.c_str(), txId.c_str());
+
+  // Merge pin and serial events by time (both lists are already sorted)
+  const std::vector<PinEvent>& pe = board.pinEvents();
+  std::vector<SerialEvent> se = board.serialEvents();
+  std::stable_sort(se.begin(), se.end(),
+                   [](const SerialEvent& a, const SerialEvent& b) { return a.time < b.time; });
+
+  size_t i = 0, j = 0;
+  uint64_t last = SIM_NEVER;
+  while (i < pe.size() || j < se.size()) {
+    bool pinNext = j >= se.size() || (i < pe.size() && pe[i].time <= se[j].time);
+    uint64_t t = pinNext ? pe[i].time : se[j].time;
+    if (t > endTime) break;
+    if (t != last) {
+      fprintf(f, "#%llu\n", (unsigned long long)t);
+      last = t;
+    }
+    if (pinNext) {
+      fprintf(f, "%d%s\n", pe[i].value, pinId[pe[i].pin].c_str());
+      i++;
+    } else {
+      fprintf(f, "%s %s\n", binary8(se[j].value).c_str(), se[j].tx ? txId.c_str() : rxId.c_str());
+      j++;
+    }
+  }
+  if (last == SIM_NEVER || endTime > last) {
+    fprintf(f, "#%llu\n", (unsigned long long)endTime);
+  }
+
+  bool ok = ferror(f) == 0;
+  fclose(f);
+  return ok;
+}
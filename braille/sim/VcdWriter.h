@@ -0,0 +1,40 @@
+/*
+ * VcdWriter.h - Writes SimBoard recordings as a Value Change Dump.
+ *
+ * One 1-bit wire per used pin (named D<n>, or a label such as "dot1") and
+ * two 8-bit vectors, serial_rx and serial_tx, holding each byte from the
+ * moment its start bit goes out. Timescale is 1 ns. The file opens in
+ * GTKWave or any VCD reader.
+ */
+
+#ifndef SIM_VCD_WRITER_H
+#define SIM_VCD_WRITER_H
+
+#include "SimBoard.h"
+#include <map>
+#include <string>
+
+class VcdWriter {
+
+public:
+
+  /**
+   * @brief Names pin `pin` in the dump instead of D<pin>.
+   */
+  void setLabel(uint8_t pin, const std::string& label);
+
+  /**
+   * @brief Writes everything the board recorded up to `endTime`.
+   * @return false if the file could not be written.
+   */
+  bool write(const std::string& path, const SimBoard& board, uint64_t endTime);
+
+private:
+
+  std::map<uint8_t, std::string> _labels;
+
+  std::string _name(uint8_t pin) const;
+  static std::string _id(int index);
+};
+
+#endif
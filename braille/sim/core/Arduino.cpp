@@ -0,0 +1,229 @@
+#include "Arduino.h"
+#include "SimBoard.h"
+
+SimSerial Serial;
+
+// Uno port mapping: PORTD = D0-D7, PORTB = D8-D13, PORTC = A0-A5
+SimPortRegister PORTD(0, 8, SimPortRegister::PORT);
+SimPortRegister PORTB(8, 6, SimPortRegister::PORT);
+SimPortRegister PORTC(14, 6, SimPortRegister::PORT);
+SimPortRegister DDRD(0, 8, SimPortRegister::DDR);
+SimPortRegister DDRB(8, 6, SimPortRegister::DDR);
+SimPortRegister DDRC(14, 6, SimPortRegister::DDR);
+SimPortRegister PIND(0, 8, SimPortRegister::PIN);
+SimPortRegister PINB(8, 6, SimPortRegister::PIN);
+SimPortRegister PINC(14, 6, SimPortRegister::PIN);
+
+static SimBoard& board() {
+  return SimBoard::instance();
+}
+
+// ---------------------------------------------------------------------------
+// Pin-change interrupts
+// ---------------------------------------------------------------------------
+
+volatile uint8_t PCICR = 0;
+volatile uint8_t PCMSK0 = 0, PCMSK1 = 0, PCMSK2 = 0;
+
+// A sketch without handlers gets these; its own ISR() definitions win
+__attribute__((weak)) void PCINT0_vect() {}
+__attribute__((weak)) void PCINT1_vect() {}
+__attribute__((weak)) void PCINT2_vect() {}
+
+static bool interruptsEnabled = true;
+static bool inInterrupt = false;
+static uint8_t pendingGroups = 0;   // PCIFR
+
+static void runPendingInterrupts() {
+  static void (*const vectors[3])() = {PCINT0_vect, PCINT1_vect, PCINT2_vect};
+  while (interruptsEnabled && !inInterrupt && (pendingGroups & PCICR)) {
+    for (uint8_t g = 0; g < 3; g++) {
+      if (!(pendingGroups & PCICR & _BV(g))) continue;
+      pendingGroups &= (uint8_t)~_BV(g);
+      inInterrupt = true;
+      board().advance(board().timing().interruptNs);
+      vectors[g]();
+      inInterrupt = false;
+    }
+  }
+}
+
+static void onInputChange(uint8_t pin) {
+  volatile uint8_t* mask = digitalPinToPCMSK(pin);
+  if (!mask || !(*mask & _BV(digitalPinToPCMSKbit(pin)))) return;
+  pendingGroups |= (uint8_t)_BV(digitalPinToPCICRbit(pin));
+  runPendingInterrupts();
+}
+
+static struct InterruptHook {
+  InterruptHook() { SimBoard::instance().onInputChange = onInputChange; }
+} interruptHook;
+
+void noInterrupts() {
+  interruptsEnabled = false;
+}
+
+void interrupts() {
+  interruptsEnabled = true;
+  runPendingInterrupts();
+}
+
+// ---------------------------------------------------------------------------
+// Digital I/O and time
+// ---------------------------------------------------------------------------
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  board().advance(board().timing().pinModeNs);
+  board().setPinMode(pin, mode);
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  board().advance(board().timing().digitalWriteNs);
+  board().writePin(pin, value);
+}
+
+int digitalRead(uint8_t pin) {
+  board().advance(board().timing().digitalReadNs);
+  board().markBusy();
+  return board().readPin(pin);
+}
+
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t value) {
+  for (uint8_t i = 0; i < 8; i++) {
+    uint8_t bit = bitOrder == LSBFIRST ? (value >> i) & 1 : (value >> (7 - i)) & 1;
+    digitalWrite(dataPin, bit);
+    digitalWrite(clockPin, HIGH);
+    digitalWrite(clockPin, LOW);
+  }
+}
+
+unsigned long millis() {
+  board().markBusy();   // time-dependent loop: no fast-forward
+  return (unsigned long)(board().now() / 1000000ULL);
+}
+
+unsigned long micros() {
+  board().markBusy();
+  return (unsigned long)(board().now() / 1000ULL);
+}
+
+void delay(unsigned long ms) {
+  board().markBusy();
+  board().advance((uint64_t)ms * 1000000ULL);
+}
+
+void delayMicroseconds(unsigned int us) {
+  board().markBusy();
+  board().advance((uint64_t)us * 1000ULL);
+}
+
+// ---------------------------------------------------------------------------
+// Serial
+// ---------------------------------------------------------------------------
+
+void SimSerial::begin(unsigned long baud) {
+  board().serialBegin(baud);
+}
+
+int SimSerial::available() {
+  return board().rxAvailable();
+}
+
+int SimSerial::peek() {
+  return board().rxPeek();
+}
+
+int SimSerial::read() {
+  return board().rxRead();
+}
+
+void SimSerial::flush() {
+  board().txFlush();
+}
+
+int SimSerial::availableForWrite() {
+  return board().txAvailable();
+}
+
+size_t SimSerial::write(uint8_t b) {
+  board().txWrite(b);
+  return 1;
+}
+
+size_t SimSerial::write(const uint8_t* data, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    board().txWrite(data[i]);
+  }
+  return n;
+}
+
+size_t SimSerial::print(unsigned long n, int base) {
+  char buf[33];
+  char* p = buf + sizeof(buf) - 1;
+  *p = '\0';
+  if (base < 2) base = 10;
+  do {
+    unsigned long digit = n % base;
+    *--p = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+    n /= base;
+  } while (n > 0);
+  return write(p);
+}
+
+size_t SimSerial::print(long n, int base) {
+  if (base == 10 && n < 0) {
+    return print('-') + print((unsigned long)(-n), 10);
+  }
+  return print((unsigned long)n, base);
+}
+
+size_t SimSerial::print(double n, int digits) {
+  char buf[40];
+  snprintf(buf, sizeof(buf), "%.*f", digits, n);
+  return write(buf);
+}
+
+// ---------------------------------------------------------------------------
+// Port registers
+// ---------------------------------------------------------------------------
+
+SimPortRegister::operator uint8_t() const {
+  SimBoard& b = board();
+  b.advance(b.timing().portAccessNs);
+  uint8_t value = 0;
+  for (uint8_t i = 0; i < _width; i++) {
+    uint8_t pin = _firstPin + i;
+    uint8_t bit = 0;
+    if (_kind == DDR) {
+      bit = b.getPinMode(pin) == OUTPUT;
+    } else if (_kind == PIN) {
+      bit = b.readPin(pin);
+    } else {
+      // PORTx reads back the output latch
+      bit = b.getPinMode(pin) == OUTPUT ? b.readPin(pin) : 0;
+    }
+    value |= bit << i;
+  }
+  return value;
+}
+
+SimPortRegister& SimPortRegister::operator=(uint8_t value) {
+  SimBoard& b = board();
+  b.advance(b.timing().portAccessNs);
+  b.markBusy();
+
+  // All bits change at the same instant: no skew between pins
+  for (uint8_t i = 0; i < _width; i++) {
+    uint8_t pin = _firstPin + i;
+    uint8_t bit = (value >> i) & 1;
+    if (_kind == DDR) {
+      b.setPinMode(pin, bit ? OUTPUT : INPUT);
+    } else if (_kind == PIN) {
+      // Writing 1 to PINx toggles the pin
+      if (bit) b.writePin(pin, !b.readPin(pin));
+    } else {
+      b.writePin(pin, bit);
+    }
+  }
+  return *this;
+}
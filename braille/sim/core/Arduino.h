@@ -0,0 +1,148 @@
+/*
+ * Arduino.h - Simulated Arduino core for braille_sim.
+ *
+ * Just enough of the AVR Arduino API for the firmware in braille/src and
+ * the libraries in braille/lib to compile unchanged on a PC. Every call
+ * goes to SimBoard, which advances virtual time and records pin and
+ * serial activity. Direct port access (PORTB/C/D, DDRx, PINx) is mapped
+ * onto the same pins with Uno numbering, and pin-change interrupts
+ * (PCICR, PCMSKn, ISR(PCINTn_vect)) fire when a scripted input changes.
+ */
+
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+#include <ctype.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+
+#define _BV(bit) (1 << (bit))
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define F(s) (s)
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t value);
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// Pin-change interrupts, ATmega328P layout: group 0 = D8-D13 (PCMSK0),
+// 1 = A0-A5 (PCMSK1), 2 = D0-D7 (PCMSK2). A change on a pin enabled in
+// PCMSKn calls ISR(PCINTn_vect) if PCICR has bit PCIEn, at once or when
+// interrupts() allows it again; handlers do not nest.
+extern volatile uint8_t PCICR;
+extern volatile uint8_t PCMSK0, PCMSK1, PCMSK2;
+#define PCIE0 0
+#define PCIE1 1
+#define PCIE2 2
+
+#define ISR(vector) void vector()
+void PCINT0_vect();
+void PCINT1_vect();
+void PCINT2_vect();
+
+void noInterrupts();
+void interrupts();
+
+// As in the Uno's pins_arduino.h
+#define digitalPinToPCICR(p) (((p) >= 0 && (p) <= 19) ? (&PCICR) : ((volatile uint8_t*)0))
+#define digitalPinToPCICRbit(p) (((p) <= 7) ? 2 : (((p) <= 13) ? 0 : 1))
+#define digitalPinToPCMSK(p) \
+  (((p) <= 7) ? (&PCMSK2) : (((p) <= 13) ? (&PCMSK0) : (((p) <= 19) ? (&PCMSK1) : ((volatile uint8_t*)0))))
+#define digitalPinToPCMSKbit(p) (((p) <= 7) ? (p) : (((p) <= 13) ? ((p) - 8) : ((p) - 14)))
+
+class SimSerial {
+public:
+  void begin(unsigned long baud);
+  void end() {}
+  int available();
+  int peek();
+  int read();
+  void flush();
+  int availableForWrite();
+  operator bool() { return true; }
+
+  size_t write(uint8_t b);
+  size_t write(const uint8_t* data, size_t n);
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+
+  size_t print(const char* s) { return write(s); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int n, int base = DEC) { return print((long)n, base); }
+  size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); }
+  size_t print(long n, int base = DEC);
+  size_t print(unsigned long n, int base = DEC);
+  size_t print(double n, int digits = 2);
+
+  size_t println() { return write("\r\n"); }
+  template <class T>
+  size_t println(T value) { return print(value) + println(); }
+  template <class T>
+  size_t println(T value, int format) { return print(value, format) + println(); }
+};
+
+extern SimSerial Serial;
+
+/**
+ * AVR I/O register mapped onto simulated pins. Writes to PORTx change all
+ * affected pins at the same virtual instant.
+ */
+class SimPortRegister {
+public:
+  enum Kind { PORT, DDR, PIN };
+
+  SimPortRegister(uint8_t firstPin, uint8_t width, Kind kind)
+    : _firstPin(firstPin), _width(width), _kind(kind) {}
+
+  operator uint8_t() const;
+  SimPortRegister& operator=(uint8_t value);
+  SimPortRegister& operator|=(uint8_t value) { return *this = (uint8_t)(*this | value); }
+  SimPortRegister& operator&=(uint8_t value) { return *this = (uint8_t)(*this & value); }
+  SimPortRegister& operator^=(uint8_t value) { return *this = (uint8_t)(*this ^ value); }
+
+private:
+  uint8_t _firstPin;
+  uint8_t _width;
+  Kind _kind;
+};
+
+extern SimPortRegister PORTB, PORTC, PORTD;
+extern SimPortRegister DDRB, DDRC, DDRD;
+extern SimPortRegister PINB, PINC, PIND;
+
+#endif
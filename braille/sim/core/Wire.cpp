@@ -0,0 +1,36 @@
+#include "Wire.h"
+#include "SimBoard.h"
+
+TwoWire Wire;
+
+void TwoWire::begin() {
+  SimBoard::instance().markBusy();
+}
+
+void TwoWire::setClock(uint32_t hz) {
+  SimBoard::instance().i2cSetClock(hz);
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+  _address = address;
+  _length = 0;
+  _transmitting = true;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+  (void)sendStop;
+  _transmitting = false;
+  return SimBoard::instance().i2cWrite(_address, _buffer, _length);
+}
+
+size_t TwoWire::write(uint8_t b) {
+  if (!_transmitting || _length >= BUFFER_LENGTH) return 0;
+  _buffer[_length++] = b;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t n) {
+  size_t written = 0;
+  while (written < n && write(data[written])) written++;
+  return written;
+}
@@ -0,0 +1,43 @@
+/*
+ * Wire.h - Simulated I2C master (TwoWire) for braille_sim.
+ *
+ * The write side of the AVR Wire library: a transmission is buffered (32
+ * bytes, like BUFFER_LENGTH) and goes to SimBoard::i2cWrite() at
+ * endTransmission(), which charges the bus time at setClock()'s rate and
+ * hands the bytes to the simulated devices.
+ */
+
+#ifndef SIM_WIRE_H
+#define SIM_WIRE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BUFFER_LENGTH 32
+
+class TwoWire {
+public:
+  TwoWire() : _address(0), _length(0), _transmitting(false) {}
+
+  void begin();
+  void end() {}
+  void setClock(uint32_t hz);
+
+  void beginTransmission(uint8_t address);
+  void beginTransmission(int address) { beginTransmission((uint8_t)address); }
+  // 0 = sent, 2 = address NACKed; no repeated START in this model
+  uint8_t endTransmission(bool sendStop = true);
+
+  size_t write(uint8_t b);
+  size_t write(const uint8_t* data, size_t n);
+
+private:
+  uint8_t _address;
+  uint8_t _buffer[BUFFER_LENGTH];
+  uint8_t _length;
+  bool _transmitting;
+};
+
+extern TwoWire Wire;
+
+#endif
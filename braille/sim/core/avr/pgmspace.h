@@ -0,0 +1,14 @@
+/*
+ * avr/pgmspace.h - PROGMEM and pgm_read_* for braille_sim.
+ *
+ * The simulated core already defines them in Arduino.h (flash is ordinary
+ * memory on a PC); this header only lets libraries that include
+ * <avr/pgmspace.h> directly, like BrailleConverter, compile unchanged.
+ */
+
+#ifndef SIM_AVR_PGMSPACE_H
+#define SIM_AVR_PGMSPACE_H
+
+#include "Arduino.h"
+
+#endif // SIM_AVR_PGMSPACE_H
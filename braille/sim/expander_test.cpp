@@ -0,0 +1,295 @@
+/*
+ * expander_test.cpp - BrailleExpander on braille_sim's I2C bus.
+ *
+ *   expander_test [--quiet]
+ *
+ * Puts sixteen MCP23017 models (register file with auto-increment) and a
+ * TCA9548A model on SimBoard's bus and checks what BrailleExpander sends:
+ * the OLATA/OLATB burst bytes, that update() only addresses expanders
+ * whose cells changed and retries one that NACKed, that each expander's
+ * latches end up holding the staged frame, and that a full update at
+ * 16 and 32 cells takes no more SCL time than the figures published in
+ * BrailleExpander.h. Prints the refresh table; exits with 1 on a failure.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "BrailleExpander.h"
+#include "SimBoard.h"
+
+#define MUX_ADDRESS 0x70
+#define MCP_REGISTERS 0x16   // IOCON.BANK = 0: 0x00-0x15
+#define MCP_IODIRA 0x00
+#define MCP_IODIRB 0x01
+#define MCP_OLATA 0x14
+#define MCP_OLATB 0x15
+
+namespace {
+
+struct Mcp23017 {
+  uint8_t regs[MCP_REGISTERS];
+  bool present;
+};
+
+// Expanders 0-7 on the main bus or mux channel 0, 8-15 on channel 1
+struct Bus {
+  Mcp23017 mcp[16];
+  bool muxPresent;
+  uint8_t muxChannels;   // TCA9548A control register
+  bool conflict;         // two expanders answered one address
+
+  void reset(bool mux) {
+    for (uint8_t e = 0; e < 16; e++) {
+      memset(mcp[e].regs, 0, sizeof(mcp[e].regs));
+      mcp[e].regs[MCP_IODIRA] = mcp[e].regs[MCP_IODIRB] = 0xFF;   // power-on: inputs
+      mcp[e].present = true;
+    }
+    muxPresent = mux;
+    muxChannels = 0;
+    conflict = false;
+  }
+
+  bool write(uint8_t address, const uint8_t* data, size_t n) {
+    if (muxPresent && address == MUX_ADDRESS) {
+      if (n >= 1) muxChannels = data[n - 1];
+      return true;
+    }
+    if (address < EXPANDER_BASE_ADDRESS || address >= EXPANDER_BASE_ADDRESS + EXPANDER_PER_BUS) {
+      return false;
+    }
+    // Which copies of this address are on the selected channels
+    Mcp23017* target = 0;
+    for (uint8_t group = 0; group < 2; group++) {
+      bool visible = muxPresent ? (muxChannels & (1 << group)) != 0 : group == 0;
+      Mcp23017& m = mcp[group * EXPANDER_PER_BUS + address - EXPANDER_BASE_ADDRESS];
+      if (!visible || !m.present) continue;
+      if (target) conflict = true;
+      target = &m;
+    }
+    if (!target || n == 0) return target != 0;
+    // First byte is the register pointer, then sequential writes
+    uint8_t reg = data[0];
+    for (size_t i = 1; i < n; i++) {
+      if (reg < MCP_REGISTERS) target->regs[reg] = data[i];
+      reg = (uint8_t)((reg + 1) % MCP_REGISTERS);
+    }
+    return true;
+  }
+};
+
+Bus bus;
+int failures = 0;
+bool quiet = false;
+
+void check(bool ok, const std::string& what) {
+  if (!ok) {
+    fprintf(stderr, "FAIL: %s\n", what.c_str());
+    failures++;
+  }
+}
+
+std::string hex(const std::vector<uint8_t>& bytes) {
+  std::string s;
+  char b[4];
+  for (size_t i = 0; i < bytes.size(); i++) {
+    snprintf(b, sizeof(b), "%s%02X", i ? " " : "", bytes[i]);
+    s += b;
+  }
+  return s;
+}
+
+// Transfers recorded since `from`
+std::vector<I2cTransfer> since(size_t from) {
+  const std::vector<I2cTransfer>& all = SimBoard::instance().i2cTransfers();
+  return std::vector<I2cTransfer>(all.begin() + from, all.end());
+}
+
+uint64_t busNs(const std::vector<I2cTransfer>& transfers) {
+  uint64_t periods = 0;
+  for (size_t i = 0; i < transfers.size(); i++) periods += transfers[i].sclPeriods;
+  return periods * 1000000000ULL / SimBoard::instance().getI2cClock();
+}
+
+bool latchesHold(const uint8_t* frame, uint8_t cells) {
+  for (uint8_t c = 0; c < cells; c++) {
+    const Mcp23017& m = bus.mcp[c / 2];
+    if (m.regs[c % 2 ? MCP_OLATB : MCP_OLATA] != frame[c]) return false;
+  }
+  return true;
+}
+
+void startBoard(bool mux) {
+  SimBoard& board = SimBoard::instance();
+  board.reset();
+  bus.reset(mux);
+  board.onI2cWrite = [](uint8_t address, const uint8_t* data, size_t n) {
+    return bus.write(address, data, n);
+  };
+}
+
+void testBeginAndBursts() {
+  startBoard(false);
+  BrailleExpander display;
+  check(display.begin(16, 400000), "begin(16) acknowledged");
+  for (uint8_t e = 0; e < 8; e++) {
+    check(bus.mcp[e].regs[MCP_IODIRA] == 0 && bus.mcp[e].regs[MCP_IODIRB] == 0,
+          "expander " + std::to_string(e) + " ports are outputs after begin()");
+  }
+  check(display.update() == 0, "update() right after begin() writes nothing");
+
+  // Every cell changed: one OLATA, OLATB burst per expander, in order
+  uint8_t frame[16];
+  for (uint8_t c = 0; c < 16; c++) frame[c] = (uint8_t)(0x11 * (c + 1));
+  display.setFrame(frame, 16);
+  size_t mark = SimBoard::instance().i2cTransfers().size();
+  check(display.update() == 8, "full update writes 8 expanders");
+  std::vector<I2cTransfer> t = since(mark);
+  check(t.size() == 8, "full update is 8 transfers, got " + std::to_string(t.size()));
+  for (size_t i = 0; i < t.size() && i < 8; i++) {
+    std::vector<uint8_t> expect;
+    expect.push_back(MCP_OLATA);
+    expect.push_back(frame[2 * i]);
+    expect.push_back(frame[2 * i + 1]);
+    check(t[i].address == EXPANDER_BASE_ADDRESS + i && t[i].bytes == expect,
+          "burst " + std::to_string(i) + " is " + hex(expect) + ", got " + hex(t[i].bytes));
+    check(t[i].sclPeriods == 38, "a burst is 38 SCL periods");
+  }
+  check(latchesHold(frame, 16), "latches hold the frame after a full update");
+}
+
+void testChangedOnly() {
+  startBoard(false);
+  BrailleExpander display;
+  display.begin(16, 1000000);
+  uint8_t frame[16] = {0};
+
+  struct Step {
+    const char* what;
+    uint8_t cells[2];      // cells to change, 0xFF = none
+    uint8_t expander;
+    std::vector<uint8_t> bytes;
+  };
+  const Step steps[] = {
+    {"odd cell alone writes OLATB", {5, 0xFF}, 2, {MCP_OLATB, 0x3C}},
+    {"even cell alone writes OLATA", {4, 0xFF}, 2, {MCP_OLATA, 0x3C}},
+    {"both cells of an expander burst", {10, 11}, 5, {MCP_OLATA, 0x3C, 0x3C}},
+  };
+  for (size_t s = 0; s < sizeof(steps) / sizeof(steps[0]); s++) {
+    for (uint8_t k = 0; k < 2; k++) {
+      if (steps[s].cells[k] != 0xFF) frame[steps[s].cells[k]] = 0x3C;
+    }
+    display.setFrame(frame, 16);
+    size_t mark = SimBoard::instance().i2cTransfers().size();
+    uint8_t written = display.update();
+    std::vector<I2cTransfer> t = since(mark);
+    check(written == 1 && t.size() == 1, std::string(steps[s].what) + ": one transfer");
+    if (t.size() == 1) {
+      check(t[0].address == EXPANDER_BASE_ADDRESS + steps[s].expander && t[0].bytes == steps[s].bytes,
+            std::string(steps[s].what) + ": got " + hex(t[0].bytes));
+    }
+  }
+
+  // The same frame again: nothing on the bus
+  display.setFrame(frame, 16);
+  size_t mark = SimBoard::instance().i2cTransfers().size();
+  check(display.update() == 0 && since(mark).empty(), "unchanged frame sends nothing");
+
+  // A NACKing expander keeps its old bytes and is the only one retried
+  frame[0] = 0x01;
+  frame[15] = 0x80;
+  bus.mcp[0].present = false;
+  display.setFrame(frame, 16);
+  check(display.update() == 1, "update() counts only the acknowledged expander");
+  bus.mcp[0].present = true;
+  mark = SimBoard::instance().i2cTransfers().size();
+  check(display.update() == 1, "the NACKed expander is retried");
+  std::vector<I2cTransfer> t = since(mark);
+  check(t.size() == 1 && t[0].address == EXPANDER_BASE_ADDRESS, "only expander 0 is retried");
+  check(latchesHold(frame, 16), "latches hold the frame after the retry");
+}
+
+void testMuxAndOddCount() {
+  startBoard(true);
+  BrailleExpander display;
+  check(display.begin(31, 400000, MUX_ADDRESS), "begin(31) through the mux acknowledged");
+  uint8_t frame[32];
+  for (uint8_t c = 0; c < 31; c++) frame[c] = (uint8_t)(c * 7 + 1);
+  display.setFrame(frame, 31);
+  display.update();
+  check(latchesHold(frame, 31), "31 cells through the mux land on the right expanders");
+  check(bus.mcp[15].regs[MCP_OLATB] == 0, "the missing 32nd cell stays blank");
+  check(!bus.conflict, "one mux channel at a time");
+
+  BrailleExpander wide;
+  startBoard(false);
+  check(!wide.begin(32, 400000), "more than 16 cells without a mux is refused");
+}
+
+// Published worst case (BrailleExpander.h and braille/README.md)
+struct Published {
+  uint8_t cells;
+  uint32_t clockHz;
+  uint32_t micros;
+};
+const Published PUBLISHED[] = {
+  {16, 400000, 760}, {16, 1000000, 304}, {32, 400000, 1620}, {32, 1000000, 648},
+};
+
+void testRefreshTimes() {
+  if (!quiet) {
+    printf("%-6s %-8s %12s %12s %14s\n", "cells", "clock", "published", "bus (sim)", "update (sim)");
+  }
+  for (size_t i = 0; i < sizeof(PUBLISHED) / sizeof(PUBLISHED[0]); i++) {
+    const Published& p = PUBLISHED[i];
+    std::string name = std::to_string(p.cells) + " cells at " + std::to_string(p.clockHz) + " Hz";
+    check(BrailleExpander::worstCaseMicros(p.cells, p.clockHz) == p.micros,
+          name + ": worstCaseMicros() matches the published " + std::to_string(p.micros) + " us");
+
+    bool mux = p.cells > 16;
+    startBoard(mux);
+    BrailleExpander display;
+    display.begin(p.cells, p.clockHz, mux ? MUX_ADDRESS : EXPANDER_NO_MUX);
+    uint8_t frame[EXPANDER_MAX_CELLS];
+    for (uint8_t c = 0; c < p.cells; c++) frame[c] = (uint8_t)(0xA5 ^ c);
+    display.setFrame(frame, p.cells);
+    size_t mark = SimBoard::instance().i2cTransfers().size();
+    display.update();
+    uint64_t bus = busNs(since(mark));
+    uint32_t measured = display.getLastUpdateMicros();
+
+    check(latchesHold(frame, p.cells), name + ": every cell updated");
+    check(bus <= (uint64_t)p.micros * 1000, name + ": bus time within the published figure");
+    // Expanders take 38 periods each; the mux switch(es) make up the rest
+    uint64_t expanderNs = (uint64_t)(p.cells / 2) * 38 * 1000000000ULL / p.clockHz;
+    check(bus >= expanderNs, name + ": no expander skipped");
+    check(measured * 1000ULL >= bus, name + ": getLastUpdateMicros() includes the bus time");
+    if (!quiet) {
+      printf("%-6u %-8lu %9lu us %9.1f us %11lu us\n", p.cells, (unsigned long)p.clockHz,
+             (unsigned long)p.micros, bus / 1000.0, (unsigned long)measured);
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--quiet") == 0) {
+      quiet = true;
+    } else {
+      fprintf(stderr, "usage: expander_test [--quiet]\n");
+      return 2;
+    }
+  }
+
+  testBeginAndBursts();
+  testChangedOnly();
+  testMuxAndOddCount();
+  testRefreshTimes();
+
+  if (failures) fprintf(stderr, "%d check(s) failed\n", failures);
+  return failures ? 1 : 0;
+}
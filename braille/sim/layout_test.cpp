@@ -0,0 +1,214 @@
+/*
+ * layout_test.cpp - BrailleLayout's incremental reflow against a fresh layout.
+ *
+ *   layout_test [--quiet]
+ *
+ * Edits a generated document (words, numbers, capitals, indented lines,
+ * tabs, CR LF and words wider than the line) with random insert() and
+ * erase() calls, and after each edit compares the edited layout with a new
+ * BrailleLayout laid out from scratch over the same text: line starts,
+ * line cells, page frames, line counts and getLineForOffset(). Runs across
+ * widths and indicator settings, with page jumps between edits so reflow
+ * starts from a partly laid-out document as often as from a complete one.
+ * Built with a small LAYOUT_BREAK_SLOTS so the break table's stride doubles
+ * several times. Prints a summary per width; exits with 1 on a failure.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BrailleLayout.h"
+
+#define TEXT_CAPACITY 8192
+#define EDITS_PER_RUN 200
+
+namespace {
+
+BrailleConverter converter;
+int failures = 0;
+bool quiet = false;
+
+const char* const WORDS[] = {
+  "the", "braille", "display", "shows", "one", "line", "of", "text", "at", "a",
+  "time.", "Reading", "Chapter", "12", "1775,", "ISBN", "x2", "pp.", "and", "so",
+  "on", "unbreakablewordthatiswiderthananylineonthedisplay", "\t", "  ",
+};
+
+std::string randomText(std::mt19937& rng, size_t size) {
+  std::string s;
+  while (s.size() < size) {
+    s += WORDS[rng() % (sizeof(WORDS) / sizeof(WORDS[0]))];
+    uint32_t r = rng() % 20;
+    s += r == 0 ? "\n" : r == 1 ? "\r\n   " : r == 2 ? "\n\n" : " ";
+  }
+  return s;
+}
+
+struct Config {
+  uint8_t width;
+  uint8_t linesPerPage;
+  uint8_t indicators;
+};
+
+std::string describe(const Config& c, int edit, const std::string& what) {
+  char b[96];
+  snprintf(b, sizeof(b), "width %u, %u lines per page, indicators %u, edit %d: ", c.width,
+           c.linesPerPage, c.indicators, edit);
+  return b + what;
+}
+
+// A layout over its own copy of `text`, laid out from scratch
+struct Fresh {
+  char buffer[TEXT_CAPACITY];
+  BrailleLayout layout;
+
+  Fresh(const char* text, uint16_t length, const Config& c) : layout(converter) {
+    memcpy(buffer, text, length);
+    buffer[length] = '\0';
+    layout.begin(buffer, length, TEXT_CAPACITY);
+    layout.setWidth(c.width);
+    layout.setLinesPerPage(c.linesPerPage);
+    layout.setIndicators(c.indicators);
+  }
+};
+
+// Compares line `line` of both layouts; returns false and reports on a difference
+bool sameLine(BrailleLayout& edited, BrailleLayout& fresh, uint16_t line, const std::string& where) {
+  uint8_t a[255], b[255];
+  uint16_t sa = edited.getLineStart(line), sb = fresh.getLineStart(line);
+  uint8_t na = edited.getLine(line, a), nb = fresh.getLine(line, b);
+  if (sa == sb && na == nb && memcmp(a, b, fresh.getWidth()) == 0) return true;
+  fprintf(stderr, "FAIL: %sline %u starts at %u with %u cells, fresh layout %u with %u cells\n",
+          where.c_str(), line, sa, na, sb, nb);
+  failures++;
+  return false;
+}
+
+bool samePage(BrailleLayout& edited, BrailleLayout& fresh, uint16_t page, const std::string& where) {
+  static uint8_t a[255 * 255], b[255 * 255];
+  uint8_t la = edited.getPage(page, a), lb = fresh.getPage(page, b);
+  if (la == lb && memcmp(a, b, (size_t)fresh.getLinesPerPage() * fresh.getWidth()) == 0) return true;
+  fprintf(stderr, "FAIL: %spage %u differs: %u lines, fresh layout %u\n", where.c_str(), page, la, lb);
+  failures++;
+  return false;
+}
+
+// Everything: counts, every line and page, and offsets around the edit
+bool sameDocument(BrailleLayout& edited, BrailleLayout& fresh, uint16_t near, std::mt19937& rng,
+                  const std::string& where) {
+  uint16_t lines = fresh.getLineCount();
+  if (edited.getLineCount() != lines || edited.getPageCount() != fresh.getPageCount()) {
+    fprintf(stderr, "FAIL: %s%u lines on %u pages, fresh layout %u on %u\n", where.c_str(),
+            edited.getLineCount(), edited.getPageCount(), lines, fresh.getPageCount());
+    failures++;
+    return false;
+  }
+  for (uint16_t i = 0; i < lines; i++) {
+    if (!sameLine(edited, fresh, i, where)) return false;
+  }
+  for (uint16_t p = 0; p < fresh.getPageCount(); p++) {
+    if (!samePage(edited, fresh, p, where)) return false;
+  }
+  uint16_t length = fresh.getLength();
+  for (int i = 0; i < 8; i++) {
+    uint16_t offset = i < 4 ? (uint16_t)(near + i) : (uint16_t)(length ? rng() % length : 0);
+    if (offset > length) continue;
+    if (edited.getLineForOffset(offset) != fresh.getLineForOffset(offset)) {
+      fprintf(stderr, "FAIL: %soffset %u on line %u, fresh layout line %u\n", where.c_str(), offset,
+              edited.getLineForOffset(offset), fresh.getLineForOffset(offset));
+      failures++;
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the number of edits checked
+int run(const Config& c, unsigned seed, uint16_t* lines) {
+  std::mt19937 rng(seed);
+  static char buffer[TEXT_CAPACITY];
+  std::string start = randomText(rng, 1500);
+  memcpy(buffer, start.data(), start.size());
+  buffer[start.size()] = '\0';
+
+  BrailleLayout layout(converter);
+  layout.begin(buffer, (uint16_t)start.size(), TEXT_CAPACITY);
+  layout.setWidth(c.width);
+  layout.setLinesPerPage(c.linesPerPage);
+  layout.setIndicators(c.indicators);
+
+  for (int edit = 0; edit < EDITS_PER_RUN; edit++) {
+    // Lay out only part of the document first, most of the time
+    uint32_t jump = rng() % 4;
+    if (jump == 1) {
+      uint8_t frame[255 * 4];
+      if ((uint32_t)c.linesPerPage * c.width <= sizeof(frame)) layout.getPage((uint16_t)(rng() % 8), frame);
+      else layout.getLineStart((uint16_t)(rng() % 64));
+    } else if (jump == 2) {
+      layout.getLineStart((uint16_t)(rng() % 400));
+    } else if (jump == 3) {
+      layout.getLineCount();
+    }
+
+    uint16_t length = layout.getLength();
+    uint16_t pos = length ? (uint16_t)(rng() % (length + 1)) : 0;
+    bool ok;
+    if (rng() % 2 == 0 && length > 0) {
+      ok = layout.erase(pos, (uint16_t)(1 + rng() % 40));
+    } else {
+      std::string s = randomText(rng, 1 + rng() % 40);
+      ok = layout.insert(pos, s.data(), (uint16_t)s.size());
+    }
+    if (!ok) continue;
+
+    std::string where = describe(c, edit, "");
+    Fresh fresh(buffer, layout.getLength(), c);
+    bool same;
+    if (edit % 4 == 3) {
+      same = sameDocument(layout, fresh.layout, pos, rng, where);
+    } else {
+      // Only the page holding the edit and one further on, so the next
+      // edit often finds the layout incomplete
+      uint16_t line = fresh.layout.getLineForOffset(pos);
+      uint16_t page = line / c.linesPerPage;
+      same = samePage(layout, fresh.layout, page, where) &&
+             samePage(layout, fresh.layout, (uint16_t)(page + 1 + rng() % 3), where) &&
+             sameLine(layout, fresh.layout, line, where);
+    }
+    if (!same) return edit;
+  }
+  *lines = layout.getLineCount();
+  return EDITS_PER_RUN;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--quiet") == 0) {
+      quiet = true;
+    } else {
+      fprintf(stderr, "usage: layout_test [--quiet]\n");
+      return 2;
+    }
+  }
+
+  const uint8_t widths[] = {1, 2, 7, 12, 20, 32, 40, 255};
+  const uint8_t indicators[] = {0, LAYOUT_NUMBER_SIGN, LAYOUT_NUMBER_SIGN | LAYOUT_CAPITAL_SIGN};
+  if (!quiet) printf("%-6s %-10s %8s %8s\n", "width", "indicators", "edits", "lines");
+  unsigned seed = 26;
+  for (size_t w = 0; w < sizeof(widths); w++) {
+    for (size_t f = 0; f < sizeof(indicators); f++) {
+      Config c = {widths[w], (uint8_t)(1 + seed % 25), indicators[f]};
+      uint16_t lines = 0;
+      int edits = run(c, seed++, &lines);
+      if (!quiet) printf("%-6u %-10u %8d %8u\n", c.width, c.indicators, edits, lines);
+    }
+  }
+
+  if (failures) fprintf(stderr, "%d check(s) failed\n", failures);
+  return failures ? 1 : 0;
+}
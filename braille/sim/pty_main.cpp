@@ -0,0 +1,340 @@
+/*
+ * pty_main.cpp - braille_pty: the firmware on a pseudo-terminal, in real time.
+ *
+ *   braille_pty [options]
+ *
+ * Runs braille/src/main.cpp on the virtual Uno (SimBoard) and connects its
+ * UART to the master side of a pty, so host tools (braille-send, the
+ * Python scripts, driver.cpp's serial code) can open the slave like a real
+ * /dev/ttyACM0. Virtual time is held to the wall clock: bytes from the
+ * host arrive at the baud rate into the 64-byte RX buffer (and are lost
+ * when it is full, as on the Uno), and replies leave at the baud rate,
+ * including the visualization lines printVisualization() writes before
+ * each OK, so the host sees the board's real pacing. A sketch that runs
+ * ahead (delay(), a full TX buffer) waits for the clock to catch up.
+ * Like the Uno's USB bridge, replies reach the host in 1 ms USB frames
+ * (--usb-frame), which also keeps an idle or streaming emulator to at
+ * most one wakeup per frame, so dozens can run side by side.
+ *
+ * Faults, for testing how senders cope with a bad link:
+ *   --drop P / --flip P    lose a byte / flip one bit of it, with probability
+ *                          P per byte, on the host->board (rx), board->host
+ *                          (tx) or both directions (--faults)
+ *   --stall-every MS       the firmware stops for --stall-for MS at random
+ *                          intervals averaging MS; bytes keep arriving
+ *
+ * Prints the slave path on stdout (and links it to --link PATH), then runs
+ * until SIGINT/SIGTERM or --duration and prints byte, fault and overflow
+ * counts on stderr.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <string>
+
+#include "SimBoard.h"
+
+// The firmware under test
+void setup();
+void loop();
+
+namespace {
+
+struct Options {
+  double drop = 0;
+  double flip = 0;
+  bool faultRx = true;
+  bool faultTx = true;
+  uint64_t stallEveryNs = 0;
+  uint64_t stallForNs = 50000000ULL;
+  uint64_t usbFrameNs = 1000000ULL;
+  uint64_t durationNs = SIM_NEVER;
+  unsigned seed = 1;
+  std::string link;
+  bool verbose = false;
+};
+
+struct Stats {
+  uint64_t rxBytes = 0;       // host -> board, before faults
+  uint64_t txBytes = 0;       // board -> host, before faults
+  uint64_t rxDropped = 0, rxFlipped = 0;
+  uint64_t txDropped = 0, txFlipped = 0;
+  uint64_t stalls = 0;
+  uint64_t stalledNs = 0;
+  uint64_t lines = 0;         // '\n' received by the board
+};
+
+volatile sig_atomic_t g_stop = 0;
+
+void onSignal(int) {
+  g_stop = 1;
+}
+
+void usage() {
+  fprintf(stderr,
+          "usage: braille_pty [options]\n"
+          "  --link PATH          symlink PATH to the pty slave (replaced if it exists)\n"
+          "  --drop P             probability of losing each byte (default 0)\n"
+          "  --flip P             probability of flipping one bit of each byte (default 0)\n"
+          "  --faults rx|tx|both  direction(s) --drop/--flip apply to (default both)\n"
+          "  --stall-every MS     mean time between firmware stalls (default: none)\n"
+          "  --stall-for MS       length of each stall (default 50)\n"
+          "  --usb-frame US       deliver replies in USB frames of US (default 1000, 0: per byte)\n"
+          "  --duration S         exit after S seconds (default: run until signalled)\n"
+          "  --seed N             fault random seed (default 1)\n"
+          "  -v, --verbose        print the lines each way with their times\n");
+}
+
+bool parseNumber(const char* s, double& out) {
+  char* end;
+  out = strtod(s, &end);
+  return end != s && *end == '\0' && out >= 0;
+}
+
+bool parseArgs(int argc, char** argv, Options& o) {
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+    double n = 0;
+    if (!strcmp(a, "-v") || !strcmp(a, "--verbose")) {
+      o.verbose = true;
+      continue;
+    }
+    if (!v) return false;
+    i++;
+    if (!strcmp(a, "--link")) {
+      o.link = v;
+    } else if (!strcmp(a, "--faults")) {
+      o.faultRx = !strcmp(v, "rx") || !strcmp(v, "both");
+      o.faultTx = !strcmp(v, "tx") || !strcmp(v, "both");
+      if (!o.faultRx && !o.faultTx) return false;
+    } else if (!parseNumber(v, n)) {
+      return false;
+    } else if (!strcmp(a, "--drop") && n <= 1) {
+      o.drop = n;
+    } else if (!strcmp(a, "--flip") && n <= 1) {
+      o.flip = n;
+    } else if (!strcmp(a, "--stall-every") && n > 0) {
+      o.stallEveryNs = (uint64_t)(n * 1e6);
+    } else if (!strcmp(a, "--stall-for")) {
+      o.stallForNs = (uint64_t)(n * 1e6);
+    } else if (!strcmp(a, "--usb-frame")) {
+      o.usbFrameNs = (uint64_t)(n * 1e3);
+    } else if (!strcmp(a, "--duration") && n > 0) {
+      o.durationNs = (uint64_t)(n * 1e9);
+    } else if (!strcmp(a, "--seed")) {
+      o.seed = (unsigned)n;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint64_t monotonicNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Opens a pty with the slave in raw mode. The slave stays open here
+ * too, so the master does not see a hangup while no client has it open.
+ */
+bool openPty(int& master, int& slave, std::string& slavePath) {
+  master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+    perror("braille_pty: posix_openpt");
+    return false;
+  }
+  slavePath = ptsname(master);
+  slave = open(slavePath.c_str(), O_RDWR | O_NOCTTY);
+  if (slave < 0) {
+    perror("braille_pty: open slave");
+    return false;
+  }
+  struct termios tio;
+  if (tcgetattr(slave, &tio) == 0) {
+    cfmakeraw(&tio);
+    cfsetspeed(&tio, B115200);
+    tcsetattr(slave, TCSANOW, &tio);
+  }
+  fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+  return true;
+}
+
+/**
+ * @brief Applies --drop/--flip to one byte. Returns false if it is lost.
+ */
+bool injectFault(const Options& o, std::mt19937& rng, uint8_t& b, uint64_t& dropped, uint64_t& flipped) {
+  std::uniform_real_distribution<double> chance(0.0, 1.0);
+  if (o.drop > 0 && chance(rng) < o.drop) {
+    dropped++;
+    return false;
+  }
+  if (o.flip > 0 && chance(rng) < o.flip) {
+    b ^= (uint8_t)(1u << (rng() % 8));
+    flipped++;
+  }
+  return true;
+}
+
+void printLine(const char* dir, uint64_t time, std::string& partial, uint8_t b) {
+  if (b == '\r') return;
+  if (b != '\n') {
+    partial += (char)b;
+    return;
+  }
+  fprintf(stderr, "[%10.3f ms] %s %s\n", time / 1e6, dir, partial.c_str());
+  partial.clear();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opt;
+  if (!parseArgs(argc, argv, opt)) {
+    usage();
+    return 2;
+  }
+
+  int master = -1, slave = -1;
+  std::string slavePath;
+  if (!openPty(master, slave, slavePath)) return 1;
+  if (!opt.link.empty()) {
+    unlink(opt.link.c_str());
+    if (symlink(slavePath.c_str(), opt.link.c_str()) != 0) {
+      perror("braille_pty: symlink");
+      return 1;
+    }
+  }
+  printf("%s\n", slavePath.c_str());
+  fflush(stdout);
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  signal(SIGPIPE, SIG_IGN);
+
+  SimBoard& board = SimBoard::instance();
+  board.reset();
+  board.setRecording(false);
+  board.setDeadline(opt.durationNs);
+
+  Stats stats;
+  std::mt19937 rng(opt.seed);
+  std::deque<std::pair<uint64_t, uint8_t> > txQueue;   // (time on the host side, byte)
+  std::string rxPartial, txPartial;
+  std::string hostOut;
+  board.onTx = [&](uint64_t time, uint8_t b) {
+    txQueue.push_back(std::make_pair(time, b));
+  };
+
+  std::exponential_distribution<double> stallGap(1.0);
+  uint64_t nextStall = opt.stallEveryNs ? (uint64_t)(stallGap(rng) * opt.stallEveryNs) : SIM_NEVER;
+
+  const uint64_t start = monotonicNs();
+  bool setupDone = false;
+  try {
+    setup();
+    setupDone = true;
+    uint8_t buf[4096];
+    while (!g_stop) {
+      uint64_t wall = monotonicNs() - start;
+      if (wall > opt.durationNs) break;
+
+      // Host bytes start on the wire when they were read
+      ssize_t n = read(master, buf, sizeof(buf));
+      if (n > 0) {
+        std::string bytes;
+        for (ssize_t i = 0; i < n; i++) {
+          uint8_t b = buf[i];
+          stats.rxBytes++;
+          if (opt.verbose) printLine("->", wall, rxPartial, b);
+          if (opt.faultRx && !injectFault(opt, rng, b, stats.rxDropped, stats.rxFlipped)) continue;
+          if (b == '\n') stats.lines++;
+          bytes += (char)b;
+        }
+        if (!bytes.empty()) board.scheduleRx(wall, bytes);
+      }
+
+      // Board bytes that have finished on the wire; what the pty cannot
+      // take yet (no client reading) waits in hostOut
+      while (!txQueue.empty() && txQueue.front().first <= wall) {
+        uint8_t b = txQueue.front().second;
+        txQueue.pop_front();
+        stats.txBytes++;
+        if (opt.verbose) printLine("<-", wall, txPartial, b);
+        if (opt.faultTx && !injectFault(opt, rng, b, stats.txDropped, stats.txFlipped)) continue;
+        hostOut += (char)b;
+      }
+      if (!hostOut.empty()) {
+        ssize_t w = write(master, hostOut.data(), hostOut.size());
+        if (w > 0) hostOut.erase(0, (size_t)w);
+        else if (w < 0 && errno != EAGAIN) {
+          perror("braille_pty: write");
+          break;
+        }
+      }
+
+      if (board.now() <= wall) {
+        if (board.now() >= nextStall) {
+          // Everything keeps arriving while the firmware is stuck
+          board.advance(opt.stallForNs);
+          stats.stalls++;
+          stats.stalledNs += opt.stallForNs;
+          nextStall = board.now() + (uint64_t)(stallGap(rng) * opt.stallEveryNs);
+          continue;
+        }
+        board.beginIteration();
+        board.advance(board.timing().loopNs);
+        loop();
+        if (board.iterationWasIdle()) board.advanceTo(std::min(board.nextRxTime(), wall));
+        if (board.now() < wall) continue;
+      }
+
+      // Caught up: sleep until the sketch's clock, the next reply byte or
+      // the next host byte is due, or until the host writes
+      uint64_t wake = board.now() > wall ? board.now() : std::min<uint64_t>(board.nextRxTime(), wall + 50000000ULL);
+      wake = std::min(wake, nextStall);
+      if (!txQueue.empty()) wake = std::min(wake, txQueue.front().first);
+      if (opt.usbFrameNs) wake = (wake + opt.usbFrameNs - 1) / opt.usbFrameNs * opt.usbFrameNs;
+      if (wake <= wall) continue;
+      struct timespec timeout;
+      timeout.tv_sec = (time_t)((wake - wall) / 1000000000ULL);
+      timeout.tv_nsec = (long)((wake - wall) % 1000000000ULL);
+      struct pollfd pfd = {master, POLLIN, 0};
+      ppoll(&pfd, 1, &timeout, nullptr);
+    }
+  } catch (const SimDeadline&) {
+    // --duration ended inside the firmware
+  }
+  if (!setupDone) fprintf(stderr, "braille_pty: stopped during setup()\n");
+
+  double seconds = (monotonicNs() - start) / 1e9;
+  fprintf(stderr,
+          "braille_pty: %.1f s, %lu lines\n"
+          "  host->board %lu bytes, %lu dropped, %lu flipped, %u lost to RX overflow\n"
+          "  board->host %lu bytes, %lu dropped, %lu flipped\n"
+          "  %lu stalls (%.1f ms), %lu pin edges\n",
+          seconds, (unsigned long)stats.lines, (unsigned long)stats.rxBytes, (unsigned long)stats.rxDropped,
+          (unsigned long)stats.rxFlipped, board.getRxOverflows(), (unsigned long)stats.txBytes,
+          (unsigned long)stats.txDropped, (unsigned long)stats.txFlipped, (unsigned long)stats.stalls,
+          stats.stalledNs / 1e6, (unsigned long)board.pinEdgeCount());
+
+  if (!opt.link.empty()) unlink(opt.link.c_str());
+  close(slave);
+  close(master);
+  return 0;
+}
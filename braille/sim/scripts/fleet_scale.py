@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+"""
+Fan-out scaling: one braille-send feeds N firmwares, each under its own
+braille_pty, and the aggregate cells/s should grow with N.
+
+Usage:
+    python fleet_scale.py BRAILLE_PTY BRAILLE_SEND [--devices 1,2,4,8,16,32]
+                          [--io-threads N] [--min-efficiency F]
+
+For each N prints the aggregate and per-device throughput and the
+efficiency, aggregate / (N * the one-device rate). With --min-efficiency
+the run fails when the largest N falls below F. The emulators run on the
+same machine as braille-send, so on a small machine their own CPU time,
+not the host engine, is what bends the curve first.
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+# Lines of words, long enough for several pages and some scrolling edits
+WORDS = ['alpha', 'bravo', 'charlie', 'delta', 'echo', 'fox', 'golf', 'hotel']
+
+
+def document():
+    lines = []
+    for i in range(120):
+        lines.append(' '.join(WORDS[(i * 7 + j * 3) % len(WORDS)] for j in range(6 + i % 5)))
+    return '\n'.join(lines) + '\n'
+
+
+def run(pty_exe, send_exe, tmp, doc, devices, io_threads):
+    emus, links = [], []
+    try:
+        for i in range(devices):
+            link = os.path.join(tmp, 'tty%d' % i)
+            emus.append(subprocess.Popen([pty_exe, '--link', link, '--duration', '120'],
+                                         stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, text=True))
+            links.append(link)
+        for emu in emus:
+            if not emu.stdout.readline():
+                raise RuntimeError('braille_pty did not start')
+        args = [send_exe, '-q', '--io-threads', str(io_threads)]
+        for link in links:
+            args += ['-p', link]
+        send = subprocess.run(args + [doc], stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                              text=True, timeout=110)
+    finally:
+        for emu in emus:
+            emu.terminate()
+        for emu in emus:
+            emu.communicate(timeout=10)
+    rate = re.search(r'sustained (\d+) cells/s', send.stdout)
+    if send.returncode != 0 or not rate:
+        raise RuntimeError('braille-send failed with %d devices:\n%s' % (devices, send.stdout))
+    return float(rate.group(1))
+
+
+def main():
+    parser = argparse.ArgumentParser(usage=__doc__)
+    parser.add_argument('pty_exe')
+    parser.add_argument('send_exe')
+    parser.add_argument('--devices', default='1,2,4,8,16,32')
+    parser.add_argument('--io-threads', type=int, default=1)
+    parser.add_argument('--min-efficiency', type=float, default=0)
+    opt = parser.parse_args()
+    counts = [int(n) for n in opt.devices.split(',')]
+
+    with tempfile.TemporaryDirectory() as tmp:
+        doc = os.path.join(tmp, 'doc.txt')
+        with open(doc, 'w') as f:
+            f.write(document())
+        single = None
+        efficiency = 0
+        print('%7s %12s %12s %10s' % ('devices', 'cells/s', 'each', 'efficiency'))
+        for n in counts:
+            try:
+                rate = run(opt.pty_exe, opt.send_exe, tmp, doc, n, opt.io_threads)
+            except (RuntimeError, subprocess.TimeoutExpired) as e:
+                print(e, file=sys.stderr)
+                return 1
+            if single is None:
+                single = rate / n
+            efficiency = rate / (n * single)
+            print('%7d %12.0f %12.0f %9.0f%%' % (n, rate, rate / n, efficiency * 100))
+            sys.stdout.flush()
+
+    if efficiency < opt.min_efficiency:
+        print('efficiency %.2f below %.2f' % (efficiency, opt.min_efficiency), file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
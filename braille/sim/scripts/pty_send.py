@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""
+End-to-end check of the serial path: braille-send streams a document to
+the firmware running under braille_pty and must get an OK for every line.
+
+Usage:
+    python pty_send.py BRAILLE_PTY BRAILLE_SEND [--faults]
+    python pty_send.py BRAILLE_PTY BRAILLE_PROBE --probe
+
+braille-send runs with its default pages, which fill the firmware's
+512-byte text buffer, so every page edit has to fit that buffer while it
+is applied. With --faults the link drops bytes and the firmware stalls;
+the run then only has to finish, and the emulator must report the faults
+it injected.
+With --probe, braille-probe times T: frames instead and must get them all
+answered.
+"""
+
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+# Lines of words, long enough for several pages and some scrolling edits
+WORDS = ['alpha', 'bravo', 'charlie', 'delta', 'echo', 'fox', 'golf', 'hotel']
+
+
+def document():
+    lines = []
+    for i in range(120):
+        lines.append(' '.join(WORDS[(i * 7 + j * 3) % len(WORDS)] for j in range(6 + i % 5)))
+    return '\n'.join(lines) + '\n'
+
+
+def main():
+    if len(sys.argv) < 3:
+        print(__doc__, file=sys.stderr)
+        return 2
+    pty_exe, tool_exe = sys.argv[1], sys.argv[2]
+    faults = '--faults' in sys.argv[3:]
+    probe = '--probe' in sys.argv[3:]
+
+    with tempfile.TemporaryDirectory() as tmp:
+        doc = os.path.join(tmp, 'doc.txt')
+        with open(doc, 'w') as f:
+            f.write(document())
+        link = os.path.join(tmp, 'tty')
+
+        pty_args = [pty_exe, '--link', link, '--duration', '60']
+        if faults:
+            pty_args += ['--drop', '0.01', '--stall-every', '200', '--seed', '7']
+        emu = subprocess.Popen(pty_args, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+        try:
+            if not emu.stdout.readline():
+                print('braille_pty did not start', file=sys.stderr)
+                return 1
+            if probe:
+                tool_args = [tool_exe, '-n', '300', '-p', link]
+            else:
+                tool_args = [tool_exe, '-q', '-p', link, doc]
+            send = subprocess.run(tool_args, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True, timeout=50)
+        finally:
+            emu.terminate()
+            _, emu_err = emu.communicate(timeout=10)
+
+    print(send.stdout, end='')
+    print(emu_err, end='')
+    if faults:
+        dropped = re.search(r'host->board \d+ bytes, (\d+) dropped', emu_err)
+        stalls = re.search(r'(\d+) stalls', emu_err)
+        if not dropped or not stalls or int(dropped.group(1)) == 0 or int(stalls.group(1)) == 0:
+            print('no faults were injected', file=sys.stderr)
+            return 1
+        return 0
+    if send.returncode == 0 and not probe:
+        sent = re.search(r'pages (\d+), cells (\d+)', send.stdout)
+        if not sent or int(sent.group(2)) <= 256 * int(sent.group(1)):
+            print('pages do not fill the text buffer', file=sys.stderr)
+            return 1
+    return send.returncode
+
+
+if __name__ == '__main__':
+    sys.exit(main())
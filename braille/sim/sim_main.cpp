@@ -0,0 +1,259 @@
+/*
+ * sim_main.cpp - braille_sim: runs the firmware on a virtual Uno.
+ *
+ *   braille_sim [--vcd out.vcd] [--quiet] [-e "<script line>"]... [script.sim]
+ *
+ * Runs setup() once and loop() until the script's end time, feeding the
+ * scripted serial input at 115200 8N1 (or whatever Serial.begin() chose).
+ * Loop iterations that did nothing but poll Serial.available() are
+ * fast-forwarded to the next incoming byte.
+ *
+ * Prints every line the board sends, then one summary row per command:
+ * time from the end of the command's '\n' to the first and last pin edge
+ * (their difference is the skew between dots), the number of edges, and
+ * the command's final reply line. Exits with 1 if an expect failed.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "SimBoard.h"
+#include "SimScript.h"
+#include "VcdWriter.h"
+
+// The firmware under test
+void setup();
+void loop();
+
+static void usage() {
+  fprintf(stderr,
+          "usage: braille_sim [--vcd FILE] [--quiet] [-e LINE]... [SCRIPT]\n"
+          "  --vcd FILE   write pin and serial activity as a VCD trace\n"
+          "  --quiet      do not print the board's serial output\n"
+          "  -e LINE      script line, e.g. -e 'send PING' (repeatable)\n");
+}
+
+static double toMicros(uint64_t ns) {
+  return ns / 1000.0;
+}
+
+static void run(SimBoard& board, const SimScript& script, uint64_t endTime) {
+  const std::vector<ScriptSend>& sends = script.sends();
+  size_t nextSend = 0;
+
+  // Inputs change in the middle of whatever the firmware is doing
+  for (size_t i = 0; i < script.inputs().size(); i++) {
+    const ScriptInput& in = script.inputs()[i];
+    board.scheduleInput(in.time, in.pin, in.value);
+  }
+
+  board.setDeadline(endTime);
+  try {
+    setup();
+    while (board.now() < endTime) {
+      // Host actions that are due
+      while (nextSend < sends.size() && sends[nextSend].time <= board.now()) {
+        board.scheduleRx(sends[nextSend].time, sends[nextSend].text + "\n");
+        nextSend++;
+      }
+
+      board.beginIteration();
+      board.advance(board.timing().loopNs);
+      loop();
+
+      if (board.iterationWasIdle()) {
+        uint64_t next = std::min(board.nextRxTime(), endTime);
+        if (nextSend < sends.size()) next = std::min(next, sends[nextSend].time);
+        next = std::min(next, board.nextInputTime());
+        board.advanceTo(next);
+      }
+    }
+  } catch (const SimDeadline&) {
+    // End of the run inside the firmware
+  }
+}
+
+/**
+ * Time at which the last byte of send i (its '\n') has arrived.
+ */
+static std::vector<uint64_t> sendEndTimes(const SimBoard& board, const SimScript& script) {
+  std::vector<uint64_t> ends;
+  uint64_t lineFree = 0;
+  uint64_t byteTime = board.byteTimeNs();
+  for (size_t i = 0; i < script.sends().size(); i++) {
+    const ScriptSend& s = script.sends()[i];
+    uint64_t start = std::max(s.time, lineFree);
+    lineFree = start + (s.text.size() + 1) * byteTime;
+    ends.push_back(lineFree);
+  }
+  return ends;
+}
+
+static int checkExpects(const SimBoard& board, const SimScript& script,
+                        const std::vector<uint64_t>& ends) {
+  int failures = 0;
+  const std::vector<SerialLine>& lines = board.txLines();
+  size_t cursor = 0;
+  size_t lastSend = SIZE_MAX;
+
+  for (size_t k = 0; k < script.expects().size(); k++) {
+    const ScriptExpect& e = script.expects()[k];
+    uint64_t from = ends[e.send];
+    uint64_t to = e.send + 1 < ends.size() ? script.sends()[e.send + 1].time : SIM_NEVER;
+    if (e.send != lastSend) {
+      cursor = 0;
+      lastSend = e.send;
+    }
+
+    bool found = false;
+    for (size_t i = cursor; i < lines.size(); i++) {
+      if (lines[i].time < from) continue;
+      if (lines[i].time >= to) break;
+      if (e.within && (lines[i].time < e.from || lines[i].time > e.from + e.within)) continue;
+      bool match = e.prefix ? lines[i].text.compare(0, e.text.size(), e.text) == 0
+                            : lines[i].text == e.text;
+      if (match) {
+        cursor = i + 1;
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      fprintf(stderr, "FAIL line %d: expected '%s%s' after 'send %s'", e.line, e.text.c_str(),
+              e.prefix ? "*" : "", script.sends()[e.send].text.c_str());
+      if (e.within) fprintf(stderr, " within %.1f us", toMicros(e.within));
+      fprintf(stderr, "\n");
+      failures++;
+    }
+  }
+  return failures;
+}
+
+static void printSummary(const SimBoard& board, const SimScript& script,
+                         const std::vector<uint64_t>& ends) {
+  const std::vector<PinEvent>& pins = board.pinEvents();
+  const std::vector<SerialLine>& lines = board.txLines();
+
+  printf("\n%-10s %-12s %12s %12s %12s %6s  %s\n", "at (ms)", "command", "first edge",
+         "last edge", "skew", "edges", "reply");
+
+  for (size_t i = 0; i < script.sends().size(); i++) {
+    const ScriptSend& s = script.sends()[i];
+    uint64_t from = ends[i];
+    uint64_t to = i + 1 < ends.size() ? script.sends()[i + 1].time : SIM_NEVER;
+
+    uint64_t first = SIM_NEVER, last = 0;
+    int edges = 0;
+    for (size_t p = 0; p < pins.size(); p++) {
+      if (pins[p].time < from || pins[p].time >= to) continue;
+      if (first == SIM_NEVER) first = pins[p].time;
+      last = pins[p].time;
+      edges++;
+    }
+
+    const SerialLine* reply = nullptr;
+    for (size_t l = 0; l < lines.size(); l++) {
+      if (lines[l].time >= from && lines[l].time < to) reply = &lines[l];
+    }
+
+    char firstStr[32] = "-", lastStr[32] = "-", skewStr[32] = "-";
+    if (edges > 0) {
+      snprintf(firstStr, sizeof(firstStr), "+%.1f us", toMicros(first - from));
+      snprintf(lastStr, sizeof(lastStr), "+%.1f us", toMicros(last - from));
+      snprintf(skewStr, sizeof(skewStr), "%.1f us", toMicros(last - first));
+    }
+    std::string replyStr = "-";
+    if (reply) {
+      char at[32];
+      snprintf(at, sizeof(at), " (+%.1f us)", toMicros(reply->time - from));
+      replyStr = reply->text + at;
+    }
+
+    std::string cmd = s.text.size() > 12 ? s.text.substr(0, 11) + "~" : s.text;
+    printf("%-10.3f %-12s %12s %12s %12s %6d  %s\n", s.time / 1e6, cmd.c_str(), firstStr,
+           lastStr, skewStr, edges, replyStr.c_str());
+  }
+
+  if (board.getRxOverflows() > 0) {
+    printf("\nWARNING: %u received bytes were dropped (64-byte RX buffer full)\n",
+           board.getRxOverflows());
+  }
+}
+
+int main(int argc, char** argv) {
+  std::string vcdPath;
+  std::string scriptPath;
+  std::vector<std::string> extraLines;
+  bool quiet = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--vcd") && i + 1 < argc) {
+      vcdPath = argv[++i];
+    } else if (!strcmp(argv[i], "-e") && i + 1 < argc) {
+      extraLines.push_back(argv[++i]);
+    } else if (!strcmp(argv[i], "--quiet")) {
+      quiet = true;
+    } else if (argv[i][0] == '-') {
+      usage();
+      return 2;
+    } else {
+      scriptPath = argv[i];
+    }
+  }
+
+  SimScript script;
+  if (!scriptPath.empty() && !script.load(scriptPath)) {
+    fprintf(stderr, "%s\n", script.getError().c_str());
+    return 2;
+  }
+  for (size_t i = 0; i < extraLines.size(); i++) {
+    if (!script.parseLine(extraLines[i])) {
+      fprintf(stderr, "-e: %s\n", script.getError().c_str());
+      return 2;
+    }
+  }
+
+  SimBoard& board = SimBoard::instance();
+  board.reset();
+  std::string partial;
+  if (!quiet) {
+    board.onTx = [&partial](uint64_t time, uint8_t b) {
+      if (b == '\r') return;
+      if (b != '\n') {
+        partial += (char)b;
+        return;
+      }
+      printf("[%10.3f ms] %s\n", time / 1e6, partial.c_str());
+      partial.clear();
+    };
+  }
+
+  uint64_t endTime = script.getEndTime();
+  run(board, script, endTime);
+
+  std::vector<uint64_t> ends = sendEndTimes(board, script);
+  printSummary(board, script, ends);
+
+  if (!vcdPath.empty()) {
+    VcdWriter vcd;
+    for (size_t i = 0; i < script.labels().size(); i++) {
+      vcd.setLabel(script.labels()[i].pin, script.labels()[i].name);
+    }
+    if (!vcd.write(vcdPath, board, endTime)) {
+      fprintf(stderr, "cannot write %s\n", vcdPath.c_str());
+      return 2;
+    }
+    printf("\nWrote %s (%zu pin edges, %zu serial bytes)\n", vcdPath.c_str(),
+           board.pinEvents().size(), board.serialEvents().size());
+  }
+
+  int failures = checkExpects(board, script, ends);
+  if (failures > 0) {
+    fprintf(stderr, "%d expectation(s) failed\n", failures);
+    return 1;
+  }
+  return 0;
+}
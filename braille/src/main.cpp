@@ -1,7 +1,19 @@
 #include <Arduino.h>
 #include "BrailleCell.h"
+#include "ChordKeyboard.h"
+#include "PatternDecoder.h"
+#include "TextBuffer.h"
 
 BrailleCell cell;
+TextBuffer document;   // text edited by the host with E: commands
+
+// One line of cells, double-buffered: F: lines change frameBack, and the
+// F: line ending in '!' copies it to frameFront, the cells being shown.
+// A rejected line puts frameBack back to frameFront, so a half-applied
+// delta is never shown.
+#define FRAME_CELLS 32
+uint8_t frameFront[FRAME_CELLS];
+uint8_t frameBack[FRAME_CELLS];
 
 // Pin mapping: index = bit position in pattern byte
 // Physical wiring: pin 2=dot1, pin 3=dot2, pin 4=dot3, pin 5=dot4,
@@ -10,10 +22,234 @@ BrailleCell cell;
 //                bit4=dot4, bit5=dot5, bit6=dot6, bit7=dot8
 const int DOT_PINS[8] = {2, 3, 4, 8, 5, 6, 7, 9};
 
-char inputBuffer[32];
+// Holds one E: command with about 50 bytes of text
+char inputBuffer[64];
 int bufferIndex = 0;
+bool lineTooLong = false;
+
+const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+void printHex4(uint16_t v) {
+  for (int shift = 12; shift >= 0; shift -= 4) {
+    Serial.print(HEX_DIGITS[(v >> shift) & 0x0F]);
+  }
+}
+
+void printHex8(unsigned long v) {
+  printHex4((uint16_t)(v >> 16));
+  printHex4((uint16_t)v);
+}
+
+#ifdef BRAILLE_PROBE
+// Latency probe, built only with -DBRAILLE_PROBE ([env:uno_probe]).
+// micros() when the '\n' of the line being processed was read
+unsigned long lineReceivedMicros = 0;
+
+// "T:HHHHHHHH,XX": a host stamp and a pattern, both hex. Sets the pattern
+// and echoes the stamp with micros() at receive, parse and pin write:
+// "T:HHHHHHHH,RRRRRRRR,PPPPPPPP,WWWWWWWW". No visualization, so the reply
+// is the only traffic a probe frame causes.
+void probeCommand(char* args) {
+  char* end;
+  unsigned long stamp = strtoul(args, &end, 16);
+  if (end == args || *end != ',') {
+    Serial.println("ERR:probe");
+    return;
+  }
+  char* field = end + 1;
+  unsigned long pattern = strtoul(field, &end, 16);
+  if (end == field || *end != '\0' || pattern > 0xFF) {
+    Serial.println("ERR:probe");
+    return;
+  }
+  unsigned long parsed = micros();
+  cell.setPattern((uint8_t)pattern);
+  unsigned long written = micros();
+
+  Serial.print("T:");
+  printHex8(stamp);
+  Serial.print(",");
+  printHex8(lineReceivedMicros);
+  Serial.print(",");
+  printHex8(parsed);
+  Serial.print(",");
+  printHex8(written);
+  Serial.println();
+}
+#endif
+
+#ifdef BRAILLE_KEYS
+// Chord keyboard, built only with -DBRAILLE_KEYS ([env:uno_keys]): dots 1-6
+// on A0-A5, dot 7 on pin 10, dot 8 on 11 and the space bar on 12, each a
+// button to ground. After KEYS:1 every chord goes to the host as
+// "K:CCC,XX,TTTTTTTT": the keys (bit n-1 = dot n, 100 = space), the
+// character in hex (00 for a command chord) and micros() at the release.
+ChordKeyboard keyboard;
+const uint8_t KEY_PINS[CHORD_KEYS] = {A0, A1, A2, A3, A4, A5, 10, 11, 12};
+uint16_t chordsSent = 0;
 
-void processCommand(const char* cmd) {
+ISR(PCINT0_vect) { keyboard.onPinChange(); }
+ISR(PCINT1_vect) { keyboard.onPinChange(); }
+
+// At most one chord per loop, and only when its line fits in the TX
+// buffer: reporting never blocks the command loop, and chords wait in the
+// keyboard's queue with their release times meanwhile
+void sendChords() {
+  keyboard.poll();
+  if (!keyboard.queued() || Serial.availableForWrite() < 19) return;
+  Chord c;
+  keyboard.read(c);
+  Serial.print("K:");
+  Serial.print(HEX_DIGITS[(c.keys >> 8) & 0x0F]);
+  Serial.print(HEX_DIGITS[(c.keys >> 4) & 0x0F]);
+  Serial.print(HEX_DIGITS[c.keys & 0x0F]);
+  Serial.print(",");
+  Serial.print(HEX_DIGITS[(uint8_t)c.ch >> 4]);
+  Serial.print(HEX_DIGITS[(uint8_t)c.ch & 0x0F]);
+  Serial.print(",");
+  printHex8(c.released);
+  Serial.println();
+  chordsSent++;
+}
+
+// "KEYS:1" / "KEYS:0" turn the keyboard on and off; "KEYS" reports
+// "KEYS:N,SSSS,LLLL": on, chords sent and chords lost to a full queue
+void keysCommand(const char* args) {
+  if (strcmp(args, ":1") == 0) {
+    keyboard.begin(KEY_PINS);
+    chordsSent = 0;
+    Serial.println("OK");
+  } else if (strcmp(args, ":0") == 0) {
+    keyboard.end();
+    Serial.println("OK");
+  } else if (*args == '\0') {
+    Serial.print(keyboard.active() ? "KEYS:1," : "KEYS:0,");
+    printHex4(chordsSent);
+    Serial.print(",");
+    printHex4(keyboard.lost());
+    Serial.println();
+  } else {
+    Serial.println("ERR:keys");
+  }
+}
+#endif
+
+// Two hex digits at *p, advancing p
+bool readHexByte(const char*& p, uint8_t& v) {
+  uint8_t out = 0;
+  for (int i = 0; i < 2; i++) {
+    char c = *p++;
+    uint8_t d;
+    if (c >= '0' && c <= '9') d = c - '0';
+    else if (c >= 'A' && c <= 'F') d = c - 'A' + 10;
+    else if (c >= 'a' && c <= 'f') d = c - 'a' + 10;
+    else return false;
+    out = (out << 4) | d;
+  }
+  v = out;
+  return true;
+}
+
+// "F:" then runs in hex, each "OO" (first cell) and a control byte "LL":
+//   LL = 01-3F  LL patterns follow, one per cell
+//   LL = 4n     n & 3F patterns follow packed (PatternDecoder, for slow links)
+//   LL = 8n     n & 3F cells all set to the one pattern that follows
+//   LL = Cn     n & 3F cells copied from cell "SS" that follows (scrolling)
+// into frameBack; a trailing '!' commits. Runs are applied in order.
+// Patterns are in BrailleCell's bit order, as for P:: bits 0-2 = dots 1-3,
+// bit 3 = dot 7, bits 4-6 = dots 4-6, bit 7 = dot 8 (not the
+// BrailleConverter/.brd order, where bit n-1 is dot n).
+bool stageFrame(const char* p, bool& commit) {
+  commit = false;
+  while (*p) {
+    if (*p == '!' && p[1] == '\0') {
+      commit = true;
+      return true;
+    }
+    uint8_t offset, control;
+    if (!readHexByte(p, offset) || !readHexByte(p, control)) return false;
+    uint8_t n = control & 0x3F;
+    if (n == 0 || offset >= FRAME_CELLS || n > FRAME_CELLS - offset) return false;
+    if (control < 0x40) {
+      for (uint8_t i = 0; i < n; i++) {
+        if (!readHexByte(p, frameBack[offset + i])) return false;
+      }
+    } else if (control < 0x80) {
+      PatternDecoder packed;
+      packed.begin(p);
+      for (uint8_t i = 0; i < n; i++) {
+        if (!packed.next(frameBack[offset + i])) return false;
+      }
+      p = packed.position();
+    } else if (control < 0xC0) {
+      uint8_t pattern;
+      if (!readHexByte(p, pattern)) return false;
+      memset(frameBack + offset, pattern, n);
+    } else {
+      uint8_t source;
+      if (!readHexByte(p, source) || source >= FRAME_CELLS || n > FRAME_CELLS - source) return false;
+      memmove(frameBack + offset, frameBack + source, n);
+    }
+  }
+  return true;
+}
+
+void frameCommand(char* args) {
+  bool commit;
+  if (!stageFrame(args, commit)) {
+    memcpy(frameBack, frameFront, FRAME_CELLS);
+    Serial.println("ERR:frame");
+    return;
+  }
+  if (commit) {
+    memcpy(frameFront, frameBack, FRAME_CELLS);
+    // This board has one cell; an expander build shows the whole line here
+    // (BrailleExpander::setFrame + update)
+    cell.setPattern(frameFront[0]);
+  }
+  Serial.println("OK");
+}
+
+// CRC-16/CCITT-FALSE of the shown frame, like TextBuffer::checksum()
+uint16_t frameChecksum() {
+  uint16_t crc = 0xFFFF;
+  for (uint8_t i = 0; i < FRAME_CELLS; i++) {
+    crc ^= (uint16_t)frameFront[i] << 8;
+    for (uint8_t b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+// "E:pos,remove:text" with pos and remove in hex. In text, "\n" is a
+// newline, "\r" a carriage return and "\\" a backslash. Unescapes in place.
+bool applyEdit(char* args) {
+  char* end;
+  unsigned long pos = strtoul(args, &end, 16);
+  if (end == args || *end != ',' || pos > 0xFFFF) return false;
+
+  char* field = end + 1;
+  unsigned long remove = strtoul(field, &end, 16);
+  if (end == field || *end != ':' || remove > 0xFFFF) return false;
+
+  char* text = end + 1;
+  char* src = text;
+  char* dst = text;
+  while (*src) {
+    char c = *src++;
+    if (c == '\\') {
+      c = *src++;
+      if (c == 'n') c = '\n';
+      else if (c == 'r') c = '\r';
+      else if (c != '\\') return false;
+    }
+    *dst++ = c;
+  }
+  return document.replace((uint16_t)pos, (uint16_t)remove, text, (uint16_t)(dst - text));
+}
+
+void processCommand(char* cmd) {
   if (cmd[0] == 'P' && cmd[1] == ':') {
     // Pattern command: "P:XX" where XX is 2-digit hex
     uint8_t pattern = (uint8_t)strtoul(cmd + 2, NULL, 16);
@@ -21,10 +257,57 @@ void processCommand(const char* cmd) {
     cell.printVisualization(pattern);
     Serial.println("OK");
 
+  } else if (cmd[0] == 'E' && cmd[1] == ':') {
+    // Text delta from the host
+    Serial.println(applyEdit(cmd + 2) ? "OK" : "ERR:edit");
+
+  } else if (cmd[0] == 'F' && cmd[1] == ':') {
+    // Changed cell runs of the multi-cell frame
+    frameCommand(cmd + 2);
+
+  } else if (strcmp(cmd, "FSUM") == 0) {
+    // Cell count and CRC-16 of the shown frame: "FSUM:NN,CCCC"
+    Serial.print("FSUM:");
+    Serial.print(HEX_DIGITS[FRAME_CELLS >> 4]);
+    Serial.print(HEX_DIGITS[FRAME_CELLS & 0x0F]);
+    Serial.print(",");
+    printHex4(frameChecksum());
+    Serial.println();
+
+  } else if (strcmp(cmd, "SUM") == 0) {
+    // Length and CRC-16 of the edited text: "SUM:LLLL,CCCC"
+    Serial.print("SUM:");
+    printHex4(document.length());
+    Serial.print(",");
+    printHex4(document.checksum());
+    Serial.println();
+
   } else if (strcmp(cmd, "CLEAR") == 0) {
     cell.clear();
     Serial.println("OK");
 
+#ifdef BRAILLE_KEYS
+  } else if (strncmp(cmd, "KEYS", 4) == 0) {
+    keysCommand(cmd + 4);
+#endif
+
+#ifdef BRAILLE_PROBE
+  } else if (cmd[0] == 'T' && cmd[1] == ':') {
+    // Latency probe frame
+    probeCommand(cmd + 2);
+#endif
+
+  } else if (strcmp(cmd, "CAPS") == 0) {
+    // Optional protocol features, so the host only uses what this build
+    // understands: "CAPS:FRAME,PACK<n>" (F: frames, packed runs, code n),
+    // then ",KEYS" if there is a chord keyboard
+    Serial.print("CAPS:FRAME,PACK");
+    Serial.print(PatternDecoder::version());
+#ifdef BRAILLE_KEYS
+    Serial.print(",KEYS");
+#endif
+    Serial.println();
+
   } else if (strcmp(cmd, "PING") == 0) {
     Serial.println("PONG");
 
@@ -61,13 +344,26 @@ void loop() {
     if (c == '\r') continue;
 
     if (c == '\n') {
+#ifdef BRAILLE_PROBE
+      lineReceivedMicros = micros();
+#endif
       inputBuffer[bufferIndex] = '\0';
-      if (bufferIndex > 0) {
+      if (lineTooLong) {
+        // A cut-off edit would corrupt the text, so nothing overlong runs
+        Serial.println("ERR:line too long");
+      } else if (bufferIndex > 0) {
         processCommand(inputBuffer);
       }
       bufferIndex = 0;
+      lineTooLong = false;
     } else if (bufferIndex < (int)sizeof(inputBuffer) - 2) {
       inputBuffer[bufferIndex++] = c;
+    } else {
+      lineTooLong = true;
     }
   }
+
+#ifdef BRAILLE_KEYS
+  if (keyboard.active()) sendChords();
+#endif
 }
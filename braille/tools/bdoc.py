@@ -0,0 +1,291 @@
+#!/usr/bin/env python3
+"""
+Write pre-translated Braille documents (.brd) for the BrailleDocument
+Arduino library class.
+
+A .brd file holds the cell patterns already laid out into lines and pages,
+so the device never re-reads or re-translates the source text and can jump
+to any page with one index read.
+
+File layout (all integers little-endian):
+
+  Header, 32 bytes
+    0  char[4]  magic "BRLD"
+    4  u8       format version (1)
+    5  u8       translation table id (1 = BrailleConverter ASCII 8-dot)
+    6  u8       line width in cells
+    7  u8       lines per page
+    8  u8       layout flags (1 = number sign, 2 = capital sign)
+    9  u8[3]    reserved, zero
+   12  u32      document id (CRC-32 of the cell stream)
+   16  u32      line count
+   20  u32      page count
+   24  u32      offset of the page index
+   28  u32      offset of the cell stream
+
+  Cell stream: one record per line, u8 cell count followed by that many
+  pattern bytes (bit 0 = dot 1 ... bit 7 = dot 8).
+
+  Page index: u32 offset of the first line record of every page.
+
+Line breaking follows BrailleLayout (BrailleLayout.cpp) exactly, so a
+document written here pages the same way as text laid out on the device.
+Like BrailleLayout, which sees the UTF-8 file as a char buffer, the
+layout works on bytes: a non-ASCII character takes one 0xFF cell per
+UTF-8 byte.
+
+Usage:
+  python bdoc.py story.txt -o STORY.BRD
+  python bdoc.py story.txt -o STORY.BRD --width 20 --lines 4
+  python bdoc.py --info STORY.BRD
+"""
+
+import sys
+import struct
+import zlib
+import argparse
+from pathlib import Path
+
+MAGIC = b"BRLD"
+VERSION = 1
+HEADER = struct.Struct("<4sBBBBB3xIIIII")
+
+TABLE_ASCII8 = 1
+
+LAYOUT_NUMBER_SIGN = 0x01
+LAYOUT_CAPITAL_SIGN = 0x02
+NUMBER_SIGN_PATTERN = 0x3C
+CAPITAL_SIGN_PATTERN = 0x20
+
+# BrailleConverter::CHAR_TO_PATTERN (arduino_library/BrailleConverter.cpp)
+# bit 0 = dot 1 ... bit 7 = dot 8
+CHAR_TO_PATTERN = bytes([
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x16, 0x36, 0x3C, 0x12, 0x29, 0x2F, 0x04,  # space ! " # $ % & '
+    0x23, 0x1C, 0x14, 0x2C, 0x02, 0x24, 0x32, 0x0C,  # ( ) * + , - . /
+    0x1A, 0x01, 0x03, 0x09, 0x19, 0x11, 0x0B, 0x1B,  # 0-7
+    0x13, 0x0A, 0x12, 0x06, 0x23, 0x36, 0x1C, 0x26,  # 8 9 : ; < = > ?
+    0x01, 0x41, 0x43, 0x49, 0x59, 0x51, 0x4B, 0x5B,  # @ A-G
+    0x53, 0x4A, 0x5A, 0x45, 0x47, 0x4D, 0x5D, 0x55,  # H-O
+    0x4F, 0x5F, 0x57, 0x4E, 0x5E, 0x65, 0x67, 0x7A,  # P-W
+    0x6D, 0x7D, 0x75, 0x23, 0x21, 0x1C, 0x23, 0x24,  # X Y Z [ \ ] ^ _
+    0x22, 0x01, 0x03, 0x09, 0x19, 0x11, 0x0B, 0x1B,  # ` a-g
+    0x13, 0x0A, 0x1A, 0x05, 0x07, 0x0D, 0x1D, 0x15,  # h-o
+    0x0F, 0x1F, 0x17, 0x0E, 0x1E, 0x25, 0x27, 0x3A,  # p-w
+    0x2D, 0x3D, 0x35, 0x23, 0x33, 0x1C, 0x31, 0xFF,  # x y z { | } ~ DEL
+])
+
+
+# ---------------------------------------------------------------------------
+# Layout (mirrors BrailleLayout::nextLineStart)
+# ---------------------------------------------------------------------------
+
+def device_text(text: str) -> str:
+    """One character per UTF-8 byte, the way BrailleLayout reads the text."""
+    return text.encode("utf-8").decode("latin-1")
+
+
+def _is_blank(c: str) -> bool:
+    return c in " \t\r"
+
+
+def _pattern(c: str) -> int:
+    o = ord(c)
+    return CHAR_TO_PATTERN[o] if o < 128 else 0xFF
+
+
+def _char_cells(prev: str, c: str, flags: int) -> list[int]:
+    cells = []
+    if (flags & LAYOUT_NUMBER_SIGN) and c.isdigit() and c.isascii() and not (prev.isdigit() and prev.isascii()):
+        cells.append(NUMBER_SIGN_PATTERN)
+    p = _pattern(c)
+    if (flags & LAYOUT_CAPITAL_SIGN) and "A" <= c <= "Z":
+        cells.append(CAPITAL_SIGN_PATTERN)
+        p &= ~0x40
+    cells.append(p)
+    return cells
+
+
+def _word_end(text: str, pos: int) -> int:
+    n = len(text)
+    while pos < n and not _is_blank(text[pos]) and text[pos] != "\n":
+        pos += 1
+    return pos
+
+
+def _measure(text: str, a: int, b: int, flags: int) -> int:
+    prev = ""
+    total = 0
+    for i in range(a, b):
+        total += len(_char_cells(prev, text[i], flags))
+        prev = text[i]
+    return total
+
+
+def next_line(text: str, start: int, width: int, flags: int) -> tuple[int, bytes]:
+    """Lay out one line of device_text() output starting at `start`;
+    return (next line start, cells)."""
+    n = len(text)
+    pos = start
+    cells: list[int] = []
+
+    while pos < n and _is_blank(text[pos]):
+        if text[pos] != "\r" and len(cells) < width:
+            cells.append(0x00)
+        pos += 1
+
+    while pos < n:
+        c = text[pos]
+        if c == "\n":
+            pos += 1
+            break
+
+        if _is_blank(c):
+            ws = pos
+            gap = 0
+            while ws < n and _is_blank(text[ws]):
+                if text[ws] != "\r" and gap < width:
+                    gap += 1
+                ws += 1
+            if ws >= n or text[ws] == "\n":
+                pos = ws
+                continue
+            need = gap + _measure(text, ws, _word_end(text, ws), flags)
+            if len(cells) + need > width:
+                pos = ws
+                break
+            cells.extend([0x00] * gap)
+            pos = ws
+
+        end = _word_end(text, pos)
+        fits = len(cells) + _measure(text, pos, end, flags) <= width
+        if not fits and cells:
+            break
+
+        prev = ""
+        while pos < end:
+            cc = _char_cells(prev, text[pos], flags)
+            if len(cells) + len(cc) > width:
+                if cells:
+                    break
+                cc = cc[-1:]
+            cells.extend(cc)
+            prev = text[pos]
+            pos += 1
+        if not fits:
+            break
+
+    return pos, bytes(cells)
+
+
+def layout_lines(text: str, width: int, flags: int = LAYOUT_NUMBER_SIGN) -> list[bytes]:
+    """Wrap text into lines of at most `width` cells."""
+    width = max(1, min(width, 255))
+    text = device_text(text)
+    lines = []
+    pos = 0
+    while pos < len(text):
+        pos, cells = next_line(text, pos, width, flags)
+        lines.append(cells)
+    return lines
+
+
+# ---------------------------------------------------------------------------
+# Writer / reader
+# ---------------------------------------------------------------------------
+
+def encode_bdoc(text: str, width: int = 40, lines_per_page: int = 25,
+                flags: int = LAYOUT_NUMBER_SIGN) -> bytes:
+    """Translate text and return the complete .brd file contents."""
+    width = max(1, min(width, 255))
+    lines_per_page = max(1, min(lines_per_page, 255))
+    lines = layout_lines(text, width, flags)
+
+    cells_offset = HEADER.size
+    stream = bytearray()
+    page_index = []
+    for i, cells in enumerate(lines):
+        if i % lines_per_page == 0:
+            page_index.append(cells_offset + len(stream))
+        stream.append(len(cells))
+        stream += cells
+    if not page_index:
+        page_index.append(cells_offset)
+
+    index_offset = cells_offset + len(stream)
+    doc_id = zlib.crc32(stream) & 0xFFFFFFFF
+    header = HEADER.pack(MAGIC, VERSION, TABLE_ASCII8, width, lines_per_page, flags,
+                         doc_id, len(lines), len(page_index), index_offset, cells_offset)
+    index = struct.pack(f"<{len(page_index)}I", *page_index)
+    return header + bytes(stream) + index
+
+
+def write_bdoc(path: Path, text: str, width: int = 40, lines_per_page: int = 25,
+               flags: int = LAYOUT_NUMBER_SIGN) -> int:
+    """Write a .brd file; returns its size in bytes."""
+    data = encode_bdoc(text, width, lines_per_page, flags)
+    Path(path).write_bytes(data)
+    return len(data)
+
+
+def read_bdoc(path: Path) -> tuple[dict, list[bytes]]:
+    """Parse a .brd file into (header fields, list of line cell bytes)."""
+    data = Path(path).read_bytes()
+    if len(data) < HEADER.size:
+        raise ValueError("file too short for a .brd header")
+    (magic, version, table, width, lpp, flags,
+     doc_id, line_count, page_count, index_offset, cells_offset) = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("not a version 1 .brd file")
+
+    lines = []
+    pos = cells_offset
+    for _ in range(line_count):
+        n = data[pos]
+        lines.append(data[pos + 1:pos + 1 + n])
+        pos += 1 + n
+    info = {
+        "table": table, "width": width, "lines_per_page": lpp, "flags": flags,
+        "doc_id": doc_id, "line_count": line_count, "page_count": page_count,
+        "index_offset": index_offset, "cells_offset": cells_offset,
+    }
+    return info, lines
+
+
+# ---------------------------------------------------------------------------
+# CLI
+# ---------------------------------------------------------------------------
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description="Write a pre-translated Braille document (.brd)")
+    parser.add_argument("input", help="UTF-8 text file to translate, or a .brd file with --info")
+    parser.add_argument("--output", "-o", help="Output .brd file (default: input name with .BRD)")
+    parser.add_argument("--width", "-w", type=int, default=40, help="Cells per line (default: 40)")
+    parser.add_argument("--lines", "-l", type=int, default=25, help="Lines per page (default: 25)")
+    parser.add_argument("--capital-sign", action="store_true", help="6-dot capitals (dot 6 prefix)")
+    parser.add_argument("--no-number-sign", action="store_true", help="Do not insert number signs")
+    parser.add_argument("--info", action="store_true", help="Print the header of a .brd file")
+    args = parser.parse_args()
+
+    if args.info:
+        info, lines = read_bdoc(Path(args.input))
+        for k, v in info.items():
+            print(f"{k:<14} {v:#010x}" if k == "doc_id" else f"{k:<14} {v}")
+        return
+
+    flags = 0 if args.no_number_sign else LAYOUT_NUMBER_SIGN
+    if args.capital_sign:
+        flags |= LAYOUT_CAPITAL_SIGN
+
+    src = Path(args.input)
+    text = src.read_text(encoding="utf-8-sig")
+    out = Path(args.output) if args.output else src.with_suffix(".BRD")
+    size = write_bdoc(out, text, args.width, args.lines, flags)
+    print(f"Wrote {out} ({size} bytes, {args.width} cells x {args.lines} lines per page)")
+
+
+if __name__ == "__main__":
+    main()
@@ -280,6 +280,9 @@ Options:
   --max-chars N         Convert only the first N characters.
   --gutenberg ID        Download a book from Project Gutenberg by numeric ID
                         (e.g. 1342 for Pride and Prejudice).
+  --bdoc OUT            Write a pre-translated .brd document for the
+                        BrailleDocument Arduino class instead of printing.
+  --width N             Cells per line for --bdoc (default: 40).
 
 Examples:
   python doc_to_braille.py book.epub
@@ -288,6 +291,7 @@ Examples:
   python doc_to_braille.py page.html --preview
   python doc_to_braille.py story.txt
   python doc_to_braille.py --gutenberg 1342 --max-chars 300
+  python doc_to_braille.py --gutenberg 1342 --bdoc BOOK.BRD --width 20
 """
 
 
@@ -302,6 +306,8 @@ def main() -> None:
     max_chars: int | None = None
     gutenberg_id: int | None = None
     file_path: Path | None = None
+    bdoc_path: Path | None = None
+    width = 40
 
     i = 0
     while i < len(argv):
@@ -322,6 +328,18 @@ def main() -> None:
                 pass
             i += 1
             continue
+        if a == "--bdoc":
+            i += 1
+            if i < len(argv):
+                bdoc_path = Path(argv[i])
+            i += 1
+            continue
+        if a == "--width":
+            i += 1
+            if i < len(argv) and argv[i].isdigit():
+                width = int(argv[i])
+            i += 1
+            continue
         if a == "--gutenberg":
             i += 1
             if i < len(argv) and argv[i].isdigit():
@@ -384,6 +402,12 @@ def main() -> None:
         )
         sys.exit(1)
 
+    if bdoc_path is not None:
+        from bdoc import write_bdoc
+        size = write_bdoc(bdoc_path, text, width)
+        print(f"Wrote {bdoc_path} ({size} bytes, {width} cells per line)")
+        return
+
     display_text_as_braille(text)
 
 
@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+"""
+Train the static Huffman code for packed F: runs and write its tables.
+
+Text is laid out into lines of cells exactly as bdoc.py does (BrailleLayout,
+BrailleConverter::CHAR_TO_PATTERN, number signs), each pattern is moved
+from the converter's bit order (bit n-1 = dot n) to the F: order the
+firmware shows frames in (BrailleCell: bit3 = dot 7, bits 4-6 = dots 4-6),
+the frequencies are counted, and every one of the 256 patterns gets a
+canonical code of at most MAX_BITS bits (unseen patterns too, so any frame
+can be packed).
+
+Writes:
+  braille/lib/PatternDecoder/PatternCodeTable.h   code-length counts and the
+                                               symbols in code order (flash)
+  electrical/core/PatternCodeTable.h           code length per pattern
+
+Usage:
+  python gen_pattern_code.py [TEXT...]   (default: /usr/share/common-licenses/GPL-3)
+"""
+
+import heapq
+import math
+import sys
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+from bdoc import LAYOUT_NUMBER_SIGN, device_text, next_line  # noqa: E402
+
+MAX_BITS = 15
+VERSION = 2
+WIDTH = 32
+DEFAULT_CORPUS = '/usr/share/common-licenses/GPL-3'
+ROOT = Path(__file__).resolve().parents[2]
+
+
+def cell_order(pattern):
+    """Converter order (bit n-1 = dot n) to F: order (dots 1-3, 7, 4-6, 8)."""
+    return (pattern & 0x87) | ((pattern & 0x38) << 1) | ((pattern & 0x40) >> 3)
+
+
+def count_patterns(texts):
+    counts = [0] * 256
+    for text in texts:
+        text = device_text(text)
+        pos = 0
+        while pos < len(text):
+            pos, cells = next_line(text, pos, WIDTH, LAYOUT_NUMBER_SIGN)
+            for c in cells:
+                counts[cell_order(c)] += 1
+    return counts
+
+
+def huffman_lengths(weights):
+    heap = [(w, i, [i]) for i, w in enumerate(weights)]
+    heapq.heapify(heap)
+    lengths = [0] * len(weights)
+    tie = len(weights)
+    while len(heap) > 1:
+        w1, _, s1 = heapq.heappop(heap)
+        w2, _, s2 = heapq.heappop(heap)
+        for s in s1 + s2:
+            lengths[s] += 1
+        heapq.heappush(heap, (w1 + w2, tie, s1 + s2))
+        tie += 1
+    return lengths
+
+
+def limit_lengths(lengths, weights, max_bits):
+    """Clamp to max_bits, then lengthen the rarest short codes until the code is complete again."""
+    lengths = [min(n, max_bits) for n in lengths]
+    kraft = sum(1 << (max_bits - n) for n in lengths)
+    order = sorted(range(len(lengths)), key=lambda i: (weights[i], -lengths[i]))
+    while kraft > (1 << max_bits):
+        for i in order:
+            if lengths[i] < max_bits:
+                lengths[i] += 1
+                kraft -= 1 << (max_bits - lengths[i])
+                break
+    # Give back slack to the most frequent codes
+    for i in sorted(range(len(lengths)), key=lambda i: -weights[i]):
+        while lengths[i] > 1 and kraft + (1 << (max_bits - lengths[i])) <= (1 << max_bits):
+            kraft += 1 << (max_bits - lengths[i])
+            lengths[i] -= 1
+    return lengths
+
+
+def table_rows(values, per_row=16):
+    rows = []
+    for i in range(0, len(values), per_row):
+        rows.append('  ' + ', '.join(f'0x{v:02X}' for v in values[i:i + per_row]) + ',')
+    return '\n'.join(rows)
+
+
+def main():
+    paths = sys.argv[1:] or [DEFAULT_CORPUS]
+    texts = [Path(p).read_text(encoding='utf-8', errors='replace') for p in paths]
+    counts = count_patterns(texts)
+    total = sum(counts)
+    # Unseen patterns (cursor dots, graphics) weigh less than any seen one
+    weights = [c * 256 if c else 1 for c in counts]
+    lengths = limit_lengths(huffman_lengths(weights), weights, MAX_BITS)
+    assert sum(2.0 ** -n for n in lengths) == 1.0
+
+    per_length = [0] * (MAX_BITS + 1)
+    for n in lengths:
+        per_length[n] += 1
+    symbols = sorted(range(256), key=lambda s: (lengths[s], s))
+
+    bits = sum(counts[s] * lengths[s] for s in range(256)) / total
+    entropy = -sum(c / total * math.log2(c / total) for c in counts if c)
+    corpus = ', '.join(Path(p).name for p in paths)
+    summary = (f'Trained on {corpus}: {total} cells, {bits:.2f} bits per cell '
+               f'(entropy {entropy:.2f}), {bits / 6:.2f} characters vs 2 in hex')
+
+    avr = f"""/*
+ * PatternCodeTable.h - Generated by braille/tools/gen_pattern_code.py, do
+ * not edit. Canonical Huffman code for packed F: runs, version {VERSION}.
+ * {summary}.
+ */
+
+#ifndef PATTERN_CODE_TABLE_H
+#define PATTERN_CODE_TABLE_H
+
+#define PATTERN_CODE_VERSION {VERSION}
+#define PATTERN_CODE_MAX_BITS {MAX_BITS}
+
+// Number of codes of each length, index 1..PATTERN_CODE_MAX_BITS
+const uint8_t PATTERN_CODE_COUNTS[PATTERN_CODE_MAX_BITS + 1] PROGMEM = {{
+{table_rows(per_length)}
+}};
+
+// Patterns in code order: by length, then by value
+const uint8_t PATTERN_CODE_SYMBOLS[256] PROGMEM = {{
+{table_rows(symbols)}
+}};
+
+#endif
+"""
+    host = f"""// PatternCodeTable.h - Generated by braille/tools/gen_pattern_code.py, do
+// not edit. Code length of every pattern in the canonical Huffman code for
+// packed F: runs, version {VERSION}; the firmware decodes it from
+// braille/lib/PatternDecoder/PatternCodeTable.h.
+// {summary}.
+
+#pragma once
+
+#include <cstdint>
+
+constexpr int kPatternCodeVersion = {VERSION};
+constexpr int kPatternCodeMaxBits = {MAX_BITS};
+
+inline constexpr uint8_t kPatternCodeLengths[256] = {{
+{table_rows(lengths).replace('  0x', '    0x')}
+}};
+"""
+    (ROOT / 'braille/lib/PatternDecoder/PatternCodeTable.h').write_text(avr)
+    (ROOT / 'electrical/core/PatternCodeTable.h').write_text(host)
+    print(summary)
+
+
+if __name__ == '__main__':
+    main()
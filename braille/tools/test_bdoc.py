@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""Round trip of bdoc.py: encode_bdoc / write_bdoc -> read_bdoc.
+
+  python braille/tools/test_bdoc.py
+"""
+
+import struct
+import sys
+import tempfile
+import unittest
+import zlib
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+import bdoc  # noqa: E402
+
+TEXT = ("Chapter 12\n\n"
+        "It was the best of times, it was the worst of times, it was the age "
+        "of wisdom, it was the age of foolishness, in 1775 and 1859.\n"
+        "   Indented line\twith a tab and a verylongwordthatdoesnotfitonanyline.\n"
+        "Café — naïve \U0001F600 end\n")
+
+
+class RoundTripTest(unittest.TestCase):
+    def check(self, text, width, lines_per_page, flags):
+        with tempfile.TemporaryDirectory() as tmp:
+            path = Path(tmp) / "DOC.BRD"
+            size = bdoc.write_bdoc(path, text, width, lines_per_page, flags)
+            data = path.read_bytes()
+            info, lines = bdoc.read_bdoc(path)
+
+        self.assertEqual(size, len(data))
+        expected = bdoc.layout_lines(text, width, flags)
+        self.assertEqual(lines, expected)
+        self.assertTrue(all(len(cells) <= width for cells in lines))
+        self.assertEqual(info["table"], bdoc.TABLE_ASCII8)
+        self.assertEqual((info["width"], info["lines_per_page"], info["flags"]),
+                         (width, lines_per_page, flags))
+        self.assertEqual(info["line_count"], len(expected))
+        self.assertEqual(info["page_count"], max(1, -(-len(expected) // lines_per_page)))
+
+        stream = data[info["cells_offset"]:info["index_offset"]]
+        self.assertEqual(info["doc_id"], zlib.crc32(stream) & 0xFFFFFFFF)
+
+        # Every index entry points at the first record of its page
+        index = struct.unpack_from(f"<{info['page_count']}I", data, info["index_offset"])
+        self.assertEqual(len(data), info["index_offset"] + 4 * info["page_count"])
+        pos = info["cells_offset"]
+        for i, cells in enumerate(lines):
+            if i % lines_per_page == 0:
+                self.assertEqual(index[i // lines_per_page], pos)
+            self.assertEqual(data[pos], len(cells))
+            pos += 1 + len(cells)
+        self.assertEqual(pos, info["index_offset"])
+
+    def test_widths_and_pages(self):
+        for width in (1, 2, 5, 12, 20, 40, 255):
+            for lines_per_page in (1, 3, 25):
+                for flags in (0, bdoc.LAYOUT_NUMBER_SIGN,
+                              bdoc.LAYOUT_NUMBER_SIGN | bdoc.LAYOUT_CAPITAL_SIGN):
+                    with self.subTest(width=width, lines=lines_per_page, flags=flags):
+                        self.check(TEXT, width, lines_per_page, flags)
+
+    def test_empty_document(self):
+        self.check("", 40, 25, bdoc.LAYOUT_NUMBER_SIGN)
+
+    def test_non_ascii_takes_a_cell_per_utf8_byte(self):
+        # BrailleLayout sees the UTF-8 bytes: 2, 3 and 4 cells of 0xFF
+        for ch, n in (("é", 2), ("—", 3), ("\U0001F600", 4)):
+            with self.subTest(ch=ch):
+                self.assertEqual(bdoc.layout_lines("a" + ch + "b", 40, 0),
+                                 [bytes([0x01]) + b"\xff" * n + bytes([0x03])])
+
+    def test_letters_and_signs(self):
+        self.assertEqual(bdoc.layout_lines("ab 12", 40, bdoc.LAYOUT_NUMBER_SIGN),
+                         [bytes([0x01, 0x03, 0x00, bdoc.NUMBER_SIGN_PATTERN, 0x01, 0x03])])
+        self.assertEqual(bdoc.layout_lines("Ab", 40, bdoc.LAYOUT_CAPITAL_SIGN),
+                         [bytes([bdoc.CAPITAL_SIGN_PATTERN, 0x01, 0x03])])
+
+
+if __name__ == "__main__":
+    unittest.main()
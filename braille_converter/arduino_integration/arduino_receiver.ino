@@ -5,31 +5,71 @@
  * and controls braille cell pins/motors.
  * 
  * Protocol: "DOTS:1,2,3\n" or "DOTS:NONE\n"
+ *           "DOTS:1,2;1,4,5;NONE\n"  - one field per cell, separated by ';'
+ * Dots 1-8 are accepted (8-dot cells). Commas are optional, "DOTS:123"
+ * is the same as "DOTS:1,2,3".
+ * 
+ * Every message is answered with exactly 8 bytes:
+ *   "ACK:nn\r\n"  - nn = number of cells updated (2 hex digits)
+ *   "ERR:nn\r\n"  - nn = error code (see ERR_* below)
+ * 
  * Baud Rate: 115200
+ * 
+ * Messages are parsed one byte at a time as they arrive: there is no line
+ * buffer and no String, so RAM use is fixed (one byte per cell) no matter
+ * how long the receiver runs.
  */
 
-// Pin configuration for 6-dot braille cell
+// Pin configuration for the first 8-dot braille cell
 // Adjust these pin numbers based on your hardware setup
-const int DOT_PINS[6] = {2, 3, 4, 5, 6, 7};  // Pins for dots 1-6
+const int DOT_PINS[8] = {2, 3, 4, 5, 6, 7, 8, 9};  // Pins for dots 1-8
+
+// Cells after the first are driven through chained 74HC595 shift
+// registers, one register per cell (Q0 = dot 1 ... Q7 = dot 8)
+const int NUM_CELLS = 1;
+const int LATCH_PIN = 10;
+const int DATA_PIN = 11;
+const int CLOCK_PIN = 12;
 
-// Or if using shift register or other method:
-// const int LATCH_PIN = 8;
-// const int CLOCK_PIN = 12;
-// const int DATA_PIN = 11;
+const long BAUD_RATE = 115200;
 
-const int BAUD_RATE = 115200;
-String inputBuffer = "";
+// Reply codes
+const uint8_t ERR_UNKNOWN_COMMAND = 0x01;
+const uint8_t ERR_BAD_DOT = 0x02;
+const uint8_t ERR_TOO_MANY_CELLS = 0x03;
+
+const char PREFIX[] = "DOTS:";
+const uint8_t PREFIX_LENGTH = 5;
+const char NONE_FIELD[] = "NONE";
+const uint8_t NONE_LENGTH = 4;
+
+// Parser state
+uint8_t patterns[NUM_CELLS];   // cells being received (bit 0 = dot 1)
+uint8_t cellIndex = 0;         // field currently being parsed
+uint8_t prefixMatched = 0;     // characters of PREFIX seen so far
+uint8_t noneMatched = 0;       // characters of "NONE" seen in this field
+uint8_t errorCode = 0;         // first error in the current message
+bool lineStarted = false;      // any non-blank character in this message
 
 void setup() {
   // Initialize serial communication
   Serial.begin(BAUD_RATE);
   
   // Initialize dot pins as outputs
-  for (int i = 0; i < 6; i++) {
+  for (int i = 0; i < 8; i++) {
     pinMode(DOT_PINS[i], OUTPUT);
     digitalWrite(DOT_PINS[i], LOW);
   }
   
+  if (NUM_CELLS > 1) {
+    pinMode(LATCH_PIN, OUTPUT);
+    pinMode(DATA_PIN, OUTPUT);
+    pinMode(CLOCK_PIN, OUTPUT);
+  }
+  
+  resetParser();
+  clearAllDots();
+  
   // Send ready message
   Serial.println("READY:Arduino Braille Receiver");
   Serial.flush();
@@ -39,137 +79,142 @@ void setup() {
 }
 
 void loop() {
-  // Read incoming serial data
+  // Parse incoming bytes as they arrive
   while (Serial.available() > 0) {
-    char c = Serial.read();
-    
-    if (c == '\n') {
-      // Process complete message
-      processMessage(inputBuffer);
-      inputBuffer = "";
-    } else {
-      inputBuffer += c;
-    }
+    parseByte(Serial.read());
   }
 }
 
-void processMessage(String message) {
-  message.trim();
+void parseByte(char c) {
+  if (c == '\n') {
+    finishMessage();
+    return;
+  }
+  if (c == '\r') return;
+  if (c == ' ' && !lineStarted) return;  // leading blanks
+  lineStarted = true;
+  if (errorCode) return;                 // skip the rest of a bad message
   
-  // Check if message starts with "DOTS:"
-  if (message.startsWith("DOTS:")) {
-    String dotsStr = message.substring(5);  // Remove "DOTS:" prefix
-    
-    if (dotsStr == "NONE" || dotsStr == "") {
-      // Clear all dots (space character)
-      clearAllDots();
-      Serial.println("ACK:CLEARED");
+  // "DOTS:" prefix
+  if (prefixMatched < PREFIX_LENGTH) {
+    if (c == PREFIX[prefixMatched]) {
+      prefixMatched++;
     } else {
-      // Parse dot numbers and activate them
-      activateDots(dotsStr);
-      Serial.println("ACK:DOTS:" + dotsStr);
+      errorCode = ERR_UNKNOWN_COMMAND;
     }
-  } else {
-    Serial.println("ERROR:Unknown command");
+    return;
   }
-}
-
-void activateDots(String dotsStr) {
-  // First, clear all dots
-  clearAllDots();
-  
-  // Parse comma-separated dot numbers
-  int startIdx = 0;
-  int commaIdx = dotsStr.indexOf(',');
   
-  while (true) {
-    String dotStr;
-    
-    if (commaIdx == -1) {
-      // Last dot
-      dotStr = dotsStr.substring(startIdx);
-      if (dotStr.length() == 0) break;
+  // Cell fields: dots, or the whole word "NONE" (an empty field)
+  bool inNone = noneMatched > 0 && noneMatched < NONE_LENGTH;
+  if (c >= '1' && c <= '8' && noneMatched == 0) {
+    patterns[cellIndex] |= 1 << (c - '1');
+  } else if (c == ';' && !inNone) {
+    if (cellIndex + 1 >= NUM_CELLS) {
+      errorCode = ERR_TOO_MANY_CELLS;
     } else {
-      dotStr = dotsStr.substring(startIdx, commaIdx);
+      cellIndex++;
+      noneMatched = 0;
     }
-    
-    dotStr.trim();
-    int dotNum = dotStr.toInt();
-    
-    // Activate the dot (1-6)
-    if (dotNum >= 1 && dotNum <= 6) {
-      activateDot(dotNum);
-    }
-    
-    if (commaIdx == -1) break;
-    
-    startIdx = commaIdx + 1;
-    commaIdx = dotsStr.indexOf(',', startIdx);
+  } else if ((c == ',' || c == ' ') && !inNone) {
+    // Separators
+  } else if (noneMatched < NONE_LENGTH && c == NONE_FIELD[noneMatched] &&
+             patterns[cellIndex] == 0) {
+    noneMatched++;
+  } else {
+    errorCode = ERR_BAD_DOT;
   }
 }
 
-void activateDot(int dotNum) {
-  // Activate single dot (1-6)
-  // dotNum is 1-indexed, array is 0-indexed
+void finishMessage() {
+  if (!lineStarted) return;  // ignore empty lines
   
-  if (dotNum < 1 || dotNum > 6) return;
+  if (!errorCode && prefixMatched < PREFIX_LENGTH) {
+    errorCode = ERR_UNKNOWN_COMMAND;
+  }
+  if (!errorCode && noneMatched > 0 && noneMatched < NONE_LENGTH) {
+    errorCode = ERR_BAD_DOT;  // field cut off inside "NONE"
+  }
   
-  int pin = DOT_PINS[dotNum - 1];
-  digitalWrite(pin, HIGH);
+  if (errorCode) {
+    sendReply("ERR:", errorCode);
+  } else {
+    // Cells that got no field in this message are cleared
+    uint8_t updated = cellIndex + 1;
+    showPatterns();
+    sendReply("ACK:", updated);
+  }
+  resetParser();
+}
+
+void resetParser() {
+  for (int i = 0; i < NUM_CELLS; i++) {
+    patterns[i] = 0;
+  }
+  cellIndex = 0;
+  prefixMatched = 0;
+  noneMatched = 0;
+  errorCode = 0;
+  lineStarted = false;
+}
+
+void sendReply(const char* tag, uint8_t value) {
+  // Fixed 8-byte reply: tag (4) + 2 hex digits + CR LF
+  static const char HEX_DIGITS[] = "0123456789ABCDEF";
+  char reply[8];
+  for (int i = 0; i < 4; i++) {
+    reply[i] = tag[i];
+  }
+  reply[4] = HEX_DIGITS[value >> 4];
+  reply[5] = HEX_DIGITS[value & 0x0F];
+  reply[6] = '\r';
+  reply[7] = '\n';
+  Serial.write((const uint8_t*)reply, sizeof(reply));
+}
+
+void showPatterns() {
+  // First cell on the direct pins
+  for (int i = 0; i < 8; i++) {
+    digitalWrite(DOT_PINS[i], (patterns[0] & (1 << i)) ? HIGH : LOW);
+  }
   
-  // Optional: Debug output
-  // Serial.print("Activated dot ");
-  // Serial.println(dotNum);
+  // Remaining cells through the shift register chain, last cell first
+  if (NUM_CELLS > 1) {
+    digitalWrite(LATCH_PIN, LOW);
+    for (int cell = NUM_CELLS - 1; cell >= 1; cell--) {
+      shiftOut(DATA_PIN, CLOCK_PIN, MSBFIRST, patterns[cell]);
+    }
+    digitalWrite(LATCH_PIN, HIGH);
+  }
 }
 
 void clearAllDots() {
   // Turn off all dots
-  for (int i = 0; i < 6; i++) {
-    digitalWrite(DOT_PINS[i], LOW);
+  for (int i = 0; i < NUM_CELLS; i++) {
+    patterns[i] = 0;
   }
+  showPatterns();
 }
 
 void flashAllDots() {
   // Flash all dots as startup indicator
   for (int repeat = 0; repeat < 3; repeat++) {
-    for (int i = 0; i < 6; i++) {
+    for (int i = 0; i < 8; i++) {
       digitalWrite(DOT_PINS[i], HIGH);
     }
     delay(200);
     
-    for (int i = 0; i < 6; i++) {
+    for (int i = 0; i < 8; i++) {
       digitalWrite(DOT_PINS[i], LOW);
     }
     delay(200);
   }
 }
 
-// Alternative: If using shift register for controlling multiple cells
-/*
-void activateDotShiftRegister(int dotNum) {
-  // Example for 74HC595 shift register
-  byte pattern = 0;
-  
-  for (int i = 0; i < 6; i++) {
-    if (digitalRead(DOT_PINS[i]) == HIGH) {
-      pattern |= (1 << i);
-    }
-  }
-  
-  if (dotNum >= 1 && dotNum <= 6) {
-    pattern |= (1 << (dotNum - 1));
-  }
-  
-  digitalWrite(LATCH_PIN, LOW);
-  shiftOut(DATA_PIN, CLOCK_PIN, MSBFIRST, pattern);
-  digitalWrite(LATCH_PIN, HIGH);
-}
-*/
-
 // Alternative: If using PWM for motors/solenoids
 /*
 void activateDotPWM(int dotNum, int intensity = 255) {
-  if (dotNum < 1 || dotNum > 6) return;
+  if (dotNum < 1 || dotNum > 8) return;
   
   int pin = DOT_PINS[dotNum - 1];
   analogWrite(pin, intensity);  // 0-255
@@ -183,4 +228,3 @@ void raiseDotSmoothly(int dotNum, int duration = 200) {
   }
 }
 */
-
@@ -4,6 +4,7 @@ Send braille patterns to Arduino over serial.
 This script converts text to braille and sends the dot patterns to Arduino.
 """
 
+import string
 import sys
 import time
 import serial
@@ -13,6 +14,15 @@ import serial.tools.list_ports
 sys.path.insert(0, 'path-to-this-project')
 from braille_converter import BrailleConverter
 
+# Every reply from arduino_receiver.ino is exactly this long:
+# "ACK:nn\r\n" (nn = cells updated) or "ERR:nn\r\n" (nn = error code)
+REPLY_SIZE = 8
+ERROR_CODES = {
+    0x01: "unknown command",
+    0x02: "invalid dot number",
+    0x03: "more cells than the receiver drives",
+}
+
 
 class ArduinoBrailleInterface:
     """Interface for sending braille patterns to Arduino."""
@@ -57,6 +67,8 @@ class ArduinoBrailleInterface:
                 timeout=1
             )
             time.sleep(2)  # Wait for Arduino to reset
+            # Drop the READY banner so replies line up with messages
+            self.serial.reset_input_buffer()
             print(f"✓ Connected to Arduino on {port}")
             return True
         except serial.SerialException as e:
@@ -74,34 +86,65 @@ class ArduinoBrailleInterface:
         Send dot pattern to Arduino.
         
         Args:
-            dots: List of dot numbers (1-6) that should be raised
+            dots: List of dot numbers (1-8) that should be raised
         
         Format: "DOTS:1,2,3\n" or "DOTS:NONE\n" for space
         """
+        return self.send_cells([dots])
+    
+    def send_cells(self, cells):
+        """
+        Send dot patterns for several cells in one message.
+        
+        Args:
+            cells: List with one list of dot numbers (1-8) per cell
+        
+        Format: "DOTS:1,2;1,4,5;NONE\n" (one field per cell)
+        
+        Waits for the receiver's fixed-size reply instead of sleeping, so
+        messages go out as fast as the receiver applies them.
+        """
         if not self.serial or not self.serial.is_open:
             print("✗ Not connected to Arduino")
             return False
         
-        if not dots:
+        fields = []
+        for dots in cells:
+            if any(d < 1 or d > 8 for d in dots):
+                print(f"✗ Invalid dot pattern {dots}: dots must be 1-8")
+                return False
             # Empty pattern (space)
-            message = "DOTS:NONE\n"
-        else:
-            # Convert dots list to comma-separated string
-            dots_str = ','.join(map(str, sorted(dots)))
-            message = f"DOTS:{dots_str}\n"
+            fields.append(','.join(map(str, sorted(set(dots)))) if dots else "NONE")
+        message = f"DOTS:{';'.join(fields)}\n"
         
         try:
-            self.serial.write(message.encode('utf-8'))
+            self.serial.write(message.encode('ascii'))
             self.serial.flush()
-            
-            # Wait for acknowledgment (optional)
-            time.sleep(0.05)
-            
-            return True
+            return self._read_reply()
         except serial.SerialException as e:
             print(f"✗ Send failed: {e}")
             return False
     
+    def _read_reply(self):
+        """Read one fixed-size ACK/ERR reply. Returns True on ACK."""
+        reply = self.serial.read(REPLY_SIZE)
+        if len(reply) < REPLY_SIZE:
+            print("✗ No reply from Arduino (timeout)")
+            return False
+        
+        tag, value = reply[:4], reply[4:6]
+        if tag == b"ACK:":
+            return True
+        if tag == b"ERR:" and all(chr(c) in string.hexdigits for c in value):
+            code = int(value, 16)
+            print(f"✗ Arduino error {code:02X}: {ERROR_CODES.get(code, 'unknown')}")
+            return False
+        
+        # Out of step (e.g. a reset): drop whatever else is buffered
+        self.serial.reset_input_buffer()
+        print(f"✗ Unexpected reply from Arduino: {reply!r}")
+        return False
+    
     def send_char(self, char, delay=0.5):
         """
         Convert character to braille and send to Arduino.
@@ -238,7 +281,7 @@ def interactive_mode():
     print("  char <c>  - Send single character")
     print("  text <t>  - Send text with delays")
     print("  demo <c>  - Demo character with pattern")
-    print("  dots <d>  - Send raw dot pattern (e.g., 1,2,3)")
+    print("  dots <d>  - Send raw dot pattern (e.g., 1,2,3 or 1,2;4,5 for two cells)")
     print("  quit      - Exit")
     print("=" * 60)
     
@@ -270,10 +313,11 @@ def interactive_mode():
             
             elif command == 'dots' and len(parts) > 1:
                 try:
-                    dots = [int(d.strip()) for d in parts[1].split(',')]
-                    print(f"Sending dots: {dots}")
-                    interface.send_dots(dots)
-                    print("✓ Sent")
+                    cells = [[int(d) for d in field.split(',') if d.strip()]
+                             for field in parts[1].split(';')]
+                    print(f"Sending dots: {cells if len(cells) > 1 else cells[0]}")
+                    if interface.send_cells(cells):
+                        print("✓ Sent")
                 except ValueError:
                     print("✗ Invalid dot pattern. Use format: 1,2,3")
             
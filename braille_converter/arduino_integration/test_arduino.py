@@ -7,7 +7,7 @@ import time
 
 sys.path.insert(0, 'path-to-this-project')
 
-from braille_converter.arduino_integration.braille_to_arduino import ArduinoBrailleInterface
+from braille_converter.arduino_integration.braille_to_arduino import ArduinoBrailleInterface, REPLY_SIZE
 
 
 def test_connection():
@@ -133,17 +133,70 @@ def test_word(interface):
     print("\n✓ Test 5 PASSED\n")
 
 
+def test_malformed_fields(interface):
+    """Test 6: Malformed fields are rejected, and their replies parsed."""
+    print("=" * 60)
+    print("Test 6: Malformed Fields")
+    print("=" * 60)
+    
+    # "NONE" only counts as a whole field; its letters elsewhere are bad dots
+    messages = [
+        ("DOTS:NONE", b"ACK:01\r\n"),
+        ("DOTS:NOE", b"ERR:02\r\n"),
+        ("DOTS:EVEN", b"ERR:02\r\n"),
+        ("DOTS:1NONE", b"ERR:02\r\n"),
+        ("DOTS:NON", b"ERR:02\r\n"),
+        ("DOTS:9", b"ERR:02\r\n"),
+        ("DOT:1", b"ERR:01\r\n"),
+    ]
+    
+    passed = True
+    for message, expected in messages:
+        print(f"{message!r} → {expected[:6].decode()}...", end=" ")
+        interface.serial.write((message + "\n").encode('ascii'))
+        interface.serial.flush()
+        reply = interface.serial.read(REPLY_SIZE)
+        if reply == expected:
+            print("✓")
+        else:
+            print(f"✗ got {reply!r}")
+            passed = False
+    
+    # A garbled error code is reported, not raised
+    class GarbledSerial:
+        def read(self, size):
+            return b"ERR:ZZ\r\n"
+        def reset_input_buffer(self):
+            pass
+    
+    print("Garbled reply 'ERR:ZZ'...", end=" ")
+    port = interface.serial
+    interface.serial = GarbledSerial()
+    try:
+        ok = interface._read_reply()
+    except ValueError as e:
+        print(f"✗ raised {e}")
+        ok = passed = False
+    finally:
+        interface.serial = port
+    if ok:
+        print("✗ taken as an ACK")
+        passed = False
+    
+    print(f"{'✓' if passed else '✗'} Test 6 {'PASSED' if passed else 'FAILED'}\n")
+
+
 def test_alphabet(interface):
-    """Test 6: Send alphabet sequence (optional)."""
+    """Test 7: Send alphabet sequence (optional)."""
     print("=" * 60)
-    print("Test 6: Alphabet Sequence (Optional)")
+    print("Test 7: Alphabet Sequence (Optional)")
     print("=" * 60)
     print("This will take ~26 seconds")
     print("Press Enter to continue or 's' to skip: ", end="")
     
     choice = input().strip().lower()
     if choice == 's':
-        print("⊘ Test 6 SKIPPED\n")
+        print("⊘ Test 7 SKIPPED\n")
         return
     
     alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
@@ -154,7 +207,7 @@ def test_alphabet(interface):
         interface.send_dots(bc.dots)
         time.sleep(1.0)
     
-    print("\n✓ Test 6 PASSED\n")
+    print("\n✓ Test 7 PASSED\n")
 
 
 def run_all_tests():
@@ -190,7 +243,11 @@ def run_all_tests():
         test_word(interface)
         time.sleep(0.5)
         
-        # Test 6: Alphabet (optional)
+        # Test 6: Malformed fields
+        test_malformed_fields(interface)
+        time.sleep(0.5)
+        
+        # Test 7: Alphabet (optional)
         test_alphabet(interface)
         
         # Summary
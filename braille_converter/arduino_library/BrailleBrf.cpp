@@ -0,0 +1,219 @@
+#include "BrailleBrf.h"
+
+#if defined(ARDUINO)
+#include <avr/pgmspace.h>
+#else
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#ifndef pgm_read_byte
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#endif
+#endif
+
+// Every input byte -> 6-dot pattern (bit 0 = dot 1 ... bit 5 = dot 6) or a
+// BRF_* control code. 0x20-0x5F is North American ASCII braille; 0x60-0x7E
+// fold onto 0x40-0x5E as most BRF producers treat them.
+static const uint8_t BRF_DECODE[256] PROGMEM = {
+    0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x80, 0x83, 0x81, 0x82, 0x83, 0x83,
+    0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x82, 0x83, 0x83, 0x83, 0x83, 0x83,
+    0x00, 0x2E, 0x10, 0x3C, 0x2B, 0x29, 0x2F, 0x04, 0x37, 0x3E, 0x21, 0x2C, 0x20, 0x24, 0x28, 0x0C,  // space ! " # $ % & ' ( ) * + , - . /
+    0x34, 0x02, 0x06, 0x12, 0x32, 0x22, 0x16, 0x36, 0x26, 0x14, 0x31, 0x30, 0x23, 0x3F, 0x1C, 0x39,  // 0-9 : ; < = > ?
+    0x08, 0x01, 0x03, 0x09, 0x19, 0x11, 0x0B, 0x1B, 0x13, 0x0A, 0x1A, 0x05, 0x07, 0x0D, 0x1D, 0x15,  // @ A-O
+    0x0F, 0x1F, 0x17, 0x0E, 0x1E, 0x25, 0x27, 0x3A, 0x2D, 0x3D, 0x35, 0x2A, 0x33, 0x3B, 0x18, 0x38,  // P-Z [ \ ] ^ _
+    0x08, 0x01, 0x03, 0x09, 0x19, 0x11, 0x0B, 0x1B, 0x13, 0x0A, 0x1A, 0x05, 0x07, 0x0D, 0x1D, 0x15,  // ` a-o
+    0x0F, 0x1F, 0x17, 0x0E, 0x1E, 0x25, 0x27, 0x3A, 0x2D, 0x3D, 0x35, 0x2A, 0x33, 0x3B, 0x18, 0x83,  // p-z { | } ~ DEL
+    0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83,
+    0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83,
+    0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83,
+    0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83,
+    0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83,
+    0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83,
+    0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83,
+    0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83, 0x83,
+};
+
+// 6-dot pattern -> ASCII braille character
+static const char BRF_ENCODE[64] PROGMEM = {
+    ' ', 'A', '1', 'B', '\'', 'K', '2', 'L',
+    '@', 'C', 'I', 'F', '/', 'M', 'S', 'P',
+    '"', 'E', '3', 'H', '9', 'O', '6', 'R',
+    '^', 'D', 'J', 'G', '>', 'N', 'T', 'Q',
+    ',', '*', '5', '<', '-', 'U', '8', 'V',
+    '.', '%', '[', '$', '+', 'X', '!', '&',
+    ';', ':', '4', '\\', '0', 'Z', '7', '(',
+    '_', '?', 'W', ']', '#', 'Y', ')', '=',
+};
+
+namespace Braille {
+uint8_t brfToPattern(char c) {
+    return pgm_read_byte(&BRF_DECODE[(uint8_t)c]);
+}
+
+char patternToBrf(uint8_t pattern) {
+    return (char)pgm_read_byte(&BRF_ENCODE[pattern & 0x3F]);
+}
+}
+
+// ---------------------------------------------------------------------------
+// BrfReader
+// ---------------------------------------------------------------------------
+
+BrfReader::BrfReader()
+    : cells(nullptr), width(BRF_DEFAULT_WIDTH), linesPerPage(BRF_DEFAULT_LINES_PER_PAGE),
+      count(0), ready(false), open(false), pagePending(false),
+      lines(0), pages(0), pageFill(0), lineNumber(0), pageNumber(0), lineInPage(0),
+      invalid(0), pendingData(nullptr), pendingLength(0) {}
+
+void BrfReader::begin(uint8_t* buffer, uint8_t cellsPerLine, uint8_t pageLines) {
+    cells = buffer;
+    width = cellsPerLine ? cellsPerLine : 1;
+    linesPerPage = pageLines ? pageLines : 1;
+    count = 0;
+    ready = open = pagePending = false;
+    lines = pages = 0;
+    pageFill = 0;
+    lineNumber = pageNumber = 0;
+    lineInPage = 0;
+    invalid = 0;
+    pendingData = nullptr;
+    pendingLength = 0;
+    if (cells) memset(cells, 0, width);
+}
+
+uint16_t BrfReader::feed(const uint8_t* data, uint16_t length) {
+    if (ready || !cells || !data) return 0;
+
+    const uint8_t* p = data;
+    const uint8_t* end = data + length;
+    while (p < end) {
+        uint8_t code = pgm_read_byte(&BRF_DECODE[*p]);
+
+        if (code < 0x40) {
+            if (count >= width) {
+                if (code == 0) { p++; continue; }  // trailing blanks past the edge
+                endLine();                         // wrap, byte starts the next line
+                break;
+            }
+            cells[count++] = code;
+            open = true;
+            p++;
+            continue;
+        }
+
+        p++;
+        if (code == BRF_LINE_BREAK) {
+            endLine();
+            break;
+        }
+        if (code == BRF_PAGE_BREAK) {
+            pagePending = true;
+            if (open) {
+                endLine();
+                break;
+            }
+        } else if (code == BRF_INVALID) {
+            invalid++;
+        }
+    }
+    return p - data;
+}
+
+bool BrfReader::finish() {
+    if (!ready && open) endLine();
+    return ready;
+}
+
+void BrfReader::nextLine() {
+    if (cells) memset(cells, 0, count);
+    count = 0;
+    ready = false;
+}
+
+void BrfReader::endLine() {
+    // A form feed and a full page both start a new page, but only once
+    if (lines > 0 && (pagePending || pageFill >= linesPerPage)) {
+        pages++;
+        pageFill = 0;
+    }
+    pagePending = false;
+    open = false;
+    while (count > 0 && cells[count - 1] == 0) count--;  // trailing blanks
+
+    lineNumber = lines++;
+    pageNumber = pages;
+    lineInPage = pageFill++;
+    ready = true;
+}
+
+// ---------------------------------------------------------------------------
+// BrfWriter
+// ---------------------------------------------------------------------------
+
+BrfWriter::BrfWriter() : target(nullptr), writeFn(nullptr) {
+    reset(BRF_DEFAULT_WIDTH, BRF_DEFAULT_LINES_PER_PAGE);
+}
+
+void BrfWriter::reset(uint8_t cellsPerLine, uint8_t pageLines) {
+    used = 0;
+    width = cellsPerLine ? cellsPerLine : 1;
+    linesPerPage = pageLines ? pageLines : 1;
+    pageFill = 0;
+    lines = pages = 0;
+    dropped = 0;
+}
+
+void BrfWriter::writeLine(const uint8_t* cells, uint8_t n) {
+    if (!cells) n = 0;
+    while (n > 0 && cells[n - 1] == 0) n--;
+
+    uint8_t col = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        if (col == width) {
+            newline();
+            col = 0;
+        }
+        if (cells[i] & 0xC0) dropped++;
+        put(pgm_read_byte(&BRF_ENCODE[cells[i] & 0x3F]));
+        col++;
+    }
+    newline();
+}
+
+void BrfWriter::writePage(const uint8_t* frame, uint8_t rows) {
+    if (frame) {
+        for (uint8_t r = 0; r < rows; r++) {
+            writeLine(frame + (uint16_t)r * width, width);
+        }
+    }
+    endPage();
+}
+
+void BrfWriter::endPage() {
+    if (pageFill == 0) return;
+    put('\f');
+    pageFill = 0;
+    pages++;
+}
+
+void BrfWriter::end() {
+    endPage();
+    flush();
+}
+
+void BrfWriter::flush() {
+    if (used > 0 && writeFn) writeFn(target, buffer, used);
+    used = 0;
+}
+
+void BrfWriter::put(uint8_t b) {
+    if (used == BRF_WRITE_BUFFER) flush();
+    buffer[used++] = b;
+}
+
+void BrfWriter::newline() {
+    put('\r');
+    put('\n');
+    lines++;
+    if (++pageFill >= linesPerPage) endPage();
+}
@@ -0,0 +1,181 @@
+/*
+ * BrailleBrf.h
+ *
+ * Streaming import/export of BRF (Braille Ready Format) files
+ *
+ * BRF is the interchange format of embossers and braille libraries: plain
+ * North American ASCII braille, one character per 6-dot cell, lines ended
+ * by CR LF and pages by a form feed. Books are already formatted, so a BRF
+ * line maps directly onto a display line and a BRF page onto a layout frame
+ * (BrailleLayout::getPage).
+ *
+ *  - BrfReader decodes one line at a time into a caller-owned cell buffer.
+ *    State is a handful of counters, so memory use does not depend on the
+ *    size of the book. Input is fed in whatever chunks are at hand (SD
+ *    sectors from BrailleFileReader, or large fread() blocks on a PC); each
+ *    byte costs one lookup in a 256-entry table.
+ *  - BrfWriter encodes lines or whole frames back to BRF through a small
+ *    output buffer, inserting CR LF and form feeds.
+ *
+ * Patterns use the BrailleConverter bit order (bit 0 = dot 1 ... bit 5 =
+ * dot 6). BRF has no dots 7 and 8: the writer drops them and counts the
+ * cells that lost dots, so 8-dot capitals should be laid out with
+ * LAYOUT_CAPITAL_SIGN before export.
+ *
+ * Only <stdint.h>/<string.h> are required, so the same code builds into
+ * host tools.
+ */
+
+#ifndef BRAILLE_BRF_H
+#define BRAILLE_BRF_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define BRF_DEFAULT_WIDTH 40
+#define BRF_DEFAULT_LINES_PER_PAGE 25
+
+#ifndef BRF_WRITE_BUFFER
+#define BRF_WRITE_BUFFER 64  // bytes buffered by BrfWriter between sink writes
+#endif
+
+// Non-pattern results of Braille::brfToPattern()
+#define BRF_LINE_BREAK 0x80  // '\n'
+#define BRF_PAGE_BREAK 0x81  // form feed
+#define BRF_IGNORED    0x82  // '\r', SUB (0x1A) end-of-file marker
+#define BRF_INVALID    0x83  // anything else outside ASCII braille
+
+namespace Braille {
+// ASCII braille character to 6-dot pattern (0x00-0x3F). Lowercase letters
+// and `{|}~ read like their uppercase/@[\]^ forms. Control characters and
+// invalid bytes return one of the BRF_* codes above.
+uint8_t brfToPattern(char c);
+
+// 6-dot pattern to ASCII braille (uppercase forms). Dots 7/8 are ignored.
+char patternToBrf(uint8_t pattern);
+}
+
+class BrfReader {
+public:
+    BrfReader();
+
+    // `cells` receives each decoded line and must hold `width` bytes.
+    // Longer lines are wrapped; pages without a form feed end after
+    // `linesPerPage` lines.
+    void begin(uint8_t* cells, uint8_t width = BRF_DEFAULT_WIDTH,
+               uint8_t linesPerPage = BRF_DEFAULT_LINES_PER_PAGE);
+
+    // Decodes input until the current line is complete. Returns the number
+    // of bytes consumed; pass the rest again after the line was handled.
+    uint16_t feed(const uint8_t* data, uint16_t length);
+
+    // End of input: completes a last line that had no line break.
+    // Returns true if a line is ready.
+    bool finish();
+
+    bool lineReady() { return ready; }
+    void nextLine();                         // release the line, clear `cells`
+
+    uint8_t getCount() { return count; }     // cells used in the ready line
+    uint32_t getLine() { return lineNumber; }      // 0-based, whole book
+    uint32_t getPage() { return pageNumber; }      // 0-based
+    uint8_t getLineInPage() { return lineInPage; } // 0-based
+    bool startsPage() { return lineInPage == 0; }
+    uint32_t getInvalidCount() { return invalid; }
+
+    // Pulls the next line from a BrailleFileReader (or anything whose
+    // next() returns ByteSpan-like {data, length} runs). Returns false at
+    // the end of the file. Spans are only held until the next call.
+    template <class ReaderT>
+    bool readLine(ReaderT& reader) {
+        if (ready) nextLine();
+        while (!ready) {
+            if (pendingLength == 0) {
+                auto span = reader.next();
+                if (span.length == 0) return finish();
+                pendingData = span.data;
+                pendingLength = span.length;
+            }
+            uint16_t n = feed(pendingData, pendingLength);
+            pendingData += n;
+            pendingLength -= n;
+        }
+        return true;
+    }
+
+private:
+    uint8_t* cells;
+    uint8_t width;
+    uint8_t linesPerPage;
+    uint8_t count;
+    bool ready;
+    bool open;          // the current line has content
+    bool pagePending;   // a form feed was seen since the last line
+
+    uint32_t lines;     // lines completed so far
+    uint32_t pages;     // page the next line belongs to (before breaks)
+    uint8_t pageFill;   // lines already on that page
+    uint32_t lineNumber;
+    uint32_t pageNumber;
+    uint8_t lineInPage;
+    uint32_t invalid;
+
+    const uint8_t* pendingData;
+    uint16_t pendingLength;
+
+    void endLine();
+};
+
+class BrfWriter {
+public:
+    BrfWriter();
+
+    // Any sink with write(const uint8_t*, size_t): File, Serial, ...
+    template <class SinkT>
+    void begin(SinkT& sink, uint8_t width = BRF_DEFAULT_WIDTH,
+               uint8_t linesPerPage = BRF_DEFAULT_LINES_PER_PAGE) {
+        target = &sink;
+        writeFn = &writeThunk<SinkT>;
+        reset(width, linesPerPage);
+    }
+
+    // One line of patterns. Trailing blanks are trimmed, cells beyond the
+    // width wrap onto the next line. A form feed follows every full page.
+    void writeLine(const uint8_t* cells, uint8_t count);
+
+    // A frame as produced by BrailleLayout::getPage(): `lines` rows of
+    // `width` cells. Ends the page.
+    void writePage(const uint8_t* frame, uint8_t lines);
+
+    void endPage();   // form feed unless the page is empty
+    void end();       // end the last page and flush
+    void flush();
+
+    uint32_t getLineCount() { return lines; }
+    uint32_t getPageCount() { return pages; }
+    uint32_t getDroppedDotCells() { return dropped; }  // cells that had dots 7/8
+
+private:
+    uint8_t buffer[BRF_WRITE_BUFFER];
+    uint8_t used;
+    uint8_t width;
+    uint8_t linesPerPage;
+    uint8_t pageFill;
+    uint32_t lines;
+    uint32_t pages;
+    uint32_t dropped;
+
+    void* target;
+    void (*writeFn)(void* sink, const uint8_t* data, uint16_t n);
+
+    template <class SinkT>
+    static void writeThunk(void* sink, const uint8_t* data, uint16_t n) {
+        static_cast<SinkT*>(sink)->write(data, n);
+    }
+
+    void reset(uint8_t width, uint8_t linesPerPage);
+    void put(uint8_t b);
+    void newline();
+};
+
+#endif // BRAILLE_BRF_H
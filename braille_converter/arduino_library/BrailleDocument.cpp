@@ -0,0 +1,112 @@
+#include "BrailleDocument.h"
+#include <EEPROM.h>
+
+#define BOOKMARK_MAGIC 0xB00C
+
+BrailleDocument::BrailleDocument() : line(0) {
+    memset(&header, 0, sizeof(header));
+}
+
+bool BrailleDocument::seekPage(uint32_t page) {
+    if (page >= header.pageCount) return false;
+
+    // One read into the index, one seek to the page's first record
+    uint32_t offset;
+    if (!reader.seek(header.indexOffset + page * 4) || !readU32(&offset)) return false;
+    if (!reader.seek(offset)) return false;
+
+    line = page * header.linesPerPage;
+    return true;
+}
+
+bool BrailleDocument::seekLine(uint32_t target) {
+    if (target >= header.lineCount && target > 0) return false;
+    if (!seekPage(target / header.linesPerPage)) return false;
+
+    // Skip the records in front of the target inside its page
+    while (line < target) {
+        int n = reader.read();
+        if (n < 0 || !reader.seek(reader.position() + n)) return false;
+        line++;
+    }
+    return true;
+}
+
+uint8_t BrailleDocument::readLine(uint8_t* cells) {
+    if (!cells) return 0;
+    memset(cells, 0, header.width);
+    if (atEnd()) return 0;
+
+    int n = reader.read();
+    if (n < 0) return 0;
+
+    for (int i = 0; i < n; i++) {
+        int p = reader.read();
+        if (p < 0) return 0;
+        if (i < header.width) cells[i] = (uint8_t)p;
+    }
+    line++;
+    return n < header.width ? n : header.width;
+}
+
+void BrailleDocument::saveBookmark() {
+    DocumentBookmark bm;
+    bm.magic = BOOKMARK_MAGIC;
+    bm.docId = header.docId;
+    bm.line = line;
+    EEPROM.put(DOCUMENT_BOOKMARK_ADDR, bm);  // only changed bytes are written
+#if defined(ESP8266) || defined(ESP32)
+    EEPROM.commit();
+#endif
+}
+
+bool BrailleDocument::restoreBookmark() {
+    DocumentBookmark bm;
+    EEPROM.get(DOCUMENT_BOOKMARK_ADDR, bm);
+    if (bm.magic != BOOKMARK_MAGIC || bm.docId != header.docId) return false;
+    if (bm.line >= header.lineCount) return false;
+    return seekLine(bm.line);
+}
+
+bool BrailleDocument::readHeader() {
+    memset(&header, 0, sizeof(header));
+    line = 0;
+
+    uint8_t raw[DOCUMENT_HEADER_SIZE];
+    for (uint8_t i = 0; i < DOCUMENT_HEADER_SIZE; i++) {
+        int b = reader.read();
+        if (b < 0) return false;
+        raw[i] = (uint8_t)b;
+    }
+    if (memcmp(raw, "BRLD", 4) != 0 || raw[4] != DOCUMENT_VERSION) return false;
+    // Patterns from any other table would show as the wrong dots
+    if (raw[5] != DOCUMENT_TABLE_ASCII8) return false;
+
+    header.version = raw[4];
+    header.tableId = raw[5];
+    header.width = raw[6];
+    header.linesPerPage = raw[7];
+    header.flags = raw[8];
+
+    uint32_t* fields[] = {&header.docId, &header.lineCount, &header.pageCount,
+                          &header.indexOffset, &header.cellsOffset};
+    for (uint8_t f = 0; f < 5; f++) {
+        const uint8_t* p = raw + 12 + f * 4;
+        *fields[f] = (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+                     ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    if (header.width == 0 || header.linesPerPage == 0) return false;
+    return reader.seek(header.cellsOffset);
+}
+
+bool BrailleDocument::readU32(uint32_t* value) {
+    uint32_t v = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        int b = reader.read();
+        if (b < 0) return false;
+        v |= (uint32_t)b << (8 * i);
+    }
+    *value = v;
+    return true;
+}
@@ -0,0 +1,94 @@
+/*
+ * BrailleDocument.h
+ *
+ * Reader for pre-translated Braille documents (.brd)
+ *
+ * A .brd file is written on the host by braille/tools/bdoc.py: the text is
+ * already translated and wrapped into lines and pages (same rules as
+ * BrailleLayout), followed by a page index. Playback never re-translates,
+ * jumping to any page costs one index read plus the page itself, and the
+ * current line can be bookmarked in EEPROM so a restart resumes there.
+ *
+ * File layout (little-endian):
+ *   32-byte header | line records (u8 count + patterns) | u32 page index
+ */
+
+#ifndef BRAILLE_DOCUMENT_H
+#define BRAILLE_DOCUMENT_H
+
+#include <Arduino.h>
+#include "BrailleFileReader.h"
+
+#define DOCUMENT_VERSION 1
+#define DOCUMENT_HEADER_SIZE 32
+#define DOCUMENT_TABLE_ASCII8 1  // BrailleConverter::CHAR_TO_PATTERN
+
+#ifndef DOCUMENT_BOOKMARK_ADDR
+#define DOCUMENT_BOOKMARK_ADDR 0  // EEPROM offset of a DocumentBookmark
+#endif
+
+struct DocumentHeader {
+    uint8_t version;
+    uint8_t tableId;
+    uint8_t width;
+    uint8_t linesPerPage;
+    uint8_t flags;
+    uint32_t docId;
+    uint32_t lineCount;
+    uint32_t pageCount;
+    uint32_t indexOffset;
+    uint32_t cellsOffset;
+};
+
+// What saveBookmark() stores; sizeof(DocumentBookmark) bytes of EEPROM
+// from DOCUMENT_BOOKMARK_ADDR (call EEPROM.begin() with at least that on
+// ESP8266/ESP32)
+struct DocumentBookmark {
+    uint16_t magic;
+    uint32_t docId;
+    uint32_t line;
+};
+
+class BrailleDocument {
+public:
+    BrailleDocument();
+
+    // Reads and checks the header. Returns false if the file is not a .brd
+    // translated with DOCUMENT_TABLE_ASCII8.
+    template <class FileT>
+    bool begin(FileT& file) {
+        reader.begin(file);
+        return readHeader();
+    }
+
+    const DocumentHeader& getHeader() { return header; }
+    uint8_t getWidth() { return header.width; }
+    uint32_t getLineCount() { return header.lineCount; }
+    uint32_t getPageCount() { return header.pageCount; }
+
+    uint32_t getLine() { return line; }   // next line readLine() returns
+    uint32_t getPage() { return header.linesPerPage ? line / header.linesPerPage : 0; }
+
+    bool seekPage(uint32_t page);
+    bool seekLine(uint32_t target);
+
+    // Copies the next line's patterns into `cells` (getWidth() bytes,
+    // padded with blanks). Returns the used cell count, 0 at the end.
+    uint8_t readLine(uint8_t* cells);
+    bool atEnd() { return line >= header.lineCount; }
+
+    void saveBookmark();
+    bool restoreBookmark();
+
+    BrailleFileReader& getReader() { return reader; }
+
+private:
+    BrailleFileReader reader;
+    DocumentHeader header;
+    uint32_t line;
+
+    bool readHeader();
+    bool readU32(uint32_t* value);
+};
+
+#endif // BRAILLE_DOCUMENT_H
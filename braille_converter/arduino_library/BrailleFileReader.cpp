@@ -0,0 +1,134 @@
+#include "BrailleFileReader.h"
+
+BrailleFileReader::BrailleFileReader()
+    : front(0), pos(0), backReady(false), filePos(0), sourcePos(0),
+      fileSize(0), bytesRead(0), readMicros(0),
+      source(nullptr), readFn(nullptr), seekFn(nullptr) {
+    for (uint8_t i = 0; i < READER_BUFFERS; i++) lengths[i] = 0;
+}
+
+ByteSpan BrailleFileReader::next() {
+    if (pos >= lengths[front] && !advance()) return ByteSpan();
+
+    ByteSpan span(buffers[front] + pos, lengths[front] - pos);
+    pos = lengths[front];
+    filePos += span.length;
+    return span;
+}
+
+bool BrailleFileReader::prefetch() {
+#if READER_BUFFERS > 1
+    if (backReady || !source || sourcePos >= fileSize) return false;
+    fill(front ^ 1);
+    backReady = true;
+    return true;
+#else
+    return false;  // the only buffer is still being handed out
+#endif
+}
+
+int BrailleFileReader::read() {
+    if (pos >= lengths[front] && !advance()) return -1;
+    filePos++;
+    return buffers[front][pos++];
+}
+
+uint16_t BrailleFileReader::readLine(char* out, uint16_t size) {
+    if (!out || size == 0) return 0;
+
+    uint16_t n = 0;
+    for (;;) {
+        if (pos >= lengths[front] && !advance()) break;
+
+        // Scan the buffered sector directly instead of going byte by byte
+        const uint8_t* p = buffers[front] + pos;
+        const uint8_t* end = buffers[front] + lengths[front];
+        const uint8_t* nl = (const uint8_t*)memchr(p, '\n', end - p);
+        const uint8_t* stop = nl ? nl : end;
+
+        for (const uint8_t* q = p; q < stop; q++) {
+            if (*q != '\r' && n + 1 < size) out[n++] = (char)*q;
+        }
+
+        uint16_t consumed = (stop - p) + (nl ? 1 : 0);
+        pos += consumed;
+        filePos += consumed;
+        if (nl) break;
+    }
+    out[n] = '\0';
+    return n;
+}
+
+bool BrailleFileReader::seek(uint32_t position) {
+    if (!source || position > fileSize) return false;
+
+    // Still inside the front buffer: just move the cursor
+    uint32_t frontStart = filePos - pos;
+    if (position >= frontStart && position < frontStart + lengths[front]) {
+        pos = position - frontStart;
+        filePos = position;
+        return true;
+    }
+
+    // Sector-align the underlying seek so reads stay on sector boundaries
+    uint32_t aligned = position - (position % READER_BLOCK_SIZE);
+    if (!seekFn(source, aligned)) return false;
+    reset(aligned);
+
+    uint16_t skip = position - aligned;
+    if (skip > 0) {
+        if (!advance()) return false;
+        pos = skip;
+        filePos = position;
+    }
+    return true;
+}
+
+void BrailleFileReader::resetStats() {
+    bytesRead = 0;
+    readMicros = 0;
+}
+
+uint32_t BrailleFileReader::kbPerSecond(uint32_t bytes, uint32_t micros) {
+    if (micros == 0) return 0;
+    // bytes/us * 1e6 / 1024; bytes * 1e6 passes 32 bits at ~4 KB, so in 64
+    return (uint32_t)(((uint64_t)bytes * 1000000ULL) / ((uint64_t)micros * 1024ULL));
+}
+
+void BrailleFileReader::reset(uint32_t position) {
+    for (uint8_t i = 0; i < READER_BUFFERS; i++) lengths[i] = 0;
+    front = 0;
+    pos = 0;
+    backReady = false;
+    filePos = position;
+    sourcePos = position;
+}
+
+uint16_t BrailleFileReader::fill(uint8_t index) {
+    uint32_t start = micros();
+    int n = readFn(source, buffers[index], READER_BLOCK_SIZE);
+    readMicros += micros() - start;
+
+    if (n < 0) n = 0;
+    lengths[index] = n;
+    sourcePos += n;
+    bytesRead += n;
+    if (n < READER_BLOCK_SIZE) sourcePos = fileSize;  // short read: nothing more to get
+    return n;
+}
+
+bool BrailleFileReader::advance() {
+    if (!source) return false;
+#if READER_BUFFERS > 1
+    if (!backReady) prefetch();  // nobody prefetched: read synchronously
+    if (!backReady || lengths[front ^ 1] == 0) return false;
+
+    front ^= 1;
+    backReady = false;
+#else
+    // One buffer: the next sector replaces the current one
+    if (sourcePos >= fileSize || fill(front) == 0) return false;
+#endif
+    pos = 0;
+    return true;
+}
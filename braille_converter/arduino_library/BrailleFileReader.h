@@ -0,0 +1,119 @@
+/*
+ * BrailleFileReader.h
+ *
+ * Block-buffered, prefetching reader for SD card files
+ *
+ * Reading a File one byte at a time costs an SPI transaction per character.
+ * This reader pulls whole 512-byte sectors into a double buffer instead:
+ * the front buffer is handed to the converter as zero-copy spans while the
+ * back buffer is filled by prefetch(), which sketches call while a cell is
+ * dwelling so the next sector is already in RAM when it is needed.
+ *
+ * SRAM: READER_BUFFERS * READER_BLOCK_SIZE bytes plus about 30 bytes of
+ * state. On AVR the default is one buffer (512 bytes, a quarter of an
+ * Uno's 2 KB): the next sector is read when the current one runs out and
+ * prefetch() has nothing to do. Define READER_BUFFERS 2 on boards with the
+ * RAM to spare, or a smaller READER_BLOCK_SIZE to save more.
+ *
+ * Works with any file class that has read(void*, uint16_t), seek(uint32_t)
+ * and size() (SD, SdFat, ...), without depending on a particular library.
+ */
+
+#ifndef BRAILLE_FILE_READER_H
+#define BRAILLE_FILE_READER_H
+
+#include <Arduino.h>
+
+#ifndef READER_BLOCK_SIZE
+#define READER_BLOCK_SIZE 512  // one SD sector
+#endif
+
+#ifndef READER_BUFFERS
+#if defined(__AVR__)
+#define READER_BUFFERS 1       // 512 bytes of SRAM, no read-ahead
+#else
+#define READER_BUFFERS 2       // front buffer plus one prefetched sector
+#endif
+#endif
+
+// A run of bytes inside the reader's buffer. Valid until the next call
+// to next(), read(), readLine() or seek().
+struct ByteSpan {
+    const uint8_t* data;
+    uint16_t length;
+
+    ByteSpan() : data(nullptr), length(0) {}
+    ByteSpan(const uint8_t* d, uint16_t n) : data(d), length(n) {}
+};
+
+class BrailleFileReader {
+public:
+    BrailleFileReader();
+
+    template <class FileT>
+    void begin(FileT& file) {
+        source = &file;
+        readFn = &readThunk<FileT>;
+        seekFn = &seekThunk<FileT>;
+        fileSize = file.size();
+        resetStats();
+        reset(0);
+    }
+
+    // Rest of the current sector, without copying. Empty span at end of file.
+    ByteSpan next();
+
+    // Fills the back buffer if it is empty. Call while a cell dwells so the
+    // SD read overlaps with display time. Returns true if a sector was read;
+    // always false with READER_BUFFERS 1.
+    bool prefetch();
+
+    int read();                                  // -1 at end of file
+    uint16_t readLine(char* out, uint16_t size); // without '\r'/'\n', NUL-terminated
+    bool seek(uint32_t position);
+
+    uint32_t position() { return filePos; }
+    uint32_t size() { return fileSize; }
+    uint32_t available() { return fileSize - filePos; }
+    bool eof() { return filePos >= fileSize; }
+
+    // Throughput of the SD reads alone (bytes read / time inside read())
+    uint32_t getBytesRead() { return bytesRead; }
+    uint32_t getReadMicros() { return readMicros; }
+    uint32_t getReadKBps() { return kbPerSecond(bytesRead, readMicros); }
+    void resetStats();
+
+    static uint32_t kbPerSecond(uint32_t bytes, uint32_t micros);
+
+private:
+    uint8_t buffers[READER_BUFFERS][READER_BLOCK_SIZE];
+    uint16_t lengths[READER_BUFFERS];
+    uint8_t front;
+    uint16_t pos;          // read position inside the front buffer
+    bool backReady;
+    uint32_t filePos;      // logical position of the next byte handed out
+    uint32_t sourcePos;    // where the next sector read starts
+    uint32_t fileSize;
+
+    uint32_t bytesRead;
+    uint32_t readMicros;
+
+    void* source;
+    int (*readFn)(void* file, uint8_t* buf, uint16_t n);
+    bool (*seekFn)(void* file, uint32_t position);
+
+    template <class FileT>
+    static int readThunk(void* file, uint8_t* buf, uint16_t n) {
+        return static_cast<FileT*>(file)->read(buf, n);
+    }
+    template <class FileT>
+    static bool seekThunk(void* file, uint32_t position) {
+        return static_cast<FileT*>(file)->seek(position);
+    }
+
+    void reset(uint32_t position);
+    uint16_t fill(uint8_t index);
+    bool advance();
+};
+
+#endif // BRAILLE_FILE_READER_H
@@ -0,0 +1,332 @@
+#include "BrailleLayout.h"
+
+static bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+BrailleLayout::BrailleLayout(BrailleConverter& converter)
+    : converter(converter), text(nullptr), length(0), capacity(0),
+      width(40), linesPerPage(LAYOUT_DEFAULT_LINES_PER_PAGE),
+      indicators(LAYOUT_NUMBER_SIGN) {
+    invalidate();
+}
+
+void BrailleLayout::begin(char* buffer, uint16_t len, uint16_t cap) {
+    text = buffer;
+    length = len;
+    capacity = cap;
+    invalidate();
+}
+
+void BrailleLayout::setWidth(uint8_t cells) {
+    if (cells == 0) cells = 1;
+    if (cells == width) return;
+    width = cells;
+    invalidate();
+}
+
+void BrailleLayout::setLinesPerPage(uint8_t lines) {
+    // Pages are derived from line numbers, so the break cache stays valid
+    linesPerPage = lines ? lines : 1;
+}
+
+void BrailleLayout::setIndicators(uint8_t flags) {
+    if (flags == indicators) return;
+    indicators = flags;
+    invalidate();
+}
+
+uint16_t BrailleLayout::getLineCount() {
+    extendTo(0xFFFF);
+    return lineCount;
+}
+
+uint16_t BrailleLayout::getPageCount() {
+    uint16_t lines = getLineCount();
+    if (lines == 0) return 1;
+    return (lines + linesPerPage - 1) / linesPerPage;
+}
+
+uint16_t BrailleLayout::getLineStart(uint16_t line) {
+    uint16_t start = length;
+    seekLine(line, &start);
+    return start;
+}
+
+uint16_t BrailleLayout::getLineForOffset(uint16_t offset) {
+    while (!complete && frontierStart <= offset) extendTo(frontierLine);
+    if (breakCount == 0) return 0;
+
+    uint16_t k = 0;
+    while (k + 1 < breakCount && breaks[k + 1] <= offset) k++;
+
+    uint16_t line = k * stride;
+    uint16_t s = breaks[k];
+    for (;;) {
+        uint16_t next = nextLineStart(s, nullptr, nullptr);
+        if (next > offset || next >= length) return line;
+        s = next;
+        line++;
+    }
+}
+
+uint8_t BrailleLayout::getLine(uint16_t line, uint8_t* cells) {
+    if (!cells) return 0;
+    memset(cells, 0, width);
+
+    uint16_t start;
+    if (!seekLine(line, &start)) return 0;
+
+    uint8_t used = 0;
+    nextLineStart(start, cells, &used);
+    return used;
+}
+
+uint8_t BrailleLayout::getPage(uint16_t page, uint8_t* frame) {
+    if (!frame) return 0;
+    memset(frame, 0, (uint16_t)linesPerPage * width);
+
+    uint32_t first = (uint32_t)page * linesPerPage;
+    uint16_t s;
+    if (first > 0xFFFF || !seekLine((uint16_t)first, &s)) return 0;
+
+    uint8_t lines = 0;
+    while (lines < linesPerPage && s < length) {
+        uint8_t used;
+        s = nextLineStart(s, frame + (uint16_t)lines * width, &used);
+        lines++;
+    }
+    return lines;
+}
+
+bool BrailleLayout::insert(uint16_t pos, const char* s, uint16_t n) {
+    if (!text || !s) return false;
+    if (pos > length) pos = length;
+    if ((uint32_t)length + n + 1 > capacity) return false;
+
+    memmove(text + pos + n, text + pos, length - pos);
+    memcpy(text + pos, s, n);
+    length += n;
+    text[length] = '\0';
+
+    reflow(pos, pos, n);
+    return true;
+}
+
+bool BrailleLayout::erase(uint16_t pos, uint16_t n) {
+    if (!text || pos >= length) return false;
+    if (n > length - pos) n = length - pos;
+
+    memmove(text + pos, text + pos + n, length - pos - n);
+    length -= n;
+    text[length] = '\0';
+
+    reflow(pos, pos + n, -(int32_t)n);
+    return true;
+}
+
+void BrailleLayout::invalidate() {
+    breakCount = 0;
+    stride = 1;
+    frontierLine = 0;
+    frontierStart = 0;
+    complete = false;
+    lineCount = 0;
+}
+
+uint16_t BrailleLayout::nextLineStart(uint16_t start, uint8_t* cells, uint8_t* used) {
+    uint16_t pos = start;
+    uint8_t n = 0;
+    uint8_t tmp[3];
+
+    // Blanks at the start of a line are only left over after a hard
+    // newline (soft breaks consume them), so keep them as indentation.
+    while (pos < length && isBlank(text[pos])) {
+        if (text[pos] != '\r' && n < width) {
+            if (cells) cells[n] = 0x00;
+            n++;
+        }
+        pos++;
+    }
+
+    while (pos < length) {
+        char c = text[pos];
+        if (c == '\n') {
+            pos++;
+            break;
+        }
+
+        if (isBlank(c)) {
+            uint16_t ws = pos;
+            uint8_t gap = 0;
+            while (ws < length && isBlank(text[ws])) {
+                if (text[ws] != '\r' && gap < width) gap++;
+                ws++;
+            }
+            // Trailing blanks before a newline or the end are dropped
+            if (ws >= length || text[ws] == '\n') {
+                pos = ws;
+                continue;
+            }
+            uint16_t need = gap + measureWord(ws, wordEnd(ws));
+            if (n + need > width) {
+                pos = ws;  // soft break: the next line starts at the word
+                break;
+            }
+            for (uint8_t i = 0; i < gap; i++) {
+                if (cells) cells[n] = 0x00;
+                n++;
+            }
+            pos = ws;
+        }
+
+        uint16_t end = wordEnd(pos);
+        bool fits = n + measureWord(pos, end) <= width;
+        if (!fits && n > 0) break;
+
+        // Emit the word; a word wider than the whole line is cut at the edge
+        char prev = 0;
+        while (pos < end) {
+            uint8_t k = charCells(prev, text[pos], tmp);
+            if (n + k > width) {
+                if (n > 0) break;
+                tmp[0] = tmp[k - 1];  // line too narrow for indicator + char
+                k = 1;
+            }
+            for (uint8_t i = 0; i < k; i++) {
+                if (cells) cells[n] = tmp[i];
+                n++;
+            }
+            prev = text[pos++];
+        }
+        if (!fits) break;
+    }
+
+    if (used) *used = n;
+    return pos;
+}
+
+uint8_t BrailleLayout::charCells(char prev, char c, uint8_t* out) {
+    uint8_t n = 0;
+    if ((indicators & LAYOUT_NUMBER_SIGN) && isDigit(c) && !isDigit(prev)) {
+        out[n++] = NUMBER_SIGN_PATTERN;
+    }
+    uint8_t pattern = converter.getDotPattern(c);
+    if ((indicators & LAYOUT_CAPITAL_SIGN) && c >= 'A' && c <= 'Z') {
+        out[n++] = CAPITAL_SIGN_PATTERN;
+        pattern &= ~0x40;
+    }
+    out[n++] = pattern;
+    return n;
+}
+
+uint16_t BrailleLayout::wordEnd(uint16_t pos) {
+    while (pos < length && !isBlank(text[pos]) && text[pos] != '\n') pos++;
+    return pos;
+}
+
+uint16_t BrailleLayout::measureWord(uint16_t from, uint16_t to) {
+    uint8_t tmp[3];
+    uint16_t cells = 0;
+    char prev = 0;
+    for (uint16_t i = from; i < to; i++) {
+        cells += charCells(prev, text[i], tmp);
+        prev = text[i];
+    }
+    return cells;
+}
+
+bool BrailleLayout::seekLine(uint16_t line, uint16_t* start) {
+    extendTo(line);
+    if (line >= frontierLine) return false;
+
+    uint16_t s = breaks[line / stride];
+    for (uint16_t i = line % stride; i > 0; i--) {
+        s = nextLineStart(s, nullptr, nullptr);
+    }
+    *start = s;
+    return true;
+}
+
+void BrailleLayout::extendTo(uint16_t line) {
+    if (!text) {
+        complete = true;
+        return;
+    }
+    while (!complete && frontierLine <= line) {
+        if (frontierStart >= length) {
+            complete = true;
+            lineCount = frontierLine;
+            break;
+        }
+        if (frontierLine % stride == 0) pushBreak(frontierStart);
+        frontierStart = nextLineStart(frontierStart, nullptr, nullptr);
+        frontierLine++;
+    }
+}
+
+void BrailleLayout::pushBreak(uint16_t start) {
+    if (breakCount == LAYOUT_BREAK_SLOTS) {
+        // Table full: keep every other entry and double the stride.
+        // The line being pushed is a multiple of the new stride as well.
+        for (uint16_t i = 0; i < LAYOUT_BREAK_SLOTS / 2; i++) {
+            breaks[i] = breaks[2 * i];
+        }
+        breakCount = LAYOUT_BREAK_SLOTS / 2;
+        stride *= 2;
+    }
+    breaks[breakCount++] = start;
+}
+
+void BrailleLayout::reflow(uint16_t pos, uint16_t oldEnd, int32_t delta) {
+    if (breakCount == 0) {
+        invalidate();
+        return;
+    }
+
+    // Restart one slot before the edit: the line in front of the edited
+    // one may now have room for its first word.
+    uint16_t k = 0;
+    while (k + 1 < breakCount && breaks[k + 1] < pos) k++;
+    if (k > 0) k--;
+
+    uint16_t oldCount = breakCount;
+    uint16_t oldFrontier = frontierLine;
+    bool oldComplete = complete;
+    uint16_t oldLineCount = lineCount;
+
+    uint16_t line = k * stride;
+    uint16_t s = breaks[k];
+    complete = false;
+
+    for (;;) {
+        if (s >= length) {
+            complete = true;
+            lineCount = line;
+            break;
+        }
+        if (line >= oldFrontier) break;
+
+        s = nextLineStart(s, nullptr, nullptr);
+        line++;
+
+        if (line % stride == 0) {
+            uint16_t j = line / stride;
+            if (j >= oldCount) break;
+
+            // Same line number starting at the same (shifted) text as
+            // before the edit: everything from here on is unchanged.
+            if (breaks[j] >= oldEnd && (int32_t)breaks[j] + delta == s) {
+                for (uint16_t m = j; m < oldCount; m++) breaks[m] += delta;
+                frontierStart += delta;
+                complete = oldComplete;
+                lineCount = oldLineCount;
+                return;
+            }
+            breaks[j] = s;
+        }
+    }
+
+    frontierLine = line;
+    frontierStart = s;
+    breakCount = (line + stride - 1) / stride;
+}
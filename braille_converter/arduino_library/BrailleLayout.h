@@ -0,0 +1,106 @@
+/*
+ * BrailleLayout.h
+ *
+ * Line layout for multi-cell Braille displays (20/32/40 cells, ...)
+ *
+ * Sits on top of BrailleConverter: takes a text buffer and a display width
+ * in cells and produces wrapped lines and page frames of dot patterns.
+ *
+ *  - Words are never split unless a single word is wider than the line.
+ *  - Indicator cells (number sign, optional capital sign) are counted in
+ *    the line width and kept together with the character they announce.
+ *  - Every line is laid out from its start offset alone, so the only state
+ *    worth caching is where each line starts. Those offsets are kept in a
+ *    fixed table of LAYOUT_BREAK_SLOTS entries; when the document outgrows
+ *    the table, every other entry is dropped and the stride doubles.
+ *  - Layout is lazy: changing the width or jumping to page K only lays out
+ *    the lines up to that page, never the whole document.
+ *  - insert()/erase() edit the text in place and reflow only until the new
+ *    line starts line up with the old ones again.
+ */
+
+#ifndef BRAILLE_LAYOUT_H
+#define BRAILLE_LAYOUT_H
+
+#include "BrailleConverter.h"
+
+#ifndef LAYOUT_BREAK_SLOTS
+#if defined(__AVR__)
+#define LAYOUT_BREAK_SLOTS 32     // 64 bytes of SRAM
+#else
+#define LAYOUT_BREAK_SLOTS 256
+#endif
+#endif
+
+#define LAYOUT_DEFAULT_LINES_PER_PAGE 25  // BRF/embosser page height
+
+// Indicator options
+#define LAYOUT_NUMBER_SIGN  0x01  // dots 3,4,5,6 before a run of digits
+#define LAYOUT_CAPITAL_SIGN 0x02  // dot 6 before uppercase, dot 7 dropped (6-dot mode)
+
+#define NUMBER_SIGN_PATTERN  0x3C
+#define CAPITAL_SIGN_PATTERN 0x20
+
+class BrailleLayout {
+public:
+    BrailleLayout(BrailleConverter& converter);
+
+    // The text buffer is owned by the caller; insert() may grow it up to capacity.
+    void begin(char* text, uint16_t length, uint16_t capacity);
+
+    void setWidth(uint8_t cells);
+    void setLinesPerPage(uint8_t lines);
+    void setIndicators(uint8_t flags);
+    uint8_t getWidth() { return width; }
+    uint8_t getLinesPerPage() { return linesPerPage; }
+
+    uint16_t getLineCount();
+    uint16_t getPageCount();
+    uint16_t getLineStart(uint16_t line);
+    uint16_t getLineForOffset(uint16_t offset);
+
+    // Fills `cells` with up to getWidth() patterns, padded with blanks.
+    // Returns the number of cells actually used by the line.
+    uint8_t getLine(uint16_t line, uint8_t* cells);
+
+    // Fills `frame` with getLinesPerPage() * getWidth() patterns.
+    // Returns the number of text lines on the page.
+    uint8_t getPage(uint16_t page, uint8_t* frame);
+
+    // Incremental editing; returns false if the buffer would overflow.
+    bool insert(uint16_t pos, const char* s, uint16_t n);
+    bool erase(uint16_t pos, uint16_t n);
+
+    uint16_t getLength() { return length; }
+
+private:
+    BrailleConverter& converter;
+    char* text;
+    uint16_t length;
+    uint16_t capacity;
+
+    uint8_t width;
+    uint8_t linesPerPage;
+    uint8_t indicators;
+
+    // breaks[i] is the start offset of line i * stride
+    uint16_t breaks[LAYOUT_BREAK_SLOTS];
+    uint16_t breakCount;
+    uint16_t stride;
+    uint16_t frontierLine;   // first line not laid out yet
+    uint16_t frontierStart;  // ...and where it starts
+    bool complete;           // layout has reached the end of the text
+    uint16_t lineCount;      // valid when complete
+
+    void invalidate();
+    uint16_t nextLineStart(uint16_t start, uint8_t* cells, uint8_t* used);
+    uint8_t charCells(char prev, char c, uint8_t* out);
+    uint16_t wordEnd(uint16_t pos);
+    uint16_t measureWord(uint16_t from, uint16_t to);
+    bool seekLine(uint16_t line, uint16_t* start);
+    void extendTo(uint16_t line);
+    void pushBreak(uint16_t start);
+    void reflow(uint16_t pos, uint16_t oldEnd, int32_t delta);
+};
+
+#endif // BRAILLE_LAYOUT_H
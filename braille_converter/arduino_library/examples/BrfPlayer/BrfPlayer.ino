@@ -0,0 +1,157 @@
+/*
+ * BrfPlayer.ino
+ *
+ * Plays a BRF (Braille Ready Format) book from an SD card
+ *
+ * BRF files from braille libraries and embosser software are already
+ * translated and formatted, so every character maps straight onto one
+ * cell: nothing is converted on the device, and the file is decoded a
+ * line at a time without loading it into RAM.
+ *
+ * Copy the book to the card as BOOK.BRF. Serial commands (115200 baud):
+ *   n  - skip to the next page
+ *   r  - restart from the beginning
+ *
+ * Hardware Requirements:
+ * - SD card module (CS pin 10)
+ * - 8 output pins for Braille dots (pins 2-9)
+ */
+
+#include <BrailleBrf.h>
+#include <BrailleFileReader.h>
+#include <SD.h>
+
+BrailleFileReader reader;
+BrfReader brf;
+File file;
+
+const int CS_PIN = 10;
+const char* BOOK_FILE = "BOOK.BRF";
+
+// 8-dot Braille hardware pins (bit 0 = dot 1 ... bit 7 = dot 8)
+const uint8_t DOT_PINS[8] = {2, 3, 4, 5, 6, 7, 8, 9};
+
+const uint16_t CHAR_DISPLAY_TIME = 1000;
+const uint16_t CLEAR_TIME = 200;
+
+// Standard BRF page: 40 cells x 25 lines
+const uint8_t LINE_WIDTH = 40;
+const uint8_t LINES_PER_PAGE = 25;
+
+uint8_t cells[LINE_WIDTH];
+bool lineLoaded = false;  // a line was already read ahead by a command
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    ; // Wait for serial port
+  }
+
+  for (uint8_t i = 0; i < 8; i++) {
+    pinMode(DOT_PINS[i], OUTPUT);
+    digitalWrite(DOT_PINS[i], LOW);
+  }
+
+  if (!SD.begin(CS_PIN)) {
+    Serial.println("ERROR: SD card initialization failed!");
+    while (1) delay(1000);
+  }
+
+  file = SD.open(BOOK_FILE);
+  if (!file) {
+    Serial.print("ERROR: Could not open ");
+    Serial.println(BOOK_FILE);
+    while (1) delay(1000);
+  }
+
+  restart();
+  Serial.print("Playing ");
+  Serial.print(BOOK_FILE);
+  Serial.print(" (");
+  Serial.print(file.size());
+  Serial.println(" bytes)");
+}
+
+void loop() {
+  if (!lineLoaded && !brf.readLine(reader)) {
+    Serial.println("End of book.");
+    if (brf.getInvalidCount() > 0) {
+      Serial.print(brf.getInvalidCount());
+      Serial.println(" bytes were not ASCII braille and were skipped");
+    }
+    delay(5000);
+    restart();
+    return;
+  }
+  lineLoaded = false;
+
+  if (brf.startsPage()) {
+    Serial.print("--- Page ");
+    Serial.print(brf.getPage() + 1);
+    Serial.println(" ---");
+  }
+
+  Serial.print("Line ");
+  Serial.print(brf.getLineInPage() + 1);
+  Serial.print(": ");
+  for (uint8_t i = 0; i < brf.getCount(); i++) {
+    Serial.print(Braille::patternToBrf(cells[i]));
+  }
+  Serial.println();
+
+  for (uint8_t i = 0; i < brf.getCount(); i++) {
+    displayPattern(cells[i]);
+    // The next sector loads while the cell dwells
+    reader.prefetch();
+    delay(CHAR_DISPLAY_TIME);
+    clearDisplay();
+    delay(CLEAR_TIME);
+
+    if (handleCommands()) return;
+  }
+}
+
+void restart() {
+  file.seek(0);
+  reader.begin(file);
+  brf.begin(cells, LINE_WIDTH, LINES_PER_PAGE);
+  lineLoaded = false;
+}
+
+/**
+ * Returns true if the reading position was changed.
+ */
+bool handleCommands() {
+  if (Serial.available() == 0) return false;
+
+  char c = Serial.read();
+  if (c == 'r') {
+    restart();
+    return true;
+  }
+  if (c == 'n') {
+    // Pages are only known by reading through them
+    uint32_t page = brf.getPage();
+    while (brf.readLine(reader)) {
+      if (brf.getPage() != page) {
+        // Keep the first line of the new page for loop() to show
+        lineLoaded = true;
+        return true;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+void displayPattern(uint8_t pattern) {
+  for (uint8_t i = 0; i < 8; i++) {
+    digitalWrite(DOT_PINS[i], (pattern & (1 << i)) ? HIGH : LOW);
+  }
+}
+
+void clearDisplay() {
+  for (uint8_t i = 0; i < 8; i++) {
+    digitalWrite(DOT_PINS[i], LOW);
+  }
+}
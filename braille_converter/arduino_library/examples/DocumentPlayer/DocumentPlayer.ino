@@ -0,0 +1,172 @@
+/*
+ * DocumentPlayer.ino
+ *
+ * Plays a pre-translated Braille document (.brd) from an SD card
+ *
+ * Unlike FileToHardware, nothing is translated on the device: the host
+ * writes the document once with
+ *
+ *   python braille/tools/bdoc.py book.txt -o BOOK.BRD --width 20
+ *
+ * and the sketch streams the stored patterns to the cell. Any page can be
+ * reached with a single index lookup, and the bookmark in EEPROM is
+ * updated whenever a page starts or the reader moves, so a power cycle
+ * resumes at the top of the page being read. Saving once per page rather
+ * than per line keeps EEPROM wear (about 100,000 writes per cell) and the
+ * ESP flash commits down.
+ *
+ * Serial commands (115200 baud):
+ *   g<page>  - go to page (1-based), e.g. "g50"
+ *   n / p    - next / previous page
+ *   r        - restart from the beginning
+ *
+ * Hardware Requirements:
+ * - SD card module (CS pin 10)
+ * - 8 output pins for Braille dots (pins 2-9)
+ */
+
+#include <BrailleDocument.h>
+#include <EEPROM.h>
+#include <SD.h>
+
+BrailleDocument document;
+File file;
+
+const int CS_PIN = 10;
+const char* DOCUMENT_FILE = "BOOK.BRD";
+
+// 8-dot Braille hardware pins (bit 0 = dot 1 ... bit 7 = dot 8)
+const uint8_t DOT_PINS[8] = {2, 3, 4, 5, 6, 7, 8, 9};
+
+const uint16_t CHAR_DISPLAY_TIME = 1000;
+const uint16_t CLEAR_TIME = 200;
+
+const uint8_t MAX_WIDTH = 40;
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    ; // Wait for serial port
+  }
+
+#if defined(ESP8266) || defined(ESP32)
+  // EEPROM is emulated in flash here and must be sized before use
+  EEPROM.begin(DOCUMENT_BOOKMARK_ADDR + sizeof(DocumentBookmark));
+#endif
+
+  for (uint8_t i = 0; i < 8; i++) {
+    pinMode(DOT_PINS[i], OUTPUT);
+    digitalWrite(DOT_PINS[i], LOW);
+  }
+
+  if (!SD.begin(CS_PIN)) {
+    Serial.println("ERROR: SD card initialization failed!");
+    while (1) delay(1000);
+  }
+
+  file = SD.open(DOCUMENT_FILE);
+  if (!file || !document.begin(file)) {
+    Serial.print("ERROR: ");
+    Serial.print(DOCUMENT_FILE);
+    Serial.println(" is missing or not a .brd document");
+    while (1) delay(1000);
+  }
+
+  if (document.getWidth() > MAX_WIDTH) {
+    Serial.println("ERROR: document is wider than MAX_WIDTH cells");
+    while (1) delay(1000);
+  }
+
+  Serial.print("Document: ");
+  Serial.print(document.getLineCount());
+  Serial.print(" lines, ");
+  Serial.print(document.getPageCount());
+  Serial.print(" pages, ");
+  Serial.print(document.getWidth());
+  Serial.println(" cells per line");
+
+  if (document.restoreBookmark()) {
+    Serial.print("Resuming at page ");
+    Serial.print(document.getPage() + 1);
+    Serial.print(", line ");
+    Serial.println(document.getLine() + 1);
+  }
+}
+
+void loop() {
+  handleCommands();
+
+  if (document.atEnd()) {
+    Serial.println("End of document.");
+    document.seekLine(0);
+    document.saveBookmark();
+    delay(5000);
+    return;
+  }
+
+  uint8_t cells[MAX_WIDTH];
+  uint32_t lineNumber = document.getLine();
+
+  // Remember each new page so a restart comes back to it
+  if (lineNumber % document.getHeader().linesPerPage == 0) {
+    document.saveBookmark();
+  }
+  uint8_t used = document.readLine(cells);
+
+  Serial.print("Page ");
+  Serial.print(lineNumber / document.getHeader().linesPerPage + 1);
+  Serial.print(", line ");
+  Serial.println(lineNumber + 1);
+
+  for (uint8_t i = 0; i < used; i++) {
+    displayPattern(cells[i]);
+    // The next sector loads while the cell dwells
+    document.getReader().prefetch();
+    delay(CHAR_DISPLAY_TIME);
+    clearDisplay();
+    delay(CLEAR_TIME);
+
+    if (handleCommands()) return;
+  }
+}
+
+/**
+ * Returns true if the reading position was changed.
+ */
+bool handleCommands() {
+  if (Serial.available() == 0) return false;
+
+  char c = Serial.read();
+  uint32_t page = document.getPage();
+  bool moved = false;
+
+  if (c == 'g') {
+    long target = Serial.parseInt();
+    moved = target > 0 && document.seekPage(target - 1);
+  } else if (c == 'n') {
+    moved = document.seekPage(page + 1);
+  } else if (c == 'p' && page > 0) {
+    moved = document.seekPage(page - 1);
+  } else if (c == 'r') {
+    moved = document.seekLine(0);
+  }
+
+  if (moved) {
+    document.saveBookmark();
+    Serial.print("-> page ");
+    Serial.println(document.getPage() + 1);
+  }
+  return moved;
+}
+
+void displayPattern(uint8_t pattern) {
+  for (uint8_t i = 0; i < 8; i++) {
+    digitalWrite(DOT_PINS[i], (pattern & (1 << i)) ? HIGH : LOW);
+  }
+}
+
+void clearDisplay() {
+  for (uint8_t i = 0; i < 8; i++) {
+    digitalWrite(DOT_PINS[i], LOW);
+  }
+}
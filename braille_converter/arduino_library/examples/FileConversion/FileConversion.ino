@@ -4,14 +4,26 @@
  * Example for reading text from an SD card (or other storage)
  * and converting it to Braille
  * 
+ * The file is read a whole 512-byte sector at a time through
+ * BrailleFileReader, and lines are built in a fixed char buffer,
+ * so there is no per-byte SPI traffic and no String on the heap.
+ * 
  * Note: Requires SD card module and SD library
  * Adjust the CS_PIN for your SD card module
  */
 
 #include <BrailleConverter.h>
+#include <BrailleFileReader.h>
 #include <SD.h>
 
 BrailleConverter converter;
+BrailleFileReader reader;
+
+// Longest line kept; longer lines are truncated
+const uint16_t LINE_BUFFER_SIZE = MAX_INPUT_LENGTH + 1;
+
+// Time spent in the converter, for the throughput report
+uint32_t convertMicros = 0;
 
 // SD card chip select pin (adjust for your hardware)
 const int CS_PIN = 10;
@@ -80,62 +92,49 @@ void convertFile(const char* filename) {
   
   uint32_t totalChars = 0;
   uint16_t lineNumber = 1;
+  char line[LINE_BUFFER_SIZE];
   
-  String line = "";
+  reader.begin(file);
+  convertMicros = 0;
   
-  while (file.available()) {
-    char c = file.read();
+  while (!reader.eof()) {
+    uint16_t length = reader.readLine(line, sizeof(line));
     
-    if (c == '\n') {
-      // Process the line
-      if (line.length() > 0) {
-        Serial.print("Line ");
-        Serial.print(lineNumber);
-        Serial.print(": \"");
-        Serial.print(line);
-        Serial.println("\"");
-        
-        processLine(line);
-        totalChars += line.length();
-        lineNumber++;
-        
-        Serial.println();
-      }
-      line = "";
-    } else if (c != '\r') {
-      line += c;
+    // Process the line
+    if (length > 0) {
+      Serial.print("Line ");
+      Serial.print(lineNumber);
+      Serial.print(": \"");
+      Serial.print(line);
+      Serial.println("\"");
+      
+      processLine(line);
+      totalChars += length;
+      lineNumber++;
+      
+      Serial.println();
     }
   }
   
-  // Process last line if no trailing newline
-  if (line.length() > 0) {
-    Serial.print("Line ");
-    Serial.print(lineNumber);
-    Serial.print(": \"");
-    Serial.print(line);
-    Serial.println("\"");
-    
-    processLine(line);
-    totalChars += line.length();
-    
-    Serial.println();
-  }
-  
   file.close();
   
   Serial.println("========================================");
   Serial.print("Conversion complete! Processed ");
   Serial.print(totalChars);
   Serial.println(" characters.");
+  Serial.print("SD read:  ");
+  Serial.print(reader.getReadKBps());
+  Serial.println(" KB/s");
+  Serial.print("Convert:  ");
+  Serial.print(BrailleFileReader::kbPerSecond(totalChars, convertMicros));
+  Serial.println(" KB/s");
   Serial.println("========================================");
 }
 
-void processLine(String line) {
-  // Convert to char array
-  char buffer[256];
-  line.toCharArray(buffer, 256);
-  
-  uint16_t count = converter.convertText(buffer);
+void processLine(const char* line) {
+  uint32_t start = micros();
+  uint16_t count = converter.convertText(line);
+  convertMicros += micros() - start;
   
   // Display conversion summary
   Serial.print("  Converted ");
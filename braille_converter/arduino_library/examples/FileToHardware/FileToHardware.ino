@@ -4,7 +4,7 @@
  * Complete example: Read .txt file from SD card and display on 8-dot Braille hardware
  * 
  * This demonstrates the COMPLETE workflow:
- * 1. Read text from .txt file on SD card
+ * 1. Read text from .txt file on SD card (a 512-byte sector at a time)
  * 2. Convert each character to 8-bit Braille pattern
  * 3. Output directly to 8 Arduino pins (for solenoids/actuators)
  * 
@@ -17,9 +17,11 @@
  */
 
 #include <BrailleConverter.h>
+#include <BrailleFileReader.h>
 #include <SD.h>
 
 BrailleConverter converter;
+BrailleFileReader reader;
 
 // SD card configuration
 const int CS_PIN = 10;
@@ -115,59 +117,68 @@ void processFileToHardware(const char* filename) {
   Serial.println();
   
   uint32_t charNumber = 0;
+  uint32_t convertMicros = 0;
   
-  // Read and process each character from file
-  while (file.available()) {
-    char c = file.read();
-    
-    // Skip newlines and carriage returns for display
-    if (c == '\n' || c == '\r') {
-      Serial.println("[newline]");
-      continue;
-    }
-    
-    charNumber++;
-    
-    // Convert character to 8-bit Braille pattern
-    BrailleChar bc = converter.convertChar(c);
-    
-    // Display information
-    Serial.print("[");
-    Serial.print(charNumber);
-    Serial.print("] '");
-    Serial.print(c);
-    Serial.print("' -> ");
-    
-    // Show 8-bit pattern in binary and hex
-    Serial.print("0x");
-    if (bc.dotPattern < 0x10) Serial.print("0");
-    Serial.print(bc.dotPattern, HEX);
-    Serial.print(" (0b");
-    for (int8_t i = 7; i >= 0; i--) {
-      Serial.print((bc.dotPattern >> i) & 1);
-    }
-    Serial.print(") -> Dots: [");
-    
-    // Show which dots are raised
-    if (bc.dotCount == 0) {
-      Serial.print("none");
-    } else {
-      for (uint8_t i = 0; i < bc.dotCount; i++) {
-        Serial.print(bc.dots[i]);
-        if (i < bc.dotCount - 1) Serial.print(",");
+  reader.begin(file);
+  
+  // Read and process each character from file, one buffered sector at a time
+  ByteSpan span;
+  while ((span = reader.next()).length > 0) {
+    for (uint16_t k = 0; k < span.length; k++) {
+      char c = (char)span.data[k];
+      
+      // Skip newlines and carriage returns for display
+      if (c == '\n' || c == '\r') {
+        Serial.println("[newline]");
+        continue;
       }
+      
+      charNumber++;
+      
+      // Convert character to 8-bit Braille pattern
+      uint32_t start = micros();
+      BrailleChar bc = converter.convertChar(c);
+      convertMicros += micros() - start;
+      
+      // Display information
+      Serial.print("[");
+      Serial.print(charNumber);
+      Serial.print("] '");
+      Serial.print(c);
+      Serial.print("' -> ");
+      
+      // Show 8-bit pattern in binary and hex
+      Serial.print("0x");
+      if (bc.dotPattern < 0x10) Serial.print("0");
+      Serial.print(bc.dotPattern, HEX);
+      Serial.print(" (0b");
+      for (int8_t i = 7; i >= 0; i--) {
+        Serial.print((bc.dotPattern >> i) & 1);
+      }
+      Serial.print(") -> Dots: [");
+      
+      // Show which dots are raised
+      if (bc.dotCount == 0) {
+        Serial.print("none");
+      } else {
+        for (uint8_t i = 0; i < bc.dotCount; i++) {
+          Serial.print(bc.dots[i]);
+          if (i < bc.dotCount - 1) Serial.print(",");
+        }
+      }
+      Serial.println("]");
+      
+      // OUTPUT TO HARDWARE: Send 8-bit pattern to Arduino pins
+      displayPattern8Bit(bc.dotPattern);
+      
+      // Hold for viewing; load the next sector while the cell dwells
+      reader.prefetch();
+      delay(CHAR_DISPLAY_TIME);
+      
+      // Clear between characters
+      clearDisplay();
+      delay(CLEAR_TIME);
     }
-    Serial.println("]");
-    
-    // OUTPUT TO HARDWARE: Send 8-bit pattern to Arduino pins
-    displayPattern8Bit(bc.dotPattern);
-    
-    // Hold for viewing
-    delay(CHAR_DISPLAY_TIME);
-    
-    // Clear between characters
-    clearDisplay();
-    delay(CLEAR_TIME);
   }
   
   file.close();
@@ -176,6 +187,11 @@ void processFileToHardware(const char* filename) {
   Serial.print("Processed ");
   Serial.print(charNumber);
   Serial.println(" characters from file.");
+  Serial.print("SD read: ");
+  Serial.print(reader.getReadKBps());
+  Serial.print(" KB/s, convert: ");
+  Serial.print(BrailleFileReader::kbPerSecond(charNumber, convertMicros));
+  Serial.println(" KB/s");
 }
 
 /**
@@ -234,20 +250,20 @@ void processFileBuffered(const char* filename) {
   File file = SD.open(filename);
   if (!file) return;
   
-  // Read entire file into string
-  String fileContent = "";
-  while (file.available()) {
-    char c = file.read();
+  // Read the file into a fixed buffer (no String, no heap)
+  char buffer[MAX_INPUT_LENGTH + 1];
+  uint16_t length = 0;
+  
+  reader.begin(file);
+  int c;
+  while (length < MAX_INPUT_LENGTH && (c = reader.read()) >= 0) {
     if (c != '\n' && c != '\r') {
-      fileContent += c;
+      buffer[length++] = (char)c;
     }
   }
+  buffer[length] = '\0';
   file.close();
   
-  // Convert to char array
-  char buffer[256];
-  fileContent.toCharArray(buffer, 256);
-  
   // Convert all at once
   uint16_t count = converter.convertText(buffer);
   
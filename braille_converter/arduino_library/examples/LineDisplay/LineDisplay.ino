@@ -0,0 +1,106 @@
+/*
+ * LineDisplay.ino
+ *
+ * Example for laying out text on a multi-cell Braille line display
+ *
+ * Wraps a paragraph to a 20-cell line, prints each page to the Serial
+ * Monitor, then edits the text in place and shows the reflowed result.
+ *
+ * Serial commands:
+ *   n      - next page
+ *   p      - previous page
+ *   w<num> - change the line width (e.g. "w32")
+ */
+
+#include <BrailleConverter.h>
+#include <BrailleLayout.h>
+
+BrailleConverter converter;
+BrailleLayout layout(converter);
+
+const uint8_t MAX_WIDTH = 40;
+const uint8_t LINES_PER_PAGE = 4;
+
+char text[256] =
+  "Braille displays show one line at a time, so text has to be wrapped "
+  "without breaking words. Room 101 is on floor 3.";
+
+uint16_t page = 0;
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    ; // Wait for serial port to connect
+  }
+
+  Serial.println("========================================");
+  Serial.println("  BrailleLayout Line Display Example");
+  Serial.println("========================================");
+  Serial.println();
+
+  layout.begin(text, strlen(text), sizeof(text));
+  layout.setWidth(20);
+  layout.setLinesPerPage(LINES_PER_PAGE);
+
+  showPage();
+
+  // Incremental edit: only the affected lines are laid out again
+  const char* extra = " Please knock.";
+  layout.insert(layout.getLength(), extra, strlen(extra));
+  Serial.println("After appending text:");
+  showPage();
+}
+
+void loop() {
+  if (Serial.available() == 0) return;
+
+  char c = Serial.read();
+  if (c == 'n' && page + 1 < layout.getPageCount()) {
+    page++;
+    showPage();
+  } else if (c == 'p' && page > 0) {
+    page--;
+    showPage();
+  } else if (c == 'w') {
+    int w = Serial.parseInt();
+    if (w > 0 && w <= MAX_WIDTH) {
+      layout.setWidth(w);
+      page = 0;
+      showPage();
+    }
+  }
+}
+
+void showPage() {
+  uint8_t cells[MAX_WIDTH];
+  uint16_t first = page * LINES_PER_PAGE;
+
+  Serial.print("Page ");
+  Serial.print(page + 1);
+  Serial.print("/");
+  Serial.print(layout.getPageCount());
+  Serial.print("  (width ");
+  Serial.print(layout.getWidth());
+  Serial.println(" cells)");
+
+  for (uint16_t line = first; line < first + LINES_PER_PAGE; line++) {
+    if (line >= layout.getLineCount()) break;
+
+    uint8_t used = layout.getLine(line, cells);
+    uint16_t start = layout.getLineStart(line);
+
+    Serial.print("  |");
+    for (uint8_t i = 0; i < layout.getWidth(); i++) {
+      // Unicode Braille block: U+2800 + pattern (dots 1-8 map to bits 0-7)
+      uint16_t cp = 0x2800 + (i < used ? cells[i] : 0);
+      Serial.write(0xE0 | (cp >> 12));
+      Serial.write(0x80 | ((cp >> 6) & 0x3F));
+      Serial.write(0x80 | (cp & 0x3F));
+    }
+    Serial.print("|  line ");
+    Serial.print(line + 1);
+    Serial.print(" @ ");
+    Serial.println(start);
+  }
+  Serial.println();
+}
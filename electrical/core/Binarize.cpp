@@ -0,0 +1,152 @@
+// Binarize.cpp - Contrast normalization, summed-area tables and local
+// thresholds. See Binarize.h.
+
+#include "Binarize.h"
+#include "OcrPrep.h"
+
+#include <algorithm>
+#include <cstring>
+Binarizer::Binarizer(BinarizeOptions options, ScaleKernel kernel)
+    : m_options(options), m_kernel(ResolveScaleKernel(kernel)) {
+    m_options.window = (std::max)(3, (std::min)(255, m_options.window | 1));
+}
+
+bool Binarizer::Run(const uint8_t* gray, int width, int height, ptrdiff_t stride,
+                    uint8_t* dst, ptrdiff_t dstStride) {
+    if (!gray || !dst || width <= 0 || height <= 0) return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_gray.resize((size_t)width * height);
+    PoolOrShared(m_options.pool).ParallelFor(0, height, m_options.grainRows, [&](int y0, int y1) {
+        for (int y = y0; y < y1; y++)
+            memcpy(&m_gray[(size_t)y * width], gray + (ptrdiff_t)y * stride, (size_t)width);
+    });
+    return Finish(width, height, dst, dstStride);
+}
+
+bool Binarizer::RunBgra(const uint8_t* bgra, int width, int height, ptrdiff_t stride,
+                        uint8_t* dst, ptrdiff_t dstStride) {
+    if (!bgra || !dst || width <= 0 || height <= 0) return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_gray.resize((size_t)width * height);
+    PoolOrShared(m_options.pool).ParallelFor(0, height, m_options.grainRows, [&](int y0, int y1) {
+        for (int y = y0; y < y1; y++)
+            BgraRowToGray(bgra + (ptrdiff_t)y * stride, &m_gray[(size_t)y * width], width, m_kernel);
+    });
+    return Finish(width, height, dst, dstStride);
+}
+
+bool Binarizer::Finish(int width, int height, uint8_t* dst, ptrdiff_t dstStride) {
+    ThreadPool& pool = PoolOrShared(m_options.pool);
+    const int grain = (std::max)(1, m_options.grainRows);
+    const size_t w = (size_t)width;
+
+    if (m_options.normalizeContrast) {
+        // Histogram per tile, merged
+        const int tiles = (height + grain - 1) / grain;
+        std::vector<uint32_t> tileHist((size_t)tiles * 256, 0);
+        pool.ParallelFor(0, height, grain, [&](int y0, int y1) {
+            uint32_t* hist = &tileHist[(size_t)(y0 / grain) * 256];
+            for (size_t i = w * y0, end = w * y1; i < end; i++) hist[m_gray[i]]++;
+        });
+        uint64_t hist[256] = {};
+        uint64_t total = (uint64_t)w * height, weighted = 0;
+        for (int t = 0; t < tiles; t++)
+            for (int v = 0; v < 256; v++) hist[v] += tileHist[(size_t)t * 256 + v];
+        for (int v = 0; v < 256; v++) weighted += hist[v] * (uint64_t)v;
+
+        int lo = 0, hi = 255;
+        for (uint64_t acc = 0; lo < 255 && (acc += hist[lo]) <= total / 100; lo++) {}
+        for (uint64_t acc = 0; hi > 0 && (acc += hist[hi]) <= total / 100; hi--) {}
+        const bool invert = weighted < total * 128;   // mostly dark: light text on a dark background
+
+        uint8_t lut[256];
+        for (int v = 0; v < 256; v++) {
+            int s = v;
+            if (hi - lo >= 16) s = (std::max)(0, (std::min)(255, (v - lo) * 255 / (hi - lo)));
+            lut[v] = (uint8_t)(invert ? 255 - s : s);
+        }
+        pool.ParallelFor(0, height, grain, [&](int y0, int y1) {
+            for (size_t i = w * y0, end = w * y1; i < end; i++) m_gray[i] = lut[m_gray[i]];
+        });
+    }
+
+    // Summed-area tables: row prefix sums by row tile, then the running
+    // column sum by column stripe
+    const size_t sw = w + 1;
+    m_sum.assign(sw * (height + 1), 0);
+    m_sumSq.assign(sw * (height + 1), 0);
+    pool.ParallelFor(0, height, grain, [&](int y0, int y1) {
+        for (int y = y0; y < y1; y++) {
+            const uint8_t* g = &m_gray[(size_t)y * w];
+            uint32_t* s = &m_sum[(size_t)(y + 1) * sw + 1];
+            uint32_t* q = &m_sumSq[(size_t)(y + 1) * sw + 1];
+            uint32_t rs = 0, rq = 0;
+            for (size_t x = 0; x < w; x++) {
+                rs += g[x];
+                rq += (uint32_t)g[x] * g[x];
+                s[x] = rs;
+                q[x] = rq;
+            }
+        }
+    });
+    pool.ParallelFor(0, (int)sw, 256, [&](int x0, int x1) {
+        for (int y = 1; y <= height; y++) {
+            uint32_t* s = &m_sum[(size_t)y * sw];
+            uint32_t* q = &m_sumSq[(size_t)y * sw];
+            const uint32_t* sp = s - sw;
+            const uint32_t* qp = q - sw;
+            for (int x = x0; x < x1; x++) {
+                s[x] += sp[x];
+                q[x] += qp[x];
+            }
+        }
+    });
+
+    const int r = m_options.window / 2;
+    const bool sauvola = m_options.method == BinarizeMethod::Sauvola;
+    const float k = m_options.sauvolaK;
+    const float keep = 1.0f - m_options.bradleyT;
+    pool.ParallelFor(0, height, grain, [&](int y0, int y1) {
+        for (int y = y0; y < y1; y++) {
+            const int top = (std::max)(0, y - r), bottom = (std::min)(height, y + r + 1);
+            const uint32_t* sT = &m_sum[(size_t)top * sw];
+            const uint32_t* sB = &m_sum[(size_t)bottom * sw];
+            const uint32_t* qT = &m_sumSq[(size_t)top * sw];
+            const uint32_t* qB = &m_sumSq[(size_t)bottom * sw];
+            const uint8_t* g = &m_gray[(size_t)y * w];
+            uint8_t* out = dst + (ptrdiff_t)y * dstStride;
+            for (int x = 0; x < width; x++) {
+                const int left = (std::max)(0, x - r), right = (std::min)(width, x + r + 1);
+                const float n = (float)((right - left) * (bottom - top));
+                const float sum = (float)(sB[right] - sB[left] - sT[right] + sT[left]);
+                const float p = (float)g[x];
+                bool ink;
+                if (sauvola) {
+                    // p < m (1 + k (s / 128 - 1)), without the square root:
+                    // with a = p - m (1 - k) >= 0 it is a^2 < (m k / 128)^2 var
+                    const float m = sum / n;
+                    const float sq = (float)(qB[right] - qB[left] - qT[right] + qT[left]);
+                    const float var = (std::max)(0.0f, sq / n - m * m);
+                    const float a = p - m * (1.0f - k);
+                    const float c = m * k * (1.0f / 128.0f);
+                    ink = a < 0.0f || a * a < c * c * var;
+                } else {
+                    ink = p * n < sum * keep;
+                }
+                out[x] = ink ? 0 : 255;
+            }
+        }
+    });
+    return true;
+}
+
+void Binarizer::PackBits(const uint8_t* bin, int width, int height, ptrdiff_t stride,
+                         uint8_t* dst, ptrdiff_t dstStride) {
+    for (int y = 0; y < height; y++) {
+        const uint8_t* in = bin + (ptrdiff_t)y * stride;
+        uint8_t* out = dst + (ptrdiff_t)y * dstStride;
+        memset(out, 0, (size_t)(width + 7) / 8);
+        for (int x = 0; x < width; x++)
+            if (in[x] < 128) out[x >> 3] |= (uint8_t)(0x80 >> (x & 7));
+    }
+}
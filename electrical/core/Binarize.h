@@ -0,0 +1,76 @@
+// Binarize.h - Local-threshold binarization for OCR input.
+//
+// OCR engines work faster and misread less on clean black-on-white text
+// than on low-contrast, coloured or noisy UI pixels. Binarizer turns a
+// Gray8 or BGRA image into ink (0) and background (255):
+//
+//   1. gray conversion (SIMD, BgraRowToGray) and contrast normalization:
+//      the 1st..99th percentile is stretched to 0..255, and the image is
+//      inverted if it is mostly dark, so light-on-dark text comes out dark
+//   2. summed-area tables of the pixels and their squares
+//   3. a per-pixel threshold from the mean (Bradley) or mean and standard
+//      deviation (Sauvola) of the window around it, read from the tables
+//      in constant time whatever the window size
+//
+// Every stage runs on a ThreadPool in tiles of rows (the column pass of
+// the tables in stripes of columns). The tables are 32-bit and rely on
+// wrap-around: a window's sums are exact as long as they fit, which holds
+// for windows up to 255 pixels square.
+
+#pragma once
+
+#include "ImageScale.h"
+#include "ThreadPool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+enum class BinarizeMethod {
+    Sauvola,   // T = m * (1 + k * (s / 128 - 1)); robust to uneven backgrounds
+    Bradley,   // T = m * (1 - t); cheaper, fine on flat backgrounds
+};
+
+struct BinarizeOptions {
+    BinarizeMethod method = BinarizeMethod::Sauvola;
+    int window = 31;               // odd window side in pixels, 3..255; about two text lines
+    float sauvolaK = 0.2f;
+    float bradleyT = 0.15f;
+    bool normalizeContrast = true; // percentile stretch and dark-background inversion
+    ThreadPool* pool = nullptr;    // null: ThreadPool::Shared()
+    int grainRows = 32;            // rows per tile
+};
+
+class Binarizer {
+public:
+    explicit Binarizer(BinarizeOptions options = BinarizeOptions(), ScaleKernel kernel = ScaleKernel::Auto);
+
+    // Gray8 in, 0/255 Gray8 out. dst may be the same buffer as gray.
+    bool Run(const uint8_t* gray, int width, int height, ptrdiff_t stride,
+             uint8_t* dst, ptrdiff_t dstStride);
+
+    // BGRA in, 0/255 Gray8 out
+    bool RunBgra(const uint8_t* bgra, int width, int height, ptrdiff_t stride,
+                 uint8_t* dst, ptrdiff_t dstStride);
+
+    // Packs a 0/255 image to 1 bit per pixel, MSB first, 1 = ink.
+    // dstStride must be at least (width + 7) / 8.
+    static void PackBits(const uint8_t* bin, int width, int height, ptrdiff_t stride,
+                         uint8_t* dst, ptrdiff_t dstStride);
+
+    const BinarizeOptions& Options() const { return m_options; }
+
+    Binarizer(const Binarizer&) = delete;
+    Binarizer& operator=(const Binarizer&) = delete;
+
+private:
+    bool Finish(int width, int height, uint8_t* dst, ptrdiff_t dstStride);
+
+    BinarizeOptions m_options;
+    ScaleKernel m_kernel;
+    std::mutex m_mutex;              // Run() may be called from several OCR tasks
+    std::vector<uint8_t> m_gray;     // normalized input, stride width
+    std::vector<uint32_t> m_sum;     // (width + 1) x (height + 1) summed-area tables
+    std::vector<uint32_t> m_sumSq;
+};
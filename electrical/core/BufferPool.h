@@ -0,0 +1,120 @@
+// BufferPool.h - Reusable byte buffers for the image pipeline.
+//
+// Acquire() hands out the smallest free buffer that fits, growing one only
+// when nothing does, and the Buffer handle gives the storage back when it
+// goes out of scope. After the first few frames of a given size the pool
+// stops allocating. Thread-safe; the pool must outlive its buffers.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class BufferPool {
+public:
+    class Buffer {
+    public:
+        Buffer() = default;
+        Buffer(Buffer&& other) noexcept { *this = std::move(other); }
+        Buffer& operator=(Buffer&& other) noexcept {
+            if (this != &other) {
+                Reset();
+                m_pool = other.m_pool;
+                m_storage = std::move(other.m_storage);
+                m_size = other.m_size;
+                other.m_pool = nullptr;
+                other.m_size = 0;
+            }
+            return *this;
+        }
+        ~Buffer() { Reset(); }
+
+        uint8_t* Data() { return m_storage ? m_storage->data() : nullptr; }
+        const uint8_t* Data() const { return m_storage ? m_storage->data() : nullptr; }
+        size_t Size() const { return m_size; }
+        explicit operator bool() const { return m_storage != nullptr; }
+
+        // Returns the storage to the pool now
+        void Reset() {
+            if (m_pool && m_storage) m_pool->Release(std::move(m_storage), m_size);
+            m_pool = nullptr;
+            m_storage.reset();
+            m_size = 0;
+        }
+
+    private:
+        friend class BufferPool;
+        BufferPool* m_pool = nullptr;
+        std::unique_ptr<std::vector<uint8_t>> m_storage;
+        size_t m_size = 0;
+    };
+
+    // Contents are left over from the previous user, not zeroed.
+    Buffer Acquire(size_t size) {
+        std::unique_ptr<std::vector<uint8_t>> storage;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            size_t best = m_free.size();
+            for (size_t i = 0; i < m_free.size(); i++) {
+                size_t have = m_free[i]->size();
+                if (have >= size && (best == m_free.size() || have < m_free[best]->size())) best = i;
+            }
+            if (best == m_free.size() && !m_free.empty()) {
+                // Nothing fits: grow the largest free buffer
+                best = 0;
+                for (size_t i = 1; i < m_free.size(); i++)
+                    if (m_free[i]->size() > m_free[best]->size()) best = i;
+            }
+            if (best < m_free.size()) {
+                storage = std::move(m_free[best]);
+                m_free.erase(m_free.begin() + (ptrdiff_t)best);
+            }
+            m_inUse += size;
+            if (m_inUse > m_peakInUse) m_peakInUse = m_inUse;
+            if (!storage || storage->size() < size) {
+                m_allocations++;
+                m_bytesHeld += size - (storage ? storage->size() : 0);
+            }
+        }
+
+        if (!storage) storage.reset(new std::vector<uint8_t>());
+        if (storage->size() < size) storage->resize(size);
+
+        Buffer b;
+        b.m_pool = this;
+        b.m_storage = std::move(storage);
+        b.m_size = size;
+        return b;
+    }
+
+    // Times Acquire() had to allocate or grow storage
+    size_t Allocations() const { std::lock_guard<std::mutex> lock(m_mutex); return m_allocations; }
+    // Storage owned by the pool, free or handed out
+    size_t BytesHeld() const { std::lock_guard<std::mutex> lock(m_mutex); return m_bytesHeld; }
+    // Most bytes handed out at once (requested sizes)
+    size_t PeakBytesInUse() const { std::lock_guard<std::mutex> lock(m_mutex); return m_peakInUse; }
+
+    // Frees every buffer not currently handed out
+    void Trim() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& s : m_free) m_bytesHeld -= s->size();
+        m_free.clear();
+    }
+
+private:
+    void Release(std::unique_ptr<std::vector<uint8_t>> storage, size_t size) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_inUse -= size;
+        m_free.push_back(std::move(storage));
+    }
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<std::vector<uint8_t>>> m_free;
+    size_t m_allocations = 0;
+    size_t m_bytesHeld = 0;
+    size_t m_inUse = 0;
+    size_t m_peakInUse = 0;
+};
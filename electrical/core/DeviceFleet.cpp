@@ -0,0 +1,82 @@
+// DeviceFleet.cpp - One DeviceLink per device on a shared SerialIoLoop. See DeviceFleet.h.
+
+#include "DeviceFleet.h"
+
+#include <algorithm>
+#include <chrono>
+
+DeviceFleet::DeviceFleet(DeviceFleetOptions options) : m_options(options), m_loop(options.ioThreads) {
+    m_options.serial.loop = &m_loop;
+}
+
+DeviceFleet::~DeviceFleet() {
+    Close();
+}
+
+int DeviceFleet::Add(const std::string& path, std::string& err) {
+    std::unique_ptr<Device> d(new Device(path, m_options.link));
+    const size_t index = m_devices.size();
+    Device* raw = d.get();
+    raw->port.SetLineCallback([this, raw, index](const std::string& line) {
+        raw->link.OnLine(line);
+        if (m_onLine) m_onLine(index, line);
+    });
+    raw->port.SetErrorCallback([this, index](const std::string& message) {
+        if (m_onError) m_onError(index, message);
+    });
+    if (!raw->port.Open(path, m_options.serial, err)) return -1;
+    m_devices.push_back(std::move(d));
+    return (int)index;
+}
+
+bool DeviceFleet::Send(size_t device, const std::string& utf8) {
+    return device < m_devices.size() && m_devices[device]->link.SendText(utf8);
+}
+
+size_t DeviceFleet::Broadcast(const std::string& utf8) {
+    size_t sent = 0;
+    for (auto& d : m_devices) sent += d->link.SendText(utf8) ? 1 : 0;
+    return sent;
+}
+
+void DeviceFleet::Poll() {
+    for (auto& d : m_devices) d->link.Poll();
+}
+
+template <typename Wait>
+bool DeviceFleet::WaitAll(int timeoutMs, Wait wait) {
+    using Clock = std::chrono::steady_clock;
+    const auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    bool ok = true;
+    for (auto& d : m_devices) {
+        if (!d->port.IsOpen()) continue;
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        ok = wait(d->link, (int)(std::max)((long long)left, 0LL)) && ok;
+    }
+    return ok;
+}
+
+bool DeviceFleet::WaitWritten(int timeoutMs) {
+    return WaitAll(timeoutMs, [](DeviceLink& link, int ms) { return link.WaitWritten(ms); });
+}
+
+bool DeviceFleet::WaitIdle(int timeoutMs) {
+    return WaitAll(timeoutMs, [](DeviceLink& link, int ms) { return link.WaitIdle(ms); });
+}
+
+DeviceLinkStats DeviceFleet::Totals() const {
+    DeviceLinkStats t;
+    for (const auto& d : m_devices) {
+        DeviceLinkStats s = d->link.Stats();
+        t.linesSent += s.linesSent;
+        t.linesAcked += s.linesAcked;
+        t.linesRejected += s.linesRejected;
+        t.linesLost += s.linesLost;
+        t.bytesSent += s.bytesSent;
+    }
+    return t;
+}
+
+void DeviceFleet::Close() {
+    for (auto& d : m_devices) d->port.Close();
+}
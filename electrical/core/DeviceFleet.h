@@ -0,0 +1,87 @@
+// DeviceFleet.h - Many displays fed from one host.
+//
+// For a classroom where one PC drives a dozen or more displays. Each
+// device has its own SerialPort (write queue) and its own DeviceLink
+// (mirror of the device text, window of unanswered bytes, reply
+// matching), so a slow, rejecting or unplugged display holds up only
+// itself. All ports share one SerialIoLoop, a few epoll threads, instead
+// of two threads per port. Text goes to every device (Broadcast) or to
+// one (Send).
+
+#pragma once
+
+#include "DeviceLink.h"
+#include "SerialIoLoop.h"
+#include "SerialPort.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct DeviceFleetOptions {
+    int ioThreads = 1;          // SerialIoLoop threads shared by every port
+    SerialOptions serial;       // per port; loop is set by the fleet
+    DeviceLinkOptions link;     // per device
+};
+
+class DeviceFleet {
+public:
+    using LineCallback = std::function<void(size_t device, const std::string& line)>;
+    using ErrorCallback = std::function<void(size_t device, const std::string& message)>;
+
+    explicit DeviceFleet(DeviceFleetOptions options = DeviceFleetOptions());
+    ~DeviceFleet();
+
+    DeviceFleet(const DeviceFleet&) = delete;
+    DeviceFleet& operator=(const DeviceFleet&) = delete;
+
+    // Set before Add(). Run on an I/O thread; the line callback sees every
+    // line (READY banners, SUM replies, ...) after the device's link did.
+    void SetLineCallback(LineCallback cb) { m_onLine = std::move(cb); }
+    void SetErrorCallback(ErrorCallback cb) { m_onError = std::move(cb); }
+
+    // Opens a device and returns its index, or -1 and sets err
+    int Add(const std::string& path, std::string& err);
+
+    size_t Size() const { return m_devices.size(); }
+    const std::string& Path(size_t device) const { return m_devices[device]->path; }
+    DeviceLink& Link(size_t device) { return m_devices[device]->link; }
+    SerialPort& Port(size_t device) { return m_devices[device]->port; }
+
+    // Queues the edits that bring one device, or every device, to `utf8`.
+    // Broadcast returns how many devices took the text (closed ones don't).
+    bool Send(size_t device, const std::string& utf8);
+    size_t Broadcast(const std::string& utf8);
+
+    // DeviceLink::Poll on every device
+    void Poll();
+    // Every device, within one overall timeout
+    bool WaitWritten(int timeoutMs);
+    bool WaitIdle(int timeoutMs);
+
+    // Summed over the devices
+    DeviceLinkStats Totals() const;
+
+    // Closes every port; the devices stay listed
+    void Close();
+
+private:
+    struct Device {
+        std::string path;
+        SerialPort port;
+        DeviceLink link;
+
+        Device(const std::string& p, const DeviceLinkOptions& options) : path(p), link(port, options) {}
+    };
+
+    template <typename Wait>
+    bool WaitAll(int timeoutMs, Wait wait);
+
+    DeviceFleetOptions m_options;
+    SerialIoLoop m_loop;   // outlives the ports: destroyed after m_devices
+    std::vector<std::unique_ptr<Device>> m_devices;
+    LineCallback m_onLine;
+    ErrorCallback m_onError;
+};
@@ -0,0 +1,150 @@
+// DeviceLink.cpp - Pipelined E: lines with reply matching. See DeviceLink.h.
+
+#include "DeviceLink.h"
+
+#include <algorithm>
+
+DeviceLink::DeviceLink(SerialPort& port, DeviceLinkOptions options)
+    : m_port(port), m_options(options), m_mirror(options.delta) {}
+
+bool DeviceLink::SendText(const std::string& utf8) {
+    if (!m_port.IsOpen()) return false;
+    std::string normalized = m_normalizer.Normalize(utf8);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stale) {
+        m_mirror.Reset();
+        m_stale = false;
+    }
+    std::string commands = m_mirror.Update(normalized);
+    for (size_t start = 0; start < commands.size();) {
+        size_t end = commands.find('\n', start);
+        end = end == std::string::npos ? commands.size() : end + 1;
+        m_queued.push_back(commands.substr(start, end - start));
+        start = end;
+    }
+    PumpLocked();
+    return true;
+}
+
+void DeviceLink::OnLine(const std::string& line) {
+    bool ok = line == "OK";
+    bool err = line.compare(0, 4, "ERR:") == 0;
+    if (!ok && !err) return;   // READY banner, P: visualization, PONG, ...
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_inFlight.empty()) return;   // reply to a command sent by someone else
+
+    Pending p = std::move(m_inFlight.front());
+    m_inFlight.pop_front();
+    m_inFlightBytes -= p.line.size();
+    m_latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - p.sent).count());
+    if (ok) {
+        m_stats.linesAcked++;
+    } else {
+        // The device did not apply an edit, so its text is no longer known
+        m_stats.linesRejected++;
+        MarkStaleLocked();
+    }
+    PumpLocked();
+}
+
+void DeviceLink::Poll() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_inFlight.empty() &&
+        Clock::now() - m_inFlight.front().sent > std::chrono::milliseconds(m_options.replyTimeoutMs)) {
+        // Replies can no longer be matched to lines; start over
+        m_stats.linesLost += m_inFlight.size();
+        m_inFlight.clear();
+        m_inFlightBytes = 0;
+        MarkStaleLocked();
+    }
+    PumpLocked();
+}
+
+bool DeviceLink::Idle() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_queued.empty() && m_inFlight.empty();
+}
+
+bool DeviceLink::WaitIdle(int timeoutMs) {
+    return WaitUntil(timeoutMs, [this] { return m_queued.empty() && m_inFlight.empty(); });
+}
+
+bool DeviceLink::WaitWritten(int timeoutMs) {
+    return WaitUntil(timeoutMs, [this] { return m_queued.empty(); });
+}
+
+template <typename Done>
+bool DeviceLink::WaitUntil(int timeoutMs, Done done) {
+    auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    for (;;) {
+        Poll();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (done()) return true;
+        if (Clock::now() >= deadline) return false;
+        // Wake up now and then to expire lines that are never answered
+        m_changed.wait_until(lock, (std::min)(deadline, Clock::now() + std::chrono::milliseconds(50)));
+        if (done()) return true;
+    }
+}
+
+void DeviceLink::Reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queued.clear();
+    m_inFlight.clear();
+    m_inFlightBytes = 0;
+    m_mirror.Reset();
+    m_stale = false;
+    m_changed.notify_all();
+}
+
+bool DeviceLink::Truncated() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_mirror.Truncated();
+}
+
+std::string DeviceLink::DeviceText() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_mirror.Text();
+}
+
+DeviceLinkStats DeviceLink::Stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+std::vector<double> DeviceLink::TakeLatencies() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<double> out;
+    out.swap(m_latencies);
+    return out;
+}
+
+void DeviceLink::PumpLocked() {
+    // One line always goes out when nothing is in flight, even if it is
+    // larger than the window
+    while (!m_queued.empty() &&
+           (m_inFlight.empty() || m_inFlightBytes + m_queued.front().size() <= m_options.windowBytes)) {
+        std::string line = m_queued.front();
+        if (!m_port.Write(line)) {
+            if (!m_port.IsOpen()) {
+                m_queued.clear();
+                MarkStaleLocked();
+            }
+            break;   // queue full: retried on the next reply or Poll()
+        }
+        m_queued.pop_front();
+        m_stats.linesSent++;
+        m_stats.bytesSent += line.size();
+        m_inFlightBytes += line.size();
+        m_inFlight.push_back(Pending{ std::move(line), Clock::now() });
+    }
+    m_changed.notify_all();
+}
+
+void DeviceLink::MarkStaleLocked() {
+    // Lines already queued were diffed against the old text
+    m_queued.clear();
+    m_stale = true;
+}
@@ -0,0 +1,107 @@
+// DeviceLink.h - Sends text to the firmware's TextBuffer over a SerialPort.
+//
+// This is the non-GUI sending logic shared by driver.cpp and braille-send:
+// text is normalized (TextNormalize.h), diffed against what the device
+// holds (TextDelta.h) and the resulting E: lines are pipelined: several
+// lines may be on the wire at once, up to windowBytes that the device has
+// not answered yet. The firmware answers every line with OK or ERR:..., in
+// order, so each reply is matched to the oldest outstanding line, which
+// gives a per-line latency. A rejected edit or a missing reply makes the
+// device text unknown and the next SendText() replaces everything.
+
+#pragma once
+
+#include "SerialPort.h"
+#include "TextDelta.h"
+#include "TextNormalize.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct DeviceLinkOptions {
+    TextDeltaOptions delta;
+    size_t windowBytes = 256;   // unanswered command bytes allowed on the wire
+    int replyTimeoutMs = 2000;  // a line unanswered this long counts as lost
+};
+
+struct DeviceLinkStats {
+    uint64_t linesSent = 0;
+    uint64_t linesAcked = 0;      // answered OK
+    uint64_t linesRejected = 0;   // answered ERR:...
+    uint64_t linesLost = 0;       // no reply within replyTimeoutMs
+    uint64_t bytesSent = 0;
+};
+
+class DeviceLink {
+public:
+    explicit DeviceLink(SerialPort& port, DeviceLinkOptions options = DeviceLinkOptions());
+
+    DeviceLink(const DeviceLink&) = delete;
+    DeviceLink& operator=(const DeviceLink&) = delete;
+
+    // Queues the edits that bring the device to `utf8` and starts sending.
+    // Does not wait for replies. Returns false if the port is not open.
+    bool SendText(const std::string& utf8);
+
+    // Feed every line the device sends (from the SerialPort line callback)
+    void OnLine(const std::string& line);
+
+    // Expires lines that were never answered and sends what the window
+    // allows. Replies drive sending too; call this periodically anyway.
+    void Poll();
+
+    // Nothing queued and nothing awaiting a reply
+    bool Idle() const;
+    bool WaitIdle(int timeoutMs);
+
+    // Waits until every queued line has been written (replies may still
+    // be outstanding). For streaming: queue the next text once this returns.
+    bool WaitWritten(int timeoutMs);
+
+    // The device content is unknown (e.g. after reconnecting); drops
+    // queued lines and makes the next SendText() replace everything
+    void Reset();
+
+    // Whether the last SendText() had to cut the text to the device capacity
+    bool Truncated() const;
+    // Normalized text the device holds once everything is answered
+    std::string DeviceText() const;
+
+    DeviceLinkStats Stats() const;
+
+    // Microseconds from queueing each answered line to its reply, oldest
+    // first, since the previous call
+    std::vector<double> TakeLatencies();
+
+private:
+    using Clock = std::chrono::steady_clock;
+    struct Pending {
+        std::string line;
+        Clock::time_point sent;
+    };
+
+    template <typename Done>
+    bool WaitUntil(int timeoutMs, Done done);
+    void PumpLocked();
+    void MarkStaleLocked();
+
+    SerialPort& m_port;
+    DeviceLinkOptions m_options;
+    BrailleNormalizer m_normalizer;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_changed;
+    DeviceTextMirror m_mirror;
+    bool m_stale = false;
+    std::deque<std::string> m_queued;    // encoded, not yet written
+    std::deque<Pending> m_inFlight;      // written, awaiting OK/ERR
+    size_t m_inFlightBytes = 0;
+    DeviceLinkStats m_stats;
+    std::vector<double> m_latencies;
+};
@@ -0,0 +1,103 @@
+// DocumentSource.cpp - Lazily paged, memory-mapped text. See DocumentSource.h.
+
+#include "DocumentSource.h"
+
+#include <algorithm>
+
+namespace {
+
+inline bool IsContinuation(uint8_t c) { return (c & 0xC0) == 0x80; }
+inline bool IsSpace(uint8_t c) { return c == ' ' || c == '\n' || c == '\t' || c == '\r'; }
+
+} // namespace
+
+size_t SnapPageBreak(const char* text, size_t limit, size_t snapBytes) {
+    const uint8_t* t = reinterpret_cast<const uint8_t*>(text);
+    const size_t floor = limit > snapBytes ? limit - snapBytes : 0;
+    for (size_t p = limit; p > floor; p--)
+        if (IsSpace(t[p - 1])) return p;
+
+    size_t p = limit;
+    for (int i = 0; i < 3 && p > floor && IsContinuation(t[p]); i++) p--;
+    return p;
+}
+
+DocumentSource::DocumentSource(DocumentOptions options) : m_options(options) {
+    if (m_options.pageBytes < 16) m_options.pageBytes = 16;
+    m_options.snapBytes = (std::min)(m_options.snapBytes, m_options.pageBytes / 2);
+}
+
+bool DocumentSource::Open(const std::string& path, std::string& err) {
+    Close();
+    if (!m_file.Open(path, err)) return false;
+
+    const uint8_t* data = m_file.Data();
+    size_t size = m_file.Size();
+    if (size >= 3 && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF) {
+        data += 3;
+        size -= 3;
+    }
+    m_text = data;
+    m_size = size;
+    m_pages = (size + m_options.pageBytes - 1) / m_options.pageBytes;
+    return true;
+}
+
+void DocumentSource::Close() {
+    m_file.Close();
+    m_text = nullptr;
+    m_size = m_pages = 0;
+    m_touchedBegin = m_touchedEnd = 0;
+}
+
+size_t DocumentSource::PageStart(size_t page) const {
+    if (page == 0) return 0;
+    if (page >= m_pages) return m_size;
+
+    return SnapPageBreak(reinterpret_cast<const char*>(m_text), page * m_options.pageBytes, m_options.snapBytes);
+}
+
+size_t DocumentSource::PageOf(size_t offset) const {
+    if (m_pages == 0) return 0;
+    if (offset >= m_size) return m_pages - 1;
+    // Starts move back by less than a page, so it is this page or the next
+    size_t page = offset / m_options.pageBytes;
+    return page + 1 < m_pages && offset >= PageStart(page + 1) ? page + 1 : page;
+}
+
+std::string_view DocumentSource::Page(size_t page) {
+    if (page >= m_pages) return {};
+    size_t begin = PageStart(page);
+    size_t end = PageStart(page + 1);
+
+    if (m_touchedBegin == m_touchedEnd) {
+        m_touchedBegin = begin;
+        m_touchedEnd = end;
+    }
+    m_touchedBegin = (std::min)(m_touchedBegin, begin);
+    m_touchedEnd = (std::max)(m_touchedEnd, end);
+    if (m_touchedEnd - m_touchedBegin > m_options.residentBytes) Trim(begin, end);
+
+    return std::string_view(reinterpret_cast<const char*>(m_text + begin), end - begin);
+}
+
+void DocumentSource::Trim(size_t begin, size_t end) {
+    // Keep half the budget on each side of the current page
+    const size_t half = m_options.residentBytes / 2;
+    size_t keepBegin = begin > half ? begin - half : 0;
+    size_t keepEnd = (std::min)(m_size, end + half);
+
+    const size_t base = (size_t)(m_text - m_file.Data());
+    if (m_touchedBegin < keepBegin) m_file.Discard(base + m_touchedBegin, keepBegin - m_touchedBegin);
+    if (m_touchedEnd > keepEnd) m_file.Discard(base + keepEnd, m_touchedEnd - keepEnd);
+
+    m_touchedBegin = (std::max)(m_touchedBegin, keepBegin);
+    m_touchedEnd = (std::min)(m_touchedEnd, keepEnd);
+}
+
+bool PageFeeder::Pump(bool linkReady, const SendFn& send) {
+    if (!m_hasPending || !linkReady) return false;
+    if (!send(m_pending)) return false;
+    m_hasPending = false;
+    return true;
+}
@@ -0,0 +1,96 @@
+// DocumentSource.h - Pages of a large UTF-8 text file, read on demand.
+//
+// The file is memory-mapped and never read as a whole: Open() only maps
+// it, and page k starts near k * pageBytes, moved back to the previous
+// whitespace (or at least to a UTF-8 character boundary), so any page can
+// be found without scanning what comes before it. Only the pages that are
+// looked at are read from disk, and mapped ranges far from the current
+// page are released, so memory stays flat however large the file is.
+//
+// PageFeeder sits between page navigation and the serial link: it keeps
+// only the newest requested page and hands it to the sender when the
+// link has drained, so paging quickly through a book does not queue
+// hundreds of pages behind a 115200 baud port.
+
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+struct DocumentOptions {
+    size_t pageBytes = 448;          // nominal page size
+    size_t snapBytes = 64;           // how far a page start may move back; pages
+                                     // hold at most pageBytes + snapBytes, which
+                                     // is TEXT_BUFFER_SIZE (512) by default
+    size_t residentBytes = 8 << 20;  // mapped span kept before older pages are released
+};
+
+// Where to cut text so the part before the cut is at most `limit` bytes:
+// just after the last whitespace within `snapBytes` before limit, or else
+// at the UTF-8 character boundary at or before limit. Reads at most
+// snapBytes + 3 bytes; text must hold more than limit bytes.
+size_t SnapPageBreak(const char* text, size_t limit, size_t snapBytes);
+
+class DocumentSource {
+public:
+    explicit DocumentSource(DocumentOptions options = DocumentOptions());
+
+    // Maps path (UTF-8) and skips a UTF-8 BOM. Does not read the file.
+    bool Open(const std::string& path, std::string& err);
+    void Close();
+
+    bool IsOpen() const { return m_file.IsOpen(); }
+    const DocumentOptions& Options() const { return m_options; }
+
+    // Text bytes, BOM excluded
+    size_t Size() const { return m_size; }
+
+    // 0 for an empty file
+    size_t PageCount() const { return m_pages; }
+
+    // Byte offset of page k in the text; PageStart(PageCount()) == Size()
+    size_t PageStart(size_t page) const;
+
+    // Page containing byte offset `offset` of the text
+    size_t PageOf(size_t offset) const;
+
+    // The bytes of page k, valid until Close(). Never splits a UTF-8
+    // character; invalid bytes in the file are passed through unchanged.
+    // Releases mapped pages far from k once residentBytes have been touched.
+    std::string_view Page(size_t page);
+
+private:
+    void Trim(size_t begin, size_t end);
+
+    DocumentOptions m_options;
+    MappedFile m_file;
+    const uint8_t* m_text = nullptr;
+    size_t m_size = 0;
+    size_t m_pages = 0;
+    size_t m_touchedBegin = 0;   // span of the text that may still be resident
+    size_t m_touchedEnd = 0;
+};
+
+class PageFeeder {
+public:
+    // Returns false if the page could not be queued; it stays pending
+    using SendFn = std::function<bool(size_t page)>;
+
+    // Replaces any page not yet sent
+    void Request(size_t page) { m_pending = page; m_hasPending = true; }
+    void Cancel() { m_hasPending = false; }
+
+    bool HasPending() const { return m_hasPending; }
+
+    // Call periodically. Sends the pending page if the link is ready
+    // (nothing queued on it) and returns true if one was sent.
+    bool Pump(bool linkReady, const SendFn& send);
+
+private:
+    size_t m_pending = 0;
+    bool m_hasPending = false;
+};
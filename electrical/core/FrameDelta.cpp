@@ -0,0 +1,241 @@
+// FrameDelta.cpp - Cell run diff and F: line encoding. See FrameDelta.h.
+
+#include "FrameDelta.h"
+
+#include "PatternCode.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+const size_t kMaxLiteral = 0x3F;   // control byte 01-3F (4n: packed)
+const size_t kMaxRun = 0x3F;       // 8n / Cn: six bits of count
+
+// A run header ("OO" "LL") costs as much as two literal cells, a repeat or
+// copy ("OO" "LL" "XX") as much as three
+const size_t kBridgeCells = 2;
+const size_t kCopyCells = 3;
+
+void PushCopy(std::vector<CellRun>& runs, size_t offset, size_t source, size_t count) {
+    // Chunks go in the direction that never reads a cell an earlier chunk wrote
+    bool left = offset < source;
+    for (size_t done = 0; done < count;) {
+        size_t n = (std::min)(kMaxRun, count - done);
+        size_t at = left ? done : count - done - n;
+        runs.push_back({ CellRun::Copy, offset + at, n, source + at, {} });
+        done += n;
+    }
+}
+
+void PushRepeat(std::vector<CellRun>& runs, size_t offset, size_t count, uint8_t pattern) {
+    for (size_t done = 0; done < count; done += kMaxRun)
+        runs.push_back({ CellRun::Repeat, offset + done, (std::min)(kMaxRun, count - done), 0, { pattern } });
+}
+
+void PushLiteral(std::vector<CellRun>& runs, const std::vector<uint8_t>& frame, size_t offset, size_t count) {
+    for (size_t done = 0; done < count; done += kMaxLiteral) {
+        size_t n = (std::min)(kMaxLiteral, count - done);
+        auto first = frame.begin() + (ptrdiff_t)(offset + done);
+        runs.push_back({ CellRun::Literal, offset + done, n, 0, std::vector<uint8_t>(first, first + (ptrdiff_t)n) });
+    }
+}
+
+// Cells [start, end) of target as repeats where a row of equal cells pays
+// for its header, literals elsewhere
+void EncodeSpan(std::vector<CellRun>& runs, const std::vector<uint8_t>& target, size_t start, size_t end) {
+    auto runAt = [&](size_t i) {
+        size_t r = 1;
+        while (i + r < end && target[i + r] == target[i]) r++;
+        return r;
+    };
+    // Inside a span a repeat also splits the literal around it: one more header
+    auto worthRepeat = [&](size_t i, size_t r) { return r >= ((i == start || i + r == end) ? 3u : 5u); };
+
+    size_t i = start;
+    while (i < end) {
+        size_t r = runAt(i);
+        if (worthRepeat(i, r)) {
+            PushRepeat(runs, i, r, target[i]);
+            i += r;
+            continue;
+        }
+        size_t j = i + r;
+        while (j < end) {
+            size_t r2 = runAt(j);
+            if (worthRepeat(j, r2)) break;
+            j += r2;
+        }
+        PushLiteral(runs, target, i, j - i);
+        i = j;
+    }
+}
+
+} // namespace
+
+std::vector<CellRun> DiffCells(const std::vector<uint8_t>& oldFrame, const std::vector<uint8_t>& newFrame) {
+    const size_t n = newFrame.size();
+    std::vector<CellRun> runs;
+    std::vector<uint8_t> base = oldFrame;
+    const bool known = oldFrame.size() == n;
+
+    if (known && n > kCopyCells) {
+        // Scrolling by a word shifts the line: find the shift that leaves
+        // the most cells in place and start with one copy if it pays off
+        size_t same = 0;
+        for (size_t i = 0; i < n; i++) same += oldFrame[i] == newFrame[i];
+        size_t bestMatches = same + kCopyCells;
+        long bestShift = 0;
+        for (long k = -(long)n + 1; k < (long)n; k++) {
+            if (k == 0) continue;
+            size_t lo = k < 0 ? (size_t)-k : 0, hi = k > 0 ? n - (size_t)k : n;
+            if (hi - lo <= bestMatches) continue;
+            size_t m = 0;
+            for (size_t i = lo; i < hi; i++) m += newFrame[i] == oldFrame[(size_t)((long)i + k)];
+            if (m > bestMatches) { bestMatches = m; bestShift = k; }
+        }
+        if (bestShift > 0) PushCopy(runs, 0, (size_t)bestShift, n - (size_t)bestShift);
+        else if (bestShift < 0) PushCopy(runs, (size_t)-bestShift, 0, n - (size_t)-bestShift);
+        ApplyRuns(base, runs);
+    }
+
+    // Changed cells, with gaps too short to pay for another header bridged
+    size_t i = 0;
+    while (i < n) {
+        if (known && base[i] == newFrame[i]) { i++; continue; }
+        size_t end = i + 1, gap = 0;
+        for (size_t j = i + 1; j < n && gap <= kBridgeCells; j++) {
+            if (!known || base[j] != newFrame[j]) { end = j + 1; gap = 0; }
+            else gap++;
+        }
+        EncodeSpan(runs, newFrame, i, end);
+        i = end;
+    }
+    return runs;
+}
+
+void ApplyRuns(std::vector<uint8_t>& frame, const std::vector<CellRun>& runs) {
+    for (const CellRun& r : runs) {
+        if (r.offset + r.count > frame.size()) frame.resize(r.offset + r.count, 0);
+        switch (r.kind) {
+        case CellRun::Literal:
+            std::copy(r.patterns.begin(), r.patterns.end(), frame.begin() + (ptrdiff_t)r.offset);
+            break;
+        case CellRun::Repeat:
+            std::fill_n(frame.begin() + (ptrdiff_t)r.offset, r.count, r.patterns[0]);
+            break;
+        case CellRun::Copy: {
+            std::vector<uint8_t> cells(frame.begin() + (ptrdiff_t)r.source,
+                                       frame.begin() + (ptrdiff_t)(r.source + r.count));
+            std::copy(cells.begin(), cells.end(), frame.begin() + (ptrdiff_t)r.offset);
+            break;
+        }
+        }
+    }
+}
+
+uint16_t FrameChecksum(const std::vector<uint8_t>& frame) {
+    uint16_t crc = 0xFFFF;
+    for (uint8_t c : frame) {
+        crc ^= (uint16_t)c << 8;
+        for (int b = 0; b < 8; b++) crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+bool ParseFrameCaps(const std::string& reply, FrameDeltaOptions& options) {
+    options.packed = false;
+    if (reply.compare(0, 5, "CAPS:") != 0) return false;
+    bool frames = false;
+    const std::string pack = "PACK" + std::to_string(PatternCodeVersion());
+    for (size_t start = 5; start <= reply.size();) {
+        size_t comma = reply.find(',', start);
+        if (comma == std::string::npos) comma = reply.size();
+        std::string feature = reply.substr(start, comma - start);
+        frames = frames || feature == "FRAME";
+        options.packed = options.packed || feature == pack;
+        start = comma + 1;
+    }
+    options.packed = options.packed && frames;
+    return frames;
+}
+
+DeviceFrameMirror::DeviceFrameMirror(FrameDeltaOptions options) : m_options(options) {
+    m_options.maxLineLength = (std::max)(m_options.maxLineLength, (size_t)16);
+    m_options.cells = (std::min)((std::max)(m_options.cells, (size_t)1), (size_t)0xFF);
+    Reset();
+}
+
+void DeviceFrameMirror::Reset() {
+    m_frame.assign(m_options.cells, 0);
+    m_synced = false;
+}
+
+std::string DeviceFrameMirror::ExpectedSum() const {
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "FSUM:%02X,%04X", (unsigned)m_frame.size(), FrameChecksum(m_frame));
+    return buf;
+}
+
+std::string DeviceFrameMirror::Encode(const std::vector<CellRun>& runs) const {
+    // Room for "F:" and the closing '!' on every line
+    const size_t room = m_options.maxLineLength - 3;
+    std::string out, line;
+    char hex[8];
+    auto put = [&](unsigned v) {
+        std::snprintf(hex, sizeof(hex), "%02X", v & 0xFF);
+        line += hex;
+    };
+    auto flush = [&]() {
+        if (line.empty()) return;
+        out += "F:" + line + "\n";
+        line.clear();
+    };
+
+    for (const CellRun& r : runs) {
+        if (r.kind != CellRun::Literal) {
+            if (line.size() + 6 > room) flush();
+            put((unsigned)r.offset);
+            put((unsigned)r.count | (r.kind == CellRun::Repeat ? 0x80u : 0xC0u));
+            put(r.kind == CellRun::Repeat ? r.patterns[0] : (unsigned)r.source);
+            continue;
+        }
+        // Literals split across lines, each piece in hex or packed,
+        // whichever carries more cells in the room left
+        for (size_t done = 0; done < r.count;) {
+            if (line.size() + 6 > room) flush();
+            const size_t space = room - line.size() - 4, left = r.count - done;
+            const uint8_t* cells = r.patterns.data() + done;
+            size_t n = (std::min)(left, space / 2), packed = 0;
+            if (m_options.packed) {
+                size_t bits = 0;
+                while (packed < left && (bits + PackedBits(cells + packed, 1) + 5) / 6 <= space)
+                    bits += PackedBits(cells + packed++, 1);
+            }
+            put((unsigned)(r.offset + done));
+            if (packed > n || (packed == n && PackedSize(cells, n) < 2 * n)) {
+                put((unsigned)packed | 0x40u);
+                PackPatterns(cells, packed, line);
+                done += packed;
+            } else {
+                put((unsigned)n);
+                for (size_t k = 0; k < n; k++) put(cells[k]);
+                done += n;
+            }
+        }
+    }
+    line += '!';
+    flush();
+    return out;
+}
+
+std::string DeviceFrameMirror::Update(const std::vector<uint8_t>& newFrame) {
+    std::vector<uint8_t> target = newFrame;
+    target.resize(m_options.cells, 0);
+    if (m_synced && target == m_frame) return std::string();
+
+    std::vector<CellRun> runs = DiffCells(m_synced ? m_frame : std::vector<uint8_t>(), target);
+    m_frame = std::move(target);
+    m_synced = true;
+    return Encode(runs);
+}
@@ -0,0 +1,82 @@
+// FrameDelta.h - Sends the changed cells of a multi-cell line instead of
+// the whole line.
+//
+// Most refreshes of a line of cells change a few of them: a fixed typo, a
+// moved cursor, or a scroll by a word that shifts everything else along.
+// DiffCells() turns old -> new into runs against the device's frame: a
+// copy of cells already there for a shift, a repeat for a row of equal
+// cells (blanks), and literal patterns for the rest. DeviceFrameMirror
+// keeps the frame the device shows and encodes the runs as the firmware's
+// "F:" lines (braille/src/main.cpp), the last one ending in '!' so the
+// device shows the whole change at once. Over a slow link, literal runs
+// can go packed (PatternCode.h) once the device's CAPS reply offers it.
+//
+// Frames hold patterns in the firmware's F: bit order (BrailleCell, as for
+// P:): bits 0-2 = dots 1-3, bit 3 = dot 7, bits 4-6 = dots 4-6, bit 7 =
+// dot 8. Patterns from BrailleConverter or a .brd file (bit n-1 = dot n)
+// have to be moved to it first.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct CellRun {
+    enum Kind { Literal, Repeat, Copy };
+    Kind kind;
+    size_t offset;                   // first cell written
+    size_t count;
+    size_t source = 0;               // Copy: first cell read, before this run
+    std::vector<uint8_t> patterns;   // Literal: count patterns; Repeat: one
+};
+
+struct FrameDeltaOptions {
+    size_t cells = 32;               // FRAME_CELLS
+    size_t maxLineLength = 62;       // firmware inputBuffer (64) minus '\n' and NUL
+    bool packed = false;             // literal runs Huffman-coded where shorter; see ParseFrameCaps
+};
+
+// Reads the reply to "CAPS" ("CAPS:FRAME,PACK2"): sets options.packed when
+// the device decodes this host's pattern code. False if the device has no
+// F: frames at all (older firmware answers ERR:unknown cmd).
+bool ParseFrameCaps(const std::string& reply, FrameDeltaOptions& options);
+
+// Runs that turn oldFrame into newFrame (both `cells` long) when applied
+// in order. With no oldFrame known (empty), every cell is written.
+std::vector<CellRun> DiffCells(const std::vector<uint8_t>& oldFrame, const std::vector<uint8_t>& newFrame);
+
+// Applies runs to frame (the reference for what the firmware does)
+void ApplyRuns(std::vector<uint8_t>& frame, const std::vector<CellRun>& runs);
+
+// CRC-16/CCITT-FALSE of the frame, as reported by the firmware's FSUM
+uint16_t FrameChecksum(const std::vector<uint8_t>& frame);
+
+class DeviceFrameMirror {
+public:
+    explicit DeviceFrameMirror(FrameDeltaOptions options = FrameDeltaOptions());
+
+    // Commands, '\n'-terminated and concatenated, that bring the device
+    // from the last synced frame to newFrame (cut or padded with blanks
+    // to the cell count). Empty if nothing changed. The mirror assumes
+    // they will be delivered; call Reset() if not (an ERR:frame reply).
+    std::string Update(const std::vector<uint8_t>& newFrame);
+
+    // The device frame is unknown: the next Update() writes every cell
+    void Reset();
+
+    const std::vector<uint8_t>& Frame() const { return m_frame; }
+    bool Synced() const { return m_synced; }
+
+    // Expected reply to "FSUM" for the current frame
+    std::string ExpectedSum() const;
+
+    // Encodes runs as F: lines, the last one committing
+    std::string Encode(const std::vector<CellRun>& runs) const;
+
+private:
+    FrameDeltaOptions m_options;
+    std::vector<uint8_t> m_frame;
+    bool m_synced = false;
+};
@@ -0,0 +1,255 @@
+// FrameRecord.cpp - Chunked frame recordings. See FrameRecord.h.
+
+#include "FrameRecord.h"
+
+#include "Lz4Block.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+
+namespace {
+
+const char kFileMagic[8] = { 'B', 'R', 'F', 'R', 'A', 'M', 'E', 'S' };
+const uint32_t kVersion = 1;
+const uint32_t kChunkMagic = 0x314D5246;   // "FRM1"
+const size_t kHeaderBytes = 64;
+const uint32_t kStoredRaw = 0x80000000u;   // block size flag
+
+enum Codec : uint8_t { kRaw = 0, kLz4 = 1 };
+
+size_t Align64(size_t n) { return (n + 63) & ~(size_t)63; }
+
+void Put16(uint8_t* p, uint16_t v) { for (int i = 0; i < 2; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+void Put32(uint8_t* p, uint32_t v) { for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+void Put64(uint8_t* p, uint64_t v) { for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+
+uint16_t Get16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+uint32_t Get32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+uint64_t Get64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+} // namespace
+
+FrameRecorder::FrameRecorder(FrameRecordOptions options) : m_options(options) {
+    m_options.blockRows = (std::max)(1, (std::min)(65535, m_options.blockRows));
+}
+
+bool FrameRecorder::Open(const std::string& path, std::string& err) {
+    Close();
+    m_out.open(std::filesystem::u8path(path), std::ios::binary | std::ios::trunc);
+    if (!m_out) { err = "Cannot create " + path; return false; }
+
+    uint8_t header[kHeaderBytes] = {};
+    memcpy(header, kFileMagic, sizeof(kFileMagic));
+    Put32(header + 8, kVersion);
+    m_out.write(reinterpret_cast<const char*>(header), kHeaderBytes);
+    m_out.flush();
+    if (!m_out) { err = "Cannot write " + path; Close(); return false; }
+
+    m_frames = 0;
+    m_rawBytes = 0;
+    m_fileBytes = kHeaderBytes;
+    return true;
+}
+
+void FrameRecorder::Close() {
+    if (m_out.is_open()) m_out.close();
+    m_out.clear();
+}
+
+bool FrameRecorder::Add(const uint8_t* pixels, int width, int height, ptrdiff_t stride,
+                        FrameFormat format, int64_t timestampUs, std::string& err) {
+    if (!m_out.is_open()) { err = "Recording is not open."; return false; }
+    const size_t rowBytes = (size_t)width * FrameBytesPerPixel(format);
+    if (!pixels || width <= 0 || height <= 0 || width > 65535 || height > 65535 ||
+        stride < (ptrdiff_t)rowBytes || (format != FrameFormat::Bgra8 && format != FrameFormat::Gray8)) {
+        err = "Invalid frame.";
+        return false;
+    }
+
+    ThreadPool& pool = PoolOrShared(m_options.pool);
+    const size_t outStride = Align64(rowBytes);
+    const size_t rawBytes = outStride * height;
+    m_rows.resize(rawBytes);
+    pool.ParallelFor(0, height, 64, [&](int y0, int y1) {
+        for (int y = y0; y < y1; y++) {
+            uint8_t* row = &m_rows[(size_t)y * outStride];
+            memcpy(row, pixels + (ptrdiff_t)y * stride, rowBytes);
+            memset(row + rowBytes, 0, outStride - rowBytes);
+        }
+    });
+
+    // Each block is compressed into its own slot, at most its raw size;
+    // blocks that do not shrink are stored raw
+    const int blockRows = (std::min)(m_options.blockRows, (int)((kStoredRaw - 1) / outStride));
+    const int blocks = (height + blockRows - 1) / blockRows;
+    const size_t blockBytes = (size_t)blockRows * outStride;
+    size_t payloadBytes = rawBytes;
+    uint8_t codec = kRaw;
+    if (m_options.compress) {
+        m_packed.resize(rawBytes);
+        m_sizes.resize((size_t)blocks);
+        pool.ParallelFor(0, blocks, 1, [&](int b0, int b1) {
+            for (int b = b0; b < b1; b++) {
+                const size_t offset = (size_t)b * blockBytes;
+                const size_t n = (std::min)(blockBytes, rawBytes - offset);
+                size_t packed = Lz4Compress(&m_rows[offset], n, &m_packed[offset], n - 1);
+                if (packed == 0) {
+                    memcpy(&m_packed[offset], &m_rows[offset], n);
+                    m_sizes[(size_t)b] = (uint32_t)n | kStoredRaw;
+                } else {
+                    m_sizes[(size_t)b] = (uint32_t)packed;
+                }
+            }
+        });
+        size_t total = 4 * (size_t)blocks;
+        for (uint32_t s : m_sizes) total += s & ~kStoredRaw;
+        if (total < rawBytes) {
+            codec = kLz4;
+            payloadBytes = total;
+        }
+    }
+
+    uint8_t header[kHeaderBytes] = {};
+    Put32(header, kChunkMagic);
+    header[4] = (uint8_t)format;
+    header[5] = codec;
+    Put16(header + 6, (uint16_t)blockRows);
+    Put32(header + 8, (uint32_t)width);
+    Put32(header + 12, (uint32_t)height);
+    Put32(header + 16, (uint32_t)outStride);
+    Put64(header + 20, (uint64_t)timestampUs);
+    Put64(header + 28, (uint64_t)payloadBytes);
+    m_out.write(reinterpret_cast<const char*>(header), kHeaderBytes);
+
+    if (codec == kRaw) {
+        m_out.write(reinterpret_cast<const char*>(m_rows.data()), (std::streamsize)rawBytes);
+    } else {
+        for (int b = 0; b < blocks; b++) {
+            uint8_t size[4];
+            Put32(size, m_sizes[(size_t)b]);
+            m_out.write(reinterpret_cast<const char*>(size), 4);
+        }
+        for (int b = 0; b < blocks; b++)
+            m_out.write(reinterpret_cast<const char*>(&m_packed[(size_t)b * blockBytes]),
+                        (std::streamsize)(m_sizes[(size_t)b] & ~kStoredRaw));
+    }
+    static const char zeros[64] = {};
+    const size_t chunkBytes = kHeaderBytes + payloadBytes;
+    m_out.write(zeros, (std::streamsize)(Align64(chunkBytes) - chunkBytes));
+    m_out.flush();
+    if (!m_out) { err = "Write failed."; return false; }
+
+    m_frames++;
+    m_rawBytes += rawBytes;
+    m_fileBytes += Align64(chunkBytes);
+    return true;
+}
+
+bool FrameReader::Open(const std::string& path, std::string& err) {
+    Close();
+    if (!m_file.Open(path, err)) return false;
+
+    const uint8_t* data = m_file.Data();
+    const size_t size = m_file.Size();
+    if (size < kHeaderBytes || memcmp(data, kFileMagic, sizeof(kFileMagic)) != 0) {
+        err = path + " is not a frame recording.";
+        m_file.Close();
+        return false;
+    }
+    if (Get32(data + 8) != kVersion) {
+        err = path + " has unsupported version " + std::to_string(Get32(data + 8)) + ".";
+        m_file.Close();
+        return false;
+    }
+
+    // Stop at the first chunk that is cut short or does not make sense
+    size_t offset = kHeaderBytes;
+    while (size - offset >= kHeaderBytes) {
+        const uint8_t* h = data + offset;
+        Chunk c;
+        c.info.format = (FrameFormat)h[4];
+        const uint8_t codec = h[5];
+        c.blockRows = Get16(h + 6);
+        c.info.width = (int)Get32(h + 8);
+        c.info.height = (int)Get32(h + 12);
+        c.info.stride = (ptrdiff_t)Get32(h + 16);
+        c.info.timestampUs = (int64_t)Get64(h + 20);
+        c.info.storedBytes = (size_t)Get64(h + 28);
+        c.info.compressed = codec == kLz4;
+        c.offset = offset + kHeaderBytes;
+
+        if (Get32(h) != kChunkMagic || h[4] > (uint8_t)FrameFormat::Gray8 || codec > kLz4 ||
+            c.info.width <= 0 || c.info.width > 65535 || c.info.height <= 0 || c.info.height > 65535 ||
+            c.info.stride != (ptrdiff_t)Align64((size_t)c.info.width * FrameBytesPerPixel(c.info.format)) ||
+            c.blockRows == 0 || c.info.storedBytes > size - c.offset)
+            break;
+        const size_t rawBytes = (size_t)c.info.stride * c.info.height;
+        const size_t blocks = (size_t)(c.info.height + c.blockRows - 1) / c.blockRows;
+        if (codec == kRaw ? c.info.storedBytes != rawBytes : c.info.storedBytes < 4 * blocks) break;
+
+        m_frames.push_back(c);
+        offset = (std::min)(size, Align64(c.offset + c.info.storedBytes));
+    }
+    return true;
+}
+
+void FrameReader::Close() {
+    m_file.Close();
+    m_frames.clear();
+    m_current = (size_t)-1;
+}
+
+const uint8_t* FrameReader::Frame(size_t frame) {
+    if (frame >= m_frames.size()) return nullptr;
+    if (m_current < m_frames.size() && m_current != frame) {
+        const Chunk& last = m_frames[m_current];
+        m_file.Discard(last.offset - kHeaderBytes, kHeaderBytes + last.info.storedBytes);
+    }
+    m_current = frame;
+
+    const Chunk& c = m_frames[frame];
+    const uint8_t* payload = m_file.Data() + c.offset;
+    if (!c.info.compressed) return payload;
+
+    const size_t stride = (size_t)c.info.stride;
+    const size_t rawBytes = stride * c.info.height;
+    const size_t blockBytes = (size_t)c.blockRows * stride;
+    const int blocks = (c.info.height + c.blockRows - 1) / c.blockRows;
+
+    // Block offsets from the size table, checked against the payload
+    std::vector<size_t> starts((size_t)blocks + 1);
+    starts[0] = 4 * (size_t)blocks;
+    for (int b = 0; b < blocks; b++) {
+        const size_t n = Get32(payload + 4 * (size_t)b) & ~kStoredRaw;
+        if (n > c.info.storedBytes - starts[(size_t)b]) return nullptr;
+        starts[(size_t)b + 1] = starts[(size_t)b] + n;
+    }
+
+    m_decoded.resize(rawBytes);
+    std::atomic<bool> ok{ true };
+    PoolOrShared(m_pool).ParallelFor(0, blocks, 1, [&](int b0, int b1) {
+        for (int b = b0; b < b1; b++) {
+            const size_t out = (size_t)b * blockBytes;
+            const size_t n = (std::min)(blockBytes, rawBytes - out);
+            const uint8_t* in = payload + starts[(size_t)b];
+            const size_t inBytes = starts[(size_t)b + 1] - starts[(size_t)b];
+            if (Get32(payload + 4 * (size_t)b) & kStoredRaw) {
+                if (inBytes != n) { ok = false; continue; }
+                memcpy(&m_decoded[out], in, n);
+            } else if (!Lz4Decompress(in, inBytes, &m_decoded[out], n)) {
+                ok = false;
+            }
+        }
+    });
+    return ok ? m_decoded.data() : nullptr;
+}
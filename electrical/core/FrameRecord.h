@@ -0,0 +1,123 @@
+// FrameRecord.h - Recorded capture sessions for offline replay.
+//
+// A recording holds frames as the capture produced them (BGRA or Gray8
+// pixels, row stride and a timestamp), so the preprocessing and change
+// detection stages can be run and benchmarked on Linux without a screen.
+// FrameRecorder appends frames to a file; FrameReader memory-maps one and
+// hands frames out by index.
+//
+// Each frame is one chunk: a 64-byte header, then its rows. Rows are
+// stored at the frame's stride, the row size rounded up to 64 bytes, with
+// the padding zeroed. A frame is stored raw, or as LZ4 blocks (Lz4Block.h)
+// of blockRows rows each when that is smaller; the blocks are compressed
+// and decoded in parallel on a ThreadPool. Chunks start on 64-byte
+// boundaries, so a raw frame is used in place from the mapping and only
+// compressed frames are copied, into one buffer the reader reuses.
+//
+// Layout, little-endian:
+//   file header (64 bytes)  "BRFRAMES", uint32 version
+//   chunk header (64 bytes) uint32 'FRM1', uint8 format, uint8 codec,
+//                           uint16 blockRows, int32 width, height, stride,
+//                           int64 timestampUs, uint64 payloadBytes
+//   payload                 raw: height * stride bytes
+//                           LZ4: uint32 size per block (bit 31: stored
+//                           raw), then the blocks back to back
+//
+// There is no index: Open() walks the chunk headers, which touches one
+// page per frame. A recording cut short (the capture crashed, the disk
+// filled) opens with the frames that were written in full.
+
+#pragma once
+
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+enum class FrameFormat : uint8_t { Bgra8 = 0, Gray8 = 1 };
+
+inline int FrameBytesPerPixel(FrameFormat format) { return format == FrameFormat::Bgra8 ? 4 : 1; }
+
+struct FrameInfo {
+    FrameFormat format = FrameFormat::Bgra8;
+    int width = 0, height = 0;
+    ptrdiff_t stride = 0;         // bytes per row as stored and as handed out
+    int64_t timestampUs = 0;      // as given to FrameRecorder::Add()
+    bool compressed = false;
+    size_t storedBytes = 0;       // payload size in the file
+};
+
+struct FrameRecordOptions {
+    bool compress = true;         // LZ4, kept only for frames it makes smaller
+    int blockRows = 64;           // rows per LZ4 block
+    ThreadPool* pool = nullptr;   // null: ThreadPool::Shared()
+};
+
+class FrameRecorder {
+public:
+    explicit FrameRecorder(FrameRecordOptions options = FrameRecordOptions());
+    ~FrameRecorder() { Close(); }
+
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    // Creates or truncates path (UTF-8). Returns false and sets err on failure.
+    bool Open(const std::string& path, std::string& err);
+    void Close();
+
+    bool IsOpen() const { return m_out.is_open(); }
+
+    // Appends a frame; stride is the source's (may be larger than a row).
+    // The file is flushed after every frame.
+    bool Add(const uint8_t* pixels, int width, int height, ptrdiff_t stride,
+             FrameFormat format, int64_t timestampUs, std::string& err);
+
+    size_t Frames() const { return m_frames; }
+    size_t RawBytes() const { return m_rawBytes; }      // payload bytes if nothing were compressed
+    size_t FileBytes() const { return m_fileBytes; }
+
+private:
+    FrameRecordOptions m_options;
+    std::ofstream m_out;
+    std::vector<uint8_t> m_rows;     // frame at its stored stride
+    std::vector<uint8_t> m_packed;   // compressed blocks, each at its bound
+    std::vector<uint32_t> m_sizes;
+    size_t m_frames = 0;
+    size_t m_rawBytes = 0;
+    size_t m_fileBytes = 0;
+};
+
+class FrameReader {
+public:
+    explicit FrameReader(ThreadPool* pool = nullptr) : m_pool(pool) {}
+
+    // Maps path (UTF-8) and indexes its frames. Returns false and sets err
+    // if it is not a recording; a truncated last frame is dropped.
+    bool Open(const std::string& path, std::string& err);
+    void Close();
+
+    size_t FrameCount() const { return m_frames.size(); }
+    const FrameInfo& Info(size_t frame) const { return m_frames[frame].info; }
+
+    // Pixels of frame k at Info(k).stride, valid until the next Frame() or
+    // Close(). Null if k is out of range or its data is corrupt. Mapped
+    // pages of the previously returned frame are released.
+    const uint8_t* Frame(size_t frame);
+
+private:
+    struct Chunk {
+        FrameInfo info;
+        int blockRows = 0;
+        size_t offset = 0;   // payload offset in the file
+    };
+
+    ThreadPool* m_pool;
+    MappedFile m_file;
+    std::vector<Chunk> m_frames;
+    std::vector<uint8_t> m_decoded;
+    size_t m_current = (size_t)-1;
+};
@@ -0,0 +1,291 @@
+// ImageScale.h - Bilinear resampling of 8-bit images (header-only).
+//
+// Used by driver.cpp to enlarge small OCR regions before recognition.
+// Pixel mapping matches the old float loop in UpscaleIfLowResolution:
+// destination pixel x samples source position x * srcW / dstW (no half-
+// pixel offset), clamped at the right and bottom edges.
+//
+// Source positions are snapped to 1/128 pixel (exact for the 2x and 4x
+// factors driver.cpp uses) and the math is 16-bit fixed point with 7-bit
+// weights, so the only rounding is the final one. Each output row is
+// done in two passes: a vertical blend of the two source rows into a row
+// of int16 (SIMD over the whole row), then a horizontal blend that uses a
+// table of column offsets and weights computed once per call. Results are
+// rounded and stay within +-1 of an exact float computation; the scalar,
+// SSE2 and AVX2 kernels produce identical bytes. Output rows run on a
+// ThreadPool in tiles of grainRows.
+
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMAGESCALE_SSE2 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(IMAGESCALE_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define IMAGESCALE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define IMAGESCALE_TARGET_AVX2
+#endif
+
+enum class ScaleKernel {
+    Auto,      // fastest kernel this CPU supports
+    Scalar,
+    Sse2,
+    Avx2,
+};
+
+namespace imagescale_detail {
+
+const int kFracBits = 7;
+const int kOne = 1 << kFracBits;
+const int kShift = 2 * kFracBits;              // after both passes
+const int kRound = 1 << (kShift - 1);
+
+// One destination column: int16 offsets of the two source pixels in the
+// vertically blended row, and their weights packed as (w0 | w1 << 16)
+// for _mm_madd_epi16.
+struct Column {
+    uint32_t off0;
+    uint32_t off1;
+    uint32_t weights;
+};
+
+inline void SourcePosition(int i, int dstSize, int srcSize, int& i0, int& i1, int& frac) {
+    uint64_t pos = (uint64_t)i * (uint64_t)srcSize * kOne / (uint64_t)dstSize;
+    i0 = (int)(pos >> kFracBits);
+    frac = (int)(pos & (kOne - 1));
+    i1 = (std::min)(i0 + 1, srcSize - 1);
+}
+
+inline void BuildColumns(int srcW, int dstW, int channels, std::vector<Column>& cols) {
+    cols.resize((size_t)dstW);
+    for (int x = 0; x < dstW; x++) {
+        int x0, x1, frac;
+        SourcePosition(x, dstW, srcW, x0, x1, frac);
+        cols[x].off0 = (uint32_t)(x0 * channels);
+        cols[x].off1 = (uint32_t)(x1 * channels);
+        cols[x].weights = (uint32_t)(kOne - frac) | ((uint32_t)frac << 16);
+    }
+}
+
+// ---- Vertical pass: v[i] = r0[i] * (128 - wy) + r1[i] * wy  (<= 32640) ----
+
+inline void BlendRowsScalar(const uint8_t* r0, const uint8_t* r1, int wy, int16_t* v, size_t n, size_t i = 0) {
+    const int w0 = kOne - wy;
+    for (; i < n; i++) v[i] = (int16_t)(r0[i] * w0 + r1[i] * wy);
+}
+
+#if defined(IMAGESCALE_SSE2)
+inline void BlendRowsSse2(const uint8_t* r0, const uint8_t* r1, int wy, int16_t* v, size_t n) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i w0 = _mm_set1_epi16((short)(kOne - wy));
+    const __m128i w1 = _mm_set1_epi16((short)wy);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r0 + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r1 + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), w0),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), w1));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), w0),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), w1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(v + i), lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(v + i + 8), hi);
+    }
+    BlendRowsScalar(r0, r1, wy, v, n, i);
+}
+
+IMAGESCALE_TARGET_AVX2
+inline void BlendRowsAvx2(const uint8_t* r0, const uint8_t* r1, int wy, int16_t* v, size_t n) {
+    const __m256i w0 = _mm256_set1_epi16((short)(kOne - wy));
+    const __m256i w1 = _mm256_set1_epi16((short)wy);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i a0 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(r0 + i)));
+        __m256i b0 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(r1 + i)));
+        __m256i a1 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(r0 + i + 16)));
+        __m256i b1 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(r1 + i + 16)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(v + i),
+                            _mm256_add_epi16(_mm256_mullo_epi16(a0, w0), _mm256_mullo_epi16(b0, w1)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(v + i + 16),
+                            _mm256_add_epi16(_mm256_mullo_epi16(a1, w0), _mm256_mullo_epi16(b1, w1)));
+    }
+    BlendRowsScalar(r0, r1, wy, v, n, i);
+}
+#endif
+
+// ---- Horizontal pass: out = (v[off0] * w0 + v[off1] * w1 + round) >> 14 ----
+
+inline void BlendColumnsScalar(const int16_t* v, const Column* cols, int channels, uint8_t* out, int dstW, int x = 0) {
+    for (; x < dstW; x++) {
+        const Column& c = cols[x];
+        int w0 = (int)(c.weights & 0xFFFF);
+        int w1 = (int)(c.weights >> 16);
+        for (int ch = 0; ch < channels; ch++) {
+            int s = v[c.off0 + ch] * w0 + v[c.off1 + ch] * w1;
+            out[x * channels + ch] = (uint8_t)((s + kRound) >> kShift);
+        }
+    }
+}
+
+#if defined(IMAGESCALE_SSE2)
+// Four channels of one destination pixel as 4 x int32
+inline __m128i Pixel4(const int16_t* v, const Column& c) {
+    __m128i a = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + c.off0));
+    __m128i b = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + c.off1));
+    return _mm_madd_epi16(_mm_unpacklo_epi16(a, b), _mm_set1_epi32((int)c.weights));
+}
+
+inline __m128i Finish4(__m128i s) {
+    return _mm_srai_epi32(_mm_add_epi32(s, _mm_set1_epi32(kRound)), kShift);
+}
+
+inline void BlendColumns4Sse2(const int16_t* v, const Column* cols, uint8_t* out, int dstW) {
+    int x = 0;
+    for (; x + 4 <= dstW; x += 4) {
+        __m128i p0 = Finish4(Pixel4(v, cols[x]));
+        __m128i p1 = Finish4(Pixel4(v, cols[x + 1]));
+        __m128i p2 = Finish4(Pixel4(v, cols[x + 2]));
+        __m128i p3 = Finish4(Pixel4(v, cols[x + 3]));
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), packed);
+    }
+    BlendColumnsScalar(v, cols, 4, out, dstW, x);
+}
+
+IMAGESCALE_TARGET_AVX2
+inline __m256i PixelPair4(const int16_t* v, const Column& lo, const Column& hi) {
+    __m256i a = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + lo.off0))),
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + hi.off0)), 1);
+    __m256i b = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + lo.off1))),
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + hi.off1)), 1);
+    __m256i w = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_set1_epi32((int)lo.weights)), _mm_set1_epi32((int)hi.weights), 1);
+    __m256i s = _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), w);
+    return _mm256_srai_epi32(_mm256_add_epi32(s, _mm256_set1_epi32(kRound)), kShift);
+}
+
+IMAGESCALE_TARGET_AVX2
+inline void BlendColumns4Avx2(const int16_t* v, const Column* cols, uint8_t* out, int dstW) {
+    int x = 0;
+    for (; x + 8 <= dstW; x += 8) {
+        // Lane 0 holds pixels x..x+3, lane 1 holds x+4..x+7, so the
+        // in-lane packs leave them in memory order.
+        __m256i p0 = PixelPair4(v, cols[x], cols[x + 4]);
+        __m256i p1 = PixelPair4(v, cols[x + 1], cols[x + 5]);
+        __m256i p2 = PixelPair4(v, cols[x + 2], cols[x + 6]);
+        __m256i p3 = PixelPair4(v, cols[x + 3], cols[x + 7]);
+        __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(p0, p1), _mm256_packs_epi32(p2, p3));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x * 4), packed);
+    }
+    BlendColumnsScalar(v, cols, 4, out, dstW, x);
+}
+#endif
+
+inline bool CpuHasAvx2() {
+#if defined(IMAGESCALE_SSE2) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_cpu_supports("avx2");
+#elif defined(IMAGESCALE_SSE2) && defined(_MSC_VER)
+    int r[4];
+    __cpuid(r, 1);
+    bool osxsave = (r[2] & (1 << 27)) != 0;
+    bool avx = (r[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(r, 7, 0);
+    return (r[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+inline ScaleKernel Resolve(ScaleKernel kernel) {
+#if defined(IMAGESCALE_SSE2)
+    static const bool hasAvx2 = CpuHasAvx2();
+    if (kernel == ScaleKernel::Auto) return hasAvx2 ? ScaleKernel::Avx2 : ScaleKernel::Sse2;
+    if (kernel == ScaleKernel::Avx2 && !hasAvx2) return ScaleKernel::Sse2;
+    return kernel;
+#else
+    (void)kernel;
+    return ScaleKernel::Scalar;
+#endif
+}
+
+// One output row from source rows r0/r1 (rowValues = srcW * channels).
+// v is scratch of rowValues int16; kernel must already be resolved.
+inline void ResampleRow(ScaleKernel kernel, const uint8_t* r0, const uint8_t* r1, int wy,
+                        int16_t* v, size_t rowValues, const Column* cols, int channels,
+                        uint8_t* out, int dstW) {
+    switch (kernel) {
+#if defined(IMAGESCALE_SSE2)
+    case ScaleKernel::Avx2:
+        BlendRowsAvx2(r0, r1, wy, v, rowValues);
+        if (channels == 4) BlendColumns4Avx2(v, cols, out, dstW);
+        else BlendColumnsScalar(v, cols, channels, out, dstW);
+        break;
+    case ScaleKernel::Sse2:
+        BlendRowsSse2(r0, r1, wy, v, rowValues);
+        if (channels == 4) BlendColumns4Sse2(v, cols, out, dstW);
+        else BlendColumnsScalar(v, cols, channels, out, dstW);
+        break;
+#endif
+    default:
+        BlendRowsScalar(r0, r1, wy, v, rowValues);
+        BlendColumnsScalar(v, cols, channels, out, dstW);
+        break;
+    }
+}
+
+} // namespace imagescale_detail
+
+// Kernel that ScaleKernel::Auto (or a request the CPU cannot run) resolves to.
+inline ScaleKernel ResolveScaleKernel(ScaleKernel kernel = ScaleKernel::Auto) {
+    return imagescale_detail::Resolve(kernel);
+}
+
+// Resamples an 8-bit image with 1 (gray) or 4 (BGRA) interleaved channels.
+// Strides are in bytes. pool null: ThreadPool::Shared(). Returns false on
+// bad arguments.
+inline bool ResizeBilinear(const uint8_t* src, int srcW, int srcH, ptrdiff_t srcStride,
+                           uint8_t* dst, int dstW, int dstH, ptrdiff_t dstStride,
+                           int channels, ScaleKernel kernel = ScaleKernel::Auto,
+                           ThreadPool* pool = nullptr, int grainRows = 32) {
+    using namespace imagescale_detail;
+
+    if (!src || !dst || srcW <= 0 || srcH <= 0 || dstW <= 0 || dstH <= 0) return false;
+    if (channels != 1 && channels != 4) return false;
+
+    kernel = Resolve(kernel);
+    const size_t rowValues = (size_t)srcW * channels;
+    std::vector<Column> cols;
+    BuildColumns(srcW, dstW, channels, cols);
+
+    PoolOrShared(pool).ParallelFor(0, dstH, grainRows, [&](int yBegin, int yEnd) {
+        std::vector<int16_t> v(rowValues);
+        for (int y = yBegin; y < yEnd; y++) {
+            int y0, y1, wy;
+            SourcePosition(y, dstH, srcH, y0, y1, wy);
+            ResampleRow(kernel, src + (ptrdiff_t)y0 * srcStride, src + (ptrdiff_t)y1 * srcStride, wy,
+                        v.data(), rowValues, cols.data(), channels, dst + (ptrdiff_t)y * dstStride, dstW);
+        }
+    });
+    return true;
+}
+
+inline bool ResizeBilinearBgra(const uint8_t* src, int srcW, int srcH, ptrdiff_t srcStride,
+                               uint8_t* dst, int dstW, int dstH, ptrdiff_t dstStride,
+                               ScaleKernel kernel = ScaleKernel::Auto,
+                               ThreadPool* pool = nullptr, int grainRows = 32) {
+    return ResizeBilinear(src, srcW, srcH, srcStride, dst, dstW, dstH, dstStride, 4, kernel, pool, grainRows);
+}
@@ -0,0 +1,177 @@
+// LatencyProbe.cpp - Probe replies, clock alignment and stages. See LatencyProbe.h.
+
+#include "LatencyProbe.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+const size_t kFrameBytes = 14;   // "T:HHHHHHHH,XX\n"
+const size_t kReplyBytes = 39;   // "T:" + four 8-digit fields + "\r\n"
+
+// CSV names of the stages Analyze() returns, in order
+const char* const kStageColumns[] = { "send_rx_us", "parse_us", "pin_write_us",
+                                      "reply_us", "send_pin_us", "round_trip_us" };
+
+// Parses exactly eight hex digits
+bool Hex8(const char* p, uint32_t& out) {
+    char buf[9];
+    for (int i = 0; i < 8; i++) {
+        char c = p[i];
+        if (!((c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f'))) return false;
+        buf[i] = c;
+    }
+    buf[8] = '\0';
+    out = (uint32_t)std::strtoul(buf, nullptr, 16);
+    return true;
+}
+
+} // namespace
+
+LatencyProbe::LatencyProbe(LatencyProbeOptions options) : m_options(options) {
+    m_options.baud = (std::max)(m_options.baud, 1u);
+    m_options.windowSamples = (std::max)(m_options.windowSamples, (size_t)1);
+}
+
+std::string LatencyProbe::Frame(uint64_t hostUs, uint8_t pattern) {
+    char buf[24];
+    std::snprintf(buf, sizeof(buf), "T:%08X,%02X\n", (unsigned)(uint32_t)hostUs, (unsigned)pattern);
+    return buf;
+}
+
+bool LatencyProbe::OnLine(const std::string& line, uint64_t hostUs) {
+    if (line.size() != kReplyBytes - 2 || line.compare(0, 2, "T:") != 0) return false;
+    uint32_t v[4];
+    for (int i = 0; i < 4; i++) {
+        const size_t at = 2 + 9 * (size_t)i;
+        if ((i > 0 && line[at - 1] != ',') || !Hex8(line.data() + at, v[i])) return false;
+    }
+
+    // The stamp is the low 32 bits of the send time, which is in the past
+    ProbeSample s;
+    s.hostReplyUs = hostUs;
+    s.hostSendUs = hostUs - (uint32_t)((uint32_t)hostUs - v[0]);
+
+    // micros() wraps every 71 minutes; the three readings are in order
+    uint64_t* device[3] = { &s.deviceRxUs, &s.deviceParsedUs, &s.devicePinUs };
+    for (int i = 0; i < 3; i++) {
+        const uint32_t m = v[i + 1];
+        if (m < m_lastMicros && m_lastMicros - m > 0x80000000u) m_deviceBase += (uint64_t)1 << 32;
+        m_lastMicros = m;
+        *device[i] = m_deviceBase + m;
+    }
+    m_samples.push_back(s);
+    return true;
+}
+
+void LatencyProbe::Clear() {
+    m_samples.clear();
+    m_deviceBase = 0;
+    m_lastMicros = 0;
+}
+
+ProbeAnalysis LatencyProbe::Analyze() const {
+    ProbeAnalysis r;
+    r.stages = { { "send->rx", {} }, { "parse", {} }, { "pin write", {} },
+                 { "reply", {} }, { "send->pin", {} }, { "round trip", {} } };
+    if (m_samples.empty()) return r;
+
+    // Times relative to the first sample keep the fit in double precision
+    const double hostBase = (double)m_samples[0].hostSendUs;
+    const double deviceBase = (double)m_samples[0].deviceRxUs;
+    auto host = [&](uint64_t t) { return (double)t - hostBase; };
+    auto device = [&](uint64_t t) { return (double)t - deviceBase; };
+
+    // The frame is complete on the device one frame time after it was
+    // sent at best, and the reply reaches the host one reply time after
+    // the pins were written; the rest of the round trip is unexplained
+    const double frameWire = kFrameBytes * 10e6 / m_options.baud;
+    const double replyWire = kReplyBytes * 10e6 / m_options.baud;
+    std::vector<double> xs, ys, bests;
+    for (size_t w = 0; w < m_samples.size(); w += m_options.windowSamples) {
+        const size_t end = (std::min)(m_samples.size(), w + m_options.windowSamples);
+        double best = 0, x = 0, y = 0;
+        for (size_t i = w; i < end; i++) {
+            const ProbeSample& s = m_samples[i];
+            const double in = host(s.hostSendUs) + frameWire;
+            const double out = host(s.hostReplyUs) - replyWire;
+            const double unexplained = (out - in) - (device(s.devicePinUs) - device(s.deviceRxUs));
+            if (i == w || unexplained < best) {
+                best = unexplained;
+                x = (in + out) / 2;
+                y = (device(s.deviceRxUs) + device(s.devicePinUs)) / 2;
+            }
+        }
+        xs.push_back(x);
+        ys.push_back(y);
+        bests.push_back(best);
+    }
+
+    // device = a + k * host
+    double a = ys[0] - xs[0], k = 1;
+    if (xs.size() > 1) {
+        double mx = 0, my = 0;
+        for (size_t i = 0; i < xs.size(); i++) { mx += xs[i]; my += ys[i]; }
+        mx /= xs.size();
+        my /= ys.size();
+        double sxy = 0, sxx = 0;
+        for (size_t i = 0; i < xs.size(); i++) {
+            sxy += (xs[i] - mx) * (ys[i] - my);
+            sxx += (xs[i] - mx) * (xs[i] - mx);
+        }
+        if (sxx > 0) k = sxy / sxx;
+        a = my - k * mx;
+    }
+    r.driftPpm = (k - 1) * 1e6;
+    r.uncertaintyUs = (std::max)(0.0, Percentile(bests, 0.5)) / 2;
+
+    auto toHost = [&](uint64_t t) { return (device(t) - a) / k; };
+    for (ProbeStage& stage : r.stages) stage.us.reserve(m_samples.size());
+    for (const ProbeSample& s : m_samples) {
+        const double send = host(s.hostSendUs), reply = host(s.hostReplyUs);
+        const double rx = toHost(s.deviceRxUs), parsed = toHost(s.deviceParsedUs), pin = toHost(s.devicePinUs);
+        r.stages[0].us.push_back(rx - send);
+        r.stages[1].us.push_back(parsed - rx);
+        r.stages[2].us.push_back(pin - parsed);
+        r.stages[3].us.push_back(reply - pin);
+        r.stages[4].us.push_back(pin - send);
+        r.stages[5].us.push_back(reply - send);
+    }
+    return r;
+}
+
+bool LatencyProbe::WriteCsv(const std::string& path, std::string& err) const {
+    std::ofstream out(std::filesystem::u8path(path), std::ios::trunc);
+    if (!out) { err = "Cannot create " + path; return false; }
+
+    const ProbeAnalysis r = Analyze();
+    out << "host_send_us,host_reply_us,device_rx_us,device_parsed_us,device_pin_us";
+    for (const char* column : kStageColumns) out << ',' << column;
+    out << '\n';
+
+    char buf[64];
+    for (size_t i = 0; i < m_samples.size(); i++) {
+        const ProbeSample& s = m_samples[i];
+        out << s.hostSendUs << ',' << s.hostReplyUs << ',' << s.deviceRxUs << ',' << s.deviceParsedUs << ','
+            << s.devicePinUs;
+        for (const ProbeStage& stage : r.stages) {
+            std::snprintf(buf, sizeof(buf), ",%.1f", stage.us[i]);
+            out << buf;
+        }
+        out << '\n';
+    }
+    out.flush();
+    if (!out) { err = "Cannot write " + path; return false; }
+    return true;
+}
+
+double LatencyProbe::Percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0;
+    size_t i = (size_t)(p * (values.size() - 1) + 0.5);
+    std::nth_element(values.begin(), values.begin() + (ptrdiff_t)i, values.end());
+    return values[i];
+}
@@ -0,0 +1,79 @@
+// LatencyProbe.h - Host side of the firmware's latency probe (T: frames).
+//
+// A firmware built with -DBRAILLE_PROBE ([env:uno_probe], braille_pty)
+// answers "T:HHHHHHHH,XX" - a host stamp and a dot pattern - with the
+// stamp and three micros() readings: when the line's '\n' was read, when
+// the frame was parsed and when the pins were written. LatencyProbe
+// collects those replies with the host times the frames were sent and
+// answered, maps the device clock onto the host clock and splits each
+// round trip into stages.
+//
+// Clock alignment: the samples with the shortest unexplained round trip
+// (round trip minus device time minus both frames' wire time) bound the
+// offset tightest, so the best sample of each window of samples gives an
+// offset estimate at its time, NTP-style, and a least-squares line
+// through them also takes out the drift of the Uno's resonator. Device
+// counters (32-bit micros(), 4 us steps on an Uno) are unwrapped.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct LatencyProbeOptions {
+    uint32_t baud = 115200;     // to take the frames' wire time out of the alignment
+    size_t windowSamples = 64;  // samples per clock offset estimate
+};
+
+// One answered frame. Host times are steady-clock microseconds; device
+// times are unwrapped micros() values.
+struct ProbeSample {
+    uint64_t hostSendUs = 0;
+    uint64_t hostReplyUs = 0;
+    uint64_t deviceRxUs = 0;
+    uint64_t deviceParsedUs = 0;
+    uint64_t devicePinUs = 0;
+};
+
+struct ProbeStage {
+    const char* name;
+    std::vector<double> us;     // one value per sample, host microseconds
+};
+
+struct ProbeAnalysis {
+    // send->rx, parse, pin write, reply, send->pin (the dot delay), round trip
+    std::vector<ProbeStage> stages;
+    double driftPpm = 0;        // device clock rate relative to the host
+    double uncertaintyUs = 0;   // half the typical best unexplained round trip of a window
+};
+
+class LatencyProbe {
+public:
+    explicit LatencyProbe(LatencyProbeOptions options = LatencyProbeOptions());
+
+    // The line to send for a frame stamped with hostUs, with its '\n'
+    static std::string Frame(uint64_t hostUs, uint8_t pattern);
+
+    // Feed each line from the device with the host time it arrived. Returns
+    // false for lines that are not probe replies.
+    bool OnLine(const std::string& line, uint64_t hostUs);
+
+    const std::vector<ProbeSample>& Samples() const { return m_samples; }
+    void Clear();
+
+    ProbeAnalysis Analyze() const;
+
+    // One row per sample: raw host and device times, then the aligned stages
+    bool WriteCsv(const std::string& path, std::string& err) const;
+
+    // Nearest-rank percentile, p in [0, 1]
+    static double Percentile(std::vector<double> values, double p);
+
+private:
+    LatencyProbeOptions m_options;
+    std::vector<ProbeSample> m_samples;
+    uint64_t m_deviceBase = 0;   // added to micros() to unwrap it
+    uint32_t m_lastMicros = 0;
+};
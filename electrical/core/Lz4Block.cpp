@@ -0,0 +1,146 @@
+// Lz4Block.cpp - Greedy LZ4 block compressor and bounds-checked decoder.
+
+#include "Lz4Block.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const size_t kMinMatch = 4;
+const size_t kLastLiterals = 5;    // a block ends with at least this many literals
+const size_t kMatchFindLimit = 12; // no match starts closer than this to the end
+const size_t kMaxOffset = 65535;
+const int kHashBits = 13;
+
+uint32_t Read32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+uint32_t Hash(uint32_t v) {
+    return (v * 2654435761u) >> (32 - kHashBits);
+}
+
+// Writes the 255-run continuation of a length field whose nibble was 15
+uint8_t* PutLength(uint8_t* op, size_t rest) {
+    while (rest >= 255) { *op++ = 255; rest -= 255; }
+    *op++ = (uint8_t)rest;
+    return op;
+}
+
+} // namespace
+
+size_t Lz4Compress(const uint8_t* src, size_t n, uint8_t* dst, size_t capacity) {
+    uint8_t* op = dst;
+    uint8_t* const opEnd = dst + capacity;
+    size_t anchor = 0;
+
+    // Room for a sequence with `lit` literals and a match of `len`
+    auto fits = [&](size_t lit, size_t len) {
+        return (size_t)(opEnd - op) >= 1 + lit + lit / 255 + 1 + 2 + len / 255 + 1;
+    };
+
+    if (n > kMatchFindLimit) {
+        uint32_t table[1 << kHashBits] = {};
+        const size_t matchLimit = n - kLastLiterals;
+        const size_t ipLimit = n - kMatchFindLimit;
+        size_t ip = 1;
+        table[Hash(Read32(src))] = 0;
+        unsigned misses = 0;
+
+        while (ip < ipLimit) {
+            const uint32_t seq = Read32(src + ip);
+            const uint32_t h = Hash(seq);
+            size_t cand = table[h];
+            table[h] = (uint32_t)ip;
+            if (cand >= ip || ip - cand > kMaxOffset || Read32(src + cand) != seq) {
+                // Skip faster through data that does not compress
+                ip += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+
+            while (ip > anchor && cand > 0 && src[ip - 1] == src[cand - 1]) { ip--; cand--; }
+            size_t len = kMinMatch;
+            while (ip + len < matchLimit && src[ip + len] == src[cand + len]) len++;
+
+            const size_t lit = ip - anchor;
+            if (!fits(lit, len)) return 0;
+            uint8_t* token = op++;
+            *token = (uint8_t)((lit >= 15 ? 15 : lit) << 4);
+            if (lit >= 15) op = PutLength(op, lit - 15);
+            memcpy(op, src + anchor, lit);
+            op += lit;
+            const size_t offset = ip - cand;
+            *op++ = (uint8_t)offset;
+            *op++ = (uint8_t)(offset >> 8);
+            const size_t extra = len - kMinMatch;
+            *token |= (uint8_t)(extra >= 15 ? 15 : extra);
+            if (extra >= 15) op = PutLength(op, extra - 15);
+
+            ip += len;
+            anchor = ip;
+            if (ip < ipLimit) table[Hash(Read32(src + ip - 2))] = (uint32_t)(ip - 2);
+        }
+    }
+
+    const size_t lit = n - anchor;
+    if (!fits(lit, 0)) return 0;
+    *op++ = (uint8_t)((lit >= 15 ? 15 : lit) << 4);
+    if (lit >= 15) op = PutLength(op, lit - 15);
+    memcpy(op, src + anchor, lit);
+    op += lit;
+    return (size_t)(op - dst);
+}
+
+bool Lz4Decompress(const uint8_t* src, size_t n, uint8_t* dst, size_t dstSize) {
+    const uint8_t* ip = src;
+    const uint8_t* const ipEnd = src + n;
+    size_t out = 0;
+
+    // Adds a 255-run continuation to len; false if the input runs out
+    auto readLength = [&](size_t& len) {
+        uint8_t b;
+        do {
+            if (ip == ipEnd) return false;
+            b = *ip++;
+            len += b;
+        } while (b == 255);
+        return true;
+    };
+
+    while (ip < ipEnd) {
+        const uint8_t token = *ip++;
+        size_t lit = token >> 4;
+        if (lit == 15 && !readLength(lit)) return false;
+        if ((size_t)(ipEnd - ip) < lit || dstSize - out < lit) return false;
+        memcpy(dst + out, ip, lit);
+        ip += lit;
+        out += lit;
+        if (ip == ipEnd) break;   // the last sequence has no match
+
+        if (ipEnd - ip < 2) return false;
+        const size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > out) return false;
+        size_t len = token & 15;
+        if (len == 15 && !readLength(len)) return false;
+        len += kMinMatch;
+        if (dstSize - out < len) return false;
+
+        // An overlapping match repeats the last `offset` bytes; copy it in
+        // doubling chunks that never overlap their source
+        uint8_t* d = dst + out;
+        const uint8_t* m = d - offset;
+        out += len;
+        while (len > 0) {
+            const size_t chunk = (std::min)(len, (size_t)(d - m));
+            memcpy(d, m, chunk);
+            d += chunk;
+            len -= chunk;
+        }
+    }
+    return out == dstSize;
+}
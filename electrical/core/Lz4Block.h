@@ -0,0 +1,25 @@
+// Lz4Block.h - LZ4 block compression without a library dependency.
+//
+// Produces and reads the standard LZ4 block format (no frame header), so
+// blocks written here decode with liblz4's LZ4_decompress_safe() and the
+// other way round. The compressor is the greedy single-probe kind: one
+// hash table of recent 4-byte sequences and a 64 KB window. Screen
+// captures are mostly flat runs and repeated glyphs, which it handles at
+// several hundred MB/s. The decompressor checks every length and offset
+// and never reads or writes outside the buffers it is given.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Largest compressed size of n input bytes
+inline size_t Lz4CompressBound(size_t n) { return n + n / 255 + 16; }
+
+// Compresses src into dst. Returns the compressed size, or 0 if it does
+// not fit in capacity (capacity >= Lz4CompressBound(n) always fits).
+size_t Lz4Compress(const uint8_t* src, size_t n, uint8_t* dst, size_t capacity);
+
+// Decompresses a block that must expand to exactly dstSize bytes. Returns
+// false on malformed input.
+bool Lz4Decompress(const uint8_t* src, size_t n, uint8_t* dst, size_t dstSize);
@@ -0,0 +1,42 @@
+// MappedFile.h - Read-only memory mapping of a whole file.
+//
+// Pages are read from disk when first touched, so opening costs the same
+// for 1 KB and 1 GB. Discard() lets the OS drop pages the caller is done
+// with; they are read again if touched later.
+//
+// Backends: mmap on Linux (MappedFilePosix.cpp), file mapping objects on
+// Windows (MappedFileWin32.cpp).
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Maps path (UTF-8). Returns false and sets err on failure. An empty
+    // file opens successfully with Data() == nullptr.
+    bool Open(const std::string& path, std::string& err);
+
+    void Close();
+
+    bool IsOpen() const { return m_open; }
+    const uint8_t* Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+
+    // Hint that [offset, offset + size) is not needed soon. Only whole
+    // pages inside the range are released.
+    void Discard(size_t offset, size_t size);
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_open = false;
+};
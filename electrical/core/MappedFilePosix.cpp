@@ -0,0 +1,63 @@
+// MappedFilePosix.cpp - mmap backend for MappedFile (Linux).
+
+#include "MappedFile.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+std::string Errno(const std::string& what) {
+    return what + ": " + std::strerror(errno);
+}
+
+} // namespace
+
+bool MappedFile::Open(const std::string& path, std::string& err) {
+    Close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) { err = Errno("Cannot open " + path); return false; }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) { err = Errno("fstat"); ::close(fd); return false; }
+    if (!S_ISREG(st.st_mode)) { err = path + " is not a regular file."; ::close(fd); return false; }
+
+    size_t size = (size_t)st.st_size;
+    if (size > 0) {
+        void* p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) { err = Errno("mmap"); ::close(fd); return false; }
+        // Documents are read front to back
+        madvise(p, size, MADV_SEQUENTIAL);
+        m_data = static_cast<const uint8_t*>(p);
+    }
+    ::close(fd);   // the mapping keeps the file open
+
+    m_size = size;
+    m_open = true;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+}
+
+void MappedFile::Discard(size_t offset, size_t size) {
+    if (!m_data || offset >= m_size) return;
+    if (size > m_size - offset) size = m_size - offset;
+
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t begin = (offset + page - 1) / page * page;
+    size_t end = offset + size == m_size ? m_size : (offset + size) / page * page;
+    if (end <= begin) return;
+    // Clean file-backed pages: dropped now, re-read from the file on access
+    madvise(const_cast<uint8_t*>(m_data) + begin, end - begin, MADV_DONTNEED);
+}
@@ -0,0 +1,76 @@
+// MappedFileWin32.cpp - File mapping backend for MappedFile (Windows).
+
+#include "MappedFile.h"
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+
+namespace {
+
+std::string LastError(const std::string& what) {
+    return what + " (error " + std::to_string(GetLastError()) + ")";
+}
+
+std::wstring Widen(const std::string& s) {
+    if (s.empty()) return {};
+    int len = MultiByteToWideChar(CP_UTF8, 0, s.data(), (int)s.size(), nullptr, 0);
+    std::wstring out((size_t)len, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, s.data(), (int)s.size(), &out[0], len);
+    return out;
+}
+
+} // namespace
+
+bool MappedFile::Open(const std::string& path, std::string& err) {
+    Close();
+
+    HANDLE file = CreateFileW(Widen(path).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) { err = LastError("Cannot open " + path); return false; }
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size)) { err = LastError("GetFileSizeEx"); CloseHandle(file); return false; }
+    if ((unsigned long long)size.QuadPart > (size_t)-1) {
+        err = path + " is too large to map.";
+        CloseHandle(file);
+        return false;
+    }
+
+    if (size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) { err = LastError("CreateFileMapping"); CloseHandle(file); return false; }
+        void* p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);   // the view keeps the mapping alive
+        if (!p) { err = LastError("MapViewOfFile"); CloseHandle(file); return false; }
+        m_data = static_cast<const uint8_t*>(p);
+    }
+    CloseHandle(file);
+
+    m_size = (size_t)size.QuadPart;
+    m_open = true;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (m_data) UnmapViewOfFile(m_data);
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+}
+
+void MappedFile::Discard(size_t offset, size_t size) {
+    if (!m_data || offset >= m_size) return;
+    if (size > m_size - offset) size = m_size - offset;
+
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    const size_t page = info.dwPageSize;
+    size_t begin = (offset + page - 1) / page * page;
+    size_t end = offset + size == m_size ? m_size : (offset + size) / page * page;
+    if (end <= begin) return;
+    // Removes the pages from the working set; they stay cached and
+    // fault back in from the file on access
+    VirtualUnlock(const_cast<uint8_t*>(m_data) + begin, end - begin);
+}
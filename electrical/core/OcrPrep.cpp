@@ -0,0 +1,141 @@
+// OcrPrep.cpp - Fused crop/gray/upscale. See OcrPrep.h.
+
+#include "OcrPrep.h"
+
+#include <algorithm>
+
+OcrPrep::OcrPrep(ThreadPool* pool, int grainRows)
+    : m_threadPool(pool), m_grainRows((std::max)(1, grainRows)) {}
+
+int OcrUpscaleFactor(int width) {
+    if (width < 100) return 4;
+    if (width < 800) return 2;
+    return 1;
+}
+
+#if defined(IMAGESCALE_SSE2)
+// Four BGRA pixels to four int32 gray values
+static inline __m128i Gray4(__m128i px, __m128i zero, __m128i weights, __m128i round) {
+    // madd gives (29 B + 150 G, 77 R + 0 A) per pixel; fold each pair
+    __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(px, zero), weights);
+    __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(px, zero), weights);
+    lo = _mm_add_epi32(lo, _mm_srli_epi64(lo, 32));
+    hi = _mm_add_epi32(hi, _mm_srli_epi64(hi, 32));
+    lo = _mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 1, 2, 0));
+    hi = _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 2, 0));
+    return _mm_srli_epi32(_mm_add_epi32(_mm_unpacklo_epi64(lo, hi), round), 8);
+}
+#endif
+
+void BgraRowToGray(const uint8_t* bgra, uint8_t* gray, int width, ScaleKernel kernel) {
+    int x = 0;
+#if defined(IMAGESCALE_SSE2)
+    if (ResolveScaleKernel(kernel) != ScaleKernel::Scalar) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i weights = _mm_setr_epi16(29, 150, 77, 0, 29, 150, 77, 0);
+        const __m128i round = _mm_set1_epi32(128);
+        for (; x + 8 <= width; x += 8) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bgra + x * 4));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bgra + x * 4 + 16));
+            __m128i g = _mm_packs_epi32(Gray4(a, zero, weights, round), Gray4(b, zero, weights, round));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(gray + x), _mm_packus_epi16(g, g));
+        }
+    }
+#else
+    (void)kernel;
+#endif
+    for (; x < width; x++) gray[x] = BgraToGray(bgra + x * 4);
+}
+
+bool OcrPrep::OutputSize(int frameW, int frameH, PixelRect rect, int factor, int& outW, int& outH) {
+    int left = (std::max)(rect.left, 0);
+    int top = (std::max)(rect.top, 0);
+    int right = (std::min)(rect.right, frameW);
+    int bottom = (std::min)(rect.bottom, frameH);
+    if (factor < 1 || right <= left || bottom <= top) return false;
+    outW = (right - left) * factor;
+    outH = (bottom - top) * factor;
+    return true;
+}
+
+bool OcrPrep::Run(const uint8_t* frame, int frameW, int frameH, ptrdiff_t frameStride,
+                  PixelRect rect, int factor, uint8_t* dst, ptrdiff_t dstStride, ScaleKernel kernel) {
+    using namespace imagescale_detail;
+
+    int outW, outH;
+    if (!frame || !dst || !OutputSize(frameW, frameH, rect, factor, outW, outH)) return false;
+
+    const int cropW = outW / factor;
+    const int cropH = outH / factor;
+    const uint8_t* origin = frame + (ptrdiff_t)(std::max)(rect.top, 0) * frameStride
+                                  + (ptrdiff_t)(std::max)(rect.left, 0) * 4;
+    kernel = ResolveScaleKernel(kernel);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ThreadPool& pool = PoolOrShared(m_threadPool);
+
+    if (factor == 1) {
+        pool.ParallelFor(0, cropH, m_grainRows, [&](int y0, int y1) {
+            for (int y = y0; y < y1; y++)
+                BgraRowToGray(origin + (ptrdiff_t)y * frameStride, dst + (ptrdiff_t)y * dstStride, cropW, kernel);
+        });
+        return true;
+    }
+
+    BuildColumns(cropW, outW, 1, m_cols);
+
+    // Scratch: two cached gray source rows, then the int16 blend row. One
+    // per thread that can be in the loop at once, taken up front so the
+    // pool's allocations do not depend on how the tiles were scheduled.
+    const int grain = m_grainRows * factor;
+    const size_t grayBytes = ((size_t)cropW * 2 + 15) & ~(size_t)15;
+    std::vector<BufferPool::Buffer> scratch((size_t)(std::min)(pool.Threads(), (outH + grain - 1) / grain));
+    for (auto& b : scratch) b = m_pool.Acquire(grayBytes + (size_t)cropW * sizeof(int16_t));
+    std::vector<uint8_t*> freeScratch;
+    for (auto& b : scratch) freeScratch.push_back(b.Data());
+    std::mutex scratchMutex;
+
+    pool.ParallelFor(0, outH, grain, [&](int yBegin, int yEnd) {
+        uint8_t* mem;
+        {
+            std::lock_guard<std::mutex> scratchLock(scratchMutex);
+            mem = freeScratch.back();
+            freeScratch.pop_back();
+        }
+        uint8_t* slot[2] = { mem, mem + cropW };
+        int16_t* v = reinterpret_cast<int16_t*>(mem + grayBytes);
+        int cached[2] = { -1, -1 };
+
+        // Output rows walk the source top to bottom, so each source row is
+        // converted once per tile and stays cached while its neighbours need it.
+        auto grayRow = [&](int row, int keep) -> const uint8_t* {
+            if (cached[0] == row) return slot[0];
+            if (cached[1] == row) return slot[1];
+            int s = cached[0] == keep ? 1 : 0;
+            BgraRowToGray(origin + (ptrdiff_t)row * frameStride, slot[s], cropW, kernel);
+            cached[s] = row;
+            return slot[s];
+        };
+
+        for (int y = yBegin; y < yEnd; y++) {
+            int y0, y1, wy;
+            SourcePosition(y, outH, cropH, y0, y1, wy);
+            const uint8_t* g0 = grayRow(y0, y1);
+            const uint8_t* g1 = grayRow(y1, y0);
+            ResampleRow(kernel, g0, g1, wy, v, (size_t)cropW, m_cols.data(), 1,
+                        dst + (ptrdiff_t)y * dstStride, outW);
+        }
+
+        std::lock_guard<std::mutex> scratchLock(scratchMutex);
+        freeScratch.push_back(mem);
+    });
+    return true;
+}
+
+bool OcrPrep::Run(const uint8_t* frame, int frameW, int frameH, ptrdiff_t frameStride,
+                  PixelRect rect, int factor, BufferPool::Buffer& out, int& outW, int& outH,
+                  ScaleKernel kernel) {
+    if (!OutputSize(frameW, frameH, rect, factor, outW, outH)) return false;
+    out = m_pool.Acquire((size_t)outW * outH);
+    return Run(frame, frameW, frameH, frameStride, rect, factor, out.Data(), outW, kernel);
+}
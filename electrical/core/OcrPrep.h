@@ -0,0 +1,66 @@
+// OcrPrep.h - Fused crop -> grayscale -> upscale for the region-OCR path.
+//
+// Reads the captured BGRA frame in place (any stride), converts only the
+// source rows the output needs to gray, once each, and resamples them
+// straight into the destination Gray8 buffer. There is no cropped BGRA
+// copy, no upscaled BGRA intermediate and no separate Gray8 conversion.
+// Scratch and pooled outputs come from a BufferPool, so repeated captures
+// of the same size do not allocate. Output rows run on a ThreadPool in
+// tiles of grainRows source rows.
+
+#pragma once
+
+#include "BufferPool.h"
+#include "ImageScale.h"
+#include "ThreadPool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+struct PixelRect {
+    int left, top, right, bottom;   // right/bottom exclusive, frame pixels
+};
+
+// Upscale factor the OCR path uses for a region this wide: OCR does poorly
+// on small text, so 4x below 100 px, 2x below 800 px, otherwise none.
+int OcrUpscaleFactor(int width);
+
+// Gray value used by OcrPrep: (29 B + 150 G + 77 R + 128) >> 8 (BT.601)
+inline uint8_t BgraToGray(const uint8_t* px) {
+    return (uint8_t)((29 * px[0] + 150 * px[1] + 77 * px[2] + 128) >> 8);
+}
+
+// Converts `width` BGRA pixels to gray
+void BgraRowToGray(const uint8_t* bgra, uint8_t* gray, int width, ScaleKernel kernel = ScaleKernel::Auto);
+
+class OcrPrep {
+public:
+    // pool null: ThreadPool::Shared()
+    explicit OcrPrep(ThreadPool* pool = nullptr, int grainRows = 16);
+
+    // Clips rect to the frame and returns the output size for `factor`.
+    // Returns false if nothing of the rect lies inside the frame.
+    static bool OutputSize(int frameW, int frameH, PixelRect rect, int factor, int& outW, int& outH);
+
+    // Writes the Gray8 result into caller memory (e.g. a locked
+    // SoftwareBitmap) of the size OutputSize() reports.
+    bool Run(const uint8_t* frame, int frameW, int frameH, ptrdiff_t frameStride,
+             PixelRect rect, int factor, uint8_t* dst, ptrdiff_t dstStride,
+             ScaleKernel kernel = ScaleKernel::Auto);
+
+    // Same, into a pooled buffer with stride outW.
+    bool Run(const uint8_t* frame, int frameW, int frameH, ptrdiff_t frameStride,
+             PixelRect rect, int factor, BufferPool::Buffer& out, int& outW, int& outH,
+             ScaleKernel kernel = ScaleKernel::Auto);
+
+    BufferPool& Pool() { return m_pool; }
+
+private:
+    ThreadPool* m_threadPool;
+    int m_grainRows;
+    BufferPool m_pool;
+    std::mutex m_mutex;                               // Run() may be called from several OCR tasks
+    std::vector<imagescale_detail::Column> m_cols;
+};
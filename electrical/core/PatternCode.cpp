@@ -0,0 +1,93 @@
+// PatternCode.cpp - Canonical Huffman packing of patterns. See PatternCode.h.
+
+#include "PatternCode.h"
+
+#include "PatternCodeTable.h"
+
+namespace {
+
+struct Codes {
+    uint16_t code[256];
+    uint8_t bits[256];
+    uint8_t counts[kPatternCodeMaxBits + 1] = {};
+    uint8_t symbols[256];
+
+    // Codes of one length are consecutive, in pattern order, each length
+    // starting where the shorter ones left off (the same order the
+    // firmware's tables are in)
+    Codes() {
+        for (int s = 0; s < 256; s++) counts[kPatternCodeLengths[s]]++;
+        uint16_t next[kPatternCodeMaxBits + 2] = {};
+        int index[kPatternCodeMaxBits + 2] = {};
+        for (int len = 1; len <= kPatternCodeMaxBits; len++) {
+            next[len + 1] = (uint16_t)((next[len] + counts[len]) << 1);
+            index[len + 1] = index[len] + counts[len];
+        }
+        for (int s = 0; s < 256; s++) {
+            int len = kPatternCodeLengths[s];
+            bits[s] = (uint8_t)len;
+            code[s] = next[len]++;
+            symbols[index[len]++] = (uint8_t)s;
+        }
+    }
+};
+
+const Codes& Table() {
+    static const Codes codes;
+    return codes;
+}
+
+} // namespace
+
+size_t PackedBits(const uint8_t* patterns, size_t n) {
+    const Codes& t = Table();
+    size_t bits = 0;
+    for (size_t i = 0; i < n; i++) bits += t.bits[patterns[i]];
+    return bits;
+}
+
+void PackPatterns(const uint8_t* patterns, size_t n, std::string& out) {
+    const Codes& t = Table();
+    uint32_t acc = 0;
+    int have = 0;
+    for (size_t i = 0; i < n; i++) {
+        acc = (acc << t.bits[patterns[i]]) | t.code[patterns[i]];
+        have += t.bits[patterns[i]];
+        while (have >= 6) {
+            have -= 6;
+            out.push_back((char)('0' + ((acc >> have) & 0x3F)));
+        }
+    }
+    if (have) out.push_back((char)('0' + ((acc << (6 - have)) & 0x3F)));
+}
+
+bool UnpackPatterns(const std::string& text, size_t& pos, size_t n, std::vector<uint8_t>& out) {
+    const Codes& t = Table();
+    int bits = 0, left = 0;
+    for (size_t k = 0; k < n; k++) {
+        int code = 0, first = 0, index = 0;
+        bool found = false;
+        for (int len = 1; len <= kPatternCodeMaxBits && !found; len++) {
+            if (left == 0) {
+                if (pos >= text.size() || text[pos] < '0' || text[pos] > 'o') return false;
+                bits = text[pos++] - '0';
+                left = 6;
+            }
+            code |= (bits >> --left) & 1;
+            int count = t.counts[len];
+            if (code - first < count) {
+                out.push_back(t.symbols[index + code - first]);
+                found = true;
+            }
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        if (!found) return false;
+    }
+    return true;
+}
+
+int PatternCodeVersion() {
+    return kPatternCodeVersion;
+}
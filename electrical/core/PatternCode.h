@@ -0,0 +1,32 @@
+// PatternCode.h - Packs cell patterns for slow links.
+//
+// Units behind 9600 baud Bluetooth bridges spend most of a refresh on the
+// wire. Packed F: runs code each pattern with a static canonical Huffman
+// code trained on English text laid out into cells (PatternCodeTable.h,
+// generated by braille/tools/gen_pattern_code.py) and send the bits six at
+// a time as the characters '0'..'o'. Text averages about 0.8 characters
+// per cell instead of two hex digits. The firmware decodes it with
+// braille/lib/PatternDecoder and announces it in its CAPS reply.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Bits the code spends on n patterns
+size_t PackedBits(const uint8_t* patterns, size_t n);
+
+// Characters that n packed patterns take: the bits rounded up to sixes
+inline size_t PackedSize(const uint8_t* patterns, size_t n) { return (PackedBits(patterns, n) + 5) / 6; }
+
+// Appends n patterns, packed, to out
+void PackPatterns(const uint8_t* patterns, size_t n, std::string& out);
+
+// Reads n packed patterns at text[pos] and moves pos past them, like the
+// firmware's PatternDecoder. False on a bad character or code.
+bool UnpackPatterns(const std::string& text, size_t& pos, size_t n, std::vector<uint8_t>& out);
+
+// The code version, as in the firmware's "CAPS:...,PACK<n>"
+int PatternCodeVersion();
@@ -0,0 +1,31 @@
+// PatternCodeTable.h - Generated by braille/tools/gen_pattern_code.py, do
+// not edit. Code length of every pattern in the canonical Huffman code for
+// packed F: runs, version 2; the firmware decodes it from
+// braille/lib/PatternDecoder/PatternCodeTable.h.
+// Trained on GPL-3: 33589 cells, 4.62 bits per cell (entropy 4.56), 0.77 characters vs 2 in hex.
+
+#pragma once
+
+#include <cstdint>
+
+constexpr int kPatternCodeVersion = 2;
+constexpr int kPatternCodeMaxBits = 15;
+
+inline constexpr uint8_t kPatternCodeLengths[256] = {
+    0x03, 0x04, 0x07, 0x07, 0x0F, 0x08, 0x0F, 0x06, 0x0F, 0x08, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x08,
+    0x0F, 0x05, 0x04, 0x06, 0x0F, 0x06, 0x04, 0x06, 0x0F, 0x09, 0x08, 0x0A, 0x0F, 0x0B, 0x08, 0x08,
+    0x0F, 0x03, 0x0F, 0x05, 0x0F, 0x04, 0x0F, 0x04, 0x0F, 0x08, 0x0F, 0x0A, 0x0F, 0x09, 0x0F, 0x08,
+    0x0F, 0x05, 0x0A, 0x06, 0x09, 0x04, 0x04, 0x0E, 0x0F, 0x09, 0x0F, 0x09, 0x0F, 0x08, 0x08, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x09, 0x0F, 0x06, 0x0F, 0x07, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x09, 0x0F, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x09, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x0F, 0x07, 0x0F, 0x0F, 0x0F, 0x09, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x0F, 0x07, 0x0F, 0x09, 0x06, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x09, 0x0F, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+    0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+};
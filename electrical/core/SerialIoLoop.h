@@ -0,0 +1,51 @@
+// SerialIoLoop.h - Runs the I/O of many SerialPorts on a few threads.
+//
+// A SerialPort normally starts a reader and a writer thread, which is two
+// threads per display; one PC feeding a classroom would run dozens. Ports
+// opened with SerialOptions::loop share a loop instead. Each loop thread
+// waits on its ports with one epoll set, reads what arrived and hands it
+// to the port's callbacks, and drains the port's write queue without
+// blocking. When a device falls behind, the thread waits for POLLOUT on
+// that port only. New ports go to the thread with the fewest ports.
+//
+// Linux only (SerialIoLoopPosix.cpp). On Windows a loop has no threads
+// and ports opened with it keep their own (SerialIoLoopWin32.cpp).
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+class SerialPort;
+struct SerialIoSlot;
+
+class SerialIoLoop {
+public:
+    // threads <= 0: one
+    explicit SerialIoLoop(int threads = 1);
+    // Ports still open on the loop must be closed first
+    ~SerialIoLoop();
+
+    SerialIoLoop(const SerialIoLoop&) = delete;
+    SerialIoLoop& operator=(const SerialIoLoop&) = delete;
+
+    int Threads() const;
+    size_t Ports() const;
+
+    struct Impl;
+
+private:
+    friend class SerialPort;
+    struct Worker;
+
+    // SerialPort::Open: sets the port's slot and starts serving fd;
+    // nullptr if the loop cannot, and the port runs its own threads
+    SerialIoSlot* Attach(SerialPort* port, int fd);
+    // SerialPort::Close: returns once no loop thread touches the port.
+    // Safe from the port's own callbacks.
+    void Detach(SerialIoSlot* slot);
+    // SerialPort::Write: the port has queued data
+    void WantWrite(SerialIoSlot* slot);
+
+    std::unique_ptr<Impl> m_impl;
+};
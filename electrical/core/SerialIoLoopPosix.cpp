@@ -0,0 +1,228 @@
+// SerialIoLoopPosix.cpp - epoll threads for SerialIoLoop (Linux).
+//
+// Each thread owns an epoll set with its ports (EPOLLIN, plus EPOLLOUT
+// while a port has data the device would not take) and an eventfd that
+// WantWrite(), Detach() and the destructor signal. Requests are picked up
+// after the ready ports of a wakeup are served, so a port is never
+// removed while the thread is inside one of its callbacks.
+
+#include "SerialIoLoop.h"
+
+#include "SerialPort.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+struct SerialIoSlot {
+    SerialPort* port = nullptr;
+    int fd = -1;
+    size_t worker = 0;
+    bool wantWrite = false;     // in the worker's write list (worker mutex)
+    bool detached = false;      // the worker let go of it (worker mutex)
+    bool watchingOut = false;   // EPOLLOUT armed (worker thread)
+    bool dead = false;          // failed, out of the epoll set (worker thread)
+    bool closed = false;        // detached from a callback (worker thread)
+};
+
+struct SerialIoLoop::Worker {
+    int epoll = -1;
+    int wake = -1;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable detached;
+    std::vector<SerialIoSlot*> writes;
+    std::vector<SerialIoSlot*> removals;
+    std::vector<SerialIoSlot*> graveyard;   // closed from a callback, freed after the batch
+    size_t ports = 0;
+    bool stop = false;
+
+    void Signal() {
+        uint64_t one = 1;
+        (void)::write(wake, &one, sizeof(one));
+    }
+
+    void Watch(SerialIoSlot* s, bool out) {
+        epoll_event ev{};
+        ev.events = EPOLLIN | (out ? EPOLLOUT : 0u);
+        ev.data.ptr = s;
+        epoll_ctl(epoll, EPOLL_CTL_MOD, s->fd, &ev);
+        s->watchingOut = out;
+    }
+
+    void Drop(SerialIoSlot* s) {
+        if (!s->dead) epoll_ctl(epoll, EPOLL_CTL_DEL, s->fd, nullptr);
+        s->dead = true;
+    }
+
+    void Flush(SerialIoSlot* s) {
+        int r = s->port->LoopWrite();
+        if (r < 0) Drop(s);
+        else if ((r == 0) != s->watchingOut) Watch(s, r == 0);
+    }
+
+    void Run() {
+        epoll_event events[64];
+        std::vector<SerialIoSlot*> writesNow, removalsNow;
+        for (;;) {
+            int n = epoll_wait(epoll, events, 64, -1);
+            if (n < 0 && errno != EINTR) return;
+
+            bool woken = false;
+            for (int i = 0; i < n; i++) {
+                SerialIoSlot* s = static_cast<SerialIoSlot*>(events[i].data.ptr);
+                if (!s) { woken = true; continue; }
+                if (s->dead || s->closed) continue;
+                if (events[i].events & EPOLLOUT) Flush(s);
+                if (!s->dead && !s->closed && (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) &&
+                    !s->port->LoopRead())
+                    Drop(s);
+            }
+
+            if (woken) {
+                uint64_t count;
+                (void)::read(wake, &count, sizeof(count));
+                bool stopNow;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    writesNow.swap(writes);
+                    removalsNow.swap(removals);
+                    for (SerialIoSlot* s : writesNow) s->wantWrite = false;
+                    stopNow = stop;
+                }
+                for (SerialIoSlot* s : writesNow)
+                    if (!s->dead && !s->closed) Flush(s);
+                for (SerialIoSlot* s : removalsNow) Drop(s);
+                if (!removalsNow.empty()) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    for (SerialIoSlot* s : removalsNow) s->detached = true;
+                    detached.notify_all();
+                }
+                writesNow.clear();
+                removalsNow.clear();
+                if (stopNow) return;
+            }
+
+            for (SerialIoSlot* s : graveyard) delete s;
+            graveyard.clear();
+        }
+    }
+};
+
+struct SerialIoLoop::Impl {
+    std::vector<std::unique_ptr<Worker>> workers;
+    mutable std::mutex mutex;   // port counts
+};
+
+SerialIoLoop::SerialIoLoop(int threads) : m_impl(new Impl) {
+    threads = (std::max)(threads, 1);
+    for (int i = 0; i < threads; i++) {
+        std::unique_ptr<Worker> w(new Worker);
+        w->epoll = epoll_create1(EPOLL_CLOEXEC);
+        w->wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (w->epoll < 0 || w->wake < 0) {
+            if (w->epoll >= 0) ::close(w->epoll);
+            if (w->wake >= 0) ::close(w->wake);
+            break;   // Attach() fails without workers and ports use their own threads
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.ptr = nullptr;
+        epoll_ctl(w->epoll, EPOLL_CTL_ADD, w->wake, &ev);
+        Worker* raw = w.get();
+        w->thread = std::thread([raw] { raw->Run(); });
+        m_impl->workers.push_back(std::move(w));
+    }
+}
+
+SerialIoLoop::~SerialIoLoop() {
+    for (auto& w : m_impl->workers) {
+        {
+            std::lock_guard<std::mutex> lock(w->mutex);
+            w->stop = true;
+        }
+        w->Signal();
+        w->thread.join();
+        for (SerialIoSlot* s : w->graveyard) delete s;
+        ::close(w->epoll);
+        ::close(w->wake);
+    }
+}
+
+int SerialIoLoop::Threads() const {
+    return (int)m_impl->workers.size();
+}
+
+size_t SerialIoLoop::Ports() const {
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    size_t n = 0;
+    for (const auto& w : m_impl->workers) n += w->ports;
+    return n;
+}
+
+SerialIoSlot* SerialIoLoop::Attach(SerialPort* port, int fd) {
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    if (m_impl->workers.empty()) return nullptr;
+    size_t best = 0;
+    for (size_t i = 1; i < m_impl->workers.size(); i++)
+        if (m_impl->workers[i]->ports < m_impl->workers[best]->ports) best = i;
+
+    SerialIoSlot* s = new SerialIoSlot;
+    s->port = port;
+    s->fd = fd;
+    s->worker = best;
+    // Set before the fd is watched: a callback may close the port at once
+    port->m_loopSlot = s;
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = s;
+    if (epoll_ctl(m_impl->workers[best]->epoll, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        port->m_loopSlot = nullptr;
+        delete s;
+        return nullptr;
+    }
+    m_impl->workers[best]->ports++;
+    return s;
+}
+
+void SerialIoLoop::Detach(SerialIoSlot* slot) {
+    Worker& w = *m_impl->workers[slot->worker];
+    if (std::this_thread::get_id() == w.thread.get_id()) {
+        // From one of the thread's own callbacks: the batch being served
+        // may still name the slot, so it is freed after the batch
+        {
+            std::lock_guard<std::mutex> lock(w.mutex);
+            w.writes.erase(std::remove(w.writes.begin(), w.writes.end(), slot), w.writes.end());
+        }
+        w.Drop(slot);
+        slot->closed = true;
+        w.graveyard.push_back(slot);
+    } else {
+        std::unique_lock<std::mutex> lock(w.mutex);
+        w.removals.push_back(slot);
+        w.Signal();
+        w.detached.wait(lock, [slot] { return slot->detached; });
+        lock.unlock();
+        delete slot;
+    }
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    w.ports--;
+}
+
+void SerialIoLoop::WantWrite(SerialIoSlot* slot) {
+    Worker& w = *m_impl->workers[slot->worker];
+    std::lock_guard<std::mutex> lock(w.mutex);
+    if (slot->wantWrite) return;
+    slot->wantWrite = true;
+    // A non-empty list already has a wakeup on the way
+    if (w.writes.empty() && w.removals.empty()) w.Signal();
+    w.writes.push_back(slot);
+}
@@ -0,0 +1,27 @@
+// SerialIoLoopWin32.cpp - SerialIoLoop on Windows: no shared threads yet.
+// Attach() declines, so every port runs its own overlapped reader and
+// writer threads exactly as without a loop.
+
+#include "SerialIoLoop.h"
+
+struct SerialIoLoop::Impl {};
+
+SerialIoLoop::SerialIoLoop(int) : m_impl(new Impl) {}
+
+SerialIoLoop::~SerialIoLoop() = default;
+
+int SerialIoLoop::Threads() const {
+    return 0;
+}
+
+size_t SerialIoLoop::Ports() const {
+    return 0;
+}
+
+SerialIoSlot* SerialIoLoop::Attach(SerialPort*, int) {
+    return nullptr;
+}
+
+void SerialIoLoop::Detach(SerialIoSlot*) {}
+
+void SerialIoLoop::WantWrite(SerialIoSlot*) {}
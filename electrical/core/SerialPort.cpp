@@ -0,0 +1,237 @@
+// SerialPort.cpp - Queueing, threads and line/frame splitting. Platform
+// I/O lives in the backends.
+
+#include "SerialPort.h"
+#include "SerialIoLoop.h"
+#include "SerialPortBackend.h"
+
+#include <algorithm>
+#include <chrono>
+
+SerialPort::SerialPort() = default;
+
+SerialPort::~SerialPort() {
+    Close();
+}
+
+bool SerialPort::Open(const std::string& path, const SerialOptions& options, std::string& err) {
+    if (m_open) {
+        err = "Port is already open.";
+        return false;
+    }
+    if (options.maxQueuedWrites == 0) {
+        err = "maxQueuedWrites must be at least 1.";
+        return false;
+    }
+
+    std::unique_ptr<Backend> backend = Backend::Create();
+    if (!backend->Open(path, options.baud, err)) return false;
+
+    m_backend = std::move(backend);
+    m_options = options;
+    m_queue.clear();
+    m_writing = false;
+    m_broken = false;
+    m_stopping = false;
+    m_line.clear();
+    m_frame.clear();
+    m_bytesWritten = 0;
+    m_bytesRead = 0;
+    m_loopItem.clear();
+    m_loopOffset = 0;
+    m_open = true;
+
+    // Backends without a pollable descriptor run their own threads anyway
+    const int fd = m_backend->PollHandle();
+    if (!options.loop || fd < 0 || !options.loop->Attach(this, fd)) {
+        m_reader = std::thread(&SerialPort::ReaderLoop, this);
+        m_writer = std::thread(&SerialPort::WriterLoop, this);
+    }
+    return true;
+}
+
+void SerialPort::Close() {
+    if (!m_open) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_queueChanged.notify_all();
+    if (m_loopSlot) {
+        m_options.loop->Detach(m_loopSlot);
+        m_loopSlot = nullptr;
+    }
+    m_backend->Cancel();
+
+    if (m_reader.joinable()) m_reader.join();
+    if (m_writer.joinable()) m_writer.join();
+
+    m_backend->Close();
+    m_backend.reset();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.clear();
+    m_open = false;
+}
+
+bool SerialPort::Write(std::string data) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_open || m_stopping || m_broken) return false;
+        if (m_queue.size() >= m_options.maxQueuedWrites) return false;
+        m_queue.push_back(std::move(data));
+        // Under the lock, so Close() cannot detach the port in between
+        if (m_loopSlot) m_options.loop->WantWrite(m_loopSlot);
+    }
+    m_queueChanged.notify_all();
+    return true;
+}
+
+bool SerialPort::Flush(int timeoutMs) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_queueChanged.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] {
+        return m_stopping || m_broken || (m_queue.empty() && !m_writing);
+    }) && !m_broken && m_open;
+}
+
+size_t SerialPort::QueuedWrites() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_queue.size() + (m_writing ? 1 : 0);
+}
+
+void SerialPort::SetFrameCallback(size_t frameSize, FrameCallback cb) {
+    m_frameSize = frameSize;
+    m_onFrame = std::move(cb);
+}
+
+void SerialPort::WriterLoop() {
+    for (;;) {
+        std::string item;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_queueChanged.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            if (m_stopping) return;
+            item = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_writing = true;
+        }
+
+        std::string err;
+        bool ok = m_backend->WriteAll(reinterpret_cast<const uint8_t*>(item.data()), item.size(), err);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_writing = false;
+            if (ok) m_bytesWritten += item.size();
+            else m_broken = true;
+        }
+        m_queueChanged.notify_all();
+
+        if (!ok) {
+            if (!m_stopping) ReportError("Write failed: " + err);
+            return;
+        }
+    }
+}
+
+void SerialPort::ReaderLoop() {
+    uint8_t buf[4096];
+    for (;;) {
+        std::string err;
+        long n = m_backend->Read(buf, sizeof(buf), err);
+        if (n > 0) {
+            m_bytesRead += (uint64_t)n;
+            Dispatch(buf, (size_t)n);
+        } else if (n == 0) {
+            if (m_stopping) return;
+        } else {
+            if (!m_stopping) ReportError("Read failed: " + err);
+            return;
+        }
+    }
+}
+
+bool SerialPort::LoopRead() {
+    uint8_t buf[4096];
+    std::string err;
+    long n = m_backend->TryRead(buf, sizeof(buf), err);
+    if (n > 0) {
+        m_bytesRead += (uint64_t)n;
+        Dispatch(buf, (size_t)n);
+    } else if (n < 0) {
+        if (!m_stopping) ReportError("Read failed: " + err);
+        return false;
+    }
+    return true;
+}
+
+int SerialPort::LoopWrite() {
+    for (;;) {
+        if (m_loopOffset == m_loopItem.size()) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_writing) {
+                m_writing = false;
+                m_bytesWritten += m_loopItem.size();
+                m_queueChanged.notify_all();
+            }
+            if (m_stopping || m_queue.empty()) return 1;
+            m_loopItem = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_loopOffset = 0;
+            m_writing = true;
+        }
+
+        std::string err;
+        long n = m_backend->TryWrite(reinterpret_cast<const uint8_t*>(m_loopItem.data()) + m_loopOffset,
+                                     m_loopItem.size() - m_loopOffset, err);
+        if (n == 0) return 0;
+        if (n < 0) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_writing = false;
+                m_broken = true;
+            }
+            m_queueChanged.notify_all();
+            if (!m_stopping) ReportError("Write failed: " + err);
+            return -1;
+        }
+        m_loopOffset += (size_t)n;
+    }
+}
+
+void SerialPort::Dispatch(const uint8_t* data, size_t size) {
+    if (m_onLine) {
+        for (size_t i = 0; i < size; i++) {
+            char c = (char)data[i];
+            if (c == m_options.lineDelimiter) {
+                if (!m_line.empty() && m_line.back() == '\r') m_line.pop_back();
+                m_onLine(m_line);
+                m_line.clear();
+            } else {
+                m_line.push_back(c);
+                if (m_line.size() >= m_options.maxLineLength) {
+                    m_onLine(m_line);
+                    m_line.clear();
+                }
+            }
+        }
+    }
+
+    if (m_onFrame && m_frameSize > 0) {
+        size_t i = 0;
+        while (i < size) {
+            size_t take = std::min(m_frameSize - m_frame.size(), size - i);
+            m_frame.append(reinterpret_cast<const char*>(data + i), take);
+            i += take;
+            if (m_frame.size() == m_frameSize) {
+                m_onFrame(reinterpret_cast<const uint8_t*>(m_frame.data()), m_frame.size());
+                m_frame.clear();
+            }
+        }
+    }
+}
+
+void SerialPort::ReportError(const std::string& message) {
+    if (m_onError) m_onError(message);
+}
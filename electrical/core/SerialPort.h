@@ -0,0 +1,121 @@
+// SerialPort.h - Asynchronous serial port shared by the host tools.
+//
+// Writes go into a bounded queue that a dedicated writer thread drains,
+// so the caller (the UI thread in driver.cpp) never blocks on the port.
+// A reader thread delivers received data as lines and/or fixed-size
+// frames through callbacks; these run on the reader thread.
+//
+// A port opened with SerialOptions::loop starts no threads of its own: a
+// shared SerialIoLoop does its reads and non-blocking writes, and its
+// callbacks run on that loop's thread. Queue, callbacks and statistics
+// stay per port.
+//
+// Backends: termios + epoll on Linux (SerialPortPosix.cpp), overlapped
+// I/O on Windows (SerialPortWin32.cpp).
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class SerialIoLoop;
+struct SerialIoSlot;
+
+struct SerialOptions {
+    uint32_t baud = 115200;          // matches Serial.begin() in the firmware
+    size_t maxQueuedWrites = 64;     // Write() fails once this many are pending
+    char lineDelimiter = '\n';       // '\r' before it is stripped
+    size_t maxLineLength = 4096;     // longer lines are delivered in pieces
+    SerialIoLoop* loop = nullptr;    // shared I/O threads instead of two per port
+};
+
+class SerialPort {
+public:
+    using LineCallback = std::function<void(const std::string& line)>;
+    using FrameCallback = std::function<void(const uint8_t* frame, size_t size)>;
+    using ErrorCallback = std::function<void(const std::string& message)>;
+
+    SerialPort();
+    ~SerialPort();
+
+    SerialPort(const SerialPort&) = delete;
+    SerialPort& operator=(const SerialPort&) = delete;
+
+    // Opens the port ("/dev/ttyACM0", "COM3") in raw 8N1 mode and starts
+    // the reader and writer threads. Returns false and sets err on failure.
+    bool Open(const std::string& path, const SerialOptions& options, std::string& err);
+
+    // Stops both threads and closes the port. Queued writes are dropped.
+    void Close();
+
+    bool IsOpen() const { return m_open; }
+    const SerialOptions& Options() const { return m_options; }
+
+    // Queues data for the writer thread. Never blocks; returns false if the
+    // port is closed or maxQueuedWrites are already pending.
+    bool Write(std::string data);
+
+    // Waits until every queued write has reached the driver.
+    bool Flush(int timeoutMs);
+
+    size_t QueuedWrites() const;
+
+    // Set before Open(). Line and frame callbacks both see every byte.
+    void SetLineCallback(LineCallback cb) { m_onLine = std::move(cb); }
+    void SetFrameCallback(size_t frameSize, FrameCallback cb);
+    void SetErrorCallback(ErrorCallback cb) { m_onError = std::move(cb); }
+
+    uint64_t BytesWritten() const { return m_bytesWritten; }
+    uint64_t BytesRead() const { return m_bytesRead; }
+
+    // Platform I/O, defined in SerialPortPosix.cpp / SerialPortWin32.cpp
+    struct Backend;
+
+private:
+    friend class SerialIoLoop;
+
+    void ReaderLoop();
+    void WriterLoop();
+    // Called by the SerialIoLoop thread that owns the port. LoopRead()
+    // returns false once the port failed; LoopWrite() returns 1 when the
+    // queue is drained, 0 when the device would block, -1 on failure.
+    bool LoopRead();
+    int LoopWrite();
+    void Dispatch(const uint8_t* data, size_t size);
+    void ReportError(const std::string& message);
+
+    std::unique_ptr<Backend> m_backend;
+    SerialOptions m_options;
+    bool m_open = false;
+
+    std::thread m_reader;
+    std::thread m_writer;
+    SerialIoSlot* m_loopSlot = nullptr;   // set while a SerialIoLoop runs the port
+    std::string m_loopItem;          // being written by the loop
+    size_t m_loopOffset = 0;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_queueChanged;
+    std::deque<std::string> m_queue;
+    bool m_writing = false;          // writer holds a popped item
+    bool m_broken = false;           // a write failed; Write() refuses more
+    std::atomic<bool> m_stopping{ false };
+
+    LineCallback m_onLine;
+    FrameCallback m_onFrame;
+    ErrorCallback m_onError;
+    size_t m_frameSize = 0;
+    std::string m_line;
+    std::string m_frame;
+
+    std::atomic<uint64_t> m_bytesWritten{ 0 };
+    std::atomic<uint64_t> m_bytesRead{ 0 };
+};
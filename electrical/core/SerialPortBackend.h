@@ -0,0 +1,35 @@
+// SerialPortBackend.h - Interface each platform's SerialPort::Backend provides.
+// Only SerialPort.cpp and the backend sources include this.
+
+#pragma once
+
+#include "SerialPort.h"
+
+struct SerialPort::Backend {
+    virtual ~Backend() = default;
+
+    virtual bool Open(const std::string& path, uint32_t baud, std::string& err) = 0;
+
+    // Writes all of data, blocking the writer thread until the driver took
+    // it or Cancel() was called.
+    virtual bool WriteAll(const uint8_t* data, size_t size, std::string& err) = 0;
+
+    // Waits for input. Returns bytes read (> 0), 0 if cancelled, -1 on error.
+    virtual long Read(uint8_t* buf, size_t size, std::string& err) = 0;
+
+    // Wakes any thread blocked in WriteAll() or Read(); they return promptly.
+    virtual void Cancel() = 0;
+
+    virtual void Close() = 0;
+
+    // For SerialIoLoop: a non-blocking descriptor to wait on with epoll, or
+    // -1 if the backend only works with the reader and writer threads
+    virtual int PollHandle() const { return -1; }
+
+    // Non-blocking I/O on PollHandle(): bytes moved, 0 if the call would
+    // block, -1 on error
+    virtual long TryRead(uint8_t*, size_t, std::string& err) { err = "Not supported."; return -1; }
+    virtual long TryWrite(const uint8_t*, size_t, std::string& err) { err = "Not supported."; return -1; }
+
+    static std::unique_ptr<Backend> Create();
+};
@@ -0,0 +1,164 @@
+// SerialPortPosix.cpp - termios/epoll backend for SerialPort (Linux).
+//
+// The descriptor is non-blocking. Read() sleeps in epoll_wait on the port
+// and an eventfd that Cancel() signals; WriteAll() waits for POLLOUT on the
+// same pair, so Close() never hangs behind a stalled device. A
+// SerialIoLoop waits on the descriptor itself and uses TryRead/TryWrite.
+
+#include "SerialPortBackend.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+bool BaudToSpeed(uint32_t baud, speed_t& speed) {
+    static const struct { uint32_t baud; speed_t speed; } kRates[] = {
+        { 1200, B1200 },     { 2400, B2400 },     { 4800, B4800 },
+        { 9600, B9600 },     { 19200, B19200 },   { 38400, B38400 },
+        { 57600, B57600 },   { 115200, B115200 }, { 230400, B230400 },
+        { 460800, B460800 }, { 500000, B500000 }, { 921600, B921600 },
+        { 1000000, B1000000 }, { 2000000, B2000000 },
+    };
+    for (const auto& r : kRates) {
+        if (r.baud == baud) { speed = r.speed; return true; }
+    }
+    return false;
+}
+
+std::string Errno(const char* what) {
+    return std::string(what) + ": " + std::strerror(errno);
+}
+
+class PosixBackend : public SerialPort::Backend {
+public:
+    ~PosixBackend() override { Close(); }
+
+    bool Open(const std::string& path, uint32_t baud, std::string& err) override {
+        speed_t speed;
+        if (!BaudToSpeed(baud, speed)) {
+            err = "Unsupported baud rate " + std::to_string(baud) + ".";
+            return false;
+        }
+
+        m_fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        if (m_fd < 0) { err = Errno(("Cannot open " + path).c_str()); return false; }
+
+        termios tio{};
+        if (tcgetattr(m_fd, &tio) != 0) { err = Errno("tcgetattr"); Close(); return false; }
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+        if (tcsetattr(m_fd, TCSANOW, &tio) != 0) { err = Errno("tcsetattr"); Close(); return false; }
+
+        // Clear any junk in buffers
+        tcflush(m_fd, TCIOFLUSH);
+
+        m_cancel = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        m_epoll = epoll_create1(EPOLL_CLOEXEC);
+        if (m_cancel < 0 || m_epoll < 0) { err = Errno("eventfd/epoll"); Close(); return false; }
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = m_fd;
+        epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_fd, &ev);
+        ev.data.fd = m_cancel;
+        epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_cancel, &ev);
+        return true;
+    }
+
+    bool WriteAll(const uint8_t* data, size_t size, std::string& err) override {
+        while (size > 0) {
+            ssize_t n = ::write(m_fd, data, size);
+            if (n > 0) {
+                data += n;
+                size -= (size_t)n;
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && errno != EAGAIN) { err = Errno("write"); return false; }
+
+            pollfd fds[2] = { { m_fd, POLLOUT, 0 }, { m_cancel, POLLIN, 0 } };
+            if (poll(fds, 2, -1) < 0 && errno != EINTR) { err = Errno("poll"); return false; }
+            if (fds[1].revents & POLLIN) { err = "Cancelled."; return false; }
+            if (fds[0].revents & (POLLERR | POLLHUP)) { err = "Device disconnected."; return false; }
+        }
+        return true;
+    }
+
+    long Read(uint8_t* buf, size_t size, std::string& err) override {
+        for (;;) {
+            epoll_event events[2];
+            int n = epoll_wait(m_epoll, events, 2, -1);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                err = Errno("epoll_wait");
+                return -1;
+            }
+            for (int i = 0; i < n; i++) {
+                if (events[i].data.fd == m_cancel) return 0;
+            }
+
+            ssize_t got = ::read(m_fd, buf, size);
+            if (got > 0) return (long)got;
+            if (got == 0 || errno == EIO) { err = "Device disconnected."; return -1; }
+            if (errno != EAGAIN && errno != EINTR) { err = Errno("read"); return -1; }
+        }
+    }
+
+    int PollHandle() const override { return m_fd; }
+
+    long TryRead(uint8_t* buf, size_t size, std::string& err) override {
+        for (;;) {
+            ssize_t got = ::read(m_fd, buf, size);
+            if (got > 0) return (long)got;
+            if (got == 0 || errno == EIO) { err = "Device disconnected."; return -1; }
+            if (errno == EAGAIN) return 0;
+            if (errno != EINTR) { err = Errno("read"); return -1; }
+        }
+    }
+
+    long TryWrite(const uint8_t* data, size_t size, std::string& err) override {
+        for (;;) {
+            ssize_t n = ::write(m_fd, data, size);
+            if (n >= 0) return (long)n;
+            if (errno == EAGAIN) return 0;
+            if (errno != EINTR) { err = Errno("write"); return -1; }
+        }
+    }
+
+    void Cancel() override {
+        // Left signalled: every later Read()/WriteAll() returns at once
+        uint64_t one = 1;
+        if (m_cancel >= 0) (void)::write(m_cancel, &one, sizeof(one));
+    }
+
+    void Close() override {
+        if (m_epoll >= 0) ::close(m_epoll);
+        if (m_cancel >= 0) ::close(m_cancel);
+        if (m_fd >= 0) ::close(m_fd);
+        m_epoll = m_cancel = m_fd = -1;
+    }
+
+private:
+    int m_fd = -1;
+    int m_cancel = -1;
+    int m_epoll = -1;
+};
+
+} // namespace
+
+std::unique_ptr<SerialPort::Backend> SerialPort::Backend::Create() {
+    return std::unique_ptr<Backend>(new PosixBackend());
+}
@@ -0,0 +1,137 @@
+// SerialPortWin32.cpp - Overlapped I/O backend for SerialPort (Windows).
+//
+// The port is opened with FILE_FLAG_OVERLAPPED so the reader and writer
+// threads can each wait on their own operation plus a shared cancel event.
+
+#include "SerialPortBackend.h"
+
+#include <windows.h>
+
+namespace {
+
+std::string LastError(const char* what) {
+    return std::string(what) + " failed. Error " + std::to_string(GetLastError());
+}
+
+class Win32Backend : public SerialPort::Backend {
+public:
+    ~Win32Backend() override { Close(); }
+
+    bool Open(const std::string& path, uint32_t baud, std::string& err) override {
+        // "COM10" and above only open through the device namespace
+        std::string device = path.rfind("\\\\.\\", 0) == 0 ? path : "\\\\.\\" + path;
+        m_handle = CreateFileA(device.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+                               OPEN_EXISTING, FILE_FLAG_OVERLAPPED, nullptr);
+        if (m_handle == INVALID_HANDLE_VALUE) { err = LastError("Cannot open port: CreateFile"); return false; }
+
+        DCB dcb{};
+        dcb.DCBlength = sizeof(DCB);
+        if (!GetCommState(m_handle, &dcb)) { err = LastError("GetCommState"); Close(); return false; }
+        dcb.BaudRate = baud;
+        dcb.ByteSize = 8;
+        dcb.Parity = NOPARITY;
+        dcb.StopBits = ONESTOPBIT;
+        dcb.fBinary = TRUE;
+        dcb.fOutxCtsFlow = FALSE;
+        dcb.fOutxDsrFlow = FALSE;
+        dcb.fOutX = FALSE;
+        dcb.fInX = FALSE;
+        // Many Arduino-style boards expect DTR/RTS asserted
+        dcb.fDtrControl = DTR_CONTROL_ENABLE;
+        dcb.fRtsControl = RTS_CONTROL_ENABLE;
+        if (!SetCommState(m_handle, &dcb)) { err = LastError("SetCommState"); Close(); return false; }
+
+        // Return as soon as anything arrives; the overlapped wait does the blocking
+        COMMTIMEOUTS to{};
+        to.ReadIntervalTimeout = MAXDWORD;
+        to.ReadTotalTimeoutMultiplier = MAXDWORD;
+        to.ReadTotalTimeoutConstant = MAXDWORD - 1;
+        if (!SetCommTimeouts(m_handle, &to)) { err = LastError("SetCommTimeouts"); Close(); return false; }
+
+        // Clear any junk in buffers
+        PurgeComm(m_handle, PURGE_RXCLEAR | PURGE_TXCLEAR);
+
+        m_cancel = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        m_readDone = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        m_writeDone = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (!m_cancel || !m_readDone || !m_writeDone) { err = LastError("CreateEvent"); Close(); return false; }
+        return true;
+    }
+
+    bool WriteAll(const uint8_t* data, size_t size, std::string& err) override {
+        while (size > 0) {
+            OVERLAPPED ov{};
+            ov.hEvent = m_writeDone;
+            ResetEvent(m_writeDone);
+            DWORD chunk = (DWORD)(size > 0x10000 ? 0x10000 : size);
+            DWORD written = 0;
+            if (!WriteFile(m_handle, data, chunk, nullptr, &ov) && GetLastError() != ERROR_IO_PENDING) {
+                err = LastError("WriteFile");
+                return false;
+            }
+            if (!Wait(&ov, &written, err)) return false;
+            data += written;
+            size -= written;
+        }
+        return true;
+    }
+
+    long Read(uint8_t* buf, size_t size, std::string& err) override {
+        for (;;) {
+            OVERLAPPED ov{};
+            ov.hEvent = m_readDone;
+            ResetEvent(m_readDone);
+            DWORD got = 0;
+            if (!ReadFile(m_handle, buf, (DWORD)size, nullptr, &ov) && GetLastError() != ERROR_IO_PENDING) {
+                err = LastError("ReadFile");
+                return -1;
+            }
+            if (!Wait(&ov, &got, err)) return err.empty() ? 0 : -1;
+            if (got > 0) return (long)got;
+            // Timed out with nothing read: wait again
+        }
+    }
+
+    void Cancel() override {
+        if (m_cancel) SetEvent(m_cancel);
+    }
+
+    void Close() override {
+        if (m_handle != INVALID_HANDLE_VALUE) CloseHandle(m_handle);
+        if (m_cancel) CloseHandle(m_cancel);
+        if (m_readDone) CloseHandle(m_readDone);
+        if (m_writeDone) CloseHandle(m_writeDone);
+        m_handle = INVALID_HANDLE_VALUE;
+        m_cancel = m_readDone = m_writeDone = nullptr;
+    }
+
+private:
+    // Waits for an overlapped operation or Cancel(). On cancel the I/O is
+    // aborted and err is left empty.
+    bool Wait(OVERLAPPED* ov, DWORD* transferred, std::string& err) {
+        HANDLE events[2] = { ov->hEvent, m_cancel };
+        DWORD which = WaitForMultipleObjects(2, events, FALSE, INFINITE);
+        if (which != WAIT_OBJECT_0) {
+            CancelIoEx(m_handle, ov);
+            GetOverlappedResult(m_handle, ov, transferred, TRUE);
+            if (which != WAIT_OBJECT_0 + 1) err = LastError("WaitForMultipleObjects");
+            return false;
+        }
+        if (!GetOverlappedResult(m_handle, ov, transferred, FALSE)) {
+            err = LastError("GetOverlappedResult");
+            return false;
+        }
+        return true;
+    }
+
+    HANDLE m_handle = INVALID_HANDLE_VALUE;
+    HANDLE m_cancel = nullptr;
+    HANDLE m_readDone = nullptr;
+    HANDLE m_writeDone = nullptr;
+};
+
+} // namespace
+
+std::unique_ptr<SerialPort::Backend> SerialPort::Backend::Create() {
+    return std::unique_ptr<Backend>(new Win32Backend());
+}
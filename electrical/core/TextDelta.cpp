@@ -0,0 +1,267 @@
+// TextDelta.cpp - Word diff and E: line encoding. See TextDelta.h.
+
+#include "TextDelta.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+struct Token {
+    size_t offset, length;
+};
+
+bool IsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Alternating runs of whitespace and non-whitespace, interned to ids
+void Tokenize(const std::string& text, std::unordered_map<std::string_view, int>& ids,
+              std::vector<Token>& tokens, std::vector<int>& tokenIds) {
+    size_t i = 0;
+    while (i < text.size()) {
+        bool space = IsSpace(text[i]);
+        size_t j = i + 1;
+        while (j < text.size() && IsSpace(text[j]) == space) j++;
+        tokens.push_back({ i, j - i });
+        auto it = ids.emplace(std::string_view(text.data() + i, j - i), (int)ids.size()).first;
+        tokenIds.push_back(it->second);
+        i = j;
+    }
+}
+
+enum class Op : char { Equal, Delete, Insert };
+
+// Myers' O(ND) greedy diff. Returns false if more than maxD changes are needed.
+bool Myers(const int* a, int n, const int* b, int m, int maxD, std::vector<Op>& script) {
+    const int limit = (std::min)(n + m, maxD);
+    const int offset = limit + 1;
+    std::vector<int> v((size_t)2 * limit + 3, 0);
+    std::vector<std::vector<int>> trace;   // v[-d-1 .. d+1] before step d
+
+    for (int d = 0; d <= limit; d++) {
+        trace.emplace_back(v.begin() + (offset - d - 1), v.begin() + (offset + d + 2));
+        for (int k = -d; k <= d; k += 2) {
+            int x = (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1]))
+                ? v[offset + k + 1] : v[offset + k - 1] + 1;
+            int y = x - k;
+            while (x < n && y < m && a[x] == b[y]) { x++; y++; }
+            v[offset + k] = x;
+            if (x < n || y < m) continue;
+
+            // Walk the trace back from (n, m)
+            script.clear();
+            for (int dd = d; dd > 0; dd--) {
+                const std::vector<int>& t = trace[dd];
+                auto at = [&](int kk) { return t[kk + dd + 1]; };
+                int kk = x - y;
+                int prevK = (kk == -dd || (kk != dd && at(kk - 1) < at(kk + 1))) ? kk + 1 : kk - 1;
+                int prevX = at(prevK), prevY = prevX - prevK;
+                while (x > prevX && y > prevY) { script.push_back(Op::Equal); x--; y--; }
+                script.push_back(prevK == kk + 1 ? Op::Insert : Op::Delete);
+                x = prevX;
+                y = prevY;
+            }
+            while (x > 0 && y > 0) { script.push_back(Op::Equal); x--; y--; }
+            std::reverse(script.begin(), script.end());
+            return true;
+        }
+    }
+    return false;
+}
+
+// Front to back, an edit that grows the text can run before a later one
+// that shrinks it, and the device text would pass its capacity on the
+// way to a result that fits. Sends the shrinking edits first, then the
+// growing ones, each group back to front so that no edit moves the text
+// under one still to come; the length then only falls, then only rises.
+std::vector<TextEdit> OrderWithinCapacity(const std::vector<TextEdit>& edits) {
+    // Positions in the old text (edits are in order and do not overlap)
+    std::vector<size_t> oldPos;
+    ptrdiff_t shift = 0;
+    for (const TextEdit& e : edits) {
+        oldPos.push_back((size_t)((ptrdiff_t)e.pos - shift));
+        shift += (ptrdiff_t)e.insert.size() - (ptrdiff_t)e.remove;
+    }
+    auto grows = [&](size_t i) { return edits[i].insert.size() > edits[i].remove; };
+
+    std::vector<TextEdit> ordered;
+    for (size_t i = edits.size(); i-- > 0;) {
+        if (grows(i)) continue;
+        ordered.push_back(edits[i]);
+        ordered.back().pos = oldPos[i];
+    }
+    // Every shrinking edit has run: those before a growing edit moved it
+    for (size_t i = edits.size(); i-- > 0;) {
+        if (!grows(i)) continue;
+        ptrdiff_t moved = 0;
+        for (size_t j = 0; j < i; j++) {
+            if (!grows(j)) moved += (ptrdiff_t)edits[j].insert.size() - (ptrdiff_t)edits[j].remove;
+        }
+        ordered.push_back(edits[i]);
+        ordered.back().pos = (size_t)((ptrdiff_t)oldPos[i] + moved);
+    }
+    return ordered;
+}
+
+} // namespace
+
+std::vector<TextEdit> DiffWords(const std::string& oldText, const std::string& newText, size_t maxChanges) {
+    std::vector<TextEdit> edits;
+    if (oldText == newText) return edits;
+
+    std::unordered_map<std::string_view, int> ids;
+    std::vector<Token> oldTokens, newTokens;
+    std::vector<int> a, b;
+    Tokenize(oldText, ids, oldTokens, a);
+    Tokenize(newText, ids, newTokens, b);
+
+    size_t prefix = 0;
+    while (prefix < a.size() && prefix < b.size() && a[prefix] == b[prefix]) prefix++;
+    size_t suffix = 0;
+    while (suffix < a.size() - prefix && suffix < b.size() - prefix &&
+           a[a.size() - 1 - suffix] == b[b.size() - 1 - suffix]) suffix++;
+
+    const size_t n = a.size() - prefix - suffix, m = b.size() - prefix - suffix;
+    const size_t oldStart = prefix < oldTokens.size() ? oldTokens[prefix].offset : oldText.size();
+    const size_t newStart = prefix < newTokens.size() ? newTokens[prefix].offset : newText.size();
+    auto oldEnd = [&](size_t i) { return oldTokens[i].offset + oldTokens[i].length; };
+    auto newEnd = [&](size_t i) { return newTokens[i].offset + newTokens[i].length; };
+
+    std::vector<Op> script;
+    if (!Myers(a.data() + prefix, (int)n, b.data() + prefix, (int)m,
+               (int)(std::min)(maxChanges, (size_t)1 << 20), script)) {
+        size_t oldStop = n ? oldEnd(prefix + n - 1) : oldStart;
+        size_t newStop = m ? newEnd(prefix + m - 1) : newStart;
+        edits.push_back({ newStart, oldStop - oldStart, newText.substr(newStart, newStop - newStart) });
+        return edits;
+    }
+
+    // Each run of deletes/inserts between equal tokens becomes one edit
+    size_t ai = prefix, bj = prefix, pos = newStart;
+    for (size_t s = 0; s < script.size();) {
+        if (script[s] == Op::Equal) {
+            pos += newTokens[bj].length;
+            ai++; bj++; s++;
+            continue;
+        }
+        TextEdit e{ pos, 0, std::string() };
+        for (; s < script.size() && script[s] != Op::Equal; s++) {
+            if (script[s] == Op::Delete) {
+                e.remove += oldTokens[ai++].length;
+            }
+            else {
+                const Token& t = newTokens[bj++];
+                e.insert.append(newText, t.offset, t.length);
+            }
+        }
+        pos += e.insert.size();
+        edits.push_back(std::move(e));
+    }
+    return edits;
+}
+
+void ApplyEdits(std::string& text, const std::vector<TextEdit>& edits) {
+    for (const TextEdit& e : edits) {
+        size_t remove = (std::min)(e.remove, text.size() - e.pos);
+        text.replace(e.pos, remove, e.insert);
+    }
+}
+
+uint16_t TextChecksum(const std::string& text) {
+    uint16_t crc = 0xFFFF;
+    for (unsigned char c : text) {
+        crc ^= (uint16_t)(c << 8);
+        for (int b = 0; b < 8; b++) crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+DeviceTextMirror::DeviceTextMirror(TextDeltaOptions options) : m_options(options) {
+    // Room for the longest header plus one escaped byte
+    m_options.maxLineLength = (std::max)(m_options.maxLineLength, (size_t)16);
+    m_options.capacity = (std::min)(m_options.capacity, (size_t)0xFFFE);
+}
+
+void DeviceTextMirror::Reset() {
+    m_text.clear();
+    m_synced = false;
+}
+
+std::string DeviceTextMirror::ExpectedSum() const {
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "SUM:%04X,%04X", (unsigned)m_text.size(), (unsigned)TextChecksum(m_text));
+    return buf;
+}
+
+std::string DeviceTextMirror::Encode(const TextEdit& edit) const {
+    std::string out;
+    size_t pos = edit.pos, remove = edit.remove, i = 0;
+    do {
+        char header[24];
+        int n = std::snprintf(header, sizeof(header), "E:%X,%X:", (unsigned)pos, (unsigned)remove);
+        size_t lineStart = out.size();
+        out.append(header, (size_t)n);
+
+        // Never split an escape across lines
+        size_t start = i;
+        while (i < edit.insert.size()) {
+            char c = edit.insert[i];
+            const char* esc = c == '\n' ? "\\n" : c == '\r' ? "\\r" : c == '\\' ? "\\\\" : nullptr;
+            size_t len = esc ? 2 : 1;
+            if (out.size() - lineStart + len > m_options.maxLineLength) break;
+            if (esc) out.append(esc, 2);
+            else out.push_back(c);
+            i++;
+        }
+        out.push_back('\n');
+        pos += i - start;
+        remove = 0;
+    } while (i < edit.insert.size());
+    return out;
+}
+
+std::string DeviceTextMirror::Update(const std::string& newText) {
+    std::string target = newText;
+    m_truncated = target.size() > m_options.capacity;
+    if (m_truncated) {
+        size_t cut = m_options.capacity;
+        while (cut > 0 && ((unsigned char)target[cut] & 0xC0) == 0x80) cut--;
+        target.resize(cut);
+    }
+
+    std::string full = Encode({ 0, 0xFFFF, target });
+    if (!m_synced) {
+        m_text = std::move(target);
+        m_synced = true;
+        return full;
+    }
+    if (target == m_text) return std::string();
+
+    std::vector<TextEdit> edits = DiffWords(m_text, target);
+
+    // An E: header costs about as much as a few bytes of text, so send
+    // edits separated by a short unchanged gap as one
+    std::vector<TextEdit> merged;
+    for (TextEdit& e : edits) {
+        if (!merged.empty()) {
+            TextEdit& prev = merged.back();
+            size_t gapStart = prev.pos + prev.insert.size();
+            size_t gap = e.pos - gapStart;
+            if (gap < m_options.mergeGap) {
+                prev.remove += gap + e.remove;
+                prev.insert.append(target, gapStart, gap);
+                prev.insert += e.insert;
+                continue;
+            }
+        }
+        merged.push_back(std::move(e));
+    }
+
+    std::string delta;
+    for (const TextEdit& e : OrderWithinCapacity(merged)) delta += Encode(e);
+    m_text = std::move(target);
+    return delta.size() < full.size() ? delta : full;
+}
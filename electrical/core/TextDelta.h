@@ -0,0 +1,71 @@
+// TextDelta.h - Sends edits instead of whole documents to the device.
+//
+// DiffWords() runs a Myers diff over word and whitespace tokens and turns
+// the result into replace(pos, remove, text) edits. DeviceTextMirror keeps
+// the text the device last acknowledged and encodes the edits as the
+// firmware's "E:pos,remove:text" lines (braille/src/main.cpp, TextBuffer),
+// falling back to a full resend when that is shorter.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct TextEdit {
+    size_t pos;              // byte offset in the text as edited so far
+    size_t remove;           // bytes removed at pos
+    std::string insert;      // bytes inserted at pos
+};
+
+// Edits that turn oldText into newText when applied in order. Common
+// prefix and suffix are skipped first; if the middle still needs more than
+// maxChanges token inserts/deletes, it becomes one replace instead.
+std::vector<TextEdit> DiffWords(const std::string& oldText, const std::string& newText,
+                                size_t maxChanges = 1024);
+
+// Applies edits to text (the reference for what the firmware does)
+void ApplyEdits(std::string& text, const std::vector<TextEdit>& edits);
+
+// CRC-16/CCITT-FALSE, as reported by the firmware's SUM command
+uint16_t TextChecksum(const std::string& text);
+
+struct TextDeltaOptions {
+    size_t maxLineLength = 62;   // firmware inputBuffer (64) minus '\n' and NUL
+    size_t capacity = 512;       // TEXT_BUFFER_SIZE; longer text is cut at a UTF-8 boundary
+    size_t mergeGap = 6;         // edits closer than this are sent as one
+};
+
+class DeviceTextMirror {
+public:
+    explicit DeviceTextMirror(TextDeltaOptions options = TextDeltaOptions());
+
+    // Commands, '\n'-terminated and concatenated, that bring the device
+    // from the last synced text to newText. Empty if nothing changed.
+    // The device text stays within capacity after every line, not only
+    // at the end. The mirror assumes they will be delivered; call
+    // Reset() if not.
+    std::string Update(const std::string& newText);
+
+    // The device content is unknown (reconnect, failed write, SUM
+    // mismatch): the next Update() replaces everything.
+    void Reset();
+
+    const std::string& Text() const { return m_text; }
+    bool Synced() const { return m_synced; }
+    // Whether the last Update() had to cut newText to the capacity
+    bool Truncated() const { return m_truncated; }
+
+    // Expected reply to "SUM" for the current text
+    std::string ExpectedSum() const;
+
+    // Encodes one edit as one or more E: lines
+    std::string Encode(const TextEdit& edit) const;
+
+private:
+    TextDeltaOptions m_options;
+    std::string m_text;
+    bool m_synced = false;
+    bool m_truncated = false;
+};
@@ -0,0 +1,296 @@
+// TextNormalize.cpp - ASCII fast path and transliteration table. See TextNormalize.h.
+
+#include "TextNormalize.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Up to four bytes of ASCII text; len 0 drops the code point.
+struct Replacement {
+    uint8_t len;
+    uint8_t bytes[4];
+};
+
+struct Table {
+    uint8_t block[256] = {};          // BMP high byte -> 1 + block number, 0 if unmapped
+    std::vector<uint16_t> entries;    // 256 per block: 1 + replacement index, 0 if unmapped
+    std::vector<Replacement> replacements;
+
+    uint16_t& Entry(uint32_t cp) {
+        uint8_t& b = block[cp >> 8];
+        if (!b) {
+            entries.resize(entries.size() + 256, 0);
+            b = (uint8_t)(entries.size() / 256);
+        }
+        return entries[(size_t)(b - 1) * 256 + (cp & 0xFF)];
+    }
+
+    void Ascii(uint32_t cp, const char* text) {
+        Replacement r{};
+        r.len = (uint8_t)strlen(text);
+        memcpy(r.bytes, text, r.len);
+        Add(cp, r);
+    }
+
+    void Drop(uint32_t first, uint32_t last) {
+        for (uint32_t cp = first; cp <= last; cp++) Ascii(cp, "");
+    }
+
+    // One ASCII letter per code point from `first`; '*' entries are skipped
+    void Letters(uint32_t first, const char* letters) {
+        for (uint32_t i = 0; letters[i]; i++) {
+            if (letters[i] == '*') continue;
+            char s[2] = { letters[i], 0 };
+            Ascii(first + i, s);
+        }
+    }
+
+    void Add(uint32_t cp, const Replacement& r) {
+        replacements.push_back(r);
+        Entry(cp) = (uint16_t)replacements.size();
+    }
+
+    const Replacement* Find(uint32_t cp) const {
+        if (cp > 0xFFFF || !block[cp >> 8]) return nullptr;
+        uint16_t e = entries[(size_t)(block[cp >> 8] - 1) * 256 + (cp & 0xFF)];
+        return e ? &replacements[e - 1] : nullptr;
+    }
+};
+
+Table BuildTable() {
+    Table t;
+
+    // Controls the braille tables mark as undefined (0xFF)
+    t.Drop(0x00, 0x08);
+    t.Drop(0x0B, 0x0C);
+    t.Drop(0x0E, 0x1F);
+    t.Drop(0x7F, 0x9F);
+
+    // Latin-1 Supplement
+    t.Ascii(0xA0, " ");   t.Ascii(0xA1, "!");   t.Ascii(0xA2, "c");   t.Ascii(0xA3, "GBP");
+    t.Ascii(0xA5, "JPY"); t.Ascii(0xA6, "|");   t.Ascii(0xA8, "\"");  t.Ascii(0xAB, "\"");
+    t.Ascii(0xAC, "!");   t.Drop(0xAD, 0xAD);   t.Ascii(0xAE, "(R)"); t.Ascii(0xAF, "-");
+    t.Ascii(0xB1, "+/-"); t.Ascii(0xB2, "2");   t.Ascii(0xB3, "3");   t.Ascii(0xB4, "'");
+    t.Ascii(0xB5, "u");   t.Ascii(0xB7, ".");   t.Ascii(0xB8, ",");   t.Ascii(0xB9, "1");
+    t.Ascii(0xBA, "o");   t.Ascii(0xBB, "\"");  t.Ascii(0xBC, "1/4"); t.Ascii(0xBD, "1/2");
+    t.Ascii(0xBE, "3/4"); t.Ascii(0xBF, "?");   t.Ascii(0xAA, "a");
+    t.Ascii(0xA9, "(c)"); t.Ascii(0xB0, "deg"); t.Ascii(0xA7, "S");   t.Ascii(0xB6, "P");
+    t.Ascii(0xD7, "x");   t.Ascii(0xF7, "/");
+    t.Letters(0xC0, "AAAAAA*CEEEEIIII" "DNOOOOO*OUUUUY**" "aaaaaa*ceeeeiiii" "dnooooo*ouuuuy*y");
+    t.Ascii(0xC6, "AE");  t.Ascii(0xE6, "ae");  t.Ascii(0xDE, "Th");  t.Ascii(0xFE, "th");
+    t.Ascii(0xDF, "ss");
+
+    // Latin Extended-A
+    t.Letters(0x100, "AaAaAaCcCcCcCcDd" "DdEeEeEeEeEeGgGg" "GgGgHhHhIiIiIiIi" "Ii**JjKkkLlLlLlL"
+                     "lLlNnNnNn*NnOoOo" "Oo**RrRrRrSsSsSs" "SsTtTtTtUuUuUuUu" "UuUuWwYyYZzZzZzs");
+    t.Ascii(0x132, "IJ"); t.Ascii(0x133, "ij"); t.Ascii(0x149, "'n");
+    t.Ascii(0x152, "OE"); t.Ascii(0x153, "oe");
+
+    // Spacing modifiers and combining marks (decomposed accents)
+    t.Ascii(0x2BC, "'");  t.Ascii(0x2C6, "^");  t.Ascii(0x2DC, "~");
+    t.Drop(0x300, 0x36F);
+
+    // General Punctuation
+    for (uint32_t cp = 0x2000; cp <= 0x200A; cp++) t.Ascii(cp, " ");
+    t.Drop(0x200B, 0x200F);
+    t.Ascii(0x2010, "-");  t.Ascii(0x2011, "-");  t.Ascii(0x2012, "-");  t.Ascii(0x2013, "-");
+    t.Ascii(0x2014, "--"); t.Ascii(0x2015, "--"); t.Ascii(0x2016, "||");
+    t.Ascii(0x2018, "'");  t.Ascii(0x2019, "'");  t.Ascii(0x201A, "'");  t.Ascii(0x201B, "'");
+    t.Ascii(0x201C, "\""); t.Ascii(0x201D, "\""); t.Ascii(0x201E, "\""); t.Ascii(0x201F, "\"");
+    t.Ascii(0x2024, ".");  t.Ascii(0x2025, ".."); t.Ascii(0x2026, "...");
+    t.Ascii(0x2027, "-");  t.Ascii(0x2028, "\n"); t.Ascii(0x2029, "\n"); t.Drop(0x202A, 0x202E);
+    t.Ascii(0x202F, " ");  t.Ascii(0x2030, "%");  t.Ascii(0x2032, "'");  t.Ascii(0x2033, "\"");
+    t.Ascii(0x2039, "'");  t.Ascii(0x203A, "'");  t.Ascii(0x2044, "/");  t.Ascii(0x205F, " ");
+    t.Drop(0x2060, 0x2064);
+    t.Ascii(0x2022, "*");  // bullet
+
+    // Currency, letterlike, arrows, math
+    t.Ascii(0x20AC, "EUR"); t.Ascii(0x2122, "(TM)");
+    t.Ascii(0x2190, "<-");  t.Ascii(0x2192, "->");  t.Ascii(0x2194, "<->");
+    t.Ascii(0x21D0, "<="); t.Ascii(0x21D2, "=>");
+    t.Ascii(0x2212, "-");   t.Ascii(0x2215, "/");   t.Ascii(0x2217, "*");
+    t.Ascii(0x2248, "~");   t.Ascii(0x2260, "!=");  t.Ascii(0x2264, "<=");  t.Ascii(0x2265, ">=");
+
+    // Alphabetic presentation forms (ligatures)
+    t.Ascii(0xFB00, "ff");  t.Ascii(0xFB01, "fi");  t.Ascii(0xFB02, "fl");
+    t.Ascii(0xFB03, "ffi"); t.Ascii(0xFB04, "ffl"); t.Ascii(0xFB05, "st"); t.Ascii(0xFB06, "st");
+
+    t.Drop(0xFEFF, 0xFEFF);   // BOM / zero-width no-break space
+    t.Ascii(0xFFFD, "?");
+    return t;
+}
+
+const Table& Transliteration() {
+    static const Table table = BuildTable();
+    return table;
+}
+
+// Decodes one code point at p (p[0] >= 0x80 or a control). Returns its
+// length, or 0 if the sequence is invalid.
+size_t DecodeUtf8(const uint8_t* p, size_t n, uint32_t& cp) {
+    uint8_t c = p[0];
+    size_t len;
+    uint32_t min;
+    if (c < 0x80) { cp = c; return 1; }
+    else if ((c & 0xE0) == 0xC0) { len = 2; cp = c & 0x1F; min = 0x80; }
+    else if ((c & 0xF0) == 0xE0) { len = 3; cp = c & 0x0F; min = 0x800; }
+    else if ((c & 0xF8) == 0xF0) { len = 4; cp = c & 0x07; min = 0x10000; }
+    else return 0;
+    if (len > n) return 0;
+    for (size_t i = 1; i < len; i++) {
+        if ((p[i] & 0xC0) != 0x80) return 0;
+        cp = (cp << 6) | (p[i] & 0x3F);
+    }
+    if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return 0;
+    return len;
+}
+
+inline bool IsPlain(uint8_t c) {
+    return (c >= 0x20 && c < 0x7F) || c == '\n' || c == '\r' || c == '\t';
+}
+
+size_t PlainPrefixScalar(const uint8_t* p, size_t n) {
+    size_t i = 0;
+    while (i < n && IsPlain(p[i])) i++;
+    return i;
+}
+
+#if defined(IMAGESCALE_SSE2)
+inline int CountTrailingZeros(uint32_t v) {
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward(&i, v);
+    return (int)i;
+#else
+    return __builtin_ctz(v);
+#endif
+}
+
+// Signed compares: bytes >= 0x80 are negative, so one "> 0x1F && < 0x7F"
+// test rejects both controls and non-ASCII
+size_t PlainPrefixSse2(const uint8_t* p, size_t n) {
+    const __m128i lo = _mm_set1_epi8(0x1F), hi = _mm_set1_epi8(0x7F);
+    const __m128i tab = _mm_set1_epi8('\t'), lf = _mm_set1_epi8('\n'), cr = _mm_set1_epi8('\r');
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i ok = _mm_and_si128(_mm_cmpgt_epi8(v, lo), _mm_cmplt_epi8(v, hi));
+        ok = _mm_or_si128(ok, _mm_or_si128(_mm_cmpeq_epi8(v, lf),
+                                           _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, tab))));
+        uint32_t bad = ~(uint32_t)_mm_movemask_epi8(ok) & 0xFFFF;
+        if (bad) return i + CountTrailingZeros(bad);
+    }
+    return i + PlainPrefixScalar(p + i, n - i);
+}
+
+IMAGESCALE_TARGET_AVX2
+size_t PlainPrefixAvx2(const uint8_t* p, size_t n) {
+    const __m256i lo = _mm256_set1_epi8(0x1F), hi = _mm256_set1_epi8(0x7F);
+    const __m256i tab = _mm256_set1_epi8('\t'), lf = _mm256_set1_epi8('\n'), cr = _mm256_set1_epi8('\r');
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        __m256i ok = _mm256_and_si256(_mm256_cmpgt_epi8(v, lo), _mm256_cmpgt_epi8(hi, v));
+        ok = _mm256_or_si256(ok, _mm256_or_si256(_mm256_cmpeq_epi8(v, lf),
+                                                 _mm256_or_si256(_mm256_cmpeq_epi8(v, cr), _mm256_cmpeq_epi8(v, tab))));
+        uint32_t bad = ~(uint32_t)_mm256_movemask_epi8(ok);
+        if (bad) return i + CountTrailingZeros(bad);
+    }
+    return i + PlainPrefixSse2(p + i, n - i);
+}
+#endif
+
+} // namespace
+
+using PlainPrefixFn = size_t (*)(const uint8_t*, size_t);
+
+PlainPrefixFn SelectPlainPrefix(ScaleKernel kernel) {
+    switch (ResolveScaleKernel(kernel)) {
+#if defined(IMAGESCALE_SSE2)
+    case ScaleKernel::Avx2: return PlainPrefixAvx2;
+    case ScaleKernel::Sse2: return PlainPrefixSse2;
+#endif
+    default: return PlainPrefixScalar;
+    }
+}
+
+size_t PlainAsciiPrefix(const char* text, size_t size, ScaleKernel kernel) {
+    return SelectPlainPrefix(kernel)(reinterpret_cast<const uint8_t*>(text), size);
+}
+
+BrailleNormalizer::BrailleNormalizer(std::string unknown, ScaleKernel kernel)
+    : m_unknown(std::move(unknown)), m_kernel(ResolveScaleKernel(kernel)) {
+    Transliteration();   // build the table now rather than on the first send
+}
+
+void BrailleNormalizer::Normalize(const char* text, size_t size, std::string& out, NormalizeStats* stats) const {
+    NormalizeStats s;
+    const Table& table = Transliteration();
+    const PlainPrefixFn plainPrefix = SelectPlainPrefix(m_kernel);
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(text);
+
+    // Output is written through a pointer into space reserved per chunk:
+    // one input byte never produces more than `grow` output bytes (a
+    // 2-byte code point -> up to 3 ASCII bytes, or one unknown per byte)
+    const size_t grow = (std::max)((size_t)2, m_unknown.size());
+    const size_t kChunk = 16384;
+
+    size_t i = 0;
+    while (i < size) {
+        const size_t chunkEnd = (std::min)(size, i + kChunk);
+        const size_t base = out.size();
+        out.resize(base + (chunkEnd - i + 3) * grow);
+        char* const begin = &out[base];
+        char* o = begin;
+
+        while (i < chunkEnd) {
+            // Runs of non-ASCII (accented words, symbols) skip the SIMD setup
+            size_t run = IsPlain(p[i]) ? plainPrefix(p + i, chunkEnd - i) : 0;
+            memcpy(o, p + i, run);
+            o += run;
+            s.asciiBytes += run;
+            i += run;
+            if (i == chunkEnd) break;
+
+            // A code point may run up to 3 bytes past chunkEnd; that is reserved
+            uint32_t cp;
+            size_t len = DecodeUtf8(p + i, size - i, cp);
+            if (len == 0) {
+                memcpy(o, m_unknown.data(), m_unknown.size());
+                o += m_unknown.size();
+                s.invalid++;
+                i++;
+                continue;
+            }
+            i += len;
+
+            if (const Replacement* r = table.Find(cp)) {
+                if (r->len == 0) {
+                    s.dropped++;
+                } else {
+                    memcpy(o, r->bytes, r->len);
+                    o += r->len;
+                    s.mapped++;
+                }
+            } else {
+                memcpy(o, m_unknown.data(), m_unknown.size());
+                o += m_unknown.size();
+                s.unknown++;
+            }
+        }
+        out.resize(base + (size_t)(o - begin));
+    }
+
+    if (stats) {
+        stats->asciiBytes += s.asciiBytes;
+        stats->mapped += s.mapped;
+        stats->dropped += s.dropped;
+        stats->unknown += s.unknown;
+        stats->invalid += s.invalid;
+    }
+}
@@ -0,0 +1,54 @@
+// TextNormalize.h - Folds Unicode text down to what the braille tables know.
+//
+// The device (BrailleCell::_translateToBraille) and BrailleConverter's
+// CHAR_TO_PATTERN only cover 7-bit ASCII, while OCR results and documents
+// carry curly quotes, dashes, ligatures and accented letters. The
+// normalizer runs on the host before text is sent:
+//
+//   - printable ASCII, tab, CR and LF are copied; SIMD skips 32 (AVX2) or
+//     16 (SSE2) such bytes per step, so plain text costs about a memcpy
+//   - other code points are looked up in a two-level table (high byte ->
+//     block, low byte -> entry) and become ASCII ("fi", "...", "e", "--",
+//     "(c)") or nothing (controls, zero-width characters, combining marks)
+//   - anything else, and invalid UTF-8, becomes the `unknown` string;
+//     that includes Unicode braille (U+2800-U+28FF), since E: text is
+//     translated per ASCII byte on the device and nothing there decodes it
+
+#pragma once
+
+#include "ImageScale.h"
+
+#include <cstddef>
+#include <string>
+
+struct NormalizeStats {
+    size_t asciiBytes = 0;   // copied unchanged
+    size_t mapped = 0;       // code points replaced by ASCII
+    size_t dropped = 0;      // controls, zero-width and combining characters
+    size_t unknown = 0;      // code points with no mapping
+    size_t invalid = 0;      // bytes that are not valid UTF-8
+};
+
+class BrailleNormalizer {
+public:
+    explicit BrailleNormalizer(std::string unknown = "?", ScaleKernel kernel = ScaleKernel::Auto);
+
+    // Appends the normalized form of text to out and adds to stats
+    void Normalize(const char* text, size_t size, std::string& out, NormalizeStats* stats = nullptr) const;
+
+    std::string Normalize(const std::string& text) const {
+        std::string out;
+        out.reserve(text.size());
+        Normalize(text.data(), text.size(), out);
+        return out;
+    }
+
+    ScaleKernel Kernel() const { return m_kernel; }
+
+private:
+    std::string m_unknown;
+    ScaleKernel m_kernel;
+};
+
+// Length of the leading run of bytes Normalize() copies unchanged
+size_t PlainAsciiPrefix(const char* text, size_t size, ScaleKernel kernel = ScaleKernel::Auto);
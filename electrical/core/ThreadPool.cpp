@@ -0,0 +1,136 @@
+// ThreadPool.cpp - Per-participant tile queues with stealing. See ThreadPool.h.
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+// Pool whose tile this thread is running (or waiting on), if any
+thread_local const ThreadPool* t_insidePool = nullptr;
+
+} // namespace
+
+struct ThreadPool::Job {
+    const std::function<void(int, int)>* fn;
+    std::atomic<int> pending;
+    std::mutex mutex;
+    std::condition_variable done;
+    bool finished = false;
+};
+
+ThreadPool::ThreadPool(int threads) {
+    if (threads <= 0) threads = (int)(std::max)(1u, std::thread::hardware_concurrency());
+    m_threads = threads;
+    for (int i = 0; i < threads; i++) m_queues.emplace_back(new Queue());
+    m_workers.reserve((size_t)threads - 1);
+    for (int i = 1; i < threads; i++) m_workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& w : m_workers) w.join();
+}
+
+ThreadPool& ThreadPool::Shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::ParallelFor(int begin, int end, int grain, const std::function<void(int, int)>& fn) {
+    if (end <= begin) return;
+    const int count = end - begin;
+    if (grain <= 0) grain = (std::max)(1, (count + m_threads * 4 - 1) / (m_threads * 4));
+    if (m_threads <= 1 || count <= grain || t_insidePool == this) {
+        fn(begin, end);
+        return;
+    }
+
+    const int tiles = (count + grain - 1) / grain;
+    Job job;
+    job.fn = &fn;
+    job.pending = tiles;
+
+    // Deal contiguous blocks of tiles, the first block to the caller's queue
+    const int participants = (std::min)(m_threads, tiles);
+    for (int p = 0; p < participants; p++) {
+        const int t0 = (int)((int64_t)tiles * p / participants);
+        const int t1 = (int)((int64_t)tiles * (p + 1) / participants);
+        Queue& q = *m_queues[(size_t)p];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        for (int t = t0; t < t1; t++)
+            q.tasks.push_back({ &job, begin + t * grain, (std::min)(end, begin + (t + 1) * grain) });
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_queued += (size_t)tiles;
+    }
+    m_wake.notify_all();
+
+    // Work on this call's tiles until none are left to take, then wait
+    // for the ones still running. Tiles of other callers are left to the
+    // workers, so no more than Threads() tiles of one call run at once.
+    const ThreadPool* outer = t_insidePool;
+    t_insidePool = this;
+    Task task;
+    while (job.pending.load() > 0 && TakeTask(0, task, &job)) RunTask(task);
+    t_insidePool = outer;
+
+    std::unique_lock<std::mutex> lock(job.mutex);
+    job.done.wait(lock, [&] { return job.finished; });
+}
+
+void ThreadPool::WorkerLoop(int index) {
+    t_insidePool = this;
+    for (;;) {
+        Task task;
+        if (TakeTask(index, task)) {
+            RunTask(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_wake.wait(lock, [&] { return m_stop || m_queued.load() > 0; });
+        if (m_stop && m_queued.load() == 0) return;
+    }
+}
+
+bool ThreadPool::TakeTask(int index, Task& task, const Job* only) {
+    // Own queue from the front, then the others from the back
+    for (int i = 0; i < m_threads; i++) {
+        Queue& q = *m_queues[(size_t)((index + i) % m_threads)];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) continue;
+        auto it = q.tasks.end();
+        if (i == 0) {
+            it = q.tasks.begin();
+            while (only && it != q.tasks.end() && it->job != only) ++it;
+        } else {
+            for (auto r = q.tasks.rbegin(); r != q.tasks.rend(); ++r) {
+                if (!only || r->job == only) { it = std::prev(r.base()); break; }
+            }
+        }
+        if (it == q.tasks.end()) continue;
+        task = *it;
+        q.tasks.erase(it);
+        if (i != 0) m_steals.fetch_add(1, std::memory_order_relaxed);
+        m_queued--;
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::RunTask(const Task& task) {
+    Job* job = task.job;
+    (*job->fn)(task.begin, task.end);
+    if (job->pending.fetch_sub(1) == 1) {
+        // The waiting caller owns job; it cannot return before this unlock
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->finished = true;
+        job->done.notify_all();
+    }
+}
@@ -0,0 +1,79 @@
+// ThreadPool.h - Work-stealing thread pool for the image kernels.
+//
+// ParallelFor() cuts a row range into tiles of `grain` rows and deals them
+// out in contiguous blocks, one block per participant, so neighbouring
+// rows stay on one core. Each participant works through its own block
+// front to back; when it runs dry it steals tiles from the back of
+// another's block, so a core that finishes early (or a block of expensive
+// rows) does not leave the others waiting. The calling thread is one of
+// the participants and ParallelFor() returns once every tile has run.
+//
+// Runs serially, as one fn call over the whole range on the calling
+// thread, when the pool has one thread, the range is a single tile, or
+// ParallelFor() is called from inside a tile of the same pool.
+//
+// Several threads may call ParallelFor() at once; no more than Threads()
+// tiles of one call run at the same time, so per-call scratch can be
+// sized by Threads(). fn must not throw.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    // threads counts the calling thread: 0 is one per core, 1 is serial
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    // Process-wide pool with one thread per core, started on first use
+    static ThreadPool& Shared();
+
+    // Calls fn(tileBegin, tileEnd) for tiles of `grain` indices covering
+    // [begin, end). grain <= 0 picks about four tiles per thread.
+    void ParallelFor(int begin, int end, int grain, const std::function<void(int, int)>& fn);
+
+    int Threads() const { return m_threads; }
+    // Tiles run by a participant other than the one they were dealt to
+    size_t Steals() const { return m_steals.load(std::memory_order_relaxed); }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+private:
+    struct Job;
+    struct Task {
+        Job* job;
+        int begin, end;
+    };
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void WorkerLoop(int index);
+    bool TakeTask(int index, Task& task, const Job* only = nullptr);
+    void RunTask(const Task& task);
+
+    int m_threads;
+    std::vector<std::unique_ptr<Queue>> m_queues;   // [0] callers', [i] worker i's
+    std::vector<std::thread> m_workers;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::atomic<size_t> m_queued{ 0 };
+    std::atomic<size_t> m_steals{ 0 };
+    bool m_stop = false;
+};
+
+// The pool an image kernel runs on: `pool`, or the shared one if null
+inline ThreadPool& PoolOrShared(ThreadPool* pool) {
+    return pool ? *pool : ThreadPool::Shared();
+}
@@ -0,0 +1,180 @@
+// TileChangeDetector.cpp - Tile compare and band merging. See TileChangeDetector.h.
+
+#include "TileChangeDetector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace {
+
+bool SpanEqualScalar(const uint8_t* a, const uint8_t* b, size_t n) {
+    return memcmp(a, b, n) == 0;
+}
+
+#if defined(IMAGESCALE_SSE2)
+bool SpanEqualSse2(const uint8_t* a, const uint8_t* b, size_t n) {
+    size_t i = 0;
+    __m128i diff = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        diff = _mm_or_si128(diff, _mm_xor_si128(x, y));
+    }
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) != 0xFFFF) return false;
+    return SpanEqualScalar(a + i, b + i, n - i);
+}
+
+IMAGESCALE_TARGET_AVX2
+bool SpanEqualAvx2(const uint8_t* a, const uint8_t* b, size_t n) {
+    size_t i = 0;
+    __m256i diff = _mm256_setzero_si256();
+    for (; i + 32 <= n; i += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        diff = _mm256_or_si256(diff, _mm256_xor_si256(x, y));
+    }
+    if (!_mm256_testz_si256(diff, diff)) return false;
+    return SpanEqualSse2(a + i, b + i, n - i);
+}
+#endif
+
+bool SpanEqual(ScaleKernel kernel, const uint8_t* a, const uint8_t* b, size_t n) {
+    switch (kernel) {
+#if defined(IMAGESCALE_SSE2)
+    case ScaleKernel::Avx2: return SpanEqualAvx2(a, b, n);
+    case ScaleKernel::Sse2: return SpanEqualSse2(a, b, n);
+#endif
+    default: return SpanEqualScalar(a, b, n);
+    }
+}
+
+} // namespace
+
+TileChangeDetector::TileChangeDetector(TileDiffOptions options, ScaleKernel kernel)
+    : m_options(options), m_kernel(ResolveScaleKernel(kernel)) {
+    m_options.tileWidth = (std::max)(m_options.tileWidth, 1);
+    m_options.tileHeight = (std::max)(m_options.tileHeight, 1);
+    m_options.padTiles = (std::max)(m_options.padTiles, 0);
+    m_options.mergeGapTiles = (std::max)(m_options.mergeGapTiles, 0);
+    m_options.grainTileRows = (std::max)(m_options.grainTileRows, 1);
+}
+
+void TileChangeDetector::Reset() {
+    m_width = m_height = 0;
+    m_tilesX = m_tilesY = 0;
+    m_reference.clear();
+    m_dirty.clear();
+}
+
+size_t TileChangeDetector::Update(const uint8_t* frame, int width, int height, ptrdiff_t stride,
+                                  std::vector<PixelRect>& bands) {
+    bands.clear();
+    if (!frame || width <= 0 || height <= 0) return 0;
+
+    const int tw = m_options.tileWidth, th = m_options.tileHeight;
+    const size_t refStride = (size_t)width * 4;
+    ThreadPool& pool = PoolOrShared(m_options.pool);
+    const int grain = m_options.grainTileRows;
+
+    if (width != m_width || height != m_height || m_reference.empty()) {
+        m_width = width;
+        m_height = height;
+        m_tilesX = (width + tw - 1) / tw;
+        m_tilesY = (height + th - 1) / th;
+        m_reference.resize(refStride * height);
+        pool.ParallelFor(0, height, th * grain, [&](int y0, int y1) {
+            for (int y = y0; y < y1; y++)
+                memcpy(m_reference.data() + y * refStride, frame + (ptrdiff_t)y * stride, refStride);
+        });
+        m_dirty.assign((size_t)m_tilesX * m_tilesY, 1);
+        bands.push_back({ 0, 0, width, height });
+        return m_dirty.size();
+    }
+
+    std::atomic<size_t> changed{ 0 };
+    pool.ParallelFor(0, m_tilesY, grain, [&](int tyBegin, int tyEnd) {
+        size_t tileChanged = 0;
+        for (int ty = tyBegin; ty < tyEnd; ty++) {
+            uint8_t* dirty = m_dirty.data() + (size_t)ty * m_tilesX;
+            std::fill(dirty, dirty + m_tilesX, 0);
+            const int y0 = ty * th, y1 = (std::min)(y0 + th, height);
+
+            // Walk whole pixel rows so both frames are read front to back;
+            // tiles already known to differ are skipped.
+            int clean = m_tilesX;
+            for (int y = y0; y < y1 && clean > 0; y++) {
+                const uint8_t* cur = frame + (ptrdiff_t)y * stride;
+                const uint8_t* ref = m_reference.data() + y * refStride;
+                for (int tx = 0; tx < m_tilesX; tx++) {
+                    if (dirty[tx]) continue;
+                    const size_t x0 = (size_t)tx * tw * 4;
+                    const size_t n = (size_t)((std::min)((tx + 1) * tw, width) - tx * tw) * 4;
+                    if (!SpanEqual(m_kernel, cur + x0, ref + x0, n)) {
+                        dirty[tx] = 1;
+                        clean--;
+                    }
+                }
+            }
+            if (clean == m_tilesX) continue;
+
+            for (int tx = 0; tx < m_tilesX; tx++) {
+                if (!dirty[tx]) continue;
+                tileChanged++;
+                const size_t x0 = (size_t)tx * tw * 4;
+                const size_t n = (size_t)((std::min)((tx + 1) * tw, width) - tx * tw) * 4;
+                for (int y = y0; y < y1; y++)
+                    memcpy(m_reference.data() + y * refStride + x0, frame + (ptrdiff_t)y * stride + x0, n);
+            }
+        }
+        changed += tileChanged;
+    });
+
+    if (changed) BuildBands(bands);
+    return changed.load();
+}
+
+void TileChangeDetector::BuildBands(std::vector<PixelRect>& bands) const {
+    const int tw = m_options.tileWidth, th = m_options.tileHeight, pad = m_options.padTiles;
+
+    // Runs of tile rows with changes, allowing short clean gaps, each
+    // spanning the union of its changed columns (in tiles)
+    struct Run { int top, bottom, left, right; };
+    std::vector<Run> runs;
+    for (int ty = 0; ty < m_tilesY; ty++) {
+        const uint8_t* dirty = m_dirty.data() + (size_t)ty * m_tilesX;
+        int left = -1, right = -1;
+        for (int tx = 0; tx < m_tilesX; tx++) {
+            if (!dirty[tx]) continue;
+            if (left < 0) left = tx;
+            right = tx + 1;
+        }
+        if (left < 0) continue;
+        if (!runs.empty() && ty - runs.back().bottom <= m_options.mergeGapTiles) {
+            Run& r = runs.back();
+            r.bottom = ty + 1;
+            r.left = (std::min)(r.left, left);
+            r.right = (std::max)(r.right, right);
+        }
+        else {
+            runs.push_back({ ty, ty + 1, left, right });
+        }
+    }
+
+    // Pad, convert to pixels and merge bands the padding made touch
+    for (const Run& r : runs) {
+        PixelRect b{ (std::max)(r.left - pad, 0) * tw,
+                     (std::max)(r.top - pad, 0) * th,
+                     (std::min)((r.right + pad) * tw, m_width),
+                     (std::min)((r.bottom + pad) * th, m_height) };
+        if (!bands.empty() && b.top <= bands.back().bottom) {
+            PixelRect& prev = bands.back();
+            prev.bottom = (std::max)(prev.bottom, b.bottom);
+            prev.left = (std::min)(prev.left, b.left);
+            prev.right = (std::max)(prev.right, b.right);
+        }
+        else {
+            bands.push_back(b);
+        }
+    }
+}
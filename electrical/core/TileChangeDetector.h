@@ -0,0 +1,60 @@
+// TileChangeDetector.h - Finds what changed between two captures of the
+// same screen area, for the continuous OCR mode.
+//
+// The frame is split into tiles that are compared against the previous
+// frame with SIMD, row by row and stopping early on a tile once it differs;
+// rows of tiles are spread over a ThreadPool.
+// Changed tiles are merged into horizontal bands (text lines) padded with
+// a little context so OCR sees whole glyphs. Only changed tiles are copied
+// into the reference frame, so an unchanged screen costs one read of each
+// frame and no writes.
+
+#pragma once
+
+#include "ImageScale.h"
+#include "OcrPrep.h"
+#include "ThreadPool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct TileDiffOptions {
+    int tileWidth = 64;       // pixels
+    int tileHeight = 16;      // about one line of text at 100% scaling
+    int padTiles = 1;         // context added around changed tiles
+    int mergeGapTiles = 1;    // clean tile rows allowed inside one band
+    ThreadPool* pool = nullptr;  // null: ThreadPool::Shared()
+    int grainTileRows = 2;    // tile rows per pool tile
+};
+
+class TileChangeDetector {
+public:
+    explicit TileChangeDetector(TileDiffOptions options = TileDiffOptions(),
+                                ScaleKernel kernel = ScaleKernel::Auto);
+
+    // Compares a BGRA frame with the previous one and writes the changed
+    // areas as bands in frame pixels, top to bottom. The first frame, and
+    // any frame of a different size, is reported as changed everywhere.
+    // Returns the number of changed tiles.
+    size_t Update(const uint8_t* frame, int width, int height, ptrdiff_t stride,
+                  std::vector<PixelRect>& bands);
+
+    // Forgets the reference frame; the next Update() reports everything
+    void Reset();
+
+    int TilesX() const { return m_tilesX; }
+    int TilesY() const { return m_tilesY; }
+    // One byte per tile, row-major, nonzero if it changed in the last Update()
+    const std::vector<uint8_t>& DirtyTiles() const { return m_dirty; }
+
+private:
+    void BuildBands(std::vector<PixelRect>& bands) const;
+
+    TileDiffOptions m_options;
+    ScaleKernel m_kernel;
+    int m_width = 0, m_height = 0;
+    int m_tilesX = 0, m_tilesY = 0;
+    std::vector<uint8_t> m_reference;     // previous frame, stride width * 4
+    std::vector<uint8_t> m_dirty;
+};
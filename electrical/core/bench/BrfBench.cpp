@@ -0,0 +1,112 @@
+// BrfBench.cpp - BrfReader and BrfWriter throughput on a generated book.
+//
+//   brf_bench [megabytes]
+//
+// Builds a BRF book (default 64 MB) of 40-cell lines and 25-line pages and
+// reports MB/s for decoding it in 512-byte SD sectors and in 64 KB chunks,
+// and for encoding the decoded lines back through a 64-byte buffered sink.
+// Build in Release.
+
+#include "BrailleBrf.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Words of ASCII braille letters, contractions and signs
+std::string Book(size_t bytes, unsigned seed) {
+    static const char* const words[] = { "?E", "BRL", "DISPLAY", "%[S", "\"O", "L9E", "OF", "TEXT", "AT", "A",
+                                         "TIME4", "#ABC", ",READ+", "*E", "W/", "_S" };
+    std::mt19937 rng(seed);
+    std::string s;
+    s.reserve(bytes + 64);
+    size_t column = 0, line = 0;
+    while (s.size() < bytes) {
+        const char* w = words[rng() % (sizeof(words) / sizeof(words[0]))];
+        size_t n = std::char_traits<char>::length(w);
+        if (column + n + 1 > 40) {
+            s += "\r\n";
+            if (++line % 25 == 0) s += '\f';
+            column = 0;
+        }
+        if (column) {
+            s += ' ';
+            column++;
+        }
+        s += w;
+        column += n;
+    }
+    s += "\r\n\f";
+    return s;
+}
+
+struct NullSink {
+    size_t bytes = 0;
+    void write(const uint8_t*, size_t n) { bytes += n; }
+};
+
+template <typename F>
+double MedianMBps(size_t bytes, F&& run) {
+    std::vector<double> mbps;
+    for (int i = 0; i < 5; i++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        mbps.push_back(bytes / s / 1e6);
+    }
+    std::sort(mbps.begin(), mbps.end());
+    return mbps[mbps.size() / 2];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? (size_t)(std::max)(1, atoi(argv[1])) : 64;
+    std::string book = Book(megabytes << 20, 1);
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(book.data());
+
+    std::vector<uint8_t> lines;   // every line, 40 cells each
+    uint32_t count = 0;
+
+    std::printf("%-22s %9s %10s\n", "pass", "MB/s", "lines");
+    for (size_t chunk : { (size_t)512, (size_t)65535 }) {
+        double mbps = MedianMBps(book.size(), [&] {
+            uint8_t cells[40];
+            BrfReader reader;
+            reader.begin(cells, 40, 25);
+            lines.clear();
+            size_t pos = 0;
+            while (pos < book.size()) {
+                pos += reader.feed(data + pos, (uint16_t)(std::min)(chunk, book.size() - pos));
+                if (reader.lineReady()) {
+                    lines.insert(lines.end(), cells, cells + 40);
+                    reader.nextLine();
+                }
+            }
+            if (reader.finish()) lines.insert(lines.end(), cells, cells + 40);
+            count = (uint32_t)(lines.size() / 40);
+        });
+        std::printf("decode, %5zu B chunks %9.1f %10u\n", chunk, mbps, count);
+    }
+
+    NullSink sink;
+    double mbps = MedianMBps(book.size(), [&] {
+        BrfWriter writer;
+        sink.bytes = 0;
+        writer.begin(sink, 40, 25);
+        for (uint32_t i = 0; i < count; i++) writer.writeLine(&lines[(size_t)i * 40], 40);
+        writer.end();
+    });
+    std::printf("%-22s %9.1f %10u\n", "encode", mbps, count);
+    if (sink.bytes != book.size()) {
+        std::fprintf(stderr, "encoded %zu bytes, book has %zu\n", sink.bytes, book.size());
+        return 1;
+    }
+    return 0;
+}
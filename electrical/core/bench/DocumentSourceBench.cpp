@@ -0,0 +1,135 @@
+// DocumentSourceBench.cpp - Opening and paging a large text file.
+//
+//   document_source_bench [megabytes] [file]
+//
+// Writes a temporary UTF-8 document (default 100 MB) unless a file is
+// given, then compares the old loader (read everything through an
+// ostringstream and convert it all to UTF-16 for the EDIT control) with
+// DocumentSource: time to open, time to fetch a random page, and resident
+// memory (VmRSS, Linux only) after walking every page. Build in Release.
+
+#include "DocumentSource.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+double Ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Resident set in MB, or -1 where /proc is not available
+double ResidentMb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+        if (line.compare(0, 6, "VmRSS:") == 0) return std::atof(line.c_str() + 6) / 1024.0;
+    return -1;
+}
+
+// Stand-in for MultiByteToWideChar(CP_UTF8) in the old loader
+std::u16string Utf8ToUtf16(const std::string& s) {
+    std::u16string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size();) {
+        uint8_t c = (uint8_t)s[i];
+        uint32_t cp = 0xFFFD;
+        size_t n = c < 0x80 ? 1 : (c >> 5) == 6 ? 2 : (c >> 4) == 14 ? 3 : (c >> 3) == 30 ? 4 : 0;
+        if (n == 0 || i + n > s.size()) { out.push_back(0xFFFD); i++; continue; }
+        cp = n == 1 ? c : c & (0x7F >> n);
+        for (size_t k = 1; k < n; k++) cp = (cp << 6) | ((uint8_t)s[i + k] & 0x3F);
+        if (cp >= 0x10000) {
+            out.push_back((char16_t)(0xD800 + ((cp - 0x10000) >> 10)));
+            out.push_back((char16_t)(0xDC00 + (cp & 0x3FF)));
+        } else {
+            out.push_back((char16_t)cp);
+        }
+        i += n;
+    }
+    return out;
+}
+
+std::string WriteDocument(size_t megabytes) {
+    static const char* vocab[] = { "the", "braille", "display", "shows", "one", "line", "of", "text",
+                                   "\xC3\xA9l\xC3\xA8ve", "\xE2\x80\x94", "page", "reader." };
+    std::string path = (std::filesystem::temp_directory_path() / "document_source_bench.txt").string();
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    std::mt19937 rng(1);
+    std::string chunk;
+    for (size_t written = 0; written < megabytes << 20; written += chunk.size()) {
+        chunk.clear();
+        while (chunk.size() < (1 << 16)) {
+            chunk += vocab[rng() % 12];
+            chunk += rng() % 12 == 0 ? '\n' : ' ';
+        }
+        out.write(chunk.data(), (std::streamsize)chunk.size());
+    }
+    return path;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? (size_t)(std::max)(1, atoi(argv[1])) : 100;
+    bool generated = argc <= 2;
+    std::string path = generated ? WriteDocument(megabytes) : argv[2];
+
+    std::printf("baseline RSS                 %10.1f MB\n", ResidentMb());
+
+    // Paged, memory-mapped
+    {
+        DocumentSource doc;
+        std::string err;
+        auto start = std::chrono::steady_clock::now();
+        if (!doc.Open(path, err)) { std::fprintf(stderr, "%s\n", err.c_str()); return 1; }
+        double openMs = Ms(start);
+
+        std::mt19937 rng(2);
+        std::vector<double> us;
+        size_t bytes = 0;
+        for (int i = 0; i < 1000; i++) {
+            auto t = std::chrono::steady_clock::now();
+            bytes += doc.Page(rng() % doc.PageCount()).size();
+            us.push_back(Ms(t) * 1000.0);
+        }
+        std::sort(us.begin(), us.end());
+
+        start = std::chrono::steady_clock::now();
+        uint64_t sum = 0;
+        for (size_t k = 0; k < doc.PageCount(); k++)
+            for (char c : doc.Page(k)) sum += (uint8_t)c;
+        double walkMs = Ms(start);
+
+        std::printf("DocumentSource (%zu MB, %zu pages)\n", doc.Size() >> 20, doc.PageCount());
+        std::printf("  open                       %10.3f ms\n", openMs);
+        std::printf("  random page (median)       %10.2f us\n", us[us.size() / 2]);
+        std::printf("  walk all pages             %10.1f ms  (checksum %llu)\n", walkMs, (unsigned long long)sum);
+        std::printf("  RSS after walk             %10.1f MB\n", ResidentMb());
+    }
+
+    // Old loader: slurp and convert everything
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::ifstream file(path, std::ios::binary);
+        std::ostringstream oss;
+        oss << file.rdbuf();
+        std::string bytes = oss.str();
+        std::u16string text = Utf8ToUtf16(bytes);
+        double openMs = Ms(start);
+        std::printf("slurp + UTF-16 (%zu MB)\n", bytes.size() >> 20);
+        std::printf("  open                       %10.1f ms  (%zu chars)\n", openMs, text.size());
+        std::printf("  RSS after open             %10.1f MB\n", ResidentMb());
+    }
+
+    if (generated) std::remove(path.c_str());
+    return 0;
+}
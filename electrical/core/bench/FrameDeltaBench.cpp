@@ -0,0 +1,157 @@
+// FrameDeltaBench.cpp - Wire bytes per refresh of a 32-cell line over a
+// reading session.
+//
+//   frame_delta_bench [refreshes] [seed]
+//
+// Replays a reader moving through a document on a line of cells: the
+// cursor (dots 7-8) stepping along the line, typos fixed under it, the
+// line scrolling by a word, and panning to the next line. Each refresh
+// is sent as the whole line (32 literal cells in F: lines) and as
+// DeviceFrameMirror's runs, hex and packed (PatternCode.h), and the bench
+// prints bytes per refresh for each kind of refresh and for the session.
+// Wire time is at 115200 baud (USB) and 9600 (an HC-05 at its default).
+
+#include "FrameDelta.h"
+#include "PatternCode.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// BrailleConverter::CHAR_TO_PATTERN (braille_converter/arduino_library), 0x20-0x7F,
+// in the converter's bit order (bit n-1 = dot n); Render() moves them to F: order
+const uint8_t kPatterns[96] = {
+    0x00, 0x16, 0x36, 0x3C, 0x12, 0x29, 0x2F, 0x04, 0x23, 0x1C, 0x14, 0x2C, 0x02, 0x24, 0x32, 0x0C,
+    0x1A, 0x01, 0x03, 0x09, 0x19, 0x11, 0x0B, 0x1B, 0x13, 0x0A, 0x12, 0x06, 0x23, 0x36, 0x1C, 0x26,
+    0x01, 0x41, 0x43, 0x49, 0x59, 0x51, 0x4B, 0x5B, 0x53, 0x4A, 0x5A, 0x45, 0x47, 0x4D, 0x5D, 0x55,
+    0x4F, 0x5F, 0x57, 0x4E, 0x5E, 0x65, 0x67, 0x7A, 0x6D, 0x7D, 0x75, 0x23, 0x21, 0x1C, 0x23, 0x24,
+    0x22, 0x01, 0x03, 0x09, 0x19, 0x11, 0x0B, 0x1B, 0x13, 0x0A, 0x1A, 0x05, 0x07, 0x0D, 0x1D, 0x15,
+    0x0F, 0x1F, 0x17, 0x0E, 0x1E, 0x25, 0x27, 0x3A, 0x2D, 0x3D, 0x35, 0x23, 0x33, 0x1C, 0x31, 0xFF,
+};
+const uint8_t kCursor = 0x88;   // dots 7 and 8 in F: order (bits 3 and 7)
+const size_t kCells = 32;
+
+std::string Document(size_t bytes, std::mt19937& rng) {
+    static const char* vocab[] = { "the", "braille", "display", "shows", "one", "line", "of", "text",
+                                   "at", "a", "time,", "so", "refreshes", "should", "be", "small", "Reader." };
+    std::string s;
+    while (s.size() < bytes) {
+        s += vocab[rng() % (sizeof(vocab) / sizeof(vocab[0]))];
+        s += ' ';
+    }
+    return s;
+}
+
+// Converter order to the F: order frames are shown in (BrailleCell:
+// bits 0-2 = dots 1-3, bit 3 = dot 7, bits 4-6 = dots 4-6, bit 7 = dot 8)
+uint8_t CellOrder(uint8_t p) { return (uint8_t)((p & 0x87) | ((p & 0x38) << 1) | ((p & 0x40) >> 3)); }
+
+std::vector<uint8_t> Render(const std::string& doc, size_t start, size_t cursor) {
+    std::vector<uint8_t> line(kCells, 0);
+    for (size_t i = 0; i < kCells && start + i < doc.size(); i++) {
+        unsigned char c = (unsigned char)doc[start + i];
+        line[i] = c >= 0x20 && c < 0x80 ? CellOrder(kPatterns[c - 0x20]) : 0xFF;
+    }
+    if (cursor < kCells) line[cursor] |= kCursor;
+    return line;
+}
+
+size_t NextWord(const std::string& doc, size_t pos) {
+    size_t space = doc.find(' ', pos);
+    return space == std::string::npos ? pos : space + 1;
+}
+
+double WireMs(double bytes, double baud) { return bytes * 10.0 / baud * 1000.0; }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int refreshes = argc > 1 ? (std::max)(1, atoi(argv[1])) : 20000;
+    std::mt19937 rng(argc > 2 ? (unsigned)atoi(argv[2]) : 1u);
+    std::string doc = Document((size_t)refreshes * 8 + 1000, rng);
+
+    // Share of each kind of refresh in the session (percent)
+    enum Kind { CursorStep, Typo, ScrollWord, PanLine, KindCount };
+    const char* names[KindCount] = { "cursor step", "typo fix", "scroll word", "pan line" };
+    const unsigned weights[KindCount] = { 55, 10, 25, 10 };
+
+    FrameDeltaOptions packedOptions;
+    packedOptions.packed = true;
+    DeviceFrameMirror mirror, fullMirror, packedMirror(packedOptions);
+    size_t start = 0, cursor = 0;
+    mirror.Update(Render(doc, start, cursor));
+    packedMirror.Update(Render(doc, start, cursor));
+
+    size_t count[KindCount] = {}, fullBytes[KindCount] = {}, deltaBytes[KindCount] = {};
+    size_t packedBytes[KindCount] = {};
+    size_t cells = 0, packedChars = 0;
+    double encodeUs = 0, unpackUs = 0;
+    for (int r = 0; r < refreshes; r++) {
+        unsigned pick = rng() % 100;
+        Kind kind = KindCount;
+        for (int k = 0, acc = 0; k < KindCount; k++)
+            if (pick < (unsigned)(acc += (int)weights[k])) { kind = (Kind)k; break; }
+
+        switch (kind) {
+        case CursorStep: cursor = (cursor + 1 + rng() % 4) % kCells; break;
+        case Typo: doc[start + cursor] = (char)('a' + rng() % 26); break;
+        case ScrollWord: start = NextWord(doc, start); break;
+        default: start = NextWord(doc, start + kCells - 8); cursor = 0; break;
+        }
+        std::vector<uint8_t> line = Render(doc, start, cursor);
+
+        auto t0 = std::chrono::steady_clock::now();
+        std::string delta = mirror.Update(line);
+        encodeUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+
+        // The whole line as literals, what a resend without the mirror costs
+        CellRun all = { CellRun::Literal, 0, kCells, 0, line };
+        count[kind]++;
+        fullBytes[kind] += fullMirror.Encode({ all }).size();
+        deltaBytes[kind] += delta.size();
+        packedBytes[kind] += packedMirror.Update(line).size();
+
+        // The pattern code alone, and what unpacking it costs on the host
+        std::string packed;
+        PackPatterns(line.data(), line.size(), packed);
+        std::vector<uint8_t> unpacked;
+        size_t pos = 0;
+        t0 = std::chrono::steady_clock::now();
+        bool ok = UnpackPatterns(packed, pos, line.size(), unpacked);
+        unpackUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+        if (!ok || unpacked != line) {
+            std::fprintf(stderr, "pattern code round trip failed at refresh %d\n", r);
+            return 1;
+        }
+        cells += line.size();
+        packedChars += packed.size();
+    }
+
+    std::printf("%-12s %7s %10s %10s %10s %8s\n", "refresh", "share", "full B", "delta B", "packed B", "ratio");
+    size_t totalFull = 0, totalDelta = 0, totalPacked = 0;
+    for (int k = 0; k < KindCount; k++) {
+        if (!count[k]) continue;
+        totalFull += fullBytes[k];
+        totalDelta += deltaBytes[k];
+        totalPacked += packedBytes[k];
+        std::printf("%-12s %6.0f%% %10.1f %10.1f %10.1f %7.1fx\n", names[k], 100.0 * count[k] / refreshes,
+                    (double)fullBytes[k] / count[k], (double)deltaBytes[k] / count[k],
+                    (double)packedBytes[k] / count[k], (double)fullBytes[k] / (std::max)(packedBytes[k], (size_t)1));
+    }
+    double full = (double)totalFull / refreshes, delta = (double)totalDelta / refreshes;
+    double packed = (double)totalPacked / refreshes;
+    std::printf("%-12s %7s %10.1f %10.1f %10.1f %7.1fx\n", "session", "", full, delta, packed, full / packed);
+    std::printf("wire per refresh at 115200: %.2f ms full, %.2f ms delta, %.2f ms packed; encode %.2f us\n",
+                WireMs(full, 115200), WireMs(delta, 115200), WireMs(packed, 115200), encodeUs / refreshes);
+    std::printf("wire per refresh at 9600:   %.2f ms full, %.2f ms delta, %.2f ms packed\n", WireMs(full, 9600),
+                WireMs(delta, 9600), WireMs(packed, 9600));
+    std::printf("pattern code: %.2f characters per cell vs 2 in hex (%.2fx); unpack %.1f ns per cell\n",
+                (double)packedChars / cells, 2.0 * cells / packedChars, unpackUs * 1000.0 / cells);
+    return 0;
+}
@@ -0,0 +1,102 @@
+// OcrPrepBench.cpp - Region-OCR preprocessing on a 4K capture: the staged
+// path driver.cpp used before OcrPrep against the fused pass.
+//
+//   ocr_prep_bench [iterations]
+//
+// "staged" is Convert (full-frame BGRA copy) -> crop copy -> BGRA upscale
+// -> Gray8 conversion, each into a fresh allocation as SoftwareBitmap does.
+// "fused" is OcrPrep::Run into a pooled buffer. Latency is the median of
+// the runs; memory is the most intermediate + output bytes alive at once,
+// not counting the captured frame itself. Build in Release.
+
+#include "OcrPrep.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace {
+
+const int kFrameW = 3840, kFrameH = 2160;
+
+double MedianMs(int iterations, const std::function<void()>& run) {
+    run();  // warm up caches and the pool
+    std::vector<double> ms;
+    for (int i = 0; i < iterations; i++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(ms.begin(), ms.end());
+    return ms[ms.size() / 2];
+}
+
+// Returns the peak bytes the staged path holds
+size_t Staged(const std::vector<uint8_t>& frame, PixelRect r, int factor, uint8_t& sink) {
+    const int cw = r.right - r.left, ch = r.bottom - r.top;
+    const int ow = cw * factor, oh = ch * factor;
+
+    std::vector<uint8_t> converted(frame);
+    std::vector<uint8_t> cropped((size_t)cw * ch * 4);
+    for (int y = 0; y < ch; y++)
+        memcpy(cropped.data() + (size_t)y * cw * 4,
+               converted.data() + ((size_t)(r.top + y) * kFrameW + r.left) * 4, (size_t)cw * 4);
+
+    std::vector<uint8_t> upscaled;
+    const std::vector<uint8_t>* bgra = &cropped;
+    if (factor > 1) {
+        upscaled.resize((size_t)ow * oh * 4);
+        ResizeBilinearBgra(cropped.data(), cw, ch, cw * 4, upscaled.data(), ow, oh, ow * 4);
+        bgra = &upscaled;
+    }
+
+    std::vector<uint8_t> gray((size_t)ow * oh);
+    for (size_t i = 0; i < gray.size(); i++) gray[i] = BgraToGray(bgra->data() + i * 4);
+    sink ^= gray[gray.size() / 2];
+    return converted.size() + cropped.size() + upscaled.size() + gray.size();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? (std::max)(1, atoi(argv[1])) : 15;
+
+    std::vector<uint8_t> frame((size_t)kFrameW * kFrameH * 4);
+    std::mt19937 rng(42);
+    for (auto& b : frame) b = (uint8_t)(rng() & 0xFF);
+
+    struct Case { PixelRect rect; const char* what; };
+    const Case cases[] = {
+        { { 1200, 900, 1290, 940 }, "90x40 region" },
+        { { 1000, 800, 1600, 1000 }, "600x200 region" },
+        { { 0, 0, kFrameW, kFrameH }, "full screen" },
+    };
+
+    std::printf("%-16s %-7s %11s %11s %8s %12s %12s\n", "case", "factor", "staged", "fused",
+                "speedup", "staged mem", "fused mem");
+    uint8_t sink = 0;
+    for (const Case& c : cases) {
+        int factor = OcrUpscaleFactor(c.rect.right - c.rect.left);
+
+        size_t stagedBytes = 0;
+        double stagedMs = MedianMs(iterations, [&] { stagedBytes = Staged(frame, c.rect, factor, sink); });
+
+        OcrPrep prep;
+        double fusedMs = MedianMs(iterations, [&] {
+            BufferPool::Buffer out;
+            int ow, oh;
+            prep.Run(frame.data(), kFrameW, kFrameH, (ptrdiff_t)kFrameW * 4, c.rect, factor, out, ow, oh);
+            sink ^= out.Data()[out.Size() / 2];
+        });
+        size_t fusedBytes = prep.Pool().PeakBytesInUse();
+
+        std::printf("%-16s %-7d %8.2f ms %8.2f ms %7.1fx %9.1f MB %9.2f MB\n", c.what, factor,
+                    stagedMs, fusedMs, stagedMs / fusedMs, stagedBytes / 1e6, fusedBytes / 1e6);
+    }
+    return sink == 0x5A ? 1 : 0;   // keep the work observable
+}
@@ -0,0 +1,81 @@
+// TextDeltaBench.cpp - Wire bytes and diff time for typical resends.
+//
+//   text_delta_bench [iterations]
+//
+// For documents of several sizes, compares resending the whole text (the
+// old SendText) with DeviceTextMirror's E: deltas after a one-word edit,
+// an appended sentence, and an OCR re-read where ~1% of words changed.
+// Wire time is at 115200 baud (10 bits per byte). Build in Release.
+
+#include "TextDelta.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string Document(size_t bytes, std::mt19937& rng) {
+    static const char* vocab[] = { "the", "braille", "display", "shows", "one", "line", "of", "text",
+                                   "at", "a", "time", "so", "edits", "should", "be", "small", "reader." };
+    std::string s;
+    while (s.size() < bytes) {
+        s += vocab[rng() % (sizeof(vocab) / sizeof(vocab[0]))];
+        s += (rng() % 12 == 0) ? '\n' : ' ';
+    }
+    s.resize(bytes);
+    return s;
+}
+
+double WireMs(size_t bytes) { return bytes * 10.0 / 115200.0 * 1000.0; }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? (std::max)(1, atoi(argv[1])) : 20;
+
+    struct Edit { const char* name; std::function<void(std::string&, std::mt19937&)> apply; };
+    const Edit edits[] = {
+        { "one word", [](std::string& t, std::mt19937&) {
+              size_t p = t.find(" line ", t.size() / 2);
+              if (p != std::string::npos) t.replace(p + 1, 4, "row"); } },
+        { "append sentence", [](std::string& t, std::mt19937&) { t += " Please turn the page."; } },
+        { "OCR re-read 1%", [](std::string& t, std::mt19937& rng) {
+              for (size_t p = 0; (p = t.find(' ', p + 1)) != std::string::npos;)
+                  if (rng() % 100 == 0 && p + 1 < t.size()) t[p + 1] = (char)('A' + rng() % 26); } },
+    };
+
+    std::printf("%-10s %-16s %10s %10s %10s %10s %10s\n", "document", "edit", "full B", "delta B",
+                "full ms", "delta ms", "diff us");
+    for (size_t size : { (size_t)500, (size_t)4000, (size_t)50000 }) {
+        for (const Edit& e : edits) {
+            std::mt19937 rng(1);
+            std::string base = Document(size, rng);
+            std::string changed = base;
+            e.apply(changed, rng);
+
+            TextDeltaOptions options;
+            options.capacity = 1 << 20;
+            size_t full = 0, delta = 0;
+            std::vector<double> us;
+            for (int i = 0; i < iterations; i++) {
+                DeviceTextMirror mirror(options);
+                full = mirror.Update(base).size();
+                auto start = std::chrono::steady_clock::now();
+                delta = mirror.Update(changed).size();
+                us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+            }
+            std::sort(us.begin(), us.end());
+            char doc[16];
+            std::snprintf(doc, sizeof(doc), "%zu B", size);
+            std::printf("%-10s %-16s %10zu %10zu %10.1f %10.2f %10.1f\n", doc, e.name, full, delta,
+                        WireMs(full), WireMs(delta), us[us.size() / 2]);
+        }
+    }
+    return 0;
+}
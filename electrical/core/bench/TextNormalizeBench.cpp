@@ -0,0 +1,76 @@
+// TextNormalizeBench.cpp - Normalizer throughput on mixed corpora.
+//
+//   text_normalize_bench [megabytes]
+//
+// Builds corpora (default 64 MB each) ranging from plain English to
+// accent-heavy French and OCR output full of typographic punctuation, and
+// reports GB/s per kernel plus how much of each input took the ASCII fast
+// path. Build in Release.
+
+#include "TextNormalize.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string Corpus(size_t bytes, const std::vector<const char*>& words, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::string s;
+    s.reserve(bytes + 64);
+    while (s.size() < bytes) {
+        s += words[rng() % words.size()];
+        s += rng() % 14 == 0 ? '\n' : ' ';
+    }
+    return s;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? (size_t)(std::max)(1, atoi(argv[1])) : 64;
+    size_t bytes = megabytes << 20;
+
+    struct Named { const char* name; std::string text; };
+    std::vector<Named> corpora;
+    corpora.push_back({ "English ASCII", Corpus(bytes, { "the", "braille", "display", "shows", "one", "line",
+                                                         "of", "text", "at", "a", "time.", "Reading" }, 1) });
+    corpora.push_back({ "OCR typography", Corpus(bytes, { "the", "\xE2\x80\x9Cquoted\xE2\x80\x9D", "display",
+                                                          "it\xE2\x80\x99s", "\xE2\x80\x94", "\xEF\xAC\x81nal", "line",
+                                                          "of", "text\xE2\x80\xA6", "a", "time.", "page" }, 2) });
+    corpora.push_back({ "French", Corpus(bytes, { "l'\xC3\xA9l\xC3\xA8ve", "lit", "une", "ligne", "\xC3\xA0",
+                                                  "la", "fois", "tr\xC3\xA8s", "\xC3\xA9t\xC3\xA9", "ma\xC3\xAEtre",
+                                                  "le", "texte" }, 3) });
+    corpora.push_back({ "Unicode braille", Corpus(bytes, { "\xE2\xA0\x9E\xE2\xA0\x93\xE2\xA0\x91",
+                                                           "\xE2\xA0\x83\xE2\xA0\x97", "\xE2\xA0\x87" }, 4) });
+
+    std::printf("%-16s %-7s %9s %9s %12s\n", "corpus", "kernel", "GB/s", "fast %", "out/in");
+    for (const Named& c : corpora) {
+        for (ScaleKernel k : { ScaleKernel::Scalar, ScaleKernel::Sse2, ScaleKernel::Avx2 }) {
+            if (ResolveScaleKernel(k) != k) continue;
+            BrailleNormalizer n(std::string("?"), k);
+            std::string out;
+            out.reserve(c.text.size() + c.text.size() / 4);
+            std::vector<double> gbps;
+            NormalizeStats stats;
+            for (int i = 0; i < 5; i++) {
+                out.clear();
+                stats = NormalizeStats();
+                auto start = std::chrono::steady_clock::now();
+                n.Normalize(c.text.data(), c.text.size(), out, &stats);
+                double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                gbps.push_back(c.text.size() / s / 1e9);
+            }
+            std::sort(gbps.begin(), gbps.end());
+            const char* name = k == ScaleKernel::Scalar ? "scalar" : k == ScaleKernel::Sse2 ? "sse2" : "avx2";
+            std::printf("%-16s %-7s %9.2f %8.1f%% %12.3f\n", c.name, name, gbps[gbps.size() / 2],
+                        100.0 * stats.asciiBytes / c.text.size(), (double)out.size() / c.text.size());
+        }
+    }
+    return 0;
+}
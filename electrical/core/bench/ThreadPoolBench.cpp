@@ -0,0 +1,136 @@
+// ThreadPoolBench.cpp - Core scaling of the image kernels on ThreadPool.
+//
+//   thread_pool_bench [iterations] [max threads] [grain rows]
+//
+// Each kernel runs on a 4K capture with pools of 1, 2, 4 ... threads up to
+// the core count (or max threads), reporting megapixels per second of
+// output (median of the runs) and the speedup over one thread:
+//
+//   repack    strided BGRA -> tight BGRA, as SaveSoftwareBitmapAsBMP does
+//   resize    1920x1080 -> 3840x2160 BGRA bilinear
+//   ocrprep   1600x900 region -> 3200x1800 Gray8, fused crop/gray/upscale
+//   binarize  3840x2160 BGRA -> 0/255 Gray8, Sauvola
+//   tilediff  3840x2160 compare against an unchanged reference
+//
+// grain rows (default: each kernel's own) overrides the tile height of the
+// row-tiled kernels. Build in Release.
+
+#include "Binarize.h"
+#include "ImageScale.h"
+#include "OcrPrep.h"
+#include "ThreadPool.h"
+#include "TileChangeDetector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int kW = 3840, kH = 2160;
+const ptrdiff_t kStride = kW * 4 + 64;   // capture rows are often padded
+
+double MedianMs(int iterations, const std::function<void()>& run) {
+    run();  // warm up caches, pools and the workers
+    std::vector<double> ms;
+    for (int i = 0; i < iterations; i++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(ms.begin(), ms.end());
+    return ms[ms.size() / 2];
+}
+
+struct Kernel {
+    const char* name;
+    double megapixels;   // output
+    std::function<void(size_t)> run;    // argument: index into pools
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? (std::max)(1, atoi(argv[1])) : 7;
+    int cores = argc > 2 ? (std::max)(1, atoi(argv[2])) : (int)(std::max)(1u, std::thread::hardware_concurrency());
+    int grainRows = argc > 3 ? (std::max)(0, atoi(argv[3])) : 0;
+
+    std::vector<uint8_t> frame((size_t)kStride * kH);
+    std::mt19937 rng(1);
+    for (int y = 0; y < kH; y++) {
+        for (int x = 0; x < kW; x++) {
+            uint8_t* p = &frame[(size_t)y * kStride + (size_t)x * 4];
+            bool stroke = (x % 9) < 2 && (y % 28) >= 6 && (y % 28) < 22;
+            int bg = 170 + 60 * x / kW + (int)(rng() % 7) - 3;
+            p[0] = p[1] = p[2] = (uint8_t)(stroke ? bg - 80 : bg);
+            p[3] = 255;
+        }
+    }
+    std::vector<uint8_t> bgraOut((size_t)kW * kH * 4), grayOut((size_t)kW * kH);
+    const auto grain = [&](int own) { return grainRows > 0 ? grainRows : own; };
+
+    std::vector<int> threadCounts;
+    for (int t = 1; t < cores; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(cores);
+    std::vector<std::unique_ptr<ThreadPool>> pools;
+    for (int t : threadCounts) pools.emplace_back(new ThreadPool(t));
+
+    // Kernels that keep state between runs get one instance per pool
+    std::vector<std::unique_ptr<OcrPrep>> preps;
+    std::vector<std::unique_ptr<Binarizer>> binarizers;
+    std::vector<std::unique_ptr<TileChangeDetector>> detectors;
+    for (auto& pool : pools) {
+        preps.emplace_back(new OcrPrep(pool.get(), grain(16)));
+        BinarizeOptions b;
+        b.pool = pool.get();
+        b.grainRows = grain(32);
+        binarizers.emplace_back(new Binarizer(b));
+        TileDiffOptions o;
+        o.pool = pool.get();
+        if (grainRows > 0) o.grainTileRows = (std::max)(1, grainRows / o.tileHeight);
+        detectors.emplace_back(new TileChangeDetector(o));
+    }
+
+    std::vector<Kernel> kernels = {
+        { "repack", kW * kH / 1e6, [&](size_t p) {
+            pools[p]->ParallelFor(0, kH, grain(64), [&](int y0, int y1) {
+                for (int y = y0; y < y1; y++)
+                    memcpy(&bgraOut[(size_t)y * kW * 4], &frame[(size_t)y * kStride], (size_t)kW * 4);
+            });
+        } },
+        { "resize", kW * kH / 1e6, [&](size_t p) {
+            ResizeBilinearBgra(frame.data(), kW / 2, kH / 2, kStride, bgraOut.data(), kW, kH, kW * 4,
+                               ScaleKernel::Auto, pools[p].get(), grain(32));
+        } },
+        { "ocrprep", 3200 * 1800 / 1e6, [&](size_t p) {
+            preps[p]->Run(frame.data(), kW, kH, kStride, { 1000, 600, 2600, 1500 }, 2, grayOut.data(), 3200);
+        } },
+        { "binarize", kW * kH / 1e6, [&](size_t p) {
+            binarizers[p]->RunBgra(frame.data(), kW, kH, kStride, grayOut.data(), kW);
+        } },
+        { "tilediff", kW * kH / 1e6, [&](size_t p) {
+            std::vector<PixelRect> bands;
+            detectors[p]->Update(frame.data(), kW, kH, kStride, bands);
+        } },
+    };
+
+    std::printf("%d hardware threads, %d iterations\n", (int)std::thread::hardware_concurrency(), iterations);
+    std::printf("%-9s %8s %10s %10s %8s\n", "kernel", "threads", "ms", "MP/s", "speedup");
+    for (const Kernel& k : kernels) {
+        double oneThreadMs = 0;
+        for (size_t p = 0; p < pools.size(); p++) {
+            double med = MedianMs(iterations, [&] { k.run(p); });
+            if (p == 0) oneThreadMs = med;
+            std::printf("%-9s %8d %10.2f %10.1f %7.2fx\n", k.name, pools[p]->Threads(), med,
+                        k.megapixels / (med / 1000.0), oneThreadMs / med);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+// TileDiffBench.cpp - Change detection cost per frame over a recording.
+//
+//   tile_diff_bench                      synthetic 3840x2160 recording
+//   tile_diff_bench frames.bgra W H      raw BGRA frames, back to back
+//
+// The synthetic recording has the situations continuous OCR sees: a static
+// page, a blinking caret, typing on one line and a scroll. For each one the
+// bench reports the median Update() time per kernel and how much of the
+// frame the resulting bands would send to OCR. Build in Release.
+
+#include "TileChangeDetector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Frame = std::vector<uint8_t>;
+
+struct Scenario {
+    std::string name;
+    std::vector<Frame> frames;   // frames[0] primes the detector
+};
+
+// A page of dark "glyph" blocks on white, 20 px per text line
+Frame MakePage(int w, int h, unsigned seed) {
+    Frame f((size_t)w * h * 4, 0xFF);
+    std::mt19937 rng(seed);
+    for (int line = 0; line * 20 + 14 < h; line++) {
+        for (int x = 40; x + 8 < w - 40; x += 9) {
+            if (rng() % 7 == 0) continue;   // word gap
+            int gh = 8 + (int)(rng() % 6);
+            for (int y = line * 20 + 14 - gh; y < line * 20 + 14; y++)
+                memset(f.data() + ((size_t)y * w + x) * 4, 0x20, 7 * 4);
+        }
+    }
+    return f;
+}
+
+void FillRect(Frame& f, int w, int x, int y, int rw, int rh, uint8_t v) {
+    for (int r = y; r < y + rh; r++) memset(f.data() + ((size_t)r * w + x) * 4, v, (size_t)rw * 4);
+}
+
+std::vector<Scenario> Synthetic(int w, int h, int frames) {
+    Frame page = MakePage(w, h, 1);
+    std::vector<Scenario> out;
+
+    Scenario still{ "static page", {} };
+    for (int i = 0; i <= frames; i++) still.frames.push_back(page);
+    out.push_back(std::move(still));
+
+    Scenario caret{ "caret blink", {} };
+    for (int i = 0; i <= frames; i++) {
+        caret.frames.push_back(page);
+        FillRect(caret.frames.back(), w, 900, 400, 2, 18, (i & 1) ? 0x00 : 0xFF);
+    }
+    out.push_back(std::move(caret));
+
+    Scenario typing{ "typing", {} };
+    Frame t = page;
+    for (int i = 0; i <= frames; i++) {
+        FillRect(t, w, 40 + i * 9, 1002, 7, 10, 0x60);
+        typing.frames.push_back(t);
+    }
+    out.push_back(std::move(typing));
+
+    Scenario scroll{ "scroll 3 lines", {} };
+    Frame tall = MakePage(w, h + 60 * frames + 60, 1);
+    for (int i = 0; i <= frames; i++)
+        scroll.frames.emplace_back(tall.begin() + (size_t)i * 60 * w * 4, tall.begin() + ((size_t)i * 60 + h) * w * 4);
+    out.push_back(std::move(scroll));
+    return out;
+}
+
+bool LoadRecording(const char* path, int w, int h, Scenario& s) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    const size_t frameBytes = (size_t)w * h * 4;
+    for (;;) {
+        Frame f(frameBytes);
+        if (!in.read(reinterpret_cast<char*>(f.data()), (std::streamsize)frameBytes)) break;
+        s.frames.push_back(std::move(f));
+    }
+    return s.frames.size() > 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int w = 3840, h = 2160;
+    std::vector<Scenario> scenarios;
+    if (argc >= 4) {
+        w = atoi(argv[2]);
+        h = atoi(argv[3]);
+        Scenario s{ argv[1], {} };
+        if (w <= 0 || h <= 0 || !LoadRecording(argv[1], w, h, s)) {
+            std::fprintf(stderr, "cannot read two or more %dx%d frames from %s\n", w, h, argv[1]);
+            return 1;
+        }
+        scenarios.push_back(std::move(s));
+    }
+    else {
+        scenarios = Synthetic(w, h, 12);
+    }
+
+    const ScaleKernel kernels[] = { ScaleKernel::Scalar, ScaleKernel::Sse2, ScaleKernel::Avx2 };
+    const char* names[] = { "scalar", "sse2", "avx2" };
+
+    std::printf("%dx%d frames, median ms per Update()\n", w, h);
+    std::printf("%-16s %9s %9s %9s %8s %10s\n", "scenario", names[0], names[1], names[2], "bands", "to OCR");
+    for (const Scenario& s : scenarios) {
+        std::printf("%-16s", s.name.c_str());
+        double bandCount = 0;
+        double ocrShare = 0;
+        for (int k = 0; k < 3; k++) {
+            if (ResolveScaleKernel(kernels[k]) != kernels[k]) { std::printf(" %9s", "n/a"); continue; }
+            TileChangeDetector det(TileDiffOptions(), kernels[k]);
+            std::vector<PixelRect> bands;
+            det.Update(s.frames[0].data(), w, h, (ptrdiff_t)w * 4, bands);
+
+            std::vector<double> ms;
+            double area = 0;
+            size_t count = 0;
+            for (size_t i = 1; i < s.frames.size(); i++) {
+                auto start = std::chrono::steady_clock::now();
+                det.Update(s.frames[i].data(), w, h, (ptrdiff_t)w * 4, bands);
+                ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+                for (const PixelRect& b : bands) area += (double)(b.right - b.left) * (b.bottom - b.top);
+                count += bands.size();
+            }
+            std::sort(ms.begin(), ms.end());
+            std::printf(" %9.2f", ms[ms.size() / 2]);
+            bandCount = (double)count / (s.frames.size() - 1);
+            ocrShare = area / ((double)w * h * (s.frames.size() - 1));
+        }
+        std::printf(" %8.1f %9.1f%%\n", bandCount, ocrShare * 100);
+    }
+    return 0;
+}
@@ -0,0 +1,113 @@
+// BinarizeTest.cpp - Local thresholds on synthetic text-like images.
+
+#include "Binarize.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+namespace {
+
+// Low-contrast "glyph" bars on a left-to-right gradient, with noise.
+// Ink is wherever ink[] is set.
+struct Page {
+    int w, h;
+    std::vector<uint8_t> gray;
+    std::vector<bool> ink;
+
+    Page(int w_, int h_, bool lightOnDark = false, unsigned seed = 1)
+        : w(w_), h(h_), gray((size_t)w_ * h_), ink((size_t)w_ * h_) {
+        std::mt19937 rng(seed);
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                // 3 px strokes every 8 px, in text lines 20 px tall
+                bool stroke = (x % 8) < 3 && (y % 32) >= 6 && (y % 32) < 26;
+                int bg = 150 + 70 * x / w;           // uneven lighting
+                int v = stroke ? bg - 45 : bg;       // faint ink
+                v += (int)(rng() % 9) - 4;           // sensor / compression noise
+                if (lightOnDark) v = 255 - v;
+                gray[(size_t)y * w + x] = (uint8_t)v;
+                ink[(size_t)y * w + x] = stroke;
+            }
+        }
+    }
+
+    double Accuracy(const std::vector<uint8_t>& out) const {
+        size_t right = 0;
+        for (size_t i = 0; i < out.size(); i++) right += (out[i] == 0) == ink[i];
+        return (double)right / out.size();
+    }
+};
+
+} // namespace
+
+TEST(Binarize, SauvolaSeparatesFaintInkFromUnevenBackground) {
+    Page page(400, 160);
+    Binarizer b;
+    std::vector<uint8_t> out(page.gray.size());
+    ASSERT_TRUE(b.Run(page.gray.data(), page.w, page.h, page.w, out.data(), page.w));
+    EXPECT_GT(page.Accuracy(out), 0.97);
+    for (uint8_t v : out) ASSERT_TRUE(v == 0 || v == 255);
+}
+
+TEST(Binarize, BradleyAlsoWorks) {
+    Page page(400, 160);
+    BinarizeOptions o;
+    o.method = BinarizeMethod::Bradley;
+    Binarizer b(o);
+    std::vector<uint8_t> out(page.gray.size());
+    ASSERT_TRUE(b.Run(page.gray.data(), page.w, page.h, page.w, out.data(), page.w));
+    EXPECT_GT(page.Accuracy(out), 0.95);
+}
+
+TEST(Binarize, LightTextOnDarkComesOutDarkOnLight) {
+    Page page(400, 160, true);
+    Binarizer b;
+    std::vector<uint8_t> out(page.gray.size());
+    ASSERT_TRUE(b.Run(page.gray.data(), page.w, page.h, page.w, out.data(), page.w));
+    EXPECT_GT(page.Accuracy(out), 0.97);
+}
+
+TEST(Binarize, ThreadsMatchSerialAndInPlaceWorks) {
+    Page page(333, 517, false, 7);
+    ThreadPool one(1), six(6);
+    BinarizeOptions serial;
+    serial.pool = &one;
+    BinarizeOptions parallel;
+    parallel.pool = &six;
+    parallel.grainRows = 7;
+
+    std::vector<uint8_t> a(page.gray.size()), b = page.gray;
+    Binarizer(serial).Run(page.gray.data(), page.w, page.h, page.w, a.data(), page.w);
+    Binarizer(parallel).Run(b.data(), page.w, page.h, page.w, b.data(), page.w);   // in place
+    EXPECT_EQ(a, b);
+}
+
+TEST(Binarize, BgraInputUsesTheGrayConversion) {
+    Page page(200, 96);
+    std::vector<uint8_t> bgra(page.gray.size() * 4);
+    for (size_t i = 0; i < page.gray.size(); i++) {
+        // Coloured UI text: blue-ish ink on a pale yellow background
+        uint8_t g = page.gray[i];
+        bgra[i * 4 + 0] = page.ink[i] ? 200 : (uint8_t)(g / 2);
+        bgra[i * 4 + 1] = page.ink[i] ? (uint8_t)(g / 2) : g;
+        bgra[i * 4 + 2] = page.ink[i] ? (uint8_t)(g / 3) : g;
+        bgra[i * 4 + 3] = 255;
+    }
+    Binarizer b;
+    std::vector<uint8_t> out(page.gray.size());
+    ASSERT_TRUE(b.RunBgra(bgra.data(), page.w, page.h, page.w * 4, out.data(), page.w));
+    EXPECT_GT(page.Accuracy(out), 0.95);
+}
+
+TEST(Binarize, PackBitsIsMsbFirstWithInkSet) {
+    const uint8_t bin[2][10] = { { 0, 255, 255, 255, 255, 255, 255, 0, 0, 255 },
+                                 { 255, 255, 255, 255, 255, 255, 255, 255, 255, 0 } };
+    uint8_t packed[2][2];
+    Binarizer::PackBits(&bin[0][0], 10, 2, 10, &packed[0][0], 2);
+    EXPECT_EQ(packed[0][0], 0x81);
+    EXPECT_EQ(packed[0][1], 0x80);
+    EXPECT_EQ(packed[1][0], 0x00);
+    EXPECT_EQ(packed[1][1], 0x40);
+}
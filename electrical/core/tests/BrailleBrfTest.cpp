@@ -0,0 +1,183 @@
+// BrailleBrfTest.cpp - BRF tables, BrfReader and BrfWriter from the Arduino
+// library (braille_converter/arduino_library/BrailleBrf.h), built on the host.
+
+#include "BrailleBrf.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct StringSink {
+    std::string out;
+    void write(const uint8_t* data, size_t n) { out.append(reinterpret_cast<const char*>(data), n); }
+};
+
+struct ReadLine {
+    std::vector<uint8_t> cells;
+    uint32_t page;
+    uint8_t lineInPage;
+};
+
+// Feeds `brf` in chunks of at most `chunk` bytes, like SD sectors
+std::vector<ReadLine> ReadAll(const std::string& brf, uint8_t width, uint8_t linesPerPage, size_t chunk,
+                              uint32_t* invalid = nullptr) {
+    std::vector<uint8_t> cells(width);
+    BrfReader reader;
+    reader.begin(cells.data(), width, linesPerPage);
+    std::vector<ReadLine> lines;
+    auto take = [&] {
+        lines.push_back({ std::vector<uint8_t>(cells.begin(), cells.begin() + reader.getCount()),
+                          reader.getPage(), reader.getLineInPage() });
+        EXPECT_EQ(reader.getLine(), lines.size() - 1);
+        reader.nextLine();
+    };
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(brf.data());
+    size_t left = brf.size();
+    while (left > 0) {
+        uint16_t n = (uint16_t)std::min(left, chunk);
+        uint16_t used = reader.feed(p, n);
+        p += used;
+        left -= used;
+        if (reader.lineReady()) take();
+    }
+    if (reader.finish()) take();
+    if (invalid) *invalid = reader.getInvalidCount();
+    return lines;
+}
+
+// Hands out a string in fixed spans, like BrailleFileReader::next()
+struct SpanSource {
+    struct Span { const uint8_t* data; uint16_t length; };
+    const std::string& text;
+    size_t pos = 0;
+    size_t chunk;
+    Span next() {
+        uint16_t n = (uint16_t)std::min(chunk, text.size() - pos);
+        Span s{ reinterpret_cast<const uint8_t*>(text.data()) + pos, n };
+        pos += n;
+        return s;
+    }
+};
+
+} // namespace
+
+TEST(BrailleBrf, TablesAreInverse) {
+    std::set<char> seen;
+    for (uint8_t p = 0; p < 64; p++) {
+        char c = Braille::patternToBrf(p);
+        EXPECT_EQ(Braille::brfToPattern(c), p) << "pattern " << (int)p;
+        EXPECT_TRUE(c >= 0x20 && c <= 0x5F);
+        seen.insert(c);
+        EXPECT_EQ(Braille::patternToBrf(p | 0xC0), c);   // dots 7/8 ignored
+    }
+    EXPECT_EQ(seen.size(), 64u);
+
+    // Every ASCII braille byte decodes, lowercase like uppercase
+    for (int c = 0x20; c <= 0x5F; c++) EXPECT_LT(Braille::brfToPattern((char)c), 0x40) << c;
+    for (int c = 0x60; c <= 0x7E; c++) EXPECT_EQ(Braille::brfToPattern((char)c), Braille::brfToPattern((char)(c - 0x20)));
+    EXPECT_EQ(Braille::brfToPattern(' '), 0x00);
+    EXPECT_EQ(Braille::brfToPattern('A'), 0x01);
+    EXPECT_EQ(Braille::brfToPattern('#'), 0x3C);
+    EXPECT_EQ(Braille::brfToPattern('='), 0x3F);
+
+    EXPECT_EQ(Braille::brfToPattern('\n'), BRF_LINE_BREAK);
+    EXPECT_EQ(Braille::brfToPattern('\f'), BRF_PAGE_BREAK);
+    EXPECT_EQ(Braille::brfToPattern('\r'), BRF_IGNORED);
+    EXPECT_EQ(Braille::brfToPattern('\x1A'), BRF_IGNORED);
+    for (int c : { 0x00, 0x09, 0x7F, 0x80, 0xC3, 0xFF }) EXPECT_EQ(Braille::brfToPattern((char)c), BRF_INVALID) << c;
+}
+
+TEST(BrailleBrf, WriterOutput) {
+    StringSink sink;
+    BrfWriter writer;
+    writer.begin(sink, 4, 2);
+    const uint8_t hello[] = { 0x13, 0x11, 0x07, 0x07, 0x15, 0x00, 0x00 };   // "HELLO" and blanks
+    writer.writeLine(hello, sizeof(hello));   // wraps after 4 cells, trailing blanks trimmed
+    const uint8_t dots78[] = { 0x41, 0x83 };
+    writer.writeLine(dots78, 2);
+    writer.writeLine(nullptr, 0);
+    writer.end();
+
+    EXPECT_EQ(sink.out, "HELL\r\nO\r\n\fAB\r\n\r\n\f");
+    EXPECT_EQ(writer.getLineCount(), 4u);
+    EXPECT_EQ(writer.getPageCount(), 2u);
+    EXPECT_EQ(writer.getDroppedDotCells(), 2u);
+}
+
+TEST(BrailleBrf, ReaderWrapsSkipsAndPages) {
+    uint32_t invalid = 0;
+    std::vector<ReadLine> lines = ReadAll("ab cdefg   \r\n\x01~\r\n\fX\x1A", 5, 25, 3, &invalid);
+    ASSERT_EQ(lines.size(), 4u);
+    EXPECT_EQ(lines[0].cells, (std::vector<uint8_t>{ 0x01, 0x03, 0x00, 0x09, 0x19 }));   // "AB CD"
+    EXPECT_EQ(lines[1].cells, (std::vector<uint8_t>{ 0x11, 0x0B, 0x1B }));               // "EFG", blanks dropped
+    EXPECT_EQ(lines[2].cells, (std::vector<uint8_t>{ 0x18 }));                           // '~' as '^'
+    EXPECT_EQ(lines[3].cells, (std::vector<uint8_t>{ 0x2D }));                           // no final break
+    EXPECT_EQ(invalid, 1u);
+    EXPECT_EQ(lines[2].page, 0u);
+    EXPECT_EQ(lines[3].page, 1u);
+    EXPECT_EQ(lines[3].lineInPage, 0u);
+}
+
+TEST(BrailleBrf, RoundTripAcrossWidthsAndChunks) {
+    std::mt19937 rng(29);
+    for (uint8_t width : { 1, 7, 32, 40, 255 }) {
+        for (uint8_t linesPerPage : { 1, 4, 25 }) {
+            // Lines of random cells with blank runs and blank lines, and
+            // some pages ended early
+            std::vector<std::vector<uint8_t>> source;
+            StringSink sink;
+            BrfWriter writer;
+            writer.begin(sink, width, linesPerPage);
+            std::vector<std::pair<uint32_t, uint8_t>> where;   // expected page, line in page
+            uint32_t page = 0;
+            uint8_t fill = 0;
+            for (int i = 0; i < 300; i++) {
+                std::vector<uint8_t> cells(rng() % (width + 1));
+                for (uint8_t& c : cells) c = rng() % 3 == 0 ? 0 : rng() % 64;
+                writer.writeLine(cells.data(), (uint8_t)cells.size());
+                while (!cells.empty() && cells.back() == 0) cells.pop_back();
+                source.push_back(cells);
+                where.push_back({ page, fill });
+                if (++fill == linesPerPage || rng() % 17 == 0) {
+                    writer.endPage();
+                    page++;
+                    fill = 0;
+                }
+            }
+            writer.end();
+            EXPECT_EQ(writer.getLineCount(), source.size());
+            EXPECT_EQ(writer.getPageCount(), page + (fill ? 1 : 0));
+
+            for (size_t chunk : { (size_t)1, (size_t)13, (size_t)512, (size_t)65535 }) {
+                SCOPED_TRACE("width " + std::to_string(width) + ", " + std::to_string(linesPerPage) +
+                             " lines per page, chunks of " + std::to_string(chunk));
+                std::vector<ReadLine> back = ReadAll(sink.out, width, linesPerPage, chunk);
+                ASSERT_EQ(back.size(), source.size());
+                for (size_t i = 0; i < source.size(); i++) {
+                    ASSERT_EQ(back[i].cells, source[i]) << "line " << i;
+                    ASSERT_EQ(back[i].page, where[i].first) << "line " << i;
+                    ASSERT_EQ(back[i].lineInPage, where[i].second) << "line " << i;
+                }
+            }
+
+            // The same through readLine() and a span source
+            std::vector<uint8_t> cells(width);
+            BrfReader reader;
+            reader.begin(cells.data(), width, linesPerPage);
+            SpanSource spans{ sink.out, 0, 512 };
+            size_t n = 0;
+            while (reader.readLine(spans)) {
+                ASSERT_LT(n, source.size());
+                EXPECT_EQ(std::vector<uint8_t>(cells.begin(), cells.begin() + reader.getCount()), source[n]);
+                n++;
+            }
+            EXPECT_EQ(n, source.size());
+        }
+    }
+}
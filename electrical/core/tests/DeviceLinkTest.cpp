@@ -0,0 +1,292 @@
+// DeviceLinkTest.cpp - Pipelined text sending over a Linux pty pair. A
+// thread on the master side plays the firmware: it applies E: lines to a
+// copy of the TextBuffer and answers each one.
+
+#include "DeviceFleet.h"
+#include "DeviceLink.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+
+// Applies one E: line like braille/src/main.cpp + TextBuffer
+bool ApplyEditLine(std::string& text, const std::string& line) {
+    size_t comma = line.find(','), colon = line.find(':', comma);
+    if (line.compare(0, 2, "E:") != 0 || comma == std::string::npos || colon == std::string::npos) return false;
+    size_t pos = std::strtoul(line.substr(2, comma - 2).c_str(), nullptr, 16);
+    size_t remove = std::strtoul(line.substr(comma + 1, colon - comma - 1).c_str(), nullptr, 16);
+    std::string insert;
+    for (size_t i = colon + 1; i < line.size(); i++) {
+        char c = line[i];
+        if (c == '\\' && i + 1 < line.size()) {
+            c = line[++i];
+            c = c == 'n' ? '\n' : c == 'r' ? '\r' : c;
+        }
+        insert += c;
+    }
+    if (pos > text.size()) return false;
+    text.replace(pos, (std::min)(remove, text.size() - pos), insert);
+    return true;
+}
+
+class FakeBoard {
+public:
+    // Returns the reply line for a command, or "" to stay silent
+    using Policy = std::function<std::string(const std::string& line, std::string& text)>;
+
+    explicit FakeBoard(Policy policy = nullptr, int replyDelayMs = 0)
+        : m_policy(std::move(policy)), m_delayMs(replyDelayMs) {
+        m_master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (m_master < 0 || grantpt(m_master) != 0 || unlockpt(m_master) != 0) return;
+        slavePath = ptsname(m_master);
+        m_thread = std::thread([this] { Run(); });
+    }
+    ~FakeBoard() {
+        m_stop = true;
+        if (m_thread.joinable()) m_thread.join();
+        if (m_master >= 0) close(m_master);
+    }
+
+    std::string Text() { std::lock_guard<std::mutex> lock(m_mutex); return m_text; }
+    size_t MaxUnanswered() { std::lock_guard<std::mutex> lock(m_mutex); return m_maxUnanswered; }
+
+    std::string slavePath;
+
+private:
+    void Run() {
+        std::string pending;
+        size_t unanswered = 0;
+        while (!m_stop) {
+            pollfd p = { m_master, POLLIN, 0 };
+            if (poll(&p, 1, 20) <= 0) continue;
+            char buf[4096];
+            ssize_t n = read(m_master, buf, sizeof(buf));
+            if (n <= 0) continue;
+            pending.append(buf, (size_t)n);
+            unanswered += (size_t)n;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_maxUnanswered = (std::max)(m_maxUnanswered, unanswered);
+            }
+
+            size_t nl;
+            while ((nl = pending.find('\n')) != std::string::npos) {
+                std::string line = pending.substr(0, nl);
+                pending.erase(0, nl + 1);
+                if (m_delayMs) std::this_thread::sleep_for(std::chrono::milliseconds(m_delayMs));
+                std::string reply;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    reply = m_policy ? m_policy(line, m_text) : (ApplyEditLine(m_text, line) ? "OK" : "ERR:edit");
+                }
+                unanswered -= line.size() + 1;
+                if (!reply.empty()) {
+                    reply += "\r\n";
+                    ASSERT_EQ((ssize_t)reply.size(), write(m_master, reply.data(), reply.size()));
+                }
+            }
+        }
+    }
+
+    Policy m_policy;
+    int m_delayMs;
+    int m_master = -1;
+    std::atomic<bool> m_stop{ false };
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::string m_text;
+    size_t m_maxUnanswered = 0;
+};
+
+struct Connected {
+    SerialPort port;
+    DeviceLink link;
+
+    Connected(const FakeBoard& board, DeviceLinkOptions options = DeviceLinkOptions()) : link(port, options) {
+        port.SetLineCallback([this](const std::string& line) { link.OnLine(line); });
+        std::string err;
+        EXPECT_TRUE(port.Open(board.slavePath, SerialOptions(), err)) << err;
+    }
+};
+
+} // namespace
+
+TEST(DeviceLink, TextArrivesAndEveryLineIsAnswered) {
+    FakeBoard board;
+    ASSERT_FALSE(board.slavePath.empty());
+    Connected c(board);
+
+    ASSERT_TRUE(c.link.SendText("The quick brown fox jumps over the lazy dog. "
+                                "Pack my box with five dozen liquor jugs."));
+    ASSERT_TRUE(c.link.WaitIdle(2000));
+    ASSERT_TRUE(c.link.SendText("The quick red fox jumps over the lazy dog. "
+                                "Pack my box with \xE2\x80\x9C" "five\xE2\x80\x9D dozen liquor jugs!"));
+    ASSERT_TRUE(c.link.WaitIdle(2000));
+
+    EXPECT_EQ(board.Text(), "The quick red fox jumps over the lazy dog. Pack my box with \"five\" dozen liquor jugs!");
+    EXPECT_EQ(board.Text(), c.link.DeviceText());
+    DeviceLinkStats s = c.link.Stats();
+    EXPECT_GT(s.linesSent, 2u);
+    EXPECT_EQ(s.linesAcked, s.linesSent);
+    EXPECT_EQ(c.link.TakeLatencies().size(), s.linesSent);
+}
+
+TEST(DeviceLink, PipelinesUpToTheWindow) {
+    FakeBoard board(nullptr, 5);   // slow to answer
+    DeviceLinkOptions options;
+    options.windowBytes = 200;
+    Connected c(board, options);
+
+    std::string text;
+    for (int i = 0; i < 8; i++) text += "Line number " + std::to_string(i) + " of a longer page of text. ";
+    ASSERT_TRUE(c.link.SendText(text));
+    ASSERT_TRUE(c.link.WaitIdle(5000));
+
+    EXPECT_EQ(board.Text(), text);
+    EXPECT_LE(board.MaxUnanswered(), 200u);
+    EXPECT_GT(board.MaxUnanswered(), 64u);   // more than one line was in flight
+}
+
+TEST(DeviceLink, RejectedEditForcesFullResend) {
+    std::atomic<bool> rejectNext{ false };
+    FakeBoard board([&](const std::string& line, std::string& text) -> std::string {
+        if (rejectNext) { rejectNext = false; return "ERR:edit"; }
+        return ApplyEditLine(text, line) ? "OK" : "ERR:edit";
+    });
+    Connected c(board);
+
+    ASSERT_TRUE(c.link.SendText("one two three"));
+    ASSERT_TRUE(c.link.WaitIdle(2000));
+    rejectNext = true;
+    ASSERT_TRUE(c.link.SendText("one 2 three"));
+    ASSERT_TRUE(c.link.WaitIdle(2000));
+    EXPECT_EQ(c.link.Stats().linesRejected, 1u);
+    EXPECT_EQ(board.Text(), "one two three");
+
+    ASSERT_TRUE(c.link.SendText("one 2 three"));
+    ASSERT_TRUE(c.link.WaitIdle(2000));
+    EXPECT_EQ(board.Text(), "one 2 three");
+}
+
+TEST(DeviceLink, UnansweredLinesExpire) {
+    FakeBoard board([](const std::string&, std::string&) { return std::string(); });
+    DeviceLinkOptions options;
+    options.replyTimeoutMs = 100;
+    Connected c(board, options);
+
+    ASSERT_TRUE(c.link.SendText("nobody answers"));
+    EXPECT_FALSE(c.link.Idle());
+    EXPECT_TRUE(c.link.WaitIdle(2000));
+    EXPECT_EQ(c.link.Stats().linesLost, 1u);
+}
+
+TEST(DeviceFleet, BroadcastAndPerDeviceText) {
+    std::vector<std::unique_ptr<FakeBoard>> boards;
+    for (int i = 0; i < 5; i++) boards.emplace_back(new FakeBoard);
+    DeviceFleetOptions options;
+    options.ioThreads = 2;
+    DeviceFleet fleet(options);
+    for (auto& b : boards) {
+        std::string err;
+        ASSERT_GE(fleet.Add(b->slavePath, err), 0) << err;
+    }
+    ASSERT_EQ(fleet.Size(), 5u);
+
+    EXPECT_EQ(fleet.Broadcast("The same page on every display."), 5u);
+    ASSERT_TRUE(fleet.WaitIdle(3000));
+    for (auto& b : boards) EXPECT_EQ(b->Text(), "The same page on every display.");
+
+    for (size_t i = 0; i < fleet.Size(); i++)
+        ASSERT_TRUE(fleet.Send(i, "Display " + std::to_string(i) + " reads its own page."));
+    ASSERT_TRUE(fleet.WaitIdle(3000));
+    for (size_t i = 0; i < boards.size(); i++)
+        EXPECT_EQ(boards[i]->Text(), "Display " + std::to_string(i) + " reads its own page.");
+
+    DeviceLinkStats t = fleet.Totals();
+    EXPECT_EQ(t.linesAcked, t.linesSent);
+    EXPECT_EQ(t.linesRejected, 0u);
+}
+
+TEST(DeviceFleet, OneBadDisplayHoldsUpOnlyItself) {
+    FakeBoard good1, good2;
+    FakeBoard silent([](const std::string&, std::string&) { return std::string(); });
+    FakeBoard rejecting([](const std::string&, std::string&) { return std::string("ERR:edit"); });
+    DeviceFleetOptions options;
+    options.link.replyTimeoutMs = 5000;   // the silent board stays unanswered for the whole test
+    DeviceFleet fleet(options);
+    std::string err;
+    ASSERT_EQ(fleet.Add(good1.slavePath, err), 0) << err;
+    ASSERT_EQ(fleet.Add(silent.slavePath, err), 1) << err;
+    ASSERT_EQ(fleet.Add(rejecting.slavePath, err), 2) << err;
+    ASSERT_EQ(fleet.Add(good2.slavePath, err), 3) << err;
+
+    fleet.Broadcast("first page");
+    ASSERT_TRUE(fleet.Link(0).WaitIdle(2000));
+    ASSERT_TRUE(fleet.Link(3).WaitIdle(2000));
+    ASSERT_TRUE(fleet.Link(2).WaitIdle(2000));
+    EXPECT_FALSE(fleet.Link(1).Idle());
+    fleet.Broadcast("second page");
+    ASSERT_TRUE(fleet.Link(0).WaitIdle(2000));
+    ASSERT_TRUE(fleet.Link(3).WaitIdle(2000));
+
+    EXPECT_EQ(good1.Text(), "second page");
+    EXPECT_EQ(good2.Text(), "second page");
+    EXPECT_EQ(rejecting.Text(), "");
+    EXPECT_GT(fleet.Link(2).Stats().linesRejected, 0u);
+    EXPECT_EQ(fleet.Link(0).Stats().linesRejected, 0u);
+    EXPECT_FALSE(fleet.WaitIdle(100));
+}
+
+TEST(DeviceFleet, UnpluggedDisplayIsReportedAndTheRestCarryOn) {
+    std::vector<std::unique_ptr<FakeBoard>> boards;
+    for (int i = 0; i < 3; i++) boards.emplace_back(new FakeBoard);
+    DeviceFleet fleet;
+    std::mutex mutex;
+    std::vector<size_t> failed;
+    fleet.SetErrorCallback([&](size_t device, const std::string&) {
+        std::lock_guard<std::mutex> lock(mutex);
+        failed.push_back(device);
+    });
+    for (auto& b : boards) {
+        std::string err;
+        ASSERT_GE(fleet.Add(b->slavePath, err), 0) << err;
+    }
+    fleet.Broadcast("first page");
+    ASSERT_TRUE(fleet.WaitIdle(3000));
+
+    boards[1].reset();   // the middle display is unplugged
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!failed.empty() || std::chrono::steady_clock::now() > deadline) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ASSERT_EQ(std::vector<size_t>{ 1 }, failed);
+    }
+
+    fleet.Send(0, "second page");
+    fleet.Send(2, "second page");
+    ASSERT_TRUE(fleet.Link(0).WaitIdle(2000));
+    ASSERT_TRUE(fleet.Link(2).WaitIdle(2000));
+    EXPECT_EQ(boards[0]->Text(), "second page");
+    EXPECT_EQ(boards[2]->Text(), "second page");
+    EXPECT_EQ(fleet.Totals().linesRejected, 0u);
+}
@@ -0,0 +1,176 @@
+// DocumentSourceTest.cpp - Page boundaries, BOM handling and the feeder.
+
+#include "DocumentSource.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Writes contents to a file in the system temp directory, removed on scope exit
+struct TempFile {
+    std::string path;
+
+    explicit TempFile(const std::string& contents) {
+        static unsigned counter = 0;
+        path = (std::filesystem::temp_directory_path() /
+                ("document_source_" + std::to_string(std::random_device()()) + "_" + std::to_string(counter++))).string();
+        FILE* f = std::fopen(path.c_str(), "wb");
+        std::fwrite(contents.data(), 1, contents.size(), f);
+        std::fclose(f);
+    }
+    ~TempFile() { std::remove(path.c_str()); }
+};
+
+std::string Words(size_t bytes, unsigned seed) {
+    static const char* vocab[] = { "page", "dots", "\xC3\xA9l\xC3\xA8ve", "\xE2\x80\x94", "line",
+                                   "\xF0\x9F\x93\x96", "read", "braille" };
+    std::mt19937 rng(seed);
+    std::string s;
+    while (s.size() < bytes) {
+        s += vocab[rng() % 8];
+        s += rng() % 10 == 0 ? '\n' : ' ';
+    }
+    return s;
+}
+
+bool SplitsCharacter(const DocumentSource& doc, const std::string& text, size_t page) {
+    size_t start = doc.PageStart(page);
+    return start < text.size() && ((uint8_t)text[start] & 0xC0) == 0x80;
+}
+
+DocumentOptions Small() {
+    DocumentOptions o;
+    o.pageBytes = 64;
+    o.snapBytes = 16;
+    return o;
+}
+
+} // namespace
+
+TEST(DocumentSource, PagesCoverTheFileExactly) {
+    std::string text = Words(20000, 3);
+    TempFile file(text);
+    DocumentSource doc(Small());
+    std::string err;
+    ASSERT_TRUE(doc.Open(file.path, err)) << err;
+    ASSERT_EQ(doc.Size(), text.size());
+    ASSERT_EQ(doc.PageCount(), (text.size() + 63) / 64);
+
+    std::string joined;
+    for (size_t k = 0; k < doc.PageCount(); k++) {
+        std::string_view page = doc.Page(k);
+        EXPECT_GT(page.size(), 0u);
+        EXPECT_LE(page.size(), 64u + 16u);
+        EXPECT_FALSE(SplitsCharacter(doc, text, k)) << "page " << k;
+        joined.append(page.data(), page.size());
+    }
+    EXPECT_EQ(joined, text);
+    EXPECT_EQ(doc.PageStart(doc.PageCount()), text.size());
+}
+
+TEST(DocumentSource, PagesBreakAfterWhitespace) {
+    std::string text = Words(5000, 4);
+    TempFile file(text);
+    DocumentSource doc(Small());
+    std::string err;
+    ASSERT_TRUE(doc.Open(file.path, err)) << err;
+    for (size_t k = 1; k < doc.PageCount(); k++) {
+        char before = text[doc.PageStart(k) - 1];
+        EXPECT_TRUE(before == ' ' || before == '\n') << "page " << k;
+    }
+}
+
+TEST(DocumentSource, LongWordsStillBreakOnCharacterBoundaries) {
+    std::string text;
+    for (int i = 0; i < 500; i++) text += "\xE2\xA0\x80\xF0\x9F\x98\x80";   // no whitespace at all
+    TempFile file(text);
+    DocumentSource doc(Small());
+    std::string err;
+    ASSERT_TRUE(doc.Open(file.path, err)) << err;
+    std::string joined;
+    for (size_t k = 0; k < doc.PageCount(); k++) {
+        EXPECT_FALSE(SplitsCharacter(doc, text, k)) << "page " << k;
+        std::string_view page = doc.Page(k);
+        joined.append(page.data(), page.size());
+    }
+    EXPECT_EQ(joined, text);
+}
+
+TEST(DocumentSource, PageOfFindsTheContainingPage) {
+    std::string text = Words(3000, 5);
+    TempFile file(text);
+    DocumentSource doc(Small());
+    std::string err;
+    ASSERT_TRUE(doc.Open(file.path, err)) << err;
+    for (size_t off = 0; off < text.size(); off++) {
+        size_t k = doc.PageOf(off);
+        ASSERT_LE(doc.PageStart(k), off);
+        ASSERT_LT(off, doc.PageStart(k + 1));
+    }
+}
+
+TEST(DocumentSource, SkipsBomAndHandlesEmptyAndMissingFiles) {
+    TempFile bom("\xEF\xBB\xBFhello world");
+    DocumentSource doc;
+    std::string err;
+    ASSERT_TRUE(doc.Open(bom.path, err)) << err;
+    EXPECT_EQ(doc.Size(), 11u);
+    ASSERT_EQ(doc.PageCount(), 1u);
+    EXPECT_EQ(doc.Page(0), "hello world");
+
+    TempFile empty("");
+    ASSERT_TRUE(doc.Open(empty.path, err)) << err;
+    EXPECT_EQ(doc.PageCount(), 0u);
+    EXPECT_TRUE(doc.Page(0).empty());
+
+    EXPECT_FALSE(doc.Open(empty.path + ".missing", err));
+    EXPECT_FALSE(err.empty());
+    EXPECT_FALSE(doc.IsOpen());
+}
+
+TEST(DocumentSource, ReleasingResidentPagesKeepsContent) {
+    std::string text = Words(300000, 6);
+    TempFile file(text);
+    DocumentOptions o;
+    o.residentBytes = 16384;
+    DocumentSource doc(o);
+    std::string err;
+    ASSERT_TRUE(doc.Open(file.path, err)) << err;
+    // Forward, then back over pages whose mapping was released
+    std::string joined;
+    for (size_t k = 0; k < doc.PageCount(); k++) doc.Page(k);
+    for (size_t k = 0; k < doc.PageCount(); k++) {
+        std::string_view page = doc.Page(k);
+        joined.append(page.data(), page.size());
+    }
+    EXPECT_EQ(joined, text);
+}
+
+TEST(PageFeeder, SendsOnlyTheNewestPageWhenTheLinkDrains) {
+    PageFeeder feeder;
+    std::vector<size_t> sent;
+    auto send = [&](size_t page) { sent.push_back(page); return true; };
+
+    feeder.Request(1);
+    EXPECT_TRUE(feeder.Pump(true, send));
+    for (size_t k = 2; k <= 40; k++) {
+        feeder.Request(k);
+        feeder.Pump(false, send);   // link still busy
+    }
+    EXPECT_TRUE(feeder.Pump(true, send));
+    EXPECT_FALSE(feeder.Pump(true, send));
+    EXPECT_EQ(sent, (std::vector<size_t>{ 1, 40 }));
+
+    // A failed send stays pending
+    feeder.Request(41);
+    EXPECT_FALSE(feeder.Pump(true, [](size_t) { return false; }));
+    EXPECT_TRUE(feeder.HasPending());
+    EXPECT_TRUE(feeder.Pump(true, send));
+    EXPECT_EQ(sent.back(), 41u);
+}
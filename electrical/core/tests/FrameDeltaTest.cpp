@@ -0,0 +1,258 @@
+// FrameDeltaTest.cpp - Cell run diff, F: encoding and a model of the firmware.
+
+#include "FrameDelta.h"
+#include "PatternCode.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// What braille/src/main.cpp does with F: lines: runs go to the back
+// frame, a trailing '!' shows it. Returns false like an ERR:frame.
+bool ApplyFrameLines(std::vector<uint8_t>& front, const std::string& commands, size_t maxLine, int* commits = nullptr) {
+    std::vector<uint8_t> back = front;
+    std::istringstream in(commands);
+    std::string line;
+    auto hex = [&](size_t& i) { return (uint8_t)std::stoul(line.substr((i += 2) - 2, 2), nullptr, 16); };
+    while (std::getline(in, line)) {
+        if (line.size() > maxLine || line.compare(0, 2, "F:") != 0) return false;
+        size_t i = 2;
+        while (i < line.size()) {
+            if (line[i] == '!' && i + 1 == line.size()) {
+                front = back;
+                if (commits) (*commits)++;
+                break;
+            }
+            if (i + 4 > line.size()) return false;
+            uint8_t offset = hex(i), control = hex(i);
+            size_t n = control & 0x3F;
+            if (n == 0 || offset + n > back.size()) return false;
+            if (control < 0x40) {
+                for (size_t k = 0; k < n; k++) back[offset + k] = hex(i);
+            } else if (control < 0x80) {
+                std::vector<uint8_t> cells;
+                if (!UnpackPatterns(line, i, n, cells)) return false;
+                std::copy(cells.begin(), cells.end(), back.begin() + offset);
+            } else if (control < 0xC0) {
+                uint8_t pattern = hex(i);
+                for (size_t k = 0; k < n; k++) back[offset + k] = pattern;
+            } else {
+                uint8_t source = hex(i);
+                if (source + n > back.size()) return false;
+                std::memmove(back.data() + offset, back.data() + source, n);
+            }
+        }
+    }
+    return true;
+}
+
+std::vector<uint8_t> RandomFrame(std::mt19937& rng, size_t cells) {
+    std::vector<uint8_t> f(cells);
+    for (uint8_t& c : f) c = rng() % 3 == 0 ? 0 : (uint8_t)(rng() & 0x3F);
+    return f;
+}
+
+} // namespace
+
+TEST(FrameDelta, ChecksumMatchesFirmware) {
+    // braille/sim/scripts/frame.sim
+    EXPECT_EQ(FrameChecksum(std::vector<uint8_t>(32, 0)), 0xF14C);
+    std::vector<uint8_t> f(32, 0);
+    f[0] = 0x41, f[1] = 0x42, f[2] = 0x43;
+    EXPECT_EQ(FrameChecksum(f), 0x65EC);
+}
+
+TEST(FrameDelta, RandomChangesRoundTrip) {
+    std::mt19937 rng(5);
+    FrameDeltaOptions options;
+    for (int iter = 0; iter < 1000; iter++) {
+        options.packed = iter >= 500;
+        std::vector<uint8_t> a = RandomFrame(rng, options.cells), b = a;
+        switch (iter % 4) {
+        case 0: b = RandomFrame(rng, options.cells); break;
+        case 1: b[rng() % b.size()] ^= 0x88; break;
+        case 2: {
+            size_t k = 1 + rng() % 8;
+            b.erase(b.begin(), b.begin() + (ptrdiff_t)k);
+            b.resize(options.cells, 0);
+            break;
+        }
+        case 3: {
+            size_t k = 1 + rng() % 8;
+            b.insert(b.begin(), k, (uint8_t)0x07);
+            b.resize(options.cells);
+            break;
+        }
+        }
+        std::vector<uint8_t> applied = a;
+        ApplyRuns(applied, DiffCells(a, b));
+        ASSERT_EQ(applied, b) << "iteration " << iter;
+
+        DeviceFrameMirror mirror(options);
+        std::vector<uint8_t> device(options.cells, 0xFF);
+        ASSERT_TRUE(ApplyFrameLines(device, mirror.Update(a), options.maxLineLength));
+        ASSERT_EQ(device, a);
+        int commits = 0;
+        ASSERT_TRUE(ApplyFrameLines(device, mirror.Update(b), options.maxLineLength, &commits));
+        ASSERT_EQ(device, b) << "iteration " << iter;
+        ASSERT_EQ(commits, a == b ? 0 : 1);
+    }
+}
+
+TEST(FrameDelta, SmallChangesCostFewBytes) {
+    std::vector<uint8_t> line(32, 0);
+    for (size_t i = 0; i < 20; i++) line[i] = (uint8_t)(1 + i);
+    DeviceFrameMirror mirror;
+    mirror.Update(line);
+
+    // A typo: one cell
+    std::vector<uint8_t> typo = line;
+    typo[7] = 0x3F;
+    EXPECT_EQ(mirror.Update(typo), "F:07013F!\n");
+
+    // The cursor moves from cell 7 to cell 9: dots 7 and 8 on both
+    std::vector<uint8_t> cursor = typo;
+    cursor[9] |= 0x88;
+    cursor[7] |= 0x88;
+    EXPECT_EQ(mirror.Update(cursor), "F:0703BF098A!\n");
+
+    // Scrolling by a word of four cells and a space: one copy, then the
+    // tail that came into view
+    std::vector<uint8_t> scrolled(cursor.begin() + 5, cursor.end());
+    scrolled.insert(scrolled.end(), { 0x01, 0x03, 0x09, 0x00, 0x00 });
+    std::string delta = mirror.Update(scrolled);
+    EXPECT_EQ(delta.compare(0, 8, "F:00DB05"), 0) << delta;
+    EXPECT_LT(delta.size(), 24u) << delta;
+
+    std::vector<uint8_t> device = cursor;
+    ASSERT_TRUE(ApplyFrameLines(device, delta, 62));
+    EXPECT_EQ(device, scrolled);
+
+    EXPECT_EQ(mirror.Update(scrolled), "");
+}
+
+TEST(FrameDelta, BlankCellsAreRunLengthEncoded) {
+    DeviceFrameMirror mirror;
+    std::vector<uint8_t> line(32, 0);
+    line[0] = 0x01;
+    // Unknown device frame: every cell is written, the blanks as one repeat
+    EXPECT_EQ(mirror.Update(line), "F:000101019F00!\n");
+    EXPECT_EQ(mirror.ExpectedSum().compare(0, 8, "FSUM:20,"), 0);
+}
+
+TEST(FrameDelta, ResetResendsAndLongChangesSplitAcrossLines) {
+    std::mt19937 rng(9);
+    FrameDeltaOptions options;
+    options.maxLineLength = 30;
+    DeviceFrameMirror mirror(options);
+    std::vector<uint8_t> a(32);
+    for (size_t i = 0; i < a.size(); i++) a[i] = (uint8_t)(0x40 + i);
+
+    std::string full = mirror.Update(a);
+    std::istringstream in(full);
+    std::string line;
+    int lines = 0;
+    while (std::getline(in, line)) {
+        EXPECT_LE(line.size(), options.maxLineLength);
+        EXPECT_EQ(line.back() == '!', in.peek() == EOF) << line;
+        lines++;
+    }
+    EXPECT_GT(lines, 2);
+    std::vector<uint8_t> device(32, 0);
+    ASSERT_TRUE(ApplyFrameLines(device, full, options.maxLineLength));
+    EXPECT_EQ(device, a);
+
+    EXPECT_EQ(mirror.Update(a), "");
+    mirror.Reset();
+    EXPECT_FALSE(mirror.Synced());
+    EXPECT_EQ(mirror.Update(a), full);
+}
+
+TEST(FrameDelta, PackedRunsOnlyWhenTheDeviceOffersThem) {
+    FrameDeltaOptions options;
+    EXPECT_TRUE(ParseFrameCaps("CAPS:FRAME,PACK2", options));
+    EXPECT_TRUE(options.packed);
+    EXPECT_TRUE(ParseFrameCaps("CAPS:FRAME,PACK1", options));
+    EXPECT_FALSE(options.packed);   // the first code, trained in converter order
+    EXPECT_TRUE(ParseFrameCaps("CAPS:FRAME,PACK9", options));
+    EXPECT_FALSE(options.packed);   // a code this host does not have
+    EXPECT_TRUE(ParseFrameCaps("CAPS:FRAME", options));
+    EXPECT_FALSE(options.packed);
+    EXPECT_FALSE(ParseFrameCaps("ERR:unknown cmd 'CAPS'", options));
+    EXPECT_FALSE(options.packed);
+
+    // A line of text: packed runs take well under half the hex characters
+    const char* text = "the quick brown fox jumps over a";
+    std::vector<uint8_t> line;
+    const uint8_t letters[26] = { 0x01, 0x03, 0x11, 0x31, 0x21, 0x13, 0x33, 0x23, 0x12, 0x32, 0x05, 0x07, 0x15,
+                                  0x35, 0x25, 0x17, 0x37, 0x27, 0x16, 0x36, 0x45, 0x47, 0x72, 0x55, 0x75, 0x65 };
+    for (const char* c = text; *c; c++) line.push_back(*c == ' ' ? 0 : letters[*c - 'a']);
+    DeviceFrameMirror hex, packed(FrameDeltaOptions{ 32, 62, true });
+    std::string hexLines = hex.Update(line), packedLines = packed.Update(line);
+    EXPECT_LT(packedLines.size() * 2, hexLines.size()) << packedLines;
+    EXPECT_EQ(std::count(packedLines.begin(), packedLines.end(), '\n'), 1);
+    std::vector<uint8_t> device(32, 0);
+    ASSERT_TRUE(ApplyFrameLines(device, packedLines, 62));
+    EXPECT_EQ(device, line);
+}
+
+// The session frame_delta_bench replays (cursor steps, typo fixes, word
+// scrolls and line pans in its proportions), kept here so the wire saving
+// it reports cannot quietly shrink.
+TEST(FrameDelta, ReadingSessionSavesOverWholeLines) {
+    const uint8_t letters[26] = { 0x01, 0x03, 0x11, 0x31, 0x21, 0x13, 0x33, 0x23, 0x12, 0x32, 0x05, 0x07, 0x15,
+                                  0x35, 0x25, 0x17, 0x37, 0x27, 0x16, 0x36, 0x45, 0x47, 0x72, 0x55, 0x75, 0x65 };
+    const char* vocab[] = { "the", "braille", "display", "shows", "one", "line", "of", "text",
+                            "at", "a", "time,", "so", "refreshes", "should", "be", "small", "Reader." };
+    const size_t cells = 32;
+    const int refreshes = 4000;
+    std::mt19937 rng(1);
+    std::string doc;
+    while (doc.size() < (size_t)refreshes * 8 + 1000) {
+        doc += vocab[rng() % (sizeof(vocab) / sizeof(vocab[0]))];
+        doc += ' ';
+    }
+    auto render = [&](size_t start, size_t cursor) {
+        std::vector<uint8_t> line(cells, 0);
+        for (size_t i = 0; i < cells; i++) {
+            char c = (char)std::tolower((unsigned char)doc[start + i]);
+            line[i] = c >= 'a' && c <= 'z' ? letters[c - 'a'] : c == ' ' ? 0 : 0x32;
+        }
+        line[cursor] |= 0x88;
+        return line;
+    };
+    auto nextWord = [&](size_t pos) { return doc.find(' ', pos) + 1; };
+
+    DeviceFrameMirror full, mirror, packed(FrameDeltaOptions{ 32, 62, true });
+    size_t start = 0, cursor = 0;
+    std::vector<uint8_t> device = render(start, cursor);
+    mirror.Update(device);
+    packed.Update(device);
+    size_t fullBytes = 0, deltaBytes = 0, packedBytes = 0;
+    for (int r = 0; r < refreshes; r++) {
+        unsigned pick = rng() % 100;
+        if (pick < 55) cursor = (cursor + 1 + rng() % 4) % cells;
+        else if (pick < 65) doc[start + cursor] = (char)('a' + rng() % 26);
+        else if (pick < 90) start = nextWord(start);
+        else { start = nextWord(start + cells - 8); cursor = 0; }
+        std::vector<uint8_t> line = render(start, cursor);
+
+        std::string delta = mirror.Update(line);
+        ASSERT_TRUE(ApplyFrameLines(device, delta, 62)) << delta;
+        ASSERT_EQ(device, line) << "refresh " << r;
+        fullBytes += full.Encode({ CellRun{ CellRun::Literal, 0, cells, 0, line } }).size();
+        deltaBytes += delta.size();
+        packedBytes += packed.Update(line).size();
+    }
+    // The bench measures 3.2x for hex runs and 4.3x packed
+    EXPECT_GE((double)fullBytes / deltaBytes, 3.0) << fullBytes << " / " << deltaBytes;
+    EXPECT_GE((double)fullBytes / packedBytes, 4.0) << fullBytes << " / " << packedBytes;
+}
@@ -0,0 +1,205 @@
+// FrameRecordTest.cpp - LZ4 blocks and recording round trips.
+
+#include "FrameRecord.h"
+#include "Lz4Block.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// A path in the system temp directory, removed on scope exit
+struct TempPath {
+    std::string path;
+
+    TempPath() {
+        static unsigned counter = 0;
+        path = (std::filesystem::temp_directory_path() /
+                ("frame_record_" + std::to_string(std::random_device()()) + "_" + std::to_string(counter++))).string();
+    }
+    ~TempPath() { std::remove(path.c_str()); }
+};
+
+// Screen-like content: flat background, glyph blocks and some noise
+std::vector<uint8_t> Screen(int w, int h, ptrdiff_t stride, int bpp, unsigned seed) {
+    std::vector<uint8_t> px((size_t)stride * h, 0xCD);
+    std::mt19937 rng(seed);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w * bpp; x++) {
+            bool glyph = ((x / bpp) % 9) < 6 && (y % 20) >= 4 && (y % 20) < 14 && (rng() % 3 != 0);
+            px[(size_t)y * stride + x] = glyph ? 0x20 : (y > h * 3 / 4 ? (uint8_t)rng() : 0xF0);
+        }
+    }
+    return px;
+}
+
+void ExpectRowsEqual(const uint8_t* got, ptrdiff_t gotStride, const uint8_t* want, ptrdiff_t wantStride,
+                     size_t rowBytes, int h) {
+    for (int y = 0; y < h; y++)
+        ASSERT_EQ(0, memcmp(got + y * gotStride, want + y * wantStride, rowBytes)) << "row " << y;
+}
+
+} // namespace
+
+TEST(Lz4Block, RoundTripsAllKindsOfInput) {
+    std::mt19937 rng(5);
+    std::vector<std::vector<uint8_t>> inputs;
+    for (size_t n : { 0, 1, 12, 13, 100, 70000 }) inputs.emplace_back(n, 'a');
+    for (size_t n : { 5, 64, 4096, 200000 }) {
+        std::vector<uint8_t> v(n);
+        for (auto& b : v) b = (uint8_t)rng();
+        inputs.push_back(v);
+    }
+    std::vector<uint8_t> text;
+    while (text.size() < 150000) for (const char* c = "the quick brown fox "; *c; c++) text.push_back((uint8_t)*c);
+    inputs.push_back(text);
+    std::vector<uint8_t> screen = Screen(640, 48, 640 * 4, 4, 2);
+    inputs.push_back(screen);
+
+    for (const auto& in : inputs) {
+        std::vector<uint8_t> packed(Lz4CompressBound(in.size()));
+        size_t n = Lz4Compress(in.data(), in.size(), packed.data(), packed.size());
+        ASSERT_GT(n, 0u);
+        std::vector<uint8_t> out(in.size());
+        ASSERT_TRUE(Lz4Decompress(packed.data(), n, out.data(), out.size())) << in.size();
+        EXPECT_EQ(in, out);
+    }
+    EXPECT_LT(Lz4CompressBound(0), 100u);
+}
+
+TEST(Lz4Block, CompressesFlatDataAndRefusesSmallCapacity) {
+    std::vector<uint8_t> flat(1 << 16, 0xFF), packed(Lz4CompressBound(flat.size()));
+    size_t n = Lz4Compress(flat.data(), flat.size(), packed.data(), packed.size());
+    EXPECT_LT(n, flat.size() / 100);
+    EXPECT_EQ(Lz4Compress(flat.data(), flat.size(), packed.data(), n - 1), 0u);
+
+    std::vector<uint8_t> noise(1000);
+    std::mt19937 rng(9);
+    for (auto& b : noise) b = (uint8_t)rng();
+    EXPECT_EQ(Lz4Compress(noise.data(), noise.size(), packed.data(), noise.size() - 1), 0u);
+}
+
+TEST(Lz4Block, DecodesKnownBlockAndRejectsMalformed) {
+    // "abc" literals, then a 9-byte match at offset 3, then 5 literals
+    const uint8_t block[] = { 0x35, 'a', 'b', 'c', 0x03, 0x00, 0x50, 'x', 'y', 'z', 'z', 'y' };
+    std::vector<uint8_t> out(17);
+    ASSERT_TRUE(Lz4Decompress(block, sizeof(block), out.data(), out.size()));
+    EXPECT_EQ(std::string(out.begin(), out.end()), "abcabcabcabcxyzzy");
+
+    EXPECT_FALSE(Lz4Decompress(block, sizeof(block), out.data(), 16));       // too small
+    EXPECT_FALSE(Lz4Decompress(block, sizeof(block) - 1, out.data(), 16));   // cut short
+    std::vector<uint8_t> big(18);
+    EXPECT_FALSE(Lz4Decompress(block, sizeof(block), big.data(), big.size()));  // wrong size
+    uint8_t badOffset[sizeof(block)];
+    memcpy(badOffset, block, sizeof(block));
+    badOffset[4] = 4;   // before the start of the output
+    EXPECT_FALSE(Lz4Decompress(badOffset, sizeof(badOffset), out.data(), out.size()));
+    badOffset[4] = 0;
+    EXPECT_FALSE(Lz4Decompress(badOffset, sizeof(badOffset), out.data(), out.size()));
+}
+
+TEST(FrameRecord, RoundTripsRawAndCompressedFrames) {
+    TempPath file;
+    ThreadPool pool(3);
+    std::string err;
+
+    struct Input { int w, h; ptrdiff_t stride; FrameFormat format; std::vector<uint8_t> px; };
+    std::vector<Input> inputs;
+    inputs.push_back({ 333, 130, 333 * 4 + 52, FrameFormat::Bgra8, {} });
+    inputs.push_back({ 97, 61, 128, FrameFormat::Gray8, {} });
+    inputs.push_back({ 64, 16, 256, FrameFormat::Bgra8, {} });
+    for (size_t i = 0; i < inputs.size(); i++)
+        inputs[i].px = Screen(inputs[i].w, inputs[i].h, inputs[i].stride, FrameBytesPerPixel(inputs[i].format), (unsigned)i);
+    // Noise does not compress and is stored raw
+    std::mt19937 rng(4);
+    for (auto& b : inputs[2].px) b = (uint8_t)rng();
+
+    for (bool compress : { true, false }) {
+        FrameRecordOptions o;
+        o.compress = compress;
+        o.blockRows = 16;
+        o.pool = &pool;
+        FrameRecorder rec(o);
+        ASSERT_TRUE(rec.Open(file.path, err)) << err;
+        for (size_t i = 0; i < inputs.size(); i++) {
+            const Input& in = inputs[i];
+            ASSERT_TRUE(rec.Add(in.px.data(), in.w, in.h, in.stride, in.format, 1000 * (int64_t)i - 5, err)) << err;
+        }
+        EXPECT_EQ(rec.Frames(), 3u);
+        if (compress) {
+            EXPECT_LT(rec.FileBytes(), rec.RawBytes());
+        }
+        rec.Close();
+
+        FrameReader reader(&pool);
+        ASSERT_TRUE(reader.Open(file.path, err)) << err;
+        ASSERT_EQ(reader.FrameCount(), 3u);
+        EXPECT_EQ(std::filesystem::file_size(file.path), rec.FileBytes());
+        // Out of order, and twice, to go through the decode buffer reuse
+        for (size_t i : { 2, 0, 1, 0 }) {
+            const Input& in = inputs[i];
+            const FrameInfo& info = reader.Info(i);
+            EXPECT_EQ(info.width, in.w);
+            EXPECT_EQ(info.height, in.h);
+            EXPECT_EQ(info.format, in.format);
+            EXPECT_EQ(info.timestampUs, 1000 * (int64_t)i - 5);
+            EXPECT_EQ(info.stride % 64, 0);
+            EXPECT_EQ(info.compressed, compress && i != 2);
+            const uint8_t* px = reader.Frame(i);
+            ASSERT_NE(px, nullptr);
+            ExpectRowsEqual(px, info.stride, in.px.data(), in.stride, (size_t)in.w * FrameBytesPerPixel(in.format), in.h);
+        }
+        EXPECT_EQ(reader.Frame(3), nullptr);
+    }
+}
+
+TEST(FrameRecord, TruncatedRecordingKeepsWholeFrames) {
+    TempPath file, cut;
+    std::string err;
+    std::vector<uint8_t> px = Screen(200, 100, 800, 4, 7);
+    FrameRecorder rec;
+    ASSERT_TRUE(rec.Open(file.path, err)) << err;
+    for (int i = 0; i < 4; i++) {
+        px[(size_t)i * 900] ^= 0xFF;
+        ASSERT_TRUE(rec.Add(px.data(), 200, 100, 800, FrameFormat::Bgra8, i, err)) << err;
+    }
+    rec.Close();
+
+    std::vector<uint8_t> bytes(std::filesystem::file_size(file.path));
+    FILE* f = std::fopen(file.path.c_str(), "rb");
+    ASSERT_EQ(std::fread(bytes.data(), 1, bytes.size(), f), bytes.size());
+    std::fclose(f);
+    f = std::fopen(cut.path.c_str(), "wb");
+    std::fwrite(bytes.data(), 1, bytes.size() - 100, f);
+    std::fclose(f);
+
+    FrameReader reader;
+    ASSERT_TRUE(reader.Open(cut.path, err)) << err;
+    ASSERT_EQ(reader.FrameCount(), 3u);
+    ASSERT_NE(reader.Frame(2), nullptr);
+    EXPECT_EQ(reader.Info(2).timestampUs, 2);
+}
+
+TEST(FrameRecord, RejectsOtherFiles) {
+    TempPath file;
+    FILE* f = std::fopen(file.path.c_str(), "wb");
+    std::fputs("not a recording, just some text that is long enough to hold a header.....", f);
+    std::fclose(f);
+    FrameReader reader;
+    std::string err;
+    EXPECT_FALSE(reader.Open(file.path, err));
+    EXPECT_FALSE(err.empty());
+
+    FrameRecorder rec;
+    std::vector<uint8_t> px(64);
+    EXPECT_FALSE(rec.Add(px.data(), 4, 4, 16, FrameFormat::Bgra8, 0, err));   // not open
+    ASSERT_TRUE(rec.Open(file.path, err));
+    EXPECT_FALSE(rec.Add(px.data(), 8, 4, 16, FrameFormat::Bgra8, 0, err));   // stride < row
+    EXPECT_FALSE(rec.Add(nullptr, 4, 4, 16, FrameFormat::Bgra8, 0, err));
+}
@@ -0,0 +1,150 @@
+// ImageScaleTest.cpp - ResizeBilinear kernels against a float reference.
+
+#include "ImageScale.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Image {
+    int w, h, channels;
+    ptrdiff_t stride;
+    std::vector<uint8_t> data;
+
+    Image(int w_, int h_, int channels_, int padding = 0)
+        : w(w_), h(h_), channels(channels_), stride((ptrdiff_t)w_ * channels_ + padding),
+          data((size_t)stride * h_, 0) {}
+
+    uint8_t* Row(int y) { return data.data() + (ptrdiff_t)y * stride; }
+    const uint8_t* Row(int y) const { return data.data() + (ptrdiff_t)y * stride; }
+};
+
+Image RandomImage(int w, int h, int channels, unsigned seed, int padding = 0) {
+    Image img(w, h, channels, padding);
+    std::mt19937 rng(seed);
+    for (int y = 0; y < h; y++)
+        for (int i = 0; i < w * channels; i++) img.Row(y)[i] = (uint8_t)(rng() & 0xFF);
+    return img;
+}
+
+// Straightforward float bilinear at the same 1/128-pixel source positions
+Image Reference(const Image& src, int dstW, int dstH) {
+    Image dst(dstW, dstH, src.channels);
+    for (int y = 0; y < dstH; y++) {
+        double py = std::floor((double)y * src.h / dstH * 128.0) / 128.0;
+        int y0 = (int)py;
+        int y1 = std::min(y0 + 1, src.h - 1);
+        double wy = py - y0;
+        for (int x = 0; x < dstW; x++) {
+            double px = std::floor((double)x * src.w / dstW * 128.0) / 128.0;
+            int x0 = (int)px;
+            int x1 = std::min(x0 + 1, src.w - 1);
+            double wx = px - x0;
+            for (int c = 0; c < src.channels; c++) {
+                double v = (1 - wx) * (1 - wy) * src.Row(y0)[x0 * src.channels + c] +
+                           wx * (1 - wy) * src.Row(y0)[x1 * src.channels + c] +
+                           (1 - wx) * wy * src.Row(y1)[x0 * src.channels + c] +
+                           wx * wy * src.Row(y1)[x1 * src.channels + c];
+                dst.Row(y)[x * src.channels + c] = (uint8_t)std::lround(v);
+            }
+        }
+    }
+    return dst;
+}
+
+Image Resize(const Image& src, int dstW, int dstH, ScaleKernel kernel, int padding = 0) {
+    Image dst(dstW, dstH, src.channels, padding);
+    EXPECT_TRUE(ResizeBilinear(src.Row(0), src.w, src.h, src.stride, dst.Row(0), dstW, dstH,
+                               dst.stride, src.channels, kernel));
+    return dst;
+}
+
+int MaxDifference(const Image& a, const Image& b) {
+    int worst = 0;
+    for (int y = 0; y < a.h; y++)
+        for (int i = 0; i < a.w * a.channels; i++)
+            worst = std::max(worst, std::abs((int)a.Row(y)[i] - (int)b.Row(y)[i]));
+    return worst;
+}
+
+struct Case { int srcW, srcH, dstW, dstH, channels; };
+
+const Case kCases[] = {
+    { 64, 48, 128, 96, 4 },      // 2x, vector widths divide evenly
+    { 37, 11, 148, 44, 4 },      // 4x, odd width exercises the scalar tails
+    { 99, 31, 198, 62, 4 },
+    { 50, 40, 150, 120, 4 },     // 3x: positions snapped to 1/128
+    { 200, 100, 130, 70, 4 },    // downscale
+    { 1, 1, 4, 4, 4 },
+    { 1, 5, 7, 3, 4 },
+    { 61, 17, 244, 68, 1 },      // gray
+    { 33, 9, 66, 18, 1 },
+};
+
+} // namespace
+
+TEST(ImageScaleTest, ScalarMatchesFloatReferenceWithinOne) {
+    for (const Case& c : kCases) {
+        Image src = RandomImage(c.srcW, c.srcH, c.channels, 1u + c.srcW);
+        Image ref = Reference(src, c.dstW, c.dstH);
+        Image got = Resize(src, c.dstW, c.dstH, ScaleKernel::Scalar);
+        EXPECT_LE(MaxDifference(ref, got), 1) << c.srcW << "x" << c.srcH << " -> " << c.dstW << "x" << c.dstH;
+    }
+}
+
+TEST(ImageScaleTest, SimdKernelsMatchScalarExactly) {
+    for (ScaleKernel kernel : { ScaleKernel::Sse2, ScaleKernel::Avx2, ScaleKernel::Auto }) {
+        for (const Case& c : kCases) {
+            Image src = RandomImage(c.srcW, c.srcH, c.channels, 7u + c.dstW);
+            Image scalar = Resize(src, c.dstW, c.dstH, ScaleKernel::Scalar);
+            Image simd = Resize(src, c.dstW, c.dstH, kernel);
+            EXPECT_EQ(0, MaxDifference(scalar, simd))
+                << "kernel " << (int)ResolveScaleKernel(kernel) << ", " << c.srcW << "x" << c.srcH
+                << " -> " << c.dstW << "x" << c.dstH;
+        }
+    }
+}
+
+TEST(ImageScaleTest, TwoTimesKeepsSourcePixelsOnEvenCoordinates) {
+    Image src = RandomImage(20, 10, 4, 3);
+    Image dst = Resize(src, 40, 20, ScaleKernel::Auto);
+    for (int y = 0; y < 10; y++)
+        for (int x = 0; x < 20; x++)
+            for (int c = 0; c < 4; c++)
+                ASSERT_EQ(src.Row(y)[x * 4 + c], dst.Row(2 * y)[2 * x * 4 + c]);
+}
+
+TEST(ImageScaleTest, HonoursStridesAndLeavesPaddingAlone) {
+    Image src = RandomImage(45, 13, 4, 11, /*padding=*/12);
+    Image packed(45, 13, 4);
+    for (int y = 0; y < 13; y++) std::copy(src.Row(y), src.Row(y) + 45 * 4, packed.Row(y));
+
+    Image dst(90, 26, 4, /*padding=*/8);
+    std::fill(dst.data.begin(), dst.data.end(), 0xAB);
+    ASSERT_TRUE(ResizeBilinearBgra(src.Row(0), 45, 13, src.stride, dst.Row(0), 90, 26, dst.stride));
+
+    Image expected = Resize(packed, 90, 26, ScaleKernel::Scalar);
+    EXPECT_EQ(0, MaxDifference(expected, dst));
+    for (int y = 0; y < 26; y++)
+        for (int i = 90 * 4; i < dst.stride; i++) ASSERT_EQ(0xAB, dst.Row(y)[i]);
+}
+
+TEST(ImageScaleTest, ConstantImageStaysConstant) {
+    Image src(17, 9, 4);
+    std::fill(src.data.begin(), src.data.end(), 200);
+    Image dst = Resize(src, 68, 36, ScaleKernel::Auto);
+    for (uint8_t b : dst.data) ASSERT_EQ(200, b);
+}
+
+TEST(ImageScaleTest, RejectsBadArguments) {
+    uint8_t px[16] = {};
+    EXPECT_FALSE(ResizeBilinear(px, 0, 1, 4, px, 1, 1, 4, 4));
+    EXPECT_FALSE(ResizeBilinear(px, 1, 1, 4, px, 1, 0, 4, 4));
+    EXPECT_FALSE(ResizeBilinear(px, 1, 1, 3, px, 1, 1, 3, 3));
+    EXPECT_FALSE(ResizeBilinear(nullptr, 1, 1, 4, px, 1, 1, 4, 4));
+}
@@ -0,0 +1,126 @@
+// LatencyProbeTest.cpp - Probe reply parsing, unwrapping and clock alignment.
+
+#include "LatencyProbe.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+namespace {
+
+std::string Reply(uint32_t stamp, uint32_t rx, uint32_t parsed, uint32_t pin) {
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "T:%08X,%08X,%08X,%08X", stamp, rx, parsed, pin);
+    return buf;
+}
+
+// A device whose clock runs `ppm` fast and reads `offset` ahead of the
+// host, with fixed parse and pin times and jittery links both ways
+struct FakeDevice {
+    double ppm = 0;
+    double offset = 0;
+    uint32_t baud = 115200;
+    std::mt19937 rng{ 3 };
+
+    double Device(double hostUs) const { return offset + hostUs * (1 + ppm * 1e-6); }
+
+    // Feeds one frame sent at hostSend to the probe
+    void Exchange(LatencyProbe& probe, uint64_t hostSend, double usbUs) {
+        const double frameWire = 14 * 10e6 / baud, replyWire = 39 * 10e6 / baud;
+        std::exponential_distribution<double> jitter(1 / 300.0);
+        const double rx = hostSend + usbUs + frameWire + jitter(rng);
+        const double pin = rx + 40 + 150;
+        const double reply = pin + usbUs + replyWire + jitter(rng);
+        ASSERT_TRUE(probe.OnLine(Reply((uint32_t)hostSend, (uint32_t)(uint64_t)Device(rx),
+                                       (uint32_t)(uint64_t)Device(rx + 40), (uint32_t)(uint64_t)Device(pin)),
+                                 (uint64_t)reply));
+    }
+};
+
+} // namespace
+
+TEST(LatencyProbe, FormatsFramesAndParsesReplies) {
+    EXPECT_EQ(LatencyProbe::Frame(0x1234567890ull, 0x0F), "T:34567890,0F\n");
+
+    LatencyProbe probe;
+    EXPECT_FALSE(probe.OnLine("OK", 1000));
+    EXPECT_FALSE(probe.OnLine("T:0000000A,00000010,00000020", 1000));
+    EXPECT_FALSE(probe.OnLine("T:0000000A;00000010,00000020,00000030", 1000));
+    EXPECT_FALSE(probe.OnLine("T:0000000A,0000001G,00000020,00000030", 1000));
+    EXPECT_TRUE(probe.Samples().empty());
+
+    // A stamp is the low 32 bits of a send time before the reply
+    const uint64_t sent = 0x5FFFFFF00ull, answered = 0x600000100ull;
+    ASSERT_TRUE(probe.OnLine(Reply((uint32_t)sent, 0x10, 0x2c, 0xff), answered));
+    ASSERT_EQ(probe.Samples().size(), 1u);
+    EXPECT_EQ(probe.Samples()[0].hostSendUs, sent);
+    EXPECT_EQ(probe.Samples()[0].hostReplyUs, answered);
+    EXPECT_EQ(probe.Samples()[0].deviceParsedUs, 0x2cu);
+    EXPECT_EQ(probe.Samples()[0].devicePinUs, 0xffu);
+}
+
+TEST(LatencyProbe, UnwrapsMicros) {
+    LatencyProbe probe;
+    ASSERT_TRUE(probe.OnLine(Reply(0, 0xFFFFFF00u, 0xFFFFFFF0u, 0x00000010u), 5000));
+    ASSERT_TRUE(probe.OnLine(Reply(0, 0x00001000u, 0x00001010u, 0x00001020u), 9000));
+    const auto& s = probe.Samples();
+    EXPECT_EQ(s[0].deviceParsedUs, 0xFFFFFFF0ull);
+    EXPECT_EQ(s[0].devicePinUs, 0x100000010ull);
+    EXPECT_EQ(s[1].deviceRxUs, 0x100001000ull);
+}
+
+TEST(LatencyProbe, AlignsOffsetAndDrift) {
+    FakeDevice device;
+    device.ppm = 250;           // a ceramic resonator
+    device.offset = 7.5e6;
+    LatencyProbe probe;
+    uint64_t t = 1000000;
+    for (int i = 0; i < 5000; i++) {
+        device.Exchange(probe, t, 500);
+        t += 6000;
+    }
+
+    const ProbeAnalysis r = probe.Analyze();
+    EXPECT_NEAR(r.driftPpm, 250, 5);
+    ASSERT_EQ(r.stages.size(), 6u);
+    EXPECT_STREQ(r.stages[1].name, "parse");
+    EXPECT_NEAR(LatencyProbe::Percentile(r.stages[1].us, 0.5), 40, 1);
+    EXPECT_NEAR(LatencyProbe::Percentile(r.stages[2].us, 0.5), 150, 1);
+
+    // The bound covers any split of the 2 x 500 us USB delay; split evenly,
+    // as here, the midpoint alignment is off only by the best samples' jitter
+    const double wire = 14 * 10e6 / 115200;
+    EXPECT_GT(r.uncertaintyUs, 500);
+    EXPECT_LT(r.uncertaintyUs, 600);
+    EXPECT_NEAR(LatencyProbe::Percentile(r.stages[0].us, 0.0), 500 + wire, 30);
+    EXPECT_NEAR(LatencyProbe::Percentile(r.stages[4].us, 0.5) - LatencyProbe::Percentile(r.stages[0].us, 0.5), 190, 1);
+    for (size_t i = 0; i < r.stages[5].us.size(); i++)
+        ASSERT_NEAR(r.stages[5].us[i], r.stages[0].us[i] + r.stages[1].us[i] + r.stages[2].us[i] + r.stages[3].us[i],
+                    1e-6);
+}
+
+TEST(LatencyProbe, WritesCsv) {
+    FakeDevice device;
+    LatencyProbe probe;
+    for (int i = 0; i < 10; i++) device.Exchange(probe, 1000 + 5000 * (uint64_t)i, 200);
+
+    const std::string path = (std::filesystem::temp_directory_path() / "latency_probe_test.csv").string();
+    std::string err;
+    ASSERT_TRUE(probe.WriteCsv(path, err)) << err;
+    std::ifstream in(path);
+    std::string line;
+    ASSERT_TRUE(std::getline(in, line));
+    EXPECT_EQ(line, "host_send_us,host_reply_us,device_rx_us,device_parsed_us,device_pin_us,"
+                    "send_rx_us,parse_us,pin_write_us,reply_us,send_pin_us,round_trip_us");
+    int rows = 0;
+    while (std::getline(in, line)) rows++;
+    EXPECT_EQ(rows, 10);
+    in.close();
+    std::remove(path.c_str());
+
+    EXPECT_FALSE(probe.WriteCsv("/nonexistent-dir/x.csv", err));
+}
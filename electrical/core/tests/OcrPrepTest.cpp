@@ -0,0 +1,142 @@
+// OcrPrepTest.cpp - Fused crop/gray/upscale against the staged pipeline.
+
+#include "OcrPrep.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Frame {
+    int w, h;
+    ptrdiff_t stride;
+    std::vector<uint8_t> data;
+
+    Frame(int w_, int h_, int padding, unsigned seed)
+        : w(w_), h(h_), stride((ptrdiff_t)w_ * 4 + padding), data((size_t)stride * h_) {
+        std::mt19937 rng(seed);
+        for (auto& b : data) b = (uint8_t)(rng() & 0xFF);
+    }
+};
+
+// Crop, convert to gray, then ResizeBilinear: what the fused pass replaces
+std::vector<uint8_t> Staged(const Frame& f, PixelRect r, int factor, ScaleKernel kernel) {
+    int cw = r.right - r.left, ch = r.bottom - r.top;
+    std::vector<uint8_t> gray((size_t)cw * ch);
+    for (int y = 0; y < ch; y++)
+        for (int x = 0; x < cw; x++)
+            gray[(size_t)y * cw + x] = BgraToGray(f.data.data() + (ptrdiff_t)(r.top + y) * f.stride + (r.left + x) * 4);
+    int ow = cw * factor, oh = ch * factor;
+    std::vector<uint8_t> out((size_t)ow * oh);
+    ResizeBilinear(gray.data(), cw, ch, cw, out.data(), ow, oh, ow, 1, kernel);
+    return out;
+}
+
+} // namespace
+
+TEST(OcrPrep, UpscaleFactorThresholds) {
+    EXPECT_EQ(OcrUpscaleFactor(1), 4);
+    EXPECT_EQ(OcrUpscaleFactor(99), 4);
+    EXPECT_EQ(OcrUpscaleFactor(100), 2);
+    EXPECT_EQ(OcrUpscaleFactor(799), 2);
+    EXPECT_EQ(OcrUpscaleFactor(800), 1);
+}
+
+TEST(OcrPrep, GrayRowKernelsMatchScalar) {
+    Frame f(67, 1, 0, 1);
+    std::vector<uint8_t> scalar(67), fast(67);
+    BgraRowToGray(f.data.data(), scalar.data(), 67, ScaleKernel::Scalar);
+    BgraRowToGray(f.data.data(), fast.data(), 67, ScaleKernel::Auto);
+    EXPECT_EQ(scalar, fast);
+    for (int x = 0; x < 67; x++) EXPECT_EQ(scalar[x], BgraToGray(f.data.data() + x * 4));
+}
+
+TEST(OcrPrep, MatchesStagedPipeline) {
+    Frame f(257, 131, 12, 7);
+    const PixelRect rects[] = { {0, 0, 257, 131}, {13, 5, 103, 45}, {200, 100, 257, 131}, {40, 60, 41, 61} };
+    const ScaleKernel kernels[] = { ScaleKernel::Scalar, ScaleKernel::Sse2, ScaleKernel::Avx2 };
+    OcrPrep prep;
+    for (const PixelRect& r : rects) {
+        for (int factor : { 1, 2, 3, 4 }) {
+            for (ScaleKernel k : kernels) {
+                if (ResolveScaleKernel(k) != k) continue;
+                std::vector<uint8_t> expected = Staged(f, r, factor, ScaleKernel::Scalar);
+                BufferPool::Buffer out;
+                int ow = 0, oh = 0;
+                ASSERT_TRUE(prep.Run(f.data.data(), f.w, f.h, f.stride, r, factor, out, ow, oh, k));
+                ASSERT_EQ((size_t)ow * oh, expected.size());
+                EXPECT_EQ(0, memcmp(out.Data(), expected.data(), expected.size()))
+                    << "rect " << r.left << "," << r.top << " factor " << factor << " kernel " << (int)k;
+            }
+        }
+    }
+}
+
+TEST(OcrPrep, WritesCallerMemoryWithStride) {
+    Frame f(64, 32, 0, 3);
+    PixelRect r{ 8, 4, 40, 20 };
+    std::vector<uint8_t> expected = Staged(f, r, 2, ScaleKernel::Scalar);
+    const int ow = 64, oh = 32, stride = 80;
+    std::vector<uint8_t> dst((size_t)stride * oh, 0xCD);
+    OcrPrep prep;
+    ASSERT_TRUE(prep.Run(f.data.data(), f.w, f.h, f.stride, r, 2, dst.data(), stride));
+    for (int y = 0; y < oh; y++) {
+        EXPECT_EQ(0, memcmp(dst.data() + y * stride, expected.data() + y * ow, ow));
+        EXPECT_EQ(dst[y * stride + ow], 0xCD);   // padding untouched
+    }
+}
+
+TEST(OcrPrep, ClipsRectToFrame) {
+    Frame f(50, 40, 0, 5);
+    int ow = 0, oh = 0;
+    ASSERT_TRUE(OcrPrep::OutputSize(f.w, f.h, { -10, -5, 20, 100 }, 2, ow, oh));
+    EXPECT_EQ(ow, 40);
+    EXPECT_EQ(oh, 80);
+    EXPECT_FALSE(OcrPrep::OutputSize(f.w, f.h, { 60, 0, 70, 10 }, 2, ow, oh));
+    EXPECT_FALSE(OcrPrep::OutputSize(f.w, f.h, { 10, 10, 10, 20 }, 2, ow, oh));
+
+    OcrPrep prep;
+    BufferPool::Buffer out;
+    ASSERT_TRUE(prep.Run(f.data.data(), f.w, f.h, f.stride, { -10, -5, 20, 100 }, 2, out, ow, oh));
+    std::vector<uint8_t> expected = Staged(f, { 0, 0, 20, 40 }, 2, ScaleKernel::Auto);
+    EXPECT_EQ(0, memcmp(out.Data(), expected.data(), expected.size()));
+}
+
+TEST(OcrPrep, ThreadPoolMatchesSerial) {
+    Frame f(301, 157, 8, 5);
+    ThreadPool one(1), four(4);
+    OcrPrep serial(&one), parallel(&four, 3);
+    for (int factor : { 1, 2, 4 }) {
+        const PixelRect r = { 7, 3, 290, 150 };
+        int ow, oh;
+        ASSERT_TRUE(OcrPrep::OutputSize(f.w, f.h, r, factor, ow, oh));
+        std::vector<uint8_t> a((size_t)ow * oh), b(a.size());
+        ASSERT_TRUE(serial.Run(f.data.data(), f.w, f.h, f.stride, r, factor, a.data(), ow));
+        ASSERT_TRUE(parallel.Run(f.data.data(), f.w, f.h, f.stride, r, factor, b.data(), ow));
+        EXPECT_EQ(a, b) << "factor " << factor;
+    }
+}
+
+TEST(OcrPrep, PoolStopsAllocatingAfterWarmUp) {
+    Frame f(320, 180, 0, 9);
+    OcrPrep prep;
+    auto runOnce = [&](PixelRect r, int factor) {
+        BufferPool::Buffer out;
+        int ow, oh;
+        ASSERT_TRUE(prep.Run(f.data.data(), f.w, f.h, f.stride, r, factor, out, ow, oh));
+    };
+    runOnce({ 0, 0, 90, 30 }, 4);
+    runOnce({ 10, 10, 300, 170 }, 2);
+    size_t allocations = prep.Pool().Allocations();
+    size_t held = prep.Pool().BytesHeld();
+    for (int i = 0; i < 20; i++) {
+        runOnce({ 0, 0, 90, 30 }, 4);
+        runOnce({ 10, 10, 300, 170 }, 2);
+        runOnce({ 5, 5, 50, 25 }, 4);
+    }
+    EXPECT_EQ(prep.Pool().Allocations(), allocations);
+    EXPECT_EQ(prep.Pool().BytesHeld(), held);
+}
@@ -0,0 +1,64 @@
+// PatternCodeTest.cpp - Packing patterns and reading them back like the firmware.
+
+#include "PatternCode.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+TEST(PatternCode, EveryPatternRoundTrips) {
+    std::vector<uint8_t> all(256);
+    for (int i = 0; i < 256; i++) all[i] = (uint8_t)i;
+    std::string packed;
+    PackPatterns(all.data(), all.size(), packed);
+    EXPECT_EQ(packed.size(), PackedSize(all.data(), all.size()));
+    for (char c : packed) ASSERT_TRUE(c >= '0' && c <= 'o');
+
+    size_t pos = 0;
+    std::vector<uint8_t> back;
+    ASSERT_TRUE(UnpackPatterns(packed, pos, all.size(), back));
+    EXPECT_EQ(back, all);
+    EXPECT_EQ(pos, packed.size());
+}
+
+TEST(PatternCode, RunsFollowEachOtherAndBadInputFails) {
+    std::mt19937 rng(3);
+    std::vector<uint8_t> a(17), b(9);
+    for (uint8_t& p : a) p = (uint8_t)rng();
+    for (uint8_t& p : b) p = (uint8_t)(rng() & 0x3F);
+    std::string text;
+    PackPatterns(a.data(), a.size(), text);
+    size_t split = text.size();
+    PackPatterns(b.data(), b.size(), text);
+    text += "!";
+
+    size_t pos = 0;
+    std::vector<uint8_t> outA, outB;
+    ASSERT_TRUE(UnpackPatterns(text, pos, a.size(), outA));
+    EXPECT_EQ(pos, split);   // padding bits end with the character
+    ASSERT_TRUE(UnpackPatterns(text, pos, b.size(), outB));
+    EXPECT_EQ(outA, a);
+    EXPECT_EQ(outB, b);
+    EXPECT_EQ(text[pos], '!');
+
+    std::vector<uint8_t> out;
+    pos = 0;
+    EXPECT_FALSE(UnpackPatterns("0\\n", pos, 8, out));
+    pos = 0;
+    EXPECT_FALSE(UnpackPatterns("", pos, 1, out));
+}
+
+TEST(PatternCode, TextTakesUnderOneCharacterPerCell) {
+    // Grade 1 letters and spaces, as braille/tools/bdoc.py lays them out, in
+    // the F: bit order (dots 1-3, 7, 4-6, 8) the code is trained in
+    const uint8_t letters[26] = { 0x01, 0x03, 0x11, 0x31, 0x21, 0x13, 0x33, 0x23, 0x12, 0x32, 0x05, 0x07, 0x15,
+                                  0x35, 0x25, 0x17, 0x37, 0x27, 0x16, 0x36, 0x45, 0x47, 0x72, 0x55, 0x75, 0x65 };
+    const std::string text = "a refreshable braille display raises pins to show one line of text at a time "
+                             "and the reader moves along it with a finger";
+    std::vector<uint8_t> cells;
+    for (char c : text) cells.push_back(c == ' ' ? 0 : letters[c - 'a']);
+    EXPECT_LT(PackedSize(cells.data(), cells.size()), cells.size());
+    EXPECT_EQ(PatternCodeVersion(), 2);
+}
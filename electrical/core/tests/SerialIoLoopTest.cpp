@@ -0,0 +1,209 @@
+// SerialIoLoopTest.cpp - Ports sharing one SerialIoLoop thread over Linux
+// pty pairs: closing ports from callbacks, the EPOLLOUT backlog path and
+// one port's trouble staying with that port.
+
+#include "SerialIoLoop.h"
+#include "SerialPort.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+
+class PtyPair {
+public:
+    PtyPair() {
+        master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) return;
+        slavePath = ptsname(master);
+    }
+    ~PtyPair() { Unplug(); }
+
+    void Send(const std::string& s) const {
+        ASSERT_EQ((ssize_t)s.size(), write(master, s.data(), s.size()));
+    }
+
+    // Reads until `count` bytes arrived or the timeout passed
+    std::string Receive(size_t count, int timeoutMs = 2000) const {
+        std::string out;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (out.size() < count && std::chrono::steady_clock::now() < deadline) {
+            pollfd p = { master, POLLIN, 0 };
+            if (poll(&p, 1, 50) <= 0) continue;
+            char buf[4096];
+            ssize_t n = read(master, buf, std::min(sizeof(buf), count - out.size()));
+            if (n > 0) out.append(buf, (size_t)n);
+        }
+        return out;
+    }
+
+    void Unplug() {
+        if (master >= 0) close(master);
+        master = -1;
+    }
+
+    int master = -1;
+    std::string slavePath;
+};
+
+template <typename T>
+class Inbox {
+public:
+    void Push(T v) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_items.push_back(std::move(v));
+        m_changed.notify_all();
+    }
+    std::vector<T> WaitFor(size_t count, int timeoutMs = 2000) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_changed.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                           [&] { return m_items.size() >= count; });
+        return m_items;
+    }
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::vector<T> m_items;
+};
+
+// Distinct bytes per chunk and position, so reordering or loss shows
+std::string Payload(size_t size, char first) {
+    std::string s(size, ' ');
+    for (size_t i = 0; i < size; i++) s[i] = (char)('a' + (first - 'a' + i / 7) % 26);
+    return s;
+}
+
+} // namespace
+
+TEST(SerialIoLoopTest, PortsCloseFromTheirOwnAndEachOthersCallbacks) {
+    SerialIoLoop loop;   // one thread: every callback below runs on it
+    SerialOptions options;
+    options.loop = &loop;
+
+    // Repeated so the closing line and the victim's data often land in
+    // the same epoll batch
+    for (int round = 0; round < 20; round++) {
+        PtyPair ptyA, ptyB, ptyC;
+        SerialPort a, b, c;
+        Inbox<std::string> linesA, linesB;
+        a.SetLineCallback([&](const std::string& line) {
+            if (line == "BYE") a.Close();
+            if (line == "KILL") c.Close();
+            linesA.Push(line);
+        });
+        b.SetLineCallback([&](const std::string& line) { linesB.Push(line); });
+        std::string err;
+        ASSERT_TRUE(a.Open(ptyA.slavePath, options, err)) << err;
+        ASSERT_TRUE(b.Open(ptyB.slavePath, options, err)) << err;
+        ASSERT_TRUE(c.Open(ptyC.slavePath, options, err)) << err;
+        ASSERT_EQ(3u, loop.Ports());
+
+        ptyC.Send("C1\nC2\nC3\n");
+        ptyA.Send("KILL\n");
+        ptyB.Send("B1\n");
+        ptyA.Send("BYE\n");
+        ASSERT_EQ(2u, linesA.WaitFor(2).size());
+        EXPECT_FALSE(a.IsOpen());
+        EXPECT_FALSE(c.IsOpen());
+
+        // The survivor is still served, in both directions
+        ASSERT_EQ(1u, linesB.WaitFor(1).size());
+        EXPECT_TRUE(b.Write("PING\n"));
+        EXPECT_EQ("PING\n", ptyB.Receive(5));
+        ptyB.Send("PONG\n");
+        EXPECT_EQ("PONG", linesB.WaitFor(2).back());
+        EXPECT_EQ(1u, loop.Ports());
+        b.Close();
+        EXPECT_EQ(0u, loop.Ports());
+    }
+}
+
+TEST(SerialIoLoopTest, BacklogDrainsInOrderWhileOtherPortsRun) {
+    SerialIoLoop loop;
+    SerialOptions options;
+    options.loop = &loop;
+
+    PtyPair slow, fast;
+    SerialPort a, b;
+    Inbox<std::string> linesB;
+    b.SetLineCallback([&](const std::string& line) { linesB.Push(line); });
+    std::string err;
+    ASSERT_TRUE(a.Open(slow.slavePath, options, err)) << err;
+    ASSERT_TRUE(b.Open(fast.slavePath, options, err)) << err;
+
+    // Far more than the pty holds: the loop writes what fits and waits
+    // for EPOLLOUT on this port
+    std::string expected;
+    for (char first : { 'a', 'h', 'q' }) {
+        std::string chunk = Payload(192 * 1024, first);
+        ASSERT_TRUE(a.Write(chunk));
+        expected += chunk;
+    }
+    EXPECT_FALSE(a.Flush(200));
+    EXPECT_LT(a.BytesWritten(), expected.size());
+
+    // The same thread keeps serving the other port meanwhile
+    for (int i = 0; i < 5; i++) {
+        std::string cmd = "P:0" + std::to_string(i) + "\n";
+        ASSERT_TRUE(b.Write(cmd));
+        EXPECT_EQ(cmd, fast.Receive(cmd.size()));
+        fast.Send("OK\r\n");
+        EXPECT_EQ((size_t)i + 1, linesB.WaitFor((size_t)i + 1).size());
+    }
+
+    // The device reads; the backlog follows in order and nothing is lost
+    std::string got = slow.Receive(expected.size(), 10000);
+    ASSERT_EQ(expected.size(), got.size());
+    EXPECT_TRUE(got == expected);
+    EXPECT_TRUE(a.Flush(2000));
+    EXPECT_EQ(expected.size(), a.BytesWritten());
+
+    // Drained: ordinary writes go straight out again
+    ASSERT_TRUE(a.Write("CLEAR\n"));
+    EXPECT_EQ("CLEAR\n", slow.Receive(6));
+    a.Close();
+    b.Close();
+}
+
+TEST(SerialIoLoopTest, UnpluggedPortFailsAlone) {
+    SerialIoLoop loop;
+    SerialOptions options;
+    options.loop = &loop;
+
+    PtyPair gone, kept;
+    SerialPort a, b;
+    Inbox<std::string> errors;
+    Inbox<std::string> linesB;
+    a.SetErrorCallback([&](const std::string& m) { errors.Push(m); });
+    b.SetErrorCallback([&](const std::string& m) { errors.Push("b: " + m); });
+    b.SetLineCallback([&](const std::string& line) { linesB.Push(line); });
+    std::string err;
+    ASSERT_TRUE(a.Open(gone.slavePath, options, err)) << err;
+    ASSERT_TRUE(b.Open(kept.slavePath, options, err)) << err;
+
+    gone.Unplug();
+    std::vector<std::string> got = errors.WaitFor(1);
+    ASSERT_EQ(1u, got.size());
+    EXPECT_NE(std::string::npos, got[0].find("Read failed"));
+
+    ASSERT_TRUE(b.Write("PING\n"));
+    EXPECT_EQ("PING\n", kept.Receive(5));
+    kept.Send("PONG\n");
+    EXPECT_EQ(1u, linesB.WaitFor(1).size());
+    EXPECT_EQ(1u, errors.WaitFor(2, 100).size());
+
+    a.Close();
+    EXPECT_EQ(1u, loop.Ports());
+    b.Close();
+}
@@ -0,0 +1,287 @@
+// SerialPortTest.cpp - SerialPort end to end over a Linux pty pair. The
+// test holds the master side and plays the board; SerialPort opens the
+// slave as if it were /dev/ttyACM0.
+
+#include "SerialIoLoop.h"
+#include "SerialPort.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+
+class PtyPair {
+public:
+    PtyPair() {
+        master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) return;
+        slavePath = ptsname(master);
+    }
+    ~PtyPair() { if (master >= 0) close(master); }
+
+    void Send(const std::string& s) const {
+        ASSERT_EQ((ssize_t)s.size(), write(master, s.data(), s.size()));
+    }
+
+    // Reads until `count` bytes arrived or the timeout passed
+    std::string Receive(size_t count, int timeoutMs = 2000) const {
+        std::string out;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (out.size() < count && std::chrono::steady_clock::now() < deadline) {
+            pollfd p = { master, POLLIN, 0 };
+            if (poll(&p, 1, 50) <= 0) continue;
+            char buf[4096];
+            ssize_t n = read(master, buf, std::min(sizeof(buf), count - out.size()));
+            if (n > 0) out.append(buf, (size_t)n);
+        }
+        return out;
+    }
+
+    int master = -1;
+    std::string slavePath;
+};
+
+// Collects callback output from the reader thread
+template <typename T>
+class Inbox {
+public:
+    void Push(T v) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_items.push_back(std::move(v));
+        m_changed.notify_all();
+    }
+    std::vector<T> WaitFor(size_t count, int timeoutMs = 2000) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_changed.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                           [&] { return m_items.size() >= count; });
+        return m_items;
+    }
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::vector<T> m_items;
+};
+
+} // namespace
+
+TEST(SerialPortTest, WritesReachTheDevice) {
+    PtyPair pty;
+    ASSERT_FALSE(pty.slavePath.empty());
+
+    SerialPort port;
+    std::string err;
+    ASSERT_TRUE(port.Open(pty.slavePath, SerialOptions(), err)) << err;
+    EXPECT_TRUE(port.Write("P:FF\n"));
+    EXPECT_TRUE(port.Write("CLEAR\n"));
+    EXPECT_TRUE(port.Flush(2000));
+
+    EXPECT_EQ("P:FF\nCLEAR\n", pty.Receive(11));
+    EXPECT_EQ(11u, port.BytesWritten());
+}
+
+TEST(SerialPortTest, SplitsLinesAndStripsCarriageReturns) {
+    PtyPair pty;
+    Inbox<std::string> lines;
+
+    SerialPort port;
+    port.SetLineCallback([&](const std::string& line) { lines.Push(line); });
+    std::string err;
+    ASSERT_TRUE(port.Open(pty.slavePath, SerialOptions(), err)) << err;
+
+    pty.Send("BRAILLE_LED_READY\r\nPO");
+    pty.Send("NG\r\n\nOK\n");
+
+    std::vector<std::string> got = lines.WaitFor(4);
+    ASSERT_EQ(4u, got.size());
+    EXPECT_EQ("BRAILLE_LED_READY", got[0]);
+    EXPECT_EQ("PONG", got[1]);
+    EXPECT_EQ("", got[2]);
+    EXPECT_EQ("OK", got[3]);
+}
+
+TEST(SerialPortTest, DeliversFixedSizeFrames) {
+    PtyPair pty;
+    Inbox<std::string> frames;
+
+    SerialPort port;
+    port.SetFrameCallback(8, [&](const uint8_t* f, size_t n) {
+        frames.Push(std::string(reinterpret_cast<const char*>(f), n));
+    });
+    std::string err;
+    ASSERT_TRUE(port.Open(pty.slavePath, SerialOptions(), err)) << err;
+
+    // The receiver sketch's fixed 8-byte replies, split across writes
+    pty.Send("ACK:00\r\nER");
+    pty.Send("R:02\r\nACK:");
+
+    std::vector<std::string> got = frames.WaitFor(2);
+    ASSERT_EQ(2u, got.size());
+    EXPECT_EQ("ACK:00\r\n", got[0]);
+    EXPECT_EQ("ERR:02\r\n", got[1]);
+}
+
+TEST(SerialPortTest, LongLinesAreDeliveredInPieces) {
+    PtyPair pty;
+    Inbox<std::string> lines;
+
+    SerialOptions options;
+    options.maxLineLength = 4;
+    SerialPort port;
+    port.SetLineCallback([&](const std::string& line) { lines.Push(line); });
+    std::string err;
+    ASSERT_TRUE(port.Open(pty.slavePath, options, err)) << err;
+
+    pty.Send("abcdefg\n");
+    std::vector<std::string> got = lines.WaitFor(2);
+    ASSERT_EQ(2u, got.size());
+    EXPECT_EQ("abcd", got[0]);
+    EXPECT_EQ("efg", got[1]);
+}
+
+TEST(SerialPortTest, QueueIsBoundedWhileTheDeviceStalls) {
+    PtyPair pty;
+    SerialOptions options;
+    options.maxQueuedWrites = 2;
+
+    SerialPort port;
+    std::string err;
+    ASSERT_TRUE(port.Open(pty.slavePath, options, err)) << err;
+
+    // Nobody reads the master side, so the pty buffer fills and the writer
+    // thread blocks on its current item; two more fit in the queue.
+    const std::string chunk(256 * 1024, 'x');
+    int accepted = 0;
+    while (accepted < 10 && port.Write(chunk)) accepted++;
+    EXPECT_GE(accepted, 2);
+    EXPECT_LE(accepted, 3);
+    EXPECT_FALSE(port.Flush(100));
+
+    // Close() must not hang behind the stalled write
+    auto start = std::chrono::steady_clock::now();
+    port.Close();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+    EXPECT_FALSE(port.Write("PING\n"));
+}
+
+TEST(SerialPortTest, RejectsUnsupportedBaud) {
+    PtyPair pty;
+    SerialOptions options;
+    options.baud = 12345;
+
+    SerialPort port;
+    std::string err;
+    EXPECT_FALSE(port.Open(pty.slavePath, options, err));
+    EXPECT_NE(std::string::npos, err.find("12345"));
+    EXPECT_FALSE(port.IsOpen());
+}
+
+TEST(SerialPortTest, ReportsMissingDevice) {
+    SerialPort port;
+    std::string err;
+    EXPECT_FALSE(port.Open("/dev/does-not-exist", SerialOptions(), err));
+    EXPECT_FALSE(err.empty());
+}
+
+TEST(SerialPortTest, ReportsDisconnect) {
+    Inbox<std::string> errors;
+    SerialPort port;
+    port.SetErrorCallback([&](const std::string& m) { errors.Push(m); });
+    std::string err;
+    {
+        PtyPair pty;
+        ASSERT_TRUE(port.Open(pty.slavePath, SerialOptions(), err)) << err;
+    }
+    // Master closed: the board went away
+    std::vector<std::string> got = errors.WaitFor(1);
+    ASSERT_EQ(1u, got.size());
+    EXPECT_NE(std::string::npos, got[0].find("Read failed"));
+    port.Close();
+}
+
+TEST(SerialPortTest, PortsShareAnIoLoop) {
+    SerialIoLoop loop(2);
+    ASSERT_EQ(2, loop.Threads());
+    const int kPorts = 6;
+    std::vector<std::unique_ptr<PtyPair>> ptys;
+    std::vector<std::unique_ptr<SerialPort>> ports;
+    std::vector<std::unique_ptr<Inbox<std::string>>> lines;
+    SerialOptions options;
+    options.loop = &loop;
+    for (int i = 0; i < kPorts; i++) {
+        ptys.emplace_back(new PtyPair);
+        ports.emplace_back(new SerialPort);
+        lines.emplace_back(new Inbox<std::string>);
+        Inbox<std::string>* inbox = lines.back().get();
+        ports.back()->SetLineCallback([inbox](const std::string& line) { inbox->Push(line); });
+        std::string err;
+        ASSERT_TRUE(ports.back()->Open(ptys.back()->slavePath, options, err)) << err;
+    }
+    EXPECT_EQ((size_t)kPorts, loop.Ports());
+
+    for (int i = 0; i < kPorts; i++) {
+        EXPECT_TRUE(ports[i]->Write("P:0" + std::to_string(i) + "\n"));
+        ptys[i]->Send("OK " + std::to_string(i) + "\r\n");
+    }
+    for (int i = 0; i < kPorts; i++) {
+        EXPECT_TRUE(ports[i]->Flush(2000));
+        EXPECT_EQ("P:0" + std::to_string(i) + "\n", ptys[i]->Receive(5));
+        std::vector<std::string> got = lines[i]->WaitFor(1);
+        ASSERT_EQ(1u, got.size());
+        EXPECT_EQ("OK " + std::to_string(i), got[0]);
+    }
+
+    // A write larger than the pty buffer goes out in pieces as the device reads
+    const std::string big(200 * 1024, 'x');
+    ASSERT_TRUE(ports[0]->Write(big));
+    EXPECT_EQ(big.size(), ptys[0]->Receive(big.size(), 5000).size());
+    EXPECT_TRUE(ports[0]->Flush(2000));
+
+    for (auto& port : ports) port->Close();
+    EXPECT_EQ(0u, loop.Ports());
+}
+
+TEST(SerialPortTest, LoopPortClosesFromItsOwnCallbackAndWhileStalled) {
+    SerialIoLoop loop;
+    SerialOptions options;
+    options.loop = &loop;
+    options.maxQueuedWrites = 2;
+
+    // Nobody reads this one: its writes stall, and Close() must not hang
+    PtyPair stalled;
+    SerialPort a;
+    std::string err;
+    ASSERT_TRUE(a.Open(stalled.slavePath, options, err)) << err;
+    const std::string chunk(256 * 1024, 'x');
+    int accepted = 0;
+    while (accepted < 10 && a.Write(chunk)) accepted++;
+    EXPECT_LE(accepted, 3);
+
+    // The other port keeps working on the same thread, then closes itself
+    PtyPair pty;
+    SerialPort b;
+    Inbox<std::string> lines;
+    b.SetLineCallback([&](const std::string& line) {
+        lines.Push(line);
+        if (line == "BYE") b.Close();
+    });
+    ASSERT_TRUE(b.Open(pty.slavePath, options, err)) << err;
+    pty.Send("HELLO\nBYE\n");
+    EXPECT_EQ(2u, lines.WaitFor(2).size());
+
+    auto start = std::chrono::steady_clock::now();
+    a.Close();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+    EXPECT_FALSE(b.IsOpen());
+    EXPECT_FALSE(b.Write("PING\n"));
+}
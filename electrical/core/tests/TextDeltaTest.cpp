@@ -0,0 +1,211 @@
+// TextDeltaTest.cpp - Word diff, E: encoding and a model of the firmware.
+
+#include "TextDelta.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// What braille/src/main.cpp + TextBuffer do with the command lines.
+// peak: the longest the text got after any line.
+bool ApplyCommands(std::string& device, const std::string& commands, size_t maxLine, size_t capacity,
+                   size_t* peak = nullptr) {
+    std::istringstream in(commands);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.size() > maxLine || line.compare(0, 2, "E:") != 0) return false;
+        size_t comma = line.find(','), colon = line.find(':', comma);
+        size_t pos = std::stoul(line.substr(2, comma - 2), nullptr, 16);
+        size_t remove = std::stoul(line.substr(comma + 1, colon - comma - 1), nullptr, 16);
+        std::string text;
+        for (size_t i = colon + 1; i < line.size(); i++) {
+            char c = line[i];
+            if (c == '\\') {
+                c = line[++i];
+                c = c == 'n' ? '\n' : c == 'r' ? '\r' : c;
+            }
+            text.push_back(c);
+        }
+        if (pos > device.size()) return false;
+        remove = std::min(remove, device.size() - pos);
+        if (device.size() - remove + text.size() > capacity) return false;
+        device.replace(pos, remove, text);
+        if (peak) *peak = std::max(*peak, device.size());
+    }
+    return true;
+}
+
+std::string RandomWords(std::mt19937& rng, int words) {
+    static const char* vocab[] = { "the", "braille", "cell", "dots", "reads", "line", "a", "of",
+                                   "display", "text\n", "page", "\\path", "tab\there", "\xC3\xA9t\xC3\xA9" };
+    std::string s;
+    for (int i = 0; i < words; i++) {
+        if (i) s += ' ';
+        s += vocab[rng() % (sizeof(vocab) / sizeof(vocab[0]))];
+    }
+    return s;
+}
+
+} // namespace
+
+TEST(TextDelta, ChecksumMatchesFirmware) {
+    EXPECT_EQ(TextChecksum("123456789"), 0x29B1);
+    EXPECT_EQ(TextChecksum(""), 0xFFFF);
+    EXPECT_EQ(TextChecksum("hello world"), 0xEFEB);   // sim/scripts/text_delta.sim
+}
+
+TEST(TextDelta, DiffProducesWordEdits) {
+    std::vector<TextEdit> edits = DiffWords("the quick brown fox", "the slow brown fox jumps");
+    ASSERT_EQ(edits.size(), 2u);
+    EXPECT_EQ(edits[0].pos, 4u);
+    EXPECT_EQ(edits[0].remove, 5u);
+    EXPECT_EQ(edits[0].insert, "slow");
+    EXPECT_EQ(edits[1].pos, 18u);
+    EXPECT_EQ(edits[1].remove, 0u);
+    EXPECT_EQ(edits[1].insert, " jumps");
+
+    EXPECT_TRUE(DiffWords("same", "same").empty());
+}
+
+TEST(TextDelta, RandomEditsRoundTrip) {
+    std::mt19937 rng(3);
+    for (int iter = 0; iter < 300; iter++) {
+        std::string a = RandomWords(rng, (int)(rng() % 60));
+        std::string b = a;
+        for (int e = 0, n = (int)(rng() % 5); e < n; e++) {
+            size_t pos = b.empty() ? 0 : rng() % b.size();
+            size_t len = std::min<size_t>(rng() % 12, b.size() - pos);
+            b.replace(pos, len, RandomWords(rng, (int)(rng() % 3)));
+        }
+        for (size_t maxChanges : { (size_t)1024, (size_t)2 }) {
+            std::string applied = a;
+            ApplyEdits(applied, DiffWords(a, b, maxChanges));
+            ASSERT_EQ(applied, b) << "iteration " << iter;
+        }
+    }
+}
+
+TEST(TextDelta, MirrorKeepsDeviceInSync) {
+    TextDeltaOptions options;
+    options.capacity = 4096;
+    DeviceTextMirror mirror(options);
+    std::string device = "stale content";
+    std::mt19937 rng(5);
+    std::string text = RandomWords(rng, 200);
+
+    ASSERT_TRUE(ApplyCommands(device, mirror.Update(text), options.maxLineLength, options.capacity));
+    ASSERT_EQ(device, text);
+    for (int iter = 0; iter < 100; iter++) {
+        size_t pos = rng() % text.size();
+        text.replace(pos, std::min<size_t>(rng() % 20, text.size() - pos), RandomWords(rng, (int)(rng() % 4)));
+        ASSERT_TRUE(ApplyCommands(device, mirror.Update(text), options.maxLineLength, options.capacity));
+        ASSERT_EQ(device, text) << "iteration " << iter;
+        char sum[16];
+        snprintf(sum, sizeof(sum), "SUM:%04X,%04X", (unsigned)device.size(), (unsigned)TextChecksum(device));
+        EXPECT_EQ(mirror.ExpectedSum(), sum);
+    }
+}
+
+TEST(TextDelta, SmallEditCostsFewBytes) {
+    TextDeltaOptions options;
+    options.capacity = 100000;
+    DeviceTextMirror mirror(options);
+    std::mt19937 rng(9);
+    std::string text = RandomWords(rng, 5000);
+    std::string full = mirror.Update(text);
+
+    size_t pos = text.find(" cell ", text.size() / 2);
+    ASSERT_NE(pos, std::string::npos);
+    text.replace(pos + 1, 4, "cells");
+    std::string delta = mirror.Update(text);
+    EXPECT_LT(delta.size(), 24u) << delta;
+    EXPECT_GT(full.size(), 20000u);
+
+    EXPECT_TRUE(mirror.Update(text).empty());
+}
+
+TEST(TextDelta, ResetAndCapacity) {
+    TextDeltaOptions options;
+    options.capacity = 10;
+    DeviceTextMirror mirror(options);
+    std::string device;
+
+    // "\xC3\xA9" must not be cut in half at the capacity
+    ASSERT_TRUE(ApplyCommands(device, mirror.Update("abcdefghi\xC3\xA9xyz"), options.maxLineLength, options.capacity));
+    EXPECT_TRUE(mirror.Truncated());
+    EXPECT_EQ(device, "abcdefghi");
+
+    mirror.Reset();
+    EXPECT_FALSE(mirror.Synced());
+    std::string commands = mirror.Update("abc");
+    EXPECT_EQ(commands.compare(0, 9, "E:0,FFFF:"), 0);
+    device = "garbage!";
+    ASSERT_TRUE(ApplyCommands(device, commands, options.maxLineLength, options.capacity));
+    EXPECT_EQ(device, "abc");
+}
+
+TEST(TextDelta, LongInsertSplitsAcrossLines) {
+    TextDeltaOptions options;
+    options.capacity = 1000;
+    DeviceTextMirror mirror(options);
+    std::string text(300, 'x');
+    for (size_t i = 0; i < text.size(); i += 7) text[i] = '\n';
+    std::string commands = mirror.Update(text);
+    std::istringstream in(commands);
+    std::string line;
+    int lines = 0;
+    while (std::getline(in, line)) {
+        EXPECT_LE(line.size(), options.maxLineLength);
+        lines++;
+    }
+    EXPECT_GT(lines, 5);
+    std::string device;
+    ASSERT_TRUE(ApplyCommands(device, commands, options.maxLineLength, options.capacity));
+    EXPECT_EQ(device, text);
+}
+
+TEST(TextDelta, FullPageNeverPassesCapacityMidway) {
+    // A page of exactly TEXT_BUFFER_SIZE: a word grows near the start and
+    // a longer one shrinks near the end, so the result fits again
+    TextDeltaOptions options;
+    std::mt19937 rng(11);
+    std::string page = RandomWords(rng, 200).substr(0, options.capacity);
+    ASSERT_EQ(page.size(), options.capacity);
+
+    DeviceTextMirror mirror(options);
+    std::string device;
+    ASSERT_TRUE(ApplyCommands(device, mirror.Update(page), options.maxLineLength, options.capacity));
+
+    std::string next = page;
+    next.replace(next.size() - 40, 12, "x");
+    next.replace(20, 0, "inserted ");
+    next.insert(next.size() - 100, "ab");
+    ASSERT_EQ(next.size(), options.capacity);
+    std::string commands = mirror.Update(next);
+    EXPECT_NE(commands.compare(0, 9, "E:0,FFFF:"), 0) << "expected edits, not a full resend";
+    size_t peak = 0;
+    ASSERT_TRUE(ApplyCommands(device, commands, options.maxLineLength, options.capacity, &peak)) << commands;
+    EXPECT_EQ(device, next);
+    EXPECT_LE(peak, options.capacity);
+
+    // Random edits to full pages
+    for (int iter = 0; iter < 200; iter++) {
+        std::string text = mirror.Text();
+        for (int e = 0, n = 1 + (int)(rng() % 4); e < n; e++) {
+            size_t pos = rng() % text.size();
+            text.replace(pos, std::min<size_t>(rng() % 16, text.size() - pos), RandomWords(rng, (int)(rng() % 3)));
+        }
+        text = (text + RandomWords(rng, 20)).substr(0, options.capacity);
+        peak = 0;
+        ASSERT_TRUE(ApplyCommands(device, mirror.Update(text), options.maxLineLength, options.capacity, &peak))
+            << "iteration " << iter;
+        ASSERT_EQ(device, text) << "iteration " << iter;
+        ASSERT_LE(peak, options.capacity);
+    }
+}
@@ -0,0 +1,94 @@
+// TextNormalizeTest.cpp - Transliteration and the SIMD ASCII fast path.
+
+#include "TextNormalize.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+
+namespace {
+
+const ScaleKernel kKernels[] = { ScaleKernel::Scalar, ScaleKernel::Sse2, ScaleKernel::Avx2 };
+
+bool Supported(ScaleKernel k) { return ResolveScaleKernel(k) == k; }
+
+} // namespace
+
+TEST(TextNormalize, PlainAsciiIsCopied) {
+    BrailleNormalizer n;
+    std::string text = "The quick brown fox\tjumps\r\nover 13 lazy dogs! ~{}";
+    NormalizeStats s;
+    std::string out;
+    n.Normalize(text.data(), text.size(), out, &s);
+    EXPECT_EQ(out, text);
+    EXPECT_EQ(s.asciiBytes, text.size());
+}
+
+TEST(TextNormalize, ControlsAreDropped) {
+    BrailleNormalizer n;
+    EXPECT_EQ(n.Normalize(std::string("a\x01" "b\x7F" "c\x1B" "d\xC2\x85" "e", 10)), "abcde");
+}
+
+TEST(TextNormalize, PunctuationLigaturesAndAccents) {
+    BrailleNormalizer n;
+    EXPECT_EQ(n.Normalize("\xE2\x80\x9CHi\xE2\x80\x9D \xE2\x80\x94 it\xE2\x80\x99s \xEF\xAC\x81ne\xE2\x80\xA6"),
+              "\"Hi\" -- it's fine...");
+    EXPECT_EQ(n.Normalize("\xC3\xA9l\xC3\xA8ve na\xC3\xAFve Stra\xC3\x9F" "e \xC5\x81\xC3\xB3\x64\xC5\xBA"),
+              "eleve naive Strasse Lodz");
+    // Decomposed: e + combining acute
+    EXPECT_EQ(n.Normalize("cafe\xCC\x81"), "cafe");
+    EXPECT_EQ(n.Normalize("\xC2\xBD cup\xC2\xA0of \xE2\x82\xAC" "5"), "1/2 cup of EUR5");
+}
+
+TEST(TextNormalize, SymbolsFoldToAscii) {
+    BrailleNormalizer n;
+    EXPECT_EQ(n.Normalize("\xC2\xA9 \xC2\xA7" "3 \xE2\x80\xA2 2\xC3\x97" "4\xC3\xB7" "2 20\xC2\xB0"),
+              "(c) S3 * 2x4/2 20deg");
+
+    // The device has no decoder for Unicode braille, so it is not sent
+    NormalizeStats s;
+    std::string out;
+    std::string text = "\xE2\xA0\x81\xE2\xA3\xBF";   // U+2801, U+28FF
+    n.Normalize(text.data(), text.size(), out, &s);
+    EXPECT_EQ(out, "??");
+    EXPECT_EQ(s.unknown, 2u);
+}
+
+TEST(TextNormalize, UnknownAndInvalidUseTheReplacement) {
+    BrailleNormalizer n("_");
+    NormalizeStats s;
+    std::string out;
+    std::string text = "a\xE4\xB8\xAD" "b\xFF" "c\xE2\x80" "d\xED\xA0\x80";   // CJK, bad byte, truncated, surrogate
+    n.Normalize(text.data(), text.size(), out, &s);
+    EXPECT_EQ(s.unknown, 1u);
+    EXPECT_EQ(out.substr(0, 4), "a_b_");
+    EXPECT_EQ(out.front(), 'a');
+    EXPECT_EQ(out.find_first_not_of("abcd_"), std::string::npos);
+    EXPECT_GE(s.invalid, 3u);
+}
+
+TEST(TextNormalize, KernelsAgree) {
+    const char* pieces[] = { "word ", "\xE2\x80\x99", "\xC3\xA9", "\n", "\x01", "\xEF\xAC\x81", "\xF0\x9F\x98\x80",
+                             "\xE2\xA0\x9B", "\xFF", "long plain ascii run of text " };
+    std::mt19937 rng(9);
+    std::string text;
+    for (int i = 0; i < 5000; i++) text += pieces[rng() % 10];
+
+    std::string expected;
+    BrailleNormalizer(std::string("?"), ScaleKernel::Scalar).Normalize(text.data(), text.size(), expected);
+    for (ScaleKernel k : kKernels) {
+        if (!Supported(k)) continue;
+        BrailleNormalizer n(std::string("?"), k);
+        std::string out;
+        n.Normalize(text.data(), text.size(), out);
+        EXPECT_EQ(out, expected) << "kernel " << (int)k;
+
+        // Fast-path stop position at every offset within a 32-byte block
+        for (size_t at = 0; at < 70; at++) {
+            std::string s(80, 'x');
+            s[at] = '\x80';
+            EXPECT_EQ(PlainAsciiPrefix(s.data(), s.size(), k), at) << "kernel " << (int)k;
+        }
+    }
+}
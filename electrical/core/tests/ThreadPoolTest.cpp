@@ -0,0 +1,121 @@
+// ThreadPoolTest.cpp - Tiling, stealing, nesting and concurrent callers.
+
+#include "ThreadPool.h"
+#include "ImageScale.h"
+#include "TileChangeDetector.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+TEST(ThreadPool, EveryIndexRunsOnceInGrainTiles) {
+    for (int threads : { 1, 2, 5 }) {
+        ThreadPool pool(threads);
+        for (int grain : { 0, 1, 7, 1000 }) {
+            std::vector<std::atomic<int>> hits(503);
+            std::atomic<int> badTiles{ 0 };
+            pool.ParallelFor(-3, 500, grain, [&](int b, int e) {
+                if (threads > 1 && grain > 0 && grain < 503 && e - b > grain) badTiles++;
+                for (int i = b; i < e; i++) hits[(size_t)(i + 3)]++;
+            });
+            for (auto& h : hits) ASSERT_EQ(h.load(), 1) << threads << " threads, grain " << grain;
+            EXPECT_EQ(badTiles.load(), 0);
+        }
+    }
+}
+
+TEST(ThreadPool, SerialPoolRunsOnTheCaller) {
+    ThreadPool pool(1);
+    EXPECT_EQ(pool.Threads(), 1);
+    int calls = 0;
+    std::thread::id runner;
+    pool.ParallelFor(0, 10000, 16, [&](int b, int e) {
+        calls++;
+        runner = std::this_thread::get_id();
+        EXPECT_EQ(b, 0);
+        EXPECT_EQ(e, 10000);
+    });
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(runner, std::this_thread::get_id());
+    pool.ParallelFor(5, 5, 1, [&](int, int) { calls++; });
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(ThreadPool, IdleThreadsStealFromSlowBlocks) {
+    // The first block is far more expensive; the other threads finish
+    // their own blocks and take tiles from it
+    ThreadPool pool(4);
+    std::atomic<int> done{ 0 };
+    pool.ParallelFor(0, 64, 1, [&](int b, int) {
+        if (b < 16) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        done++;
+    });
+    EXPECT_EQ(done.load(), 64);
+    EXPECT_GT(pool.Steals(), 0u);
+}
+
+TEST(ThreadPool, NestedCallsRunInline) {
+    ThreadPool pool(3);
+    std::atomic<int> inner{ 0 };
+    pool.ParallelFor(0, 12, 1, [&](int, int) {
+        pool.ParallelFor(0, 100, 1, [&](int b, int e) { inner += e - b; });
+    });
+    EXPECT_EQ(inner.load(), 1200);
+}
+
+TEST(ThreadPool, ConcurrentCallersShareThePool) {
+    ThreadPool pool(3);
+    std::vector<std::thread> callers;
+    std::vector<long long> sums(4, 0);
+    for (int c = 0; c < 4; c++) {
+        callers.emplace_back([&, c] {
+            for (int round = 0; round < 50; round++) {
+                std::atomic<long long> sum{ 0 };
+                pool.ParallelFor(0, 1000, 10, [&](int b, int e) {
+                    long long s = 0;
+                    for (int i = b; i < e; i++) s += i;
+                    sum += s;
+                });
+                sums[(size_t)c] += sum.load();
+            }
+        });
+    }
+    for (auto& t : callers) t.join();
+    for (long long s : sums) EXPECT_EQ(s, 50LL * 999 * 1000 / 2);
+}
+
+TEST(ThreadPool, ImageKernelsMatchSerial) {
+    const int w = 211, h = 173;
+    std::vector<uint8_t> src((size_t)w * h * 4);
+    std::mt19937 rng(3);
+    for (auto& b : src) b = (uint8_t)(rng() & 0xFF);
+
+    ThreadPool one(1), four(4);
+    std::vector<uint8_t> a((size_t)w * 3 * h * 2 * 4), b(a.size());
+    ASSERT_TRUE(ResizeBilinearBgra(src.data(), w, h, w * 4, a.data(), w * 3, h * 2, w * 12, ScaleKernel::Auto, &one));
+    ASSERT_TRUE(ResizeBilinearBgra(src.data(), w, h, w * 4, b.data(), w * 3, h * 2, w * 12, ScaleKernel::Auto, &four, 5));
+    EXPECT_EQ(a, b);
+
+    TileDiffOptions serial, parallel;
+    serial.pool = &one;
+    parallel.pool = &four;
+    parallel.grainTileRows = 1;
+    TileChangeDetector ds(serial), dp(parallel);
+    std::vector<PixelRect> bs, bp;
+    ds.Update(src.data(), w, h, w * 4, bs);
+    dp.Update(src.data(), w, h, w * 4, bp);
+    for (int i = 0; i < 40; i++) src[(size_t)(rng() % (w * h)) * 4] ^= 0x55;
+    EXPECT_EQ(ds.Update(src.data(), w, h, w * 4, bs), dp.Update(src.data(), w, h, w * 4, bp));
+    EXPECT_EQ(ds.DirtyTiles(), dp.DirtyTiles());
+    ASSERT_EQ(bs.size(), bp.size());
+    for (size_t i = 0; i < bs.size(); i++) {
+        EXPECT_EQ(bs[i].top, bp[i].top);
+        EXPECT_EQ(bs[i].bottom, bp[i].bottom);
+        EXPECT_EQ(bs[i].left, bp[i].left);
+        EXPECT_EQ(bs[i].right, bp[i].right);
+    }
+}
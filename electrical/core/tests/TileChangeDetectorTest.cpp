@@ -0,0 +1,131 @@
+// TileChangeDetectorTest.cpp - Dirty tiles and band merging.
+
+#include "TileChangeDetector.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Frame {
+    int w, h;
+    ptrdiff_t stride;
+    std::vector<uint8_t> data;
+
+    Frame(int w_, int h_, int padding = 0)
+        : w(w_), h(h_), stride((ptrdiff_t)w_ * 4 + padding), data((size_t)stride * h_) {
+        std::mt19937 rng(11);
+        for (auto& b : data) b = (uint8_t)(rng() & 0xFF);
+    }
+
+    void Touch(int x, int y) { data[(size_t)y * stride + x * 4 + 1] ^= 0x40; }
+};
+
+TileDiffOptions NoPadding() {
+    TileDiffOptions o;
+    o.tileWidth = 16;
+    o.tileHeight = 8;
+    o.padTiles = 0;
+    o.mergeGapTiles = 0;
+    return o;
+}
+
+} // namespace
+
+TEST(TileChangeDetector, FirstFrameIsAllDirty) {
+    Frame f(100, 50);
+    TileChangeDetector det(NoPadding());
+    std::vector<PixelRect> bands;
+    EXPECT_EQ(det.Update(f.data.data(), f.w, f.h, f.stride, bands), 7u * 7u);
+    ASSERT_EQ(bands.size(), 1u);
+    EXPECT_EQ(bands[0].right, 100);
+    EXPECT_EQ(bands[0].bottom, 50);
+}
+
+TEST(TileChangeDetector, UnchangedFrameReportsNothing) {
+    Frame f(100, 50, 8);
+    TileChangeDetector det(NoPadding());
+    std::vector<PixelRect> bands;
+    det.Update(f.data.data(), f.w, f.h, f.stride, bands);
+    EXPECT_EQ(det.Update(f.data.data(), f.w, f.h, f.stride, bands), 0u);
+    EXPECT_TRUE(bands.empty());
+}
+
+TEST(TileChangeDetector, SinglePixelChangeMarksItsTile) {
+    const ScaleKernel kernels[] = { ScaleKernel::Scalar, ScaleKernel::Sse2, ScaleKernel::Avx2 };
+    for (ScaleKernel k : kernels) {
+        if (ResolveScaleKernel(k) != k) continue;
+        Frame f(100, 50);
+        TileChangeDetector det(NoPadding(), k);
+        std::vector<PixelRect> bands;
+        det.Update(f.data.data(), f.w, f.h, f.stride, bands);
+
+        f.Touch(99, 49);   // last pixel: partial tile in both directions
+        EXPECT_EQ(det.Update(f.data.data(), f.w, f.h, f.stride, bands), 1u) << (int)k;
+        ASSERT_EQ(bands.size(), 1u);
+        EXPECT_EQ(bands[0].left, 96);
+        EXPECT_EQ(bands[0].top, 48);
+        EXPECT_EQ(bands[0].right, 100);
+        EXPECT_EQ(bands[0].bottom, 50);
+        EXPECT_TRUE(det.DirtyTiles()[6 * 7 + 6]);
+
+        // The reference took the change: the same frame is clean again
+        EXPECT_EQ(det.Update(f.data.data(), f.w, f.h, f.stride, bands), 0u);
+    }
+}
+
+TEST(TileChangeDetector, MergesRowsIntoBands) {
+    Frame f(160, 80);
+    TileDiffOptions o = NoPadding();
+    o.mergeGapTiles = 1;
+    TileChangeDetector det(o);
+    std::vector<PixelRect> bands;
+    det.Update(f.data.data(), f.w, f.h, f.stride, bands);
+
+    f.Touch(5, 2);      // tile (0, 0)
+    f.Touch(70, 17);    // tile (4, 2): one clean row between, merged
+    f.Touch(150, 60);   // tile (9, 7): separate band
+    EXPECT_EQ(det.Update(f.data.data(), f.w, f.h, f.stride, bands), 3u);
+    ASSERT_EQ(bands.size(), 2u);
+    EXPECT_EQ(bands[0].left, 0);
+    EXPECT_EQ(bands[0].top, 0);
+    EXPECT_EQ(bands[0].right, 80);
+    EXPECT_EQ(bands[0].bottom, 24);
+    EXPECT_EQ(bands[1].left, 144);
+    EXPECT_EQ(bands[1].top, 56);
+    EXPECT_EQ(bands[1].right, 160);
+    EXPECT_EQ(bands[1].bottom, 64);
+}
+
+TEST(TileChangeDetector, PaddingAddsContextAndClips) {
+    Frame f(160, 80);
+    TileDiffOptions o = NoPadding();
+    o.padTiles = 1;
+    TileChangeDetector det(o);
+    std::vector<PixelRect> bands;
+    det.Update(f.data.data(), f.w, f.h, f.stride, bands);
+
+    f.Touch(20, 3);     // tile (1, 0)
+    det.Update(f.data.data(), f.w, f.h, f.stride, bands);
+    ASSERT_EQ(bands.size(), 1u);
+    EXPECT_EQ(bands[0].left, 0);
+    EXPECT_EQ(bands[0].top, 0);
+    EXPECT_EQ(bands[0].right, 48);
+    EXPECT_EQ(bands[0].bottom, 16);
+}
+
+TEST(TileChangeDetector, SizeChangeResets) {
+    Frame a(100, 50), b(120, 50);
+    TileChangeDetector det(NoPadding());
+    std::vector<PixelRect> bands;
+    det.Update(a.data.data(), a.w, a.h, a.stride, bands);
+    det.Update(b.data.data(), b.w, b.h, b.stride, bands);
+    ASSERT_EQ(bands.size(), 1u);
+    EXPECT_EQ(bands[0].right, 120);
+    EXPECT_EQ(det.TilesX(), 8);
+
+    det.Reset();
+    EXPECT_EQ(det.Update(b.data.data(), b.w, b.h, b.stride, bands), 8u * 7u);
+}
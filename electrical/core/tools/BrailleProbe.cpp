@@ -0,0 +1,166 @@
+// BrailleProbe.cpp - braille-probe: where the time between sending a
+// pattern and the dots moving goes.
+//
+//   braille-probe [options]
+//
+// Needs a firmware built with -DBRAILLE_PROBE (PlatformIO [env:uno_probe],
+// or braille_pty). Sends T: frames one at a time, each stamped with the
+// host clock and raising or lowering all eight dots; the firmware echoes
+// micros() at receive, parse and pin write. LatencyProbe aligns the two
+// clocks and the tool prints p50/p99/p99.9 of each stage: host write, USB
+// and UART up to the '\n' (send->rx), parsing, the pin writes, the reply
+// back, and send->pin, the delay a user feels. --csv keeps every sample.
+
+#include "LatencyProbe.h"
+#include "SerialPort.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace {
+
+struct Args {
+    std::string port = "/dev/ttyACM0";
+    uint32_t baud = 115200;        // braille/src/main.cpp: Serial.begin(115200)
+    long count = 5000;
+    int intervalMs = 0;
+    int timeoutMs = 1000;
+    int readyTimeoutMs = 3000;
+    std::string csv;
+};
+
+void Usage() {
+    std::fprintf(stderr,
+                 "usage: braille-probe [options]\n"
+                 "  -p, --port PATH        serial device (default /dev/ttyACM0)\n"
+                 "  -b, --baud N           baud rate (default 115200)\n"
+                 "  -n, --count N          frames to send (default 5000)\n"
+                 "  --interval MS          start frames MS apart (default 0: when the last is answered)\n"
+                 "  --timeout MS           a frame unanswered this long is lost (default 1000)\n"
+                 "  --ready-timeout MS     wait for BRAILLE_LED_READY after opening (default 3000, 0: don't)\n"
+                 "  --csv FILE             write every sample and its stages to FILE\n"
+                 "The firmware must be built with -DBRAILLE_PROBE ([env:uno_probe]).\n");
+}
+
+bool ParseArgs(int argc, char** argv, Args& a) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&](long& out) {
+            if (i + 1 >= argc) return false;
+            char* end;
+            out = std::strtol(argv[++i], &end, 10);
+            return *end == '\0' && out >= 0;
+        };
+        long v = 0;
+        if ((arg == "-p" || arg == "--port") && i + 1 < argc) a.port = argv[++i];
+        else if (arg == "-b" || arg == "--baud") { if (!value(v) || v == 0) return false; a.baud = (uint32_t)v; }
+        else if (arg == "-n" || arg == "--count") { if (!value(a.count) || a.count == 0) return false; }
+        else if (arg == "--interval") { if (!value(v)) return false; a.intervalMs = (int)v; }
+        else if (arg == "--timeout") { if (!value(v) || v == 0) return false; a.timeoutMs = (int)v; }
+        else if (arg == "--ready-timeout") { if (!value(v)) return false; a.readyTimeoutMs = (int)v; }
+        else if (arg == "--csv" && i + 1 < argc) a.csv = argv[++i];
+        else return false;
+    }
+    return true;
+}
+
+uint64_t NowUs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args;
+    if (!ParseArgs(argc, argv, args)) { Usage(); return 2; }
+
+    LatencyProbeOptions probeOptions;
+    probeOptions.baud = args.baud;
+    LatencyProbe probe(probeOptions);
+
+    SerialPort port;
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool ready = false;
+    std::string rejected;
+    port.SetLineCallback([&](const std::string& line) {
+        // Stamped first: the reader thread is the closest the host gets
+        // to the moment the line arrived
+        const uint64_t now = NowUs();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (line == "BRAILLE_LED_READY") ready = true;
+        else if (!probe.OnLine(line, now) && line.compare(0, 4, "ERR:") == 0) rejected = line;
+        changed.notify_all();
+    });
+    port.SetErrorCallback([](const std::string& message) {
+        std::fprintf(stderr, "braille-probe: %s\n", message.c_str());
+    });
+
+    SerialOptions serialOptions;
+    serialOptions.baud = args.baud;
+    std::string err;
+    if (!port.Open(args.port, serialOptions, err)) {
+        std::fprintf(stderr, "braille-probe: %s\n", err.c_str());
+        return 1;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (args.readyTimeoutMs > 0 &&
+        !changed.wait_for(lock, std::chrono::milliseconds(args.readyTimeoutMs), [&] { return ready; }))
+        std::fprintf(stderr, "braille-probe: no BRAILLE_LED_READY from %s, sending anyway\n", args.port.c_str());
+
+    auto next = std::chrono::steady_clock::now();
+    long lost = 0;
+    for (long i = 0; i < args.count && rejected.empty(); i++) {
+        if (args.intervalMs > 0) {
+            lock.unlock();
+            std::this_thread::sleep_until(next);
+            next += std::chrono::milliseconds(args.intervalMs);
+            lock.lock();
+        }
+        const size_t answered = probe.Samples().size();
+        if (!port.Write(LatencyProbe::Frame(NowUs(), (i & 1) ? 0x00 : 0xFF))) {
+            std::fprintf(stderr, "braille-probe: write failed\n");
+            break;
+        }
+        if (!changed.wait_for(lock, std::chrono::milliseconds(args.timeoutMs),
+                              [&] { return probe.Samples().size() > answered || !rejected.empty(); }))
+            lost++;
+    }
+    lock.unlock();
+    port.Close();
+
+    if (!rejected.empty()) {
+        std::fprintf(stderr, "braille-probe: the device answered \"%s\"; is it built with -DBRAILLE_PROBE?\n",
+                     rejected.c_str());
+        return 1;
+    }
+    if (probe.Samples().empty()) {
+        std::fprintf(stderr, "braille-probe: no frame was answered\n");
+        return 1;
+    }
+
+    const ProbeAnalysis r = probe.Analyze();
+    std::printf("%zu frames answered, %ld lost, %u baud\n", probe.Samples().size(), lost, args.baud);
+    std::printf("clock: device drift %+.1f ppm, alignment within %.0f us\n", r.driftPpm, r.uncertaintyUs);
+    std::printf("%-12s %9s %9s %9s %9s\n", "stage us", "p50", "p99", "p99.9", "max");
+    for (const ProbeStage& stage : r.stages)
+        std::printf("%-12s %9.0f %9.0f %9.0f %9.0f\n", stage.name, LatencyProbe::Percentile(stage.us, 0.5),
+                    LatencyProbe::Percentile(stage.us, 0.99), LatencyProbe::Percentile(stage.us, 0.999),
+                    LatencyProbe::Percentile(stage.us, 1.0));
+
+    if (!args.csv.empty()) {
+        if (!probe.WriteCsv(args.csv, err)) {
+            std::fprintf(stderr, "braille-probe: %s\n", err.c_str());
+            return 1;
+        }
+        std::printf("samples written to %s\n", args.csv.c_str());
+    }
+    return lost == 0 ? 0 : 1;
+}
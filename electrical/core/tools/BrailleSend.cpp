@@ -0,0 +1,269 @@
+// BrailleSend.cpp - braille-send: streams text files or stdin to the display.
+//
+//   braille-send [options] [FILE...]      (no FILE, or "-", reads stdin)
+//
+// The headless counterpart of driver.cpp's Open/Send path, for Linux lab
+// machines: files are memory-mapped and read a page at a time
+// (DocumentSource), text is normalized to what the braille tables know
+// (TextNormalize), cut into pages of the device's text buffer size and
+// sent as pipelined E: edits (DeviceLink) without waiting for each reply.
+// Repeat -p to send the same text to several displays at once (DeviceFleet:
+// per-device queues and replies, I/O on --io-threads epoll threads).
+// Prints sustained cells per second and per-line reply latency. Works
+// against any tty, including a pty played by an emulator.
+
+#include "DeviceFleet.h"
+#include "DocumentSource.h"
+#include "TextNormalize.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Args {
+    std::vector<std::string> ports;   // none: /dev/ttyACM0
+    int ioThreads = 1;
+    uint32_t baud = 115200;        // braille/src/main.cpp: Serial.begin(115200)
+    size_t windowBytes = 256;
+    size_t pageBytes = 512;        // TEXT_BUFFER_SIZE
+    int dwellMs = 0;
+    int readyTimeoutMs = 3000;
+    bool quiet = false;
+    std::vector<std::string> files;
+};
+
+void Usage() {
+    std::fprintf(stderr,
+                 "usage: braille-send [options] [FILE...]\n"
+                 "  -p, --port PATH        serial device (default /dev/ttyACM0); repeat to send to several\n"
+                 "  --io-threads N         threads serving all ports (default 1)\n"
+                 "  -b, --baud N           baud rate (default 115200)\n"
+                 "  --window BYTES         unanswered bytes allowed on the wire (default 256)\n"
+                 "  --page BYTES           text per display page (default 512, the device buffer)\n"
+                 "  --dwell MS             wait after each page is answered (default 0: stream)\n"
+                 "  --ready-timeout MS     wait for BRAILLE_LED_READY after opening (default 3000, 0: don't)\n"
+                 "  -q, --quiet            only print the summary\n"
+                 "Reads stdin when no FILE (or \"-\") is given.\n");
+}
+
+bool ParseArgs(int argc, char** argv, Args& a) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&](long& out) {
+            if (i + 1 >= argc) return false;
+            char* end;
+            out = std::strtol(argv[++i], &end, 10);
+            return *end == '\0' && out >= 0;
+        };
+        long v = 0;
+        if ((arg == "-p" || arg == "--port") && i + 1 < argc) a.ports.push_back(argv[++i]);
+        else if (arg == "--io-threads") { if (!value(v) || v == 0) return false; a.ioThreads = (int)v; }
+        else if (arg == "-b" || arg == "--baud") { if (!value(v) || v == 0) return false; a.baud = (uint32_t)v; }
+        else if (arg == "--window") { if (!value(v) || v == 0) return false; a.windowBytes = (size_t)v; }
+        else if (arg == "--page") { if (!value(v) || v < 16) return false; a.pageBytes = (size_t)v; }
+        else if (arg == "--dwell") { if (!value(v)) return false; a.dwellMs = (int)v; }
+        else if (arg == "--ready-timeout") { if (!value(v)) return false; a.readyTimeoutMs = (int)v; }
+        else if (arg == "-q" || arg == "--quiet") a.quiet = true;
+        else if (arg == "-h" || arg == "--help") return false;
+        else if (arg.size() > 1 && arg[0] == '-') return false;
+        else a.files.push_back(arg);
+    }
+    if (a.files.empty()) a.files.push_back("-");
+    if (a.ports.empty()) a.ports.push_back("/dev/ttyACM0");
+    return true;
+}
+
+size_t CountCells(const std::string& text) {
+    size_t n = 0;
+    for (unsigned char c : text) n += (c & 0xC0) != 0x80;
+    return n;
+}
+
+// Length of the prefix that ends on a complete UTF-8 character
+size_t CompleteUtf8(const char* data, size_t size) {
+    for (size_t back = 1; back <= 4 && back <= size; back++) {
+        unsigned char c = (unsigned char)data[size - back];
+        if ((c & 0xC0) == 0x80) continue;
+        size_t len = c < 0x80 ? 1 : (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : (c & 0xF8) == 0xF0 ? 4 : 1;
+        return len > back ? size - back : size;
+    }
+    return size;
+}
+
+class Streamer {
+public:
+    Streamer(const Args& args, DeviceFleet& fleet) : m_args(args), m_fleet(fleet) {}
+
+    // Normalizes text and sends every full page it completes
+    bool Feed(const char* data, size_t size) {
+        m_normalizer.Normalize(data, size, m_carry);
+        size_t start = 0;
+        while (m_carry.size() - start > m_args.pageBytes) {
+            size_t cut = SnapPageBreak(m_carry.data() + start, m_args.pageBytes, 64);
+            if (!SendPage(m_carry.substr(start, cut))) return false;
+            start += cut;
+        }
+        m_carry.erase(0, start);
+        return true;
+    }
+
+    bool Finish() {
+        if (!m_carry.empty() && !SendPage(m_carry)) return false;
+        m_carry.clear();
+        return m_fleet.WaitIdle(10000);
+    }
+
+    size_t Pages() const { return m_pages; }
+    size_t Cells() const { return m_cells; }
+
+private:
+    bool SendPage(const std::string& page) {
+        // Stream: the next page is diffed and queued as soon as the previous
+        // one is on the wire of every display. With --dwell each page waits
+        // for its replies.
+        if (!m_fleet.WaitWritten(10000) || m_fleet.Broadcast(page) != m_fleet.Size()) return false;
+        m_pages++;
+        m_cells += CountCells(page);
+        if (m_args.dwellMs > 0) {
+            if (!m_fleet.WaitIdle(10000)) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(m_args.dwellMs));
+        }
+        if (!m_args.quiet) std::fprintf(stderr, "\rpage %zu", m_pages);
+        return true;
+    }
+
+    const Args& m_args;
+    DeviceFleet& m_fleet;
+    BrailleNormalizer m_normalizer;
+    std::string m_carry;
+    size_t m_pages = 0;
+    size_t m_cells = 0;
+};
+
+bool StreamFile(const std::string& path, Streamer& streamer) {
+    if (path == "-") {
+        std::vector<char> buf(1 << 16);
+        size_t have = 0;
+        for (;;) {
+            size_t n = std::fread(buf.data() + have, 1, buf.size() - have, stdin);
+            if (n == 0) break;
+            have += n;
+            size_t complete = CompleteUtf8(buf.data(), have);
+            if (!streamer.Feed(buf.data(), complete)) return false;
+            std::memmove(buf.data(), buf.data() + complete, have - complete);
+            have -= complete;
+        }
+        return streamer.Feed(buf.data(), have);
+    }
+
+    DocumentSource doc;
+    std::string err;
+    if (!doc.Open(path, err)) {
+        std::fprintf(stderr, "braille-send: %s\n", err.c_str());
+        return false;
+    }
+    for (size_t k = 0; k < doc.PageCount(); k++) {
+        std::string_view page = doc.Page(k);
+        if (!streamer.Feed(page.data(), page.size())) return false;
+    }
+    return true;
+}
+
+double Percentile(std::vector<double>& v, double p) {
+    if (v.empty()) return 0;
+    size_t i = (size_t)(p * (v.size() - 1) + 0.5);
+    std::nth_element(v.begin(), v.begin() + (ptrdiff_t)i, v.end());
+    return v[i];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args;
+    if (!ParseArgs(argc, argv, args)) { Usage(); return 2; }
+
+    DeviceFleetOptions fleetOptions;
+    fleetOptions.ioThreads = args.ioThreads;
+    fleetOptions.serial.baud = args.baud;
+    fleetOptions.link.windowBytes = args.windowBytes;
+    fleetOptions.link.delta.capacity = args.pageBytes;
+    DeviceFleet fleet(fleetOptions);
+
+    std::mutex readyMutex;
+    std::condition_variable readyChanged;
+    std::vector<bool> ready(args.ports.size(), false);
+    size_t readyCount = 0;
+    fleet.SetLineCallback([&](size_t device, const std::string& line) {
+        if (line == "BRAILLE_LED_READY") {
+            std::lock_guard<std::mutex> lock(readyMutex);
+            if (!ready[device]) readyCount++;
+            ready[device] = true;
+            readyChanged.notify_all();
+        }
+    });
+    fleet.SetErrorCallback([&](size_t device, const std::string& message) {
+        std::fprintf(stderr, "\nbraille-send: %s: %s\n", args.ports[device].c_str(), message.c_str());
+    });
+
+    for (const std::string& path : args.ports) {
+        std::string err;
+        if (fleet.Add(path, err) < 0) {
+            std::fprintf(stderr, "braille-send: %s\n", err.c_str());
+            return 1;
+        }
+    }
+
+    if (args.readyTimeoutMs > 0) {
+        // Opening the port resets an Uno; it announces itself when ready
+        std::unique_lock<std::mutex> lock(readyMutex);
+        if (!readyChanged.wait_for(lock, std::chrono::milliseconds(args.readyTimeoutMs),
+                                   [&] { return readyCount == ready.size(); })) {
+            for (size_t i = 0; i < ready.size(); i++)
+                if (!ready[i])
+                    std::fprintf(stderr, "braille-send: no BRAILLE_LED_READY from %s, sending anyway\n",
+                                 args.ports[i].c_str());
+        }
+    }
+
+    Streamer streamer(args, fleet);
+    auto start = std::chrono::steady_clock::now();
+    bool ok = true;
+    for (const std::string& file : args.files) {
+        if (!StreamFile(file, streamer)) { ok = false; break; }
+    }
+    if (!streamer.Finish()) ok = false;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!args.quiet) std::fprintf(stderr, "\n");
+
+    DeviceLinkStats stats = fleet.Totals();
+    std::vector<double> latencies;
+    for (size_t i = 0; i < fleet.Size(); i++) {
+        std::vector<double> l = fleet.Link(i).TakeLatencies();
+        latencies.insert(latencies.end(), l.begin(), l.end());
+    }
+    fleet.Close();
+
+    const size_t devices = fleet.Size();
+    std::printf("pages %zu, cells %zu, lines %llu, wire bytes %llu in %.2f s\n", streamer.Pages(),
+                streamer.Cells(), (unsigned long long)stats.linesSent, (unsigned long long)stats.bytesSent, seconds);
+    if (devices > 1)
+        std::printf("devices %zu, %.0f cells/s each\n", devices, streamer.Cells() / seconds);
+    std::printf("sustained %.0f cells/s, %.1f KB/s on the wire\n", streamer.Cells() * devices / seconds,
+                stats.bytesSent / seconds / 1024.0);
+    std::printf("line latency us: p50 %.0f  p95 %.0f  p99 %.0f  max %.0f\n", Percentile(latencies, 0.5),
+                Percentile(latencies, 0.95), Percentile(latencies, 0.99), Percentile(latencies, 1.0));
+    std::printf("replies: %llu OK, %llu rejected, %llu lost\n", (unsigned long long)stats.linesAcked,
+                (unsigned long long)stats.linesRejected, (unsigned long long)stats.linesLost);
+
+    if (!ok) std::fprintf(stderr, "braille-send: stopped early\n");
+    return ok && stats.linesRejected == 0 && stats.linesLost == 0 ? 0 : 1;
+}
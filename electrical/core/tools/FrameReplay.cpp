@@ -0,0 +1,242 @@
+// FrameReplay.cpp - frame-replay: runs a recorded capture session through
+// the portable OCR preprocessing stages.
+//
+//   frame-replay [options] RECORDING
+//   frame-replay --synthetic OUT [FRAMES]    writes a typing/scrolling test session
+//
+// Each BGRA frame goes through what driver.cpp's live OCR loop does before
+// it hands bitmaps to Windows OCR: TileChangeDetector finds the changed
+// text-line bands, OcrPrep crops, converts and upscales each band, and
+// Binarizer thresholds it. Gray8 frames (recorded OCR inputs) are only
+// binarized. Frames run back to back unless --realtime is given.
+//
+// Prints the time spent in each stage, frames per second and a digest of
+// the bands and binarized pixels of the first pass, so a pipeline change
+// can be checked on the same recording for speed and for identical output.
+// Recordings come from driver.cpp (Shift+click "OCR (live)") or --synthetic.
+
+#include "Binarize.h"
+#include "FrameRecord.h"
+#include "OcrPrep.h"
+#include "ThreadPool.h"
+#include "TileChangeDetector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Args {
+    std::string path;
+    std::string syntheticOut;
+    int syntheticFrames = 120;
+    int loops = 1;
+    int threads = 0;
+    bool realtime = false;
+};
+
+void Usage() {
+    std::fprintf(stderr,
+                 "usage: frame-replay [options] RECORDING\n"
+                 "       frame-replay --synthetic OUT [FRAMES]\n"
+                 "  --loops N          replay the recording N times (default 1)\n"
+                 "  --threads N        image kernel threads (default 0: one per core)\n"
+                 "  --realtime         wait between frames as the recording did\n"
+                 "  --synthetic OUT    write a 1920x1080 session of FRAMES frames (default 120)\n");
+}
+
+bool ParseArgs(int argc, char** argv, Args& a) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&](int& out) {
+            if (i + 1 >= argc) return false;
+            char* end;
+            long v = std::strtol(argv[++i], &end, 10);
+            out = (int)v;
+            return *end == '\0' && v >= 0;
+        };
+        if (arg == "--loops") { if (!value(a.loops) || a.loops == 0) return false; }
+        else if (arg == "--threads") { if (!value(a.threads)) return false; }
+        else if (arg == "--realtime") a.realtime = true;
+        else if (arg == "--synthetic" && i + 1 < argc) {
+            a.syntheticOut = argv[++i];
+            if (i + 1 < argc && argv[i + 1][0] != '-' && !value(a.syntheticFrames)) return false;
+        }
+        else if (arg == "-h" || arg == "--help") return false;
+        else if (arg.size() > 1 && arg[0] == '-') return false;
+        else if (a.path.empty()) a.path = arg;
+        else return false;
+    }
+    return !a.path.empty() || !a.syntheticOut.empty();
+}
+
+// A text editor, 20 px lines: typing on one line, a blinking caret and a
+// scroll by three lines every 40 frames, captured four times a second
+bool WriteSynthetic(const std::string& path, int frames) {
+    const int w = 1920, h = 1080;
+    const ptrdiff_t stride = w * 4 + 256;   // captures are often padded
+    std::vector<uint8_t> page((size_t)stride * h * 2, 0xFF), frame((size_t)stride * h);
+    std::mt19937 rng(1);
+    for (int line = 0; line * 20 + 14 < h * 2; line++) {
+        for (int x = 40; x + 8 < w - 40; x += 9) {
+            if (rng() % 7 == 0) continue;
+            const int gh = 8 + (int)(rng() % 6);
+            for (int y = line * 20 + 14 - gh; y < line * 20 + 14; y++)
+                memset(&page[(size_t)y * stride + (size_t)x * 4], 0x20, 7 * 4);
+        }
+    }
+
+    FrameRecorder rec;
+    std::string err;
+    if (!rec.Open(path, err)) { std::fprintf(stderr, "frame-replay: %s\n", err.c_str()); return false; }
+    int scroll = 0, typed = 0;
+    for (int i = 0; i < frames; i++) {
+        if (i > 0 && i % 40 == 0) scroll += 60;
+        for (int y = 0; y < h; y++)
+            memcpy(&frame[(size_t)y * stride], &page[(size_t)((y + scroll) % (h * 2)) * stride], (size_t)w * 4);
+        const int caretLine = 30;
+        typed = i % 40 == 0 ? 0 : typed + 2;
+        for (int y = caretLine * 20 + 2; y < caretLine * 20 + 14; y++) {
+            uint8_t* row = &frame[(size_t)y * stride];
+            memset(row + 40 * 4, 0xFF, (size_t)(w - 80) * 4);
+            memset(row + 40 * 4, 0x20, (size_t)typed * 9 * 4);
+            if (i % 2 == 0) memset(row + (size_t)(40 + typed * 9) * 4, 0x00, 2 * 4);
+        }
+        if (!rec.Add(frame.data(), w, h, stride, FrameFormat::Bgra8, (int64_t)i * 250000, err)) {
+            std::fprintf(stderr, "frame-replay: %s\n", err.c_str());
+            return false;
+        }
+    }
+    std::printf("wrote %zu frames, %.1f MB (%.1f MB raw) to %s\n", rec.Frames(), rec.FileBytes() / 1e6,
+                rec.RawBytes() / 1e6, path.c_str());
+    return true;
+}
+
+uint64_t Fnv1a(uint64_t h, const void* data, size_t size) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) h = (h ^ p[i]) * 0x100000001B3ull;
+    return h;
+}
+
+double Percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0;
+    size_t i = (size_t)(p * (v.size() - 1) + 0.5);
+    std::nth_element(v.begin(), v.begin() + (ptrdiff_t)i, v.end());
+    return v[i];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args;
+    if (!ParseArgs(argc, argv, args)) { Usage(); return 2; }
+    if (!args.syntheticOut.empty()) return WriteSynthetic(args.syntheticOut, args.syntheticFrames) ? 0 : 1;
+
+    ThreadPool pool(args.threads);
+    FrameReader reader(&pool);
+    std::string err;
+    if (!reader.Open(args.path, err)) {
+        std::fprintf(stderr, "frame-replay: %s\n", err.c_str());
+        return 1;
+    }
+    if (reader.FrameCount() == 0) {
+        std::fprintf(stderr, "frame-replay: %s has no frames\n", args.path.c_str());
+        return 1;
+    }
+
+    TileDiffOptions diffOptions;
+    diffOptions.pool = &pool;
+    TileChangeDetector detector(diffOptions);
+    OcrPrep prep(&pool);
+    BinarizeOptions binarizeOptions;
+    binarizeOptions.pool = &pool;
+    Binarizer binarizer(binarizeOptions);
+
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+    double decodeMs = 0, diffMs = 0, prepMs = 0, binarizeMs = 0;
+    std::vector<double> frameMs;
+    std::vector<PixelRect> bands;
+    size_t frames = 0, changedFrames = 0, bandCount = 0, ocrPixels = 0, badFrames = 0;
+    uint64_t digest = 0xCBF29CE484222325ull;
+
+    const auto start = Clock::now();
+    for (int loop = 0; loop < args.loops; loop++) {
+        detector.Reset();
+        const auto loopStart = Clock::now();
+        for (size_t k = 0; k < reader.FrameCount(); k++) {
+            const FrameInfo& info = reader.Info(k);
+            if (args.realtime) {
+                auto due = loopStart + std::chrono::microseconds(info.timestampUs - reader.Info(0).timestampUs);
+                std::this_thread::sleep_until(due);
+            }
+
+            auto t0 = Clock::now();
+            const uint8_t* px = reader.Frame(k);
+            auto t1 = Clock::now();
+            decodeMs += ms(t1 - t0);
+            if (!px) { badFrames++; continue; }
+            frames++;
+
+            if (info.format == FrameFormat::Gray8) {
+                BufferPool::Buffer out = prep.Pool().Acquire((size_t)info.width * info.height);
+                binarizer.Run(px, info.width, info.height, info.stride, out.Data(), info.width);
+                auto t2 = Clock::now();
+                binarizeMs += ms(t2 - t1);
+                frameMs.push_back(ms(t2 - t0));
+                changedFrames++;
+                ocrPixels += out.Size();
+                if (loop == 0) digest = Fnv1a(digest, out.Data(), out.Size());
+                continue;
+            }
+
+            detector.Update(px, info.width, info.height, info.stride, bands);
+            auto t2 = Clock::now();
+            diffMs += ms(t2 - t1);
+            if (!bands.empty()) changedFrames++;
+
+            for (const PixelRect& b : bands) {
+                auto b0 = Clock::now();
+                BufferPool::Buffer out;
+                int outW = 0, outH = 0;
+                if (!prep.Run(px, info.width, info.height, info.stride, b, OcrUpscaleFactor(b.right - b.left),
+                              out, outW, outH))
+                    continue;
+                auto b1 = Clock::now();
+                binarizer.Run(out.Data(), outW, outH, outW, out.Data(), outW);
+                auto b2 = Clock::now();
+                prepMs += ms(b1 - b0);
+                binarizeMs += ms(b2 - b1);
+                bandCount++;
+                ocrPixels += (size_t)outW * outH;
+                if (loop == 0) {
+                    digest = Fnv1a(digest, &b, sizeof(b));
+                    digest = Fnv1a(digest, out.Data(), (size_t)outW * outH);
+                }
+            }
+            frameMs.push_back(ms(Clock::now() - t0));
+        }
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    const FrameInfo& first = reader.Info(0);
+    std::printf("%s: %zu frames, %dx%d %s, %.1f s recorded, %d thread(s)\n", args.path.c_str(),
+                reader.FrameCount(), first.width, first.height, first.format == FrameFormat::Bgra8 ? "BGRA" : "Gray8",
+                (reader.Info(reader.FrameCount() - 1).timestampUs - first.timestampUs) / 1e6, pool.Threads());
+    std::printf("replayed %zu frames in %.2f s: %.1f frames/s, %zu changed, %zu bands, %.1f MP to OCR\n", frames,
+                seconds, frames / seconds, changedFrames, bandCount, ocrPixels / 1e6);
+    std::printf("stage ms: decode %.1f  diff %.1f  prep %.1f  binarize %.1f\n", decodeMs, diffMs, prepMs, binarizeMs);
+    std::printf("frame ms: p50 %.2f  p95 %.2f  max %.2f\n", Percentile(frameMs, 0.5), Percentile(frameMs, 0.95),
+                Percentile(frameMs, 1.0));
+    std::printf("digest %016llx\n", (unsigned long long)digest);
+    if (badFrames) std::fprintf(stderr, "frame-replay: %zu frames could not be decoded\n", badFrames);
+    return badFrames ? 1 : 0;
+}
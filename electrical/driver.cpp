@@ -11,6 +11,9 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
 #include <shlwapi.h>
 #include <shcore.h>
 #include <commdlg.h>
@@ -34,6 +37,15 @@
 #include <DispatcherQueue.h>          // Windows SDK
 #include <winrt/Windows.System.h>     // for DispatcherQueue (optional but useful)
 
+#include "core/Binarize.h"
+#include "core/DeviceLink.h"
+#include "core/DocumentSource.h"
+#include "core/FrameRecord.h"
+#include "core/OcrPrep.h"
+#include "core/SerialPort.h"
+#include "core/ThreadPool.h"
+#include "core/TileChangeDetector.h"
+
 
 #pragma comment(lib, "setupapi.lib")
 #pragma comment(lib, "user32.lib")
@@ -62,18 +74,27 @@ enum : int {
     IDC_BTN_OCR_REGION = 1006,
     IDC_BTN_OCR_FULLSCREEN = 1007,
     IDC_BTN_OPEN = 1008,
-    IDC_BTN_SAVE = 1009
+    IDC_BTN_SAVE = 1009,
+    IDC_BTN_OCR_LIVE = 1010
 };
 
 
 
 
 HINSTANCE hInst;
-HWND hWndMain, hCbPorts, hBtnRefresh, hBtnConnect, hEditText, hBtnSend, hBtnRegion, hBtnFull, hBtnOpen, hBtnSave;
-HANDLE hSerial = INVALID_HANDLE_VALUE;
+HWND hWndMain, hCbPorts, hBtnRefresh, hBtnConnect, hEditText, hBtnSend, hBtnRegion, hBtnFull, hBtnOpen, hBtnSave, hBtnLive;
+SerialPort serialPort;
+DeviceLink deviceLink(serialPort);           // normalizes, diffs and pipelines text to the device
+DocumentSource document;                     // file from Open/Ctrl+O, read a page at a time
+PageFeeder pageFeeder;                       // newest page still to go to the device
+size_t documentPage = 0;
+std::wstring documentPath;
 bool connected = false;
 WNDPROC OriginalEditProc;
 
+static const wchar_t* kWindowTitle = L"Text Sender v1.1.0";
+static const UINT_PTR IDT_PAGE_FEEDER = 1;
+
 static winrt::Windows::Graphics::DirectX::Direct3D11::IDirect3DDevice g_d3dDevice{ nullptr };
 static winrt::Windows::System::DispatcherQueueController g_dqController{ nullptr };
 
@@ -216,30 +237,32 @@ CaptureOneFrameAsync(winrt::Windows::Graphics::Capture::GraphicsCaptureItem item
 
     // Convert captured surface -> SoftwareBitmap
     auto sb = co_await SoftwareBitmap::CreateCopyFromSurfaceAsync(frame.Surface());
-    sb = SoftwareBitmap::Convert(sb, BitmapPixelFormat::Bgra8, BitmapAlphaMode::Ignore);
+    // The pool is already B8G8R8A8; only convert if the copy came back otherwise
+    if (sb.BitmapPixelFormat() != BitmapPixelFormat::Bgra8)
+        sb = SoftwareBitmap::Convert(sb, BitmapPixelFormat::Bgra8, BitmapAlphaMode::Ignore);
     co_return sb;
 }
 
-static winrt::Windows::Graphics::Imaging::SoftwareBitmap CropSoftwareBitmap(
+static OcrPrep g_ocrPrep;
+
+// Crops rect (capture pixels) out of a monitor capture, converts it to
+// Gray8 and upscales small regions, in one pass over the frame (core/OcrPrep.h)
+static winrt::Windows::Graphics::Imaging::SoftwareBitmap PrepareOcrRect(
     winrt::Windows::Graphics::Imaging::SoftwareBitmap const& src,
-    RECT rPx,
-    int /*unused*/, int /*unused*/
+    PixelRect rect
 ) {
     using namespace winrt::Windows::Graphics::Imaging;
 
-    int x = rPx.left;
-    int y = rPx.top;
-    int w = rPx.right - rPx.left;
-    int h = rPx.bottom - rPx.top;
+    int srcW = src.PixelWidth();
+    int srcH = src.PixelHeight();
 
-    if (w <= 0 || h <= 0) return nullptr;
+    int clippedW = min(rect.right, srcW) - max(rect.left, 0);
+    int factor = OcrUpscaleFactor(clippedW);
 
-    x = max(0, min(x, src.PixelWidth() - 1));
-    y = max(0, min(y, src.PixelHeight() - 1));
-    w = min(w, src.PixelWidth() - x);
-    h = min(h, src.PixelHeight() - y);
+    int outW = 0, outH = 0;
+    if (!OcrPrep::OutputSize(srcW, srcH, rect, factor, outW, outH)) return nullptr;
 
-    auto dst = SoftwareBitmap(BitmapPixelFormat::Bgra8, w, h, BitmapAlphaMode::Ignore);
+    auto dst = SoftwareBitmap(BitmapPixelFormat::Gray8, outW, outH);
 
     auto srcBuf = src.LockBuffer(BitmapBufferAccessMode::Read);
     auto dstBuf = dst.LockBuffer(BitmapBufferAccessMode::Write);
@@ -260,17 +283,45 @@ static winrt::Windows::Graphics::Imaging::SoftwareBitmap CropSoftwareBitmap(
     winrt::check_hresult(srcRef.as<IMemoryBufferByteAccess>()->GetBuffer(&srcPtr, &srcCap));
     winrt::check_hresult(dstRef.as<IMemoryBufferByteAccess>()->GetBuffer(&dstPtr, &dstCap));
 
-    const int bpp = 4;
-    const size_t rowBytes = (size_t)w * bpp;
-
-    for (int row = 0; row < h; ++row) {
-        auto* s = srcPtr + (size_t)(y + row) * srcPlane.Stride + (size_t)x * bpp;
-        auto* d = dstPtr + (size_t)row * dstPlane.Stride;
-        memcpy(d, s, rowBytes);
-    }
+    if (!g_ocrPrep.Run(srcPtr + srcPlane.StartIndex, srcW, srcH, srcPlane.Stride, rect, factor,
+                       dstPtr + dstPlane.StartIndex, dstPlane.Stride))
+        return nullptr;
     return dst;
 }
 
+// Same for rPx in screen coordinates; the capture starts at the monitor
+// origin, not the virtual screen origin
+static winrt::Windows::Graphics::Imaging::SoftwareBitmap PrepareOcrRegion(
+    winrt::Windows::Graphics::Imaging::SoftwareBitmap const& src,
+    RECT rPx,
+    int screenLeft, int screenTop
+) {
+    return PrepareOcrRect(src, { rPx.left - screenLeft, rPx.top - screenTop, rPx.right - screenLeft, rPx.bottom - screenTop });
+}
+
+static Binarizer g_binarizer;
+
+// Thresholds a Gray8 bitmap in place to black text on white (core/Binarize.h):
+// OCR is faster on it and copes with faint or coloured UI text
+static void BinarizeForOcr(winrt::Windows::Graphics::Imaging::SoftwareBitmap const& sb)
+{
+    using namespace winrt::Windows::Graphics::Imaging;
+
+    auto buf = sb.LockBuffer(BitmapBufferAccessMode::ReadWrite);
+    auto plane = buf.GetPlaneDescription(0);
+
+    struct __declspec(uuid("5B0D3235-4DBA-4D44-865E-8F1D0E4FD04D")) IMemoryBufferByteAccess : IUnknown {
+        virtual HRESULT __stdcall GetBuffer(uint8_t** buffer, uint32_t* capacity) = 0;
+    };
+
+    auto ref = buf.CreateReference();
+    uint8_t* p = nullptr; uint32_t cap = 0;
+    winrt::check_hresult(ref.as<IMemoryBufferByteAccess>()->GetBuffer(&p, &cap));
+
+    uint8_t* px = p + plane.StartIndex;
+    g_binarizer.Run(px, plane.Width, plane.Height, plane.Stride, px, plane.Stride);
+}
+
 static winrt::Windows::Foundation::IAsyncOperation<winrt::hstring>OcrBitmapAsync(winrt::Windows::Graphics::Imaging::SoftwareBitmap sb) {
     using namespace winrt;
     using namespace winrt::Windows::Media::Ocr;
@@ -278,8 +329,10 @@ static winrt::Windows::Foundation::IAsyncOperation<winrt::hstring>OcrBitmapAsync
 
     if (!sb) co_return L"";
 
-    // Optional: Gray8 often improves OCR
-    sb = SoftwareBitmap::Convert(sb, BitmapPixelFormat::Gray8);
+    // Gray8 often improves OCR (region captures already are)
+    if (sb.BitmapPixelFormat() != BitmapPixelFormat::Gray8)
+        sb = SoftwareBitmap::Convert(sb, BitmapPixelFormat::Gray8);
+    BinarizeForOcr(sb);
 
     auto engine = OcrEngine::TryCreateFromUserProfileLanguages();
     if (!engine) co_return L"";
@@ -353,9 +406,11 @@ static bool SaveSoftwareBitmapAsBMP(
 
     // Convert to tight-packed BGRA (w*h*4), because stride may be larger than w*4
     std::vector<uint8_t> bgra((size_t)w * (size_t)h * 4);
-    for (int y = 0; y < h; ++y) {
-        memcpy(bgra.data() + (size_t)y * (size_t)w * 4, p + (size_t)y * (size_t)stride, (size_t)w * 4);
-    }
+    ThreadPool::Shared().ParallelFor(0, h, 64, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            memcpy(bgra.data() + (size_t)y * (size_t)w * 4, p + (size_t)y * (size_t)stride, (size_t)w * 4);
+        }
+    });
 
     BITMAPFILEHEADER bfh{};
     BITMAPINFOHEADER bih{};
@@ -416,32 +471,58 @@ static std::string WideToUtf8(const std::wstring& w) {
     return out;
 }
 
-static bool LoadTextFileToEdit(HWND hEdit, const std::wstring& path) {
-    std::ifstream file(std::filesystem::path(path), std::ios::binary);
-    if (!file) return false;
+static std::wstring Utf8ToWide(const std::string& s) {
+    if (s.empty()) return {};
+    int len = MultiByteToWideChar(CP_UTF8, 0, s.data(), (int)s.size(), nullptr, 0);
+    std::wstring out(len, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, s.data(), (int)s.size(), out.data(), len);
+    return out;
+}
 
-    std::ostringstream oss;
-    oss << file.rdbuf();
-    std::string bytes = oss.str();
+// Shows page `page` of the open document in the edit box and queues it
+// for the device; WM_TIMER sends it once the serial link has drained.
+static void ShowDocumentPage(size_t page) {
+    if (!document.IsOpen()) return;
 
-    // Handle UTF-8 BOM
-    if (bytes.size() >= 3 && (uint8_t)bytes[0] == 0xEF && (uint8_t)bytes[1] == 0xBB && (uint8_t)bytes[2] == 0xBF) {
-        bytes.erase(0, 3);
+    std::wstring title = std::wstring(kWindowTitle) + L" - " + std::filesystem::path(documentPath).filename().wstring();
+    if (document.PageCount() == 0) {
+        SetWindowTextW(hEditText, L"");
+        SetWindowTextW(hWndMain, (title + L" (empty)").c_str());
+        return;
     }
 
-    std::wstring w;
-    if (!bytes.empty()) {
-        int need = MultiByteToWideChar(CP_UTF8, 0, bytes.data(), (int)bytes.size(), nullptr, 0);
-        if (need > 0) {
-            w.resize(need);
-            MultiByteToWideChar(CP_UTF8, 0, bytes.data(), (int)bytes.size(), w.data(), need);
-        }
+    documentPage = (std::min)(page, document.PageCount() - 1);
+    std::string_view text = document.Page(documentPage);
+    SetWindowTextW(hEditText, Utf8ToWide(std::string(text)).c_str());
+    title += L" (page " + std::to_wstring(documentPage + 1) + L"/" + std::to_wstring(document.PageCount()) + L")";
+    SetWindowTextW(hWndMain, title.c_str());
+    pageFeeder.Request(documentPage);
+}
+
+// Maps the file (core/DocumentSource.h) and shows its first page. Nothing
+// else is read until it is paged to, so size does not matter.
+static bool OpenDocument(const std::wstring& path) {
+    pageFeeder.Cancel();
+    std::string err;
+    if (!document.Open(WideToUtf8(path), err)) {
+        documentPath.clear();
+        SetWindowTextW(hWndMain, kWindowTitle);
+        MsgBox(L"Open failed.\n" + Utf8ToWide(err), MB_ICONERROR);
+        return false;
     }
-    SetWindowTextW(hEdit, w.c_str());
+    documentPath = path;
+    ShowDocumentPage(0);
     return true;
 }
 
 static bool SaveEditToTextFile(HWND hEdit, const std::wstring& path) {
+    // The edit box only holds one page of an open document
+    std::error_code ec;
+    if (document.IsOpen() && std::filesystem::equivalent(path, documentPath, ec)) {
+        MsgBox(L"That file is open as a document; saving would replace it with the current page.", MB_ICONWARNING);
+        return false;
+    }
+
     int len = GetWindowTextLengthW(hEdit);
     std::wstring w;
     w.resize(len);
@@ -645,32 +726,6 @@ static bool SaveBGRAasBMP(const std::wstring& path,
     return true;
 }
 
-void LoadTextFile(const std::wstring& filePath) {
-    try {
-        std::ifstream file(std::filesystem::path(filePath), std::ios::binary);
-        if (!file) { MsgBox(L"Failed to open the file.", MB_ICONERROR); return; }
-
-        std::ostringstream oss;
-        oss << file.rdbuf();
-        std::string bytes = oss.str();
-
-
-        if (!bytes.empty()) {
-            int required = MultiByteToWideChar(CP_UTF8, 0, bytes.data(), (int)bytes.size(), nullptr, 0);
-            std::wstring text;
-            if (required > 0) {
-                text.resize(required);
-                MultiByteToWideChar(CP_UTF8, 0, bytes.data(), (int)bytes.size(), text.data(), required);
-            }
-            SetWindowTextW(hEditText, text.c_str());
-        } else {
-            SetWindowTextW(hEditText, L"");
-        }
-    } catch (...) {
-        MsgBox(L"Failed to read file (exception).", MB_ICONERROR);
-    }
-}
-
 void PopulatePorts() {
     SendMessageW(hCbPorts, CB_RESETCONTENT, 0, 0);
     for (auto& p : EnumComPorts())
@@ -690,213 +745,206 @@ wstring GetSelectedPort() {
     return buf;
 }
 
+// Serial errors are reported from the port's reader/writer threads
+static const UINT WM_SERIAL_ERROR = WM_APP + 2;
+
 bool OpenSerial(const wstring& port) {
     if (connected) return true;
 
-    wstring path = L"\\\\.\\" + port;
-    HANDLE h = CreateFileW(path.c_str(),
-        GENERIC_READ | GENERIC_WRITE,
-        0,
-        nullptr,
-        OPEN_EXISTING,
-        0,
-        nullptr);
-    if (h == INVALID_HANDLE_VALUE) {
-        MsgBox(L"Cannot open port.", MB_ICONERROR);
-        return false;
-    }
-
-    DCB dcb{};
-    dcb.DCBlength = sizeof(DCB);
-    if (!GetCommState(h, &dcb)) {
-        CloseHandle(h);
-        MsgBox(L"GetCommState failed.", MB_ICONERROR);
-        return false;
-    }
-
-    dcb.BaudRate = CBR_9600;
-    dcb.ByteSize = 8;
-    dcb.Parity = NOPARITY;
-    dcb.StopBits = ONESTOPBIT;
-
-    // enable DTR/RTS — many Arduino-style boards expect this
-    dcb.fOutxCtsFlow = FALSE;
-    dcb.fOutxDsrFlow = FALSE;
-    dcb.fOutX = FALSE;
-    dcb.fInX = FALSE;
-    dcb.fDtrControl = DTR_CONTROL_ENABLE;
-    dcb.fRtsControl = RTS_CONTROL_ENABLE; //111111111111111111111111111111111111111111111111111111111111111111111111111111111111111111111
-
-    if (!SetCommState(h, &dcb)) {
-        CloseHandle(h);
-        MsgBox(L"SetCommState failed.", MB_ICONERROR);
-        return false;
-    }
+    SerialOptions options;
+    options.baud = 115200;   // braille/src/main.cpp: Serial.begin(115200)
 
-    COMMTIMEOUTS to{};
-    to.ReadIntervalTimeout = MAXDWORD;
-    to.ReadTotalTimeoutMultiplier = 50;
-    to.ReadTotalTimeoutConstant = 50;
-    to.WriteTotalTimeoutMultiplier = 50;
-    to.WriteTotalTimeoutConstant = 2000;
+    serialPort.SetLineCallback([](const std::string& line) { deviceLink.OnLine(line); });
+    serialPort.SetErrorCallback([](const std::string& message) {
+        auto* p = new std::wstring(Utf8ToWide(message));
+        if (!PostMessageW(hWndMain, WM_SERIAL_ERROR, 0, (LPARAM)p)) delete p;
+    });
 
-    if (!SetCommTimeouts(h, &to)) {
-        CloseHandle(h);
-        MsgBox(L"SetCommTimeouts failed.", MB_ICONERROR);
+    std::string err;
+    if (!serialPort.Open(WideToUtf8(port), options, err)) {
+        MsgBox(L"Cannot open port.\n" + Utf8ToWide(err), MB_ICONERROR);
         return false;
     }
 
-    // Clear any junk in buffers
-    PurgeComm(h, PURGE_RXCLEAR | PURGE_TXCLEAR);
-
-
-
-    hSerial = h;
     connected = true;
+    deviceLink.Reset();
     SetWindowTextW(hBtnConnect, L"Disconnect");
     return true;
 }
 
 void CloseSerial() {
-    if (hSerial != INVALID_HANDLE_VALUE) CloseHandle(hSerial);
-    hSerial = INVALID_HANDLE_VALUE;
+    serialPort.Close();
     connected = false;
     SetWindowTextW(hBtnConnect, L"Connect");
 }
 
+// Queues the edits that turn the device's text into `text` (core/DeviceLink.h);
+// does not wait for the port or the replies. The first send after
+// connecting, or after the device rejected an edit, replaces everything.
 bool SendText(const std::wstring& text) {
-    if (!connected) { MsgBox(L"Not connected.", MB_ICONWARNING); return false; }
+    if (!connected || !deviceLink.SendText(WideToUtf8(text))) { MsgBox(L"Not connected.", MB_ICONWARNING); return false; }
 
-    int len = WideCharToMultiByte(CP_UTF8, 0, text.c_str(), (int)text.size(), nullptr, 0, nullptr, nullptr);
-    std::string utf8;
-    if (len > 0) {
-        utf8.resize(len);
-        WideCharToMultiByte(CP_UTF8, 0, text.c_str(), (int)text.size(), utf8.data(), len, nullptr, nullptr);
-    }
-    utf8.push_back('\n');
-
-    DWORD written = 0;
-    if (!WriteFile(hSerial, utf8.data(), (DWORD)utf8.size(), &written, nullptr)) {
-        DWORD err = GetLastError();
-        wstring msg = L"WriteFile failed.\nError " + to_wstring(err) + L": " + GetLastErrorMessage(err);
-        MsgBox(msg, MB_ICONERROR);
-        return false;
-    }
-    if (written != utf8.size()) {
-        MsgBox(L"Partial write to serial port.", MB_ICONWARNING);
-        return false;
-    }
+    if (deviceLink.Truncated())
+        MsgBox(L"Only the first " + std::to_wstring(deviceLink.DeviceText().size()) + L" bytes fit on the device.", MB_ICONWARNING);
     return true;
-    
 }
 
-static winrt::Windows::Graphics::Imaging::SoftwareBitmap
-UpscaleIfLowResolution(
-    winrt::Windows::Graphics::Imaging::SoftwareBitmap const& src,
-    int minWidth = 1000,
-    int scaleFactor = 2)
+// Continuous OCR. Odd while a live loop should run; each start and stop
+// bumps it, so a loop that outlives its stop click exits on its own.
+static std::atomic<unsigned> g_liveOcrGeneration{ 0 };
+
+static void StopLiveOcr() {
+    unsigned gen = g_liveOcrGeneration;
+    if ((gen & 1) && g_liveOcrGeneration.compare_exchange_strong(gen, gen + 1))
+        SetWindowTextW(hBtnLive, L"OCR (live)");
+}
+
+// Keeps one capture session open on the selected region, checks the newest
+// frame a few times a second and OCRs only the text-line bands that changed
+// since the last check (core/TileChangeDetector.h). Repeated identical
+// results (e.g. a blinking caret) are not posted again. With `record`, every
+// checked frame of the region is also written to %TEMP%\ocr_session.frames
+// (core/FrameRecord.h) for frame-replay.
+static winrt::fire_and_forget LiveOcrAsync(RECT selected, unsigned generation, bool record)
 {
     using namespace winrt;
+    using namespace winrt::Windows::Graphics::Capture;
+    using namespace winrt::Windows::Graphics::DirectX;
     using namespace winrt::Windows::Graphics::Imaging;
 
-    if (!src) return nullptr;
-
-    // Ensure format is BGRA8
-    SoftwareBitmap input = src;
-    if (input.BitmapPixelFormat() != BitmapPixelFormat::Bgra8)
-    {
-        input = SoftwareBitmap::Convert(
-            input,
-            BitmapPixelFormat::Bgra8,
-            BitmapAlphaMode::Ignore
-        );
-    }
-
-    int w = input.PixelWidth();
-    int h = input.PixelHeight();
-
-    // If resolution is already sufficient, return original
-    if (w >= minWidth)
-        return input;
-
-    int newW = w * scaleFactor;
-    int newH = h * scaleFactor;
-
-    SoftwareBitmap output(
-        BitmapPixelFormat::Bgra8,
-        newW,
-        newH,
-        BitmapAlphaMode::Ignore
-    );
-
-    auto inBuf = input.LockBuffer(BitmapBufferAccessMode::Read);
-    auto outBuf = output.LockBuffer(BitmapBufferAccessMode::Write);
-
-    auto inDesc = inBuf.GetPlaneDescription(0);
-    auto outDesc = outBuf.GetPlaneDescription(0);
-
-    struct __declspec(uuid("5B0D3235-4DBA-4D44-865E-8F1D0E4FD04D"))
-        IMemoryBufferByteAccess : IUnknown {
-        virtual HRESULT __stdcall GetBuffer(uint8_t** buffer, uint32_t* capacity) = 0;
-    };
-
-    auto inRef = inBuf.CreateReference();
-    auto outRef = outBuf.CreateReference();
-
-    uint8_t* inPtr = nullptr;
-    uint32_t inCap = 0;
-    uint8_t* outPtr = nullptr;
-    uint32_t outCap = 0;
-
-    winrt::check_hresult(inRef.as<IMemoryBufferByteAccess>()->GetBuffer(&inPtr, &inCap));
-    winrt::check_hresult(outRef.as<IMemoryBufferByteAccess>()->GetBuffer(&outPtr, &outCap));
-
-    const int bytesPerPixel = 4;
+    try {
+        HMONITOR mon = MonitorFromRect(&selected, MONITOR_DEFAULTTONEAREST);
+        MONITORINFO mi{};
+        mi.cbSize = sizeof(mi);
+        RECT rc{};
+        if (!GetMonitorInfoW(mon, &mi) || !IntersectRect(&rc, &selected, &mi.rcMonitor)) {
+            PostToEdit(L"[OCR DEBUG] Selected region not on a monitor.");
+            StopLiveOcr();
+            co_return;
+        }
 
-    // Bilinear interpolation
-    for (int y = 0; y < newH; ++y)
-    {
-        float srcY = (float)y / scaleFactor;
-        int y0 = (int)srcY;
-        int y1 = min(y0 + 1, h - 1);
-        float wy = srcY - y0;
+        auto item = CreateItemForMonitor(mon);
+        if (!item) {
+            PostToEdit(L"[OCR DEBUG] CreateItemForMonitor returned null.");
+            StopLiveOcr();
+            co_return;
+        }
 
-        for (int x = 0; x < newW; ++x)
-        {
-            float srcX = (float)x / scaleFactor;
-            int x0 = (int)srcX;
-            int x1 = min(x0 + 1, w - 1);
-            float wx = srcX - x0;
+        auto framePool = Direct3D11CaptureFramePool::CreateFreeThreaded(
+            g_d3dDevice,
+            DirectXPixelFormat::B8G8R8A8UIntNormalized,
+            2,
+            item.Size()
+        );
+        auto session = framePool.CreateCaptureSession(item);
+
+        // Frames only arrive when something on the monitor redrew; keep the newest
+        std::mutex latestLock;
+        Direct3D11CaptureFrame latest{ nullptr };
+        auto token = framePool.FrameArrived([&](auto const& sender, auto const&) {
+            auto f = sender.TryGetNextFrame();
+            std::lock_guard<std::mutex> lock(latestLock);
+            if (latest) latest.Close();
+            latest = f;
+            });
+        session.StartCapture();
+
+        const PixelRect area{ rc.left - mi.rcMonitor.left, rc.top - mi.rcMonitor.top,
+                              rc.right - mi.rcMonitor.left, rc.bottom - mi.rcMonitor.top };
+        TileChangeDetector detector;
+        std::vector<PixelRect> bands;
+        std::wstring lastText;
+
+        FrameRecorder recorder;
+        const auto recordStart = std::chrono::steady_clock::now();
+        if (record) {
+            std::wstring path = TempFile(L"ocr_session.frames");
+            std::string err;
+            if (recorder.Open(WideToUtf8(path), err)) PostToEdit(L"[OCR DEBUG] Recording to " + path);
+            else PostToEdit(L"[OCR DEBUG] Not recording: " + Utf8ToWide(err));
+        }
 
-            uint8_t* p00 = inPtr + y0 * inDesc.Stride + x0 * bytesPerPixel;
-            uint8_t* p10 = inPtr + y0 * inDesc.Stride + x1 * bytesPerPixel;
-            uint8_t* p01 = inPtr + y1 * inDesc.Stride + x0 * bytesPerPixel;
-            uint8_t* p11 = inPtr + y1 * inDesc.Stride + x1 * bytesPerPixel;
+        try {
+            while (g_liveOcrGeneration == generation) {
+                co_await winrt::resume_after(std::chrono::milliseconds(250));
 
-            uint8_t* dst = outPtr + y * outDesc.Stride + x * bytesPerPixel;
+                Direct3D11CaptureFrame frame{ nullptr };
+                {
+                    std::lock_guard<std::mutex> lock(latestLock);
+                    std::swap(frame, latest);
+                }
+                if (!frame) continue;
 
-            for (int c = 0; c < 4; ++c)
-            {
-                float val =
-                    (1 - wx) * (1 - wy) * p00[c] +
-                    wx * (1 - wy) * p10[c] +
-                    (1 - wx) * wy * p01[c] +
-                    wx * wy * p11[c];
+                auto sb = co_await SoftwareBitmap::CreateCopyFromSurfaceAsync(frame.Surface());
+                frame.Close();
+                if (sb.BitmapPixelFormat() != BitmapPixelFormat::Bgra8)
+                    sb = SoftwareBitmap::Convert(sb, BitmapPixelFormat::Bgra8, BitmapAlphaMode::Ignore);
 
-                dst[c] = (uint8_t)val;
+                int x0 = max(area.left, 0), y0 = max(area.top, 0);
+                int x1 = min(area.right, sb.PixelWidth()), y1 = min(area.bottom, sb.PixelHeight());
+                if (x1 <= x0 || y1 <= y0) continue;
+                {
+                    auto buf = sb.LockBuffer(BitmapBufferAccessMode::Read);
+                    auto plane = buf.GetPlaneDescription(0);
+                    auto ref = buf.CreateReference();
+
+                    struct __declspec(uuid("5B0D3235-4DBA-4D44-865E-8F1D0E4FD04D")) IMemoryBufferByteAccess : IUnknown {
+                        virtual HRESULT __stdcall GetBuffer(uint8_t** buffer, uint32_t* capacity) = 0;
+                    };
+                    uint8_t* p = nullptr; uint32_t cap = 0;
+                    winrt::check_hresult(ref.as<IMemoryBufferByteAccess>()->GetBuffer(&p, &cap));
+
+                    const uint8_t* origin = p + plane.StartIndex + (size_t)y0 * plane.Stride + (size_t)x0 * 4;
+                    detector.Update(origin, x1 - x0, y1 - y0, plane.Stride, bands);
+
+                    if (recorder.IsOpen()) {
+                        std::string err;
+                        auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - recordStart).count();
+                        if (!recorder.Add(origin, x1 - x0, y1 - y0, plane.Stride, FrameFormat::Bgra8, us, err)) {
+                            PostToEdit(L"[OCR DEBUG] Recording stopped: " + Utf8ToWide(err));
+                            recorder.Close();
+                        }
+                    }
+                }
+                if (bands.empty()) continue;
+
+                std::wstring text;
+                for (const PixelRect& b : bands) {
+                    auto band = PrepareOcrRect(sb, { b.left + x0, b.top + y0, b.right + x0, b.bottom + y0 });
+                    std::wstring t = (co_await OcrBitmapAsync(band)).c_str();
+                    if (t.empty()) continue;
+                    if (!text.empty()) text += L"\r\n";
+                    text += t;
+                }
+                if (!text.empty() && text != lastText) {
+                    PostToEdit(L"[LIVE] " + text);
+                    lastText = text;
+                }
             }
         }
-    }
+        catch (winrt::hresult_error const& e) {
+            PostToEdit(L"[OCR DEBUG] Live OCR stopped: " + std::wstring(e.message().c_str()));
+        }
+        catch (...) {
+            PostToEdit(L"[OCR DEBUG] Live OCR stopped: unknown exception.");
+        }
 
-    return output;
+        framePool.FrameArrived(token);
+        session.Close();
+        framePool.Close();
+        if (recorder.IsOpen())
+            PostToEdit(L"[OCR DEBUG] Recorded " + std::to_wstring(recorder.Frames()) + L" frames.");
+    }
+    catch (winrt::hresult_error const& e) {
+        PostToEdit(L"[OCR DEBUG] Live OCR could not start: " + std::wstring(e.message().c_str()));
+    }
+    catch (...) {
+        PostToEdit(L"[OCR DEBUG] Unknown exception.");
+    }
+    if (g_liveOcrGeneration == generation) StopLiveOcr();
 }
 
-
-
-
-
-
-
 struct RegionSelectState {
     bool selecting = false;
     POINT start{};
@@ -1083,10 +1131,18 @@ LRESULT CALLBACK EditSubclassProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPa
                 std::wstring path;
                 if (PickOpenTxtFile(hWndMain, path))
                 {
-                    LoadTextFileToEdit(hwnd, path);
+                    OpenDocument(path);
                 }
                 return 0;
             }
+
+            // Page through an open document
+            case VK_NEXT:
+            case VK_PRIOR:
+                if (!document.IsOpen()) break;
+                if (wParam == VK_NEXT) ShowDocumentPage(documentPage + 1);
+                else if (documentPage > 0) ShowDocumentPage(documentPage - 1);
+                return 0;
             }
         }
     }
@@ -1107,10 +1163,12 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 
         hBtnRegion = CreateWindowW(L"BUTTON", L"OCR (region)", WS_CHILD | WS_VISIBLE,  margin, margin + rowH + 220, 120, rowH, hWnd, (HMENU)IDC_BTN_OCR_REGION, hInst, nullptr);
         hBtnFull = CreateWindowW(L"BUTTON", L"OCR (full)", WS_CHILD | WS_VISIBLE, margin + 130, margin + rowH + 220, 120, rowH, hWnd, (HMENU)IDC_BTN_OCR_FULLSCREEN, hInst, nullptr);
-        hBtnOpen = CreateWindowW(L"BUTTON", L"Open", WS_CHILD | WS_VISIBLE, margin + 260, margin + rowH + 220, btnW, rowH, hWnd, (HMENU)IDC_BTN_OPEN, hInst, nullptr);
-        hBtnSave = CreateWindowW(L"BUTTON", L"Save", WS_CHILD | WS_VISIBLE, margin + 370, margin + rowH + 220, btnW, rowH, hWnd, (HMENU)IDC_BTN_SAVE, hInst, nullptr);
+        hBtnOpen = CreateWindowW(L"BUTTON", L"Open", WS_CHILD | WS_VISIBLE, margin + 260, margin + rowH + 220, 80, rowH, hWnd, (HMENU)IDC_BTN_OPEN, hInst, nullptr);
+        hBtnSave = CreateWindowW(L"BUTTON", L"Save", WS_CHILD | WS_VISIBLE, margin + 350, margin + rowH + 220, 80, rowH, hWnd, (HMENU)IDC_BTN_SAVE, hInst, nullptr);
+        hBtnLive = CreateWindowW(L"BUTTON", L"OCR (live)", WS_CHILD | WS_VISIBLE, margin + 440, margin + rowH + 220, btnW, rowH, hWnd, (HMENU)IDC_BTN_OCR_LIVE, hInst, nullptr);
 
         PopulatePorts();
+        SetTimer(hWnd, IDT_PAGE_FEEDER, 50, nullptr);
         return 0;
     }
     case WM_COMMAND: {
@@ -1125,9 +1183,10 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             }
         }
         else if (id == IDC_BTN_SEND && HIWORD(wParam) == BN_CLICKED) {
-            wchar_t buf[2048]; GetWindowTextW(hEditText, buf, 2048);
-            if (wcslen(buf) == 0) MsgBox(L"Nothing to send.", MB_ICONWARNING);
-            else if (SendText(buf)) MsgBox(L"Sent successfully.");
+            std::wstring text((size_t)GetWindowTextLengthW(hEditText) + 1, L'\0');
+            text.resize(GetWindowTextW(hEditText, text.data(), (int)text.size()));
+            if (text.empty()) MsgBox(L"Nothing to send.", MB_ICONWARNING);
+            else if (SendText(text)) MsgBox(L"Sent successfully.");
         }
         else if (id == IDC_BTN_OCR_FULLSCREEN && HIWORD(wParam) == BN_CLICKED)
         {
@@ -1228,16 +1287,13 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                         co_return;
                     }
 
-                    auto cropped = CropSoftwareBitmap(full, rc, screenLeft, screenTop);
-                    if (!cropped) {
-                        PostToEdit(L"[OCR DEBUG] CropSoftwareBitmap returned null.");
+                    auto region = PrepareOcrRegion(full, rc, screenLeft, screenTop);
+                    if (!region) {
+                        PostToEdit(L"[OCR DEBUG] PrepareOcrRegion returned null.");
                         co_return;
                     }
 
-                    cropped = UpscaleIfLowResolution(cropped, 800, 2);
-                    cropped = UpscaleIfLowResolution(cropped, 200, 2);
-
-                    auto text = co_await OcrBitmapAsync(cropped);
+                    auto text = co_await OcrBitmapAsync(region);
 
                     std::wstring t = text.c_str();
                     // trim
@@ -1260,11 +1316,26 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                 co_return;
                 }());
         }
+        else if (id == IDC_BTN_OCR_LIVE && HIWORD(wParam) == BN_CLICKED)
+        {
+            if (g_liveOcrGeneration & 1) { StopLiveOcr(); return 0; }
+            if (!winrt::Windows::Graphics::Capture::GraphicsCaptureSession::IsSupported()) {
+                PostToEdit(L"[OCR DEBUG] Windows.Graphics.Capture is not supported on this system.");
+                return 0;
+            }
+
+            // Shift+click also records the session for offline replay
+            bool record = GetKeyState(VK_SHIFT) < 0;
+            RECT selected{};
+            if (!SelectScreenRegion(hWndMain, selected)) return 0;
+
+            unsigned generation = ++g_liveOcrGeneration;
+            SetWindowTextW(hBtnLive, L"Stop live");
+            LiveOcrAsync(selected, generation, record);
+        }
         else if (id == IDC_BTN_OPEN && HIWORD(wParam) == BN_CLICKED) {
             std::wstring path;
-            if (PickOpenTxtFile(hWndMain, path)) {
-                if (!LoadTextFileToEdit(hEditText, path)) MsgBox(L"Open failed.", MB_ICONERROR);
-            }
+            if (PickOpenTxtFile(hWndMain, path)) OpenDocument(path);
 }
         else if (id == IDC_BTN_SAVE && HIWORD(wParam) == BN_CLICKED) {
             std::wstring path;
@@ -1297,7 +1368,26 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
         }
         return 0;
     }
-    case WM_DESTROY: CloseSerial(); PostQuitMessage(0); return 0;
+    case WM_SERIAL_ERROR: {
+        auto* p = reinterpret_cast<std::wstring*>(lParam);
+        std::wstring m = p ? *p : L"";
+        delete p;
+        if (connected) {
+            CloseSerial();
+            MsgBox(L"Serial port closed.\n" + m, MB_ICONERROR);
+        }
+        return 0;
+    }
+    case WM_TIMER:
+        // One page at a time, and only once the device answered the previous one
+        if (wParam == IDT_PAGE_FEEDER && connected) {
+            deviceLink.Poll();
+            pageFeeder.Pump(deviceLink.Idle(), [](size_t page) {
+                return deviceLink.SendText(std::string(document.Page(page)));
+            });
+        }
+        return 0;
+    case WM_DESTROY: KillTimer(hWnd, IDT_PAGE_FEEDER); StopLiveOcr(); CloseSerial(); PostQuitMessage(0); return 0;
     }
     return DefWindowProcW(hWnd, msg, wParam, lParam);
 }
@@ -1337,7 +1427,7 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, PWSTR, int nCmdShow) {
     wc.hCursor = LoadCursor(nullptr, IDC_ARROW);
     RegisterClassW(&wc);
 
-    hWndMain = CreateWindowW(L"UsbTextSender", L"Text Sender v1.1.0", WS_OVERLAPPED | WS_CAPTION | WS_SYSMENU, CW_USEDEFAULT, CW_USEDEFAULT, 
+    hWndMain = CreateWindowW(L"UsbTextSender", kWindowTitle, WS_OVERLAPPED | WS_CAPTION | WS_SYSMENU, CW_USEDEFAULT, CW_USEDEFAULT, 
         580, 360,
         nullptr, nullptr, hInstance, nullptr);
 